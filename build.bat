@@ -87,6 +87,54 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+echo Компиляция src\modes\aes_mode.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\aes_mode.c -o build\aes_mode.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\aes_mode.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\modes\ghash.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\ghash.c -o build\ghash.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\ghash.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\modes\gcm.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\gcm.c -o build\gcm.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\gcm.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\modes\xts.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\xts.c -o build\xts.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\xts.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\modes\chacha20_poly1305.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\chacha20_poly1305.c -o build\chacha20_poly1305.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\chacha20_poly1305.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\modes\container.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\modes\container.c -o build\container.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\modes\container.c
+    pause
+    exit /b 1
+)
+
 echo Компиляция src\mouse_entropy.c...
 gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\mouse_entropy.c -o build\mouse_entropy.o
 if %ERRORLEVEL% NEQ 0 (
@@ -111,6 +159,30 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+echo Компиляция src\hash\sha256_simd.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\sha256_simd.c -o build\sha256_simd.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\sha256_simd.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\hash\sha256_many.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\sha256_many.c -o build\sha256_many.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\sha256_many.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\hash\sha512.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\sha512.c -o build\sha512.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\sha512.c
+    pause
+    exit /b 1
+)
+
 echo Компиляция src\hash\sha3.c...
 gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\sha3.c -o build\sha3.o
 if %ERRORLEVEL% NEQ 0 (
@@ -119,6 +191,38 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+echo Компиляция src\hash\keccak_simd.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\keccak_simd.c -o build\keccak_simd.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\keccak_simd.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\hash\parallelhash.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\parallelhash.c -o build\parallelhash.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\parallelhash.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\hash\blake3.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\blake3.c -o build\blake3.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\blake3.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\hash\blake3_simd.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\hash\blake3_simd.c -o build\blake3_simd.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\hash\blake3_simd.c
+    pause
+    exit /b 1
+)
+
 echo Компиляция src\mac\hmac.c...
 gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\mac\hmac.c -o build\hmac.o
 if %ERRORLEVEL% NEQ 0 (
@@ -135,8 +239,120 @@ if %ERRORLEVEL% NEQ 0 (
     exit /b 1
 )
 
+echo Компиляция src\mac\kmac.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\mac\kmac.c -o build\kmac.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\mac\kmac.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\mac\poly1305.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\mac\poly1305.c -o build\poly1305.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\mac\poly1305.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\cpu_features.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\cpu_features.c -o build\cpu_features.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\cpu_features.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_core.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_core.c -o build\aes_core.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_core.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_ni.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_ni.c -o build\aes_ni.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_ni.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_vaes.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_vaes.c -o build\aes_vaes.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_vaes.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\ghash_clmul.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\ghash_clmul.c -o build\ghash_clmul.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\ghash_clmul.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_portable.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_portable.c -o build\aes_portable.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_portable.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_bitsliced.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_bitsliced.c -o build\aes_bitsliced.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_bitsliced.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\aes\aes_parallel.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\aes\aes_parallel.c -o build\aes_parallel.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\aes\aes_parallel.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\thread_pool.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\thread_pool.c -o build\thread_pool.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\thread_pool.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\xor.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\xor.c -o build\xor.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\xor.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\chacha\chacha20.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\chacha\chacha20.c -o build\chacha20.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\chacha\chacha20.c
+    pause
+    exit /b 1
+)
+
+echo Компиляция src\chacha\chacha20_simd.c...
+gcc -Wall -Wextra -O2 -I. -D__USE_MINGW_ANSI_STDIO=1 -finput-charset=UTF-8 -fexec-charset=UTF-8 -c src\chacha\chacha20_simd.c -o build\chacha20_simd.o
+if %ERRORLEVEL% NEQ 0 (
+    echo Ошибка: Не удалось скомпилировать src\chacha\chacha20_simd.c
+    pause
+    exit /b 1
+)
+
 echo Линковка...
-gcc build\main.o build\ecb.o build\file_io.o build\cbc.o build\cfb.o build\ofb.o build\ctr.o build\utils.o build\mouse_entropy.o build\csprng.o build\sha256.o build\sha3.o build\hmac.o build\cmac.o -o cryptocore.exe -lcrypto -lbcrypt
+gcc build\main.o build\ecb.o build\file_io.o build\cbc.o build\cfb.o build\ofb.o build\ctr.o build\utils.o build\aes_mode.o build\ghash.o build\gcm.o build\xts.o build\chacha20_poly1305.o build\container.o build\mouse_entropy.o build\csprng.o build\sha256.o build\sha256_simd.o build\sha256_many.o build\sha512.o build\sha3.o build\keccak_simd.o build\parallelhash.o build\blake3.o build\blake3_simd.o build\hmac.o build\cmac.o build\kmac.o build\poly1305.o build\cpu_features.o build\aes_core.o build\aes_ni.o build\aes_vaes.o build\ghash_clmul.o build\aes_portable.o build\aes_bitsliced.o build\aes_parallel.o build\thread_pool.o build\xor.o build\chacha20.o build\chacha20_simd.o -o cryptocore.exe -lcrypto -lbcrypt
 if %ERRORLEVEL% NEQ 0 (
     echo Ошибка: Не удалось выполнить линковку. Убедитесь, что OpenSSL установлен.
     echo.
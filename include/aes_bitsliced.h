@@ -0,0 +1,37 @@
+#ifndef AES_BITSLICED_H
+#define AES_BITSLICED_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Битово-срезовая (bitsliced) реализация AES-128 на 64-битных целых
+ * Без табличных подстановок: время работы не зависит от ключа и данных
+ * За один проход ядра обрабатываются 8 блоков (два набора по 4 блока в 8 битовых плоскостях)
+ */
+
+/* Блоков за один проход ядра */
+#define AES_BITSLICED_BLOCKS 8
+
+/* Раундовые ключи в битово-срезовом виде: 11 раундов по 8 плоскостей */
+#define AES_BITSLICED_RK_WORDS (11 * 8)
+
+/**
+ * Расширение ключа AES-128 (одно расписание для шифрования и дешифрования)
+ * S-блок расписания также вычисляется без таблиц
+ */
+void aes_bitsliced_expand_key128(const unsigned char* key, uint64_t* sk);
+
+/**
+ * Шифрование nblocks независимых блоков пакетами по 8
+ * Неполный пакет дополняется внутри ядра; in и out могут совпадать
+ */
+void aes_bitsliced_encrypt(const uint64_t* sk, const unsigned char* in, unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование nblocks независимых блоков пакетами по 8
+ * Неполный пакет дополняется внутри ядра; in и out могут совпадать
+ */
+void aes_bitsliced_decrypt(const uint64_t* sk, const unsigned char* in, unsigned char* out, size_t nblocks);
+
+#endif /* AES_BITSLICED_H */
@@ -0,0 +1,183 @@
+#ifndef AES_CORE_H
+#define AES_CORE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <openssl/evp.h>
+#include "ecb.h"
+#include "aes_ni.h"
+#include "aes_portable.h"
+#include "aes_bitsliced.h"
+#include "ghash.h"
+
+/**
+ * Реализация блочного шифра AES-128
+ * Выбирается один раз при запуске по CPUID (или явно через aes_engine_select)
+ */
+typedef enum {
+    AES_ENGINE_PORTABLE = 0,    // Переносимый C, без зависимостей от процессора
+    AES_ENGINE_AESNI,           // AES-NI, 8 блоков в конвейере
+    AES_ENGINE_VAES,            // VAES/AVX-512, 16 блоков за итерацию
+    AES_ENGINE_OPENSSL,         // OpenSSL EVP
+    AES_ENGINE_BITSLICED,       // Битово-срезовый C без таблиц (постоянное время), 8 блоков за проход
+    AES_ENGINE_COUNT
+} aes_engine_t;
+
+/**
+ * Проверка доступности реализации на текущем процессоре
+ * Возвращает 1 если доступна, 0 иначе
+ */
+int aes_engine_available(aes_engine_t engine);
+
+/**
+ * Имя реализации для командной строки и --version ("portable", "aesni", "vaes", "openssl", "bitsliced")
+ */
+const char* aes_engine_name(aes_engine_t engine);
+
+/**
+ * Разбор имени реализации
+ * Возвращает 0 при успехе, -1 если имя неизвестно
+ */
+int aes_engine_parse(const char* name, aes_engine_t* engine);
+
+/**
+ * Принудительный выбор реализации для всех последующих ключей
+ * Возвращает 0 при успехе, -1 если реализация недоступна на этом процессоре
+ */
+int aes_engine_select(aes_engine_t engine);
+
+/**
+ * Активная реализация; при первом вызове выбирается лучшая доступная:
+ * VAES, затем AES-NI; без AES-NI - битово-срезовая (без утечек времени через кэш)
+ */
+aes_engine_t aes_engine_active(void);
+
+/**
+ * Подготовленный ключ AES-128 для блочных операций
+ * Реализация фиксируется в момент подготовки ключа; после использования - aes_core_key_clear
+ */
+typedef struct {
+    aes_engine_t engine;                            // Реализация, для которой подготовлен ключ
+    unsigned char ni_rk[AES_NI_ROUND_KEYS_SIZE];    // Раундовые ключи AES-NI/VAES (шифрования или дешифрования)
+    uint32_t portable_rk[AES_PORTABLE_RK_WORDS];    // Расписание ключей переносимой реализации
+    uint64_t bitsliced_rk[AES_BITSLICED_RK_WORDS];  // Раундовые ключи битово-срезовой реализации
+    unsigned char key[AES_128_KEY_SIZE];            // Исходный ключ для режимов OpenSSL EVP с IV
+    EVP_CIPHER_CTX* evp;                            // Контекст ECB OpenSSL EVP в направлении ключа
+} aes_core_key_t;
+
+/**
+ * Независимый поток для многобуферного шифрования CBC
+ */
+typedef struct {
+    const unsigned char* in;            // Открытый текст (nblocks полных блоков)
+    unsigned char* out;                 // Шифртекст, может совпадать с in
+    size_t nblocks;
+    unsigned char iv[AES_BLOCK_SIZE];   // Вектор сцепления, по завершении - последний блок шифртекста
+} aes_cbc_stream_t;
+
+/**
+ * Подготовка ключа для шифрования блоков
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_core_set_encrypt_key(aes_core_key_t* ctx, const unsigned char* key);
+
+/**
+ * Подготовка ключа для дешифрования блоков
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_core_set_decrypt_key(aes_core_key_t* ctx, const unsigned char* key);
+
+/**
+ * Освобождение контекста OpenSSL EVP и затирание ключа
+ * Безопасно для ключа, подготовка которого завершилась ошибкой
+ */
+void aes_core_key_clear(aes_core_key_t* ctx);
+
+/**
+ * Шифрование nblocks независимых 16-байтовых блоков (ECB)
+ * in и out могут совпадать
+ */
+void aes_core_encrypt_blocks(const aes_core_key_t* ctx, const unsigned char* in,
+                             unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование nblocks независимых 16-байтовых блоков (ECB)
+ * in и out могут совпадать
+ */
+void aes_core_decrypt_blocks(const aes_core_key_t* ctx, const unsigned char* in,
+                             unsigned char* out, size_t nblocks);
+
+/**
+ * Шифрование CBC сразу для nstreams независимых потоков (ключ из aes_core_set_encrypt_key)
+ * Внутри потока блоки зависят друг от друга, поэтому с AES-NI в конвейере
+ * чередуются блоки до 8 разных потоков
+ */
+void aes_core_cbc_encrypt_multi(const aes_core_key_t* ctx, aes_cbc_stream_t* streams, size_t nstreams);
+
+/**
+ * Дешифрование CBC для nblocks полных блоков (ключ из aes_core_set_decrypt_key)
+ * Блоки обрабатываются пакетами: все входы известны заранее
+ * iv - вектор сцепления (16 байт), по завершении содержит последний блок шифртекста
+ * in и out могут совпадать
+ */
+void aes_core_cbc_decrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CFB (полный блок) для nblocks полных блоков (ключ из aes_core_set_encrypt_key)
+ * iv - регистр сдвига (16 байт), по завершении содержит последний блок шифртекста
+ * in и out могут совпадать
+ */
+void aes_core_cfb_decrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * OFB: XOR len байт входа с потоком ключа (ключ из aes_core_set_encrypt_key)
+ * Поток ключа накладывается прямо в выходной буфер, неполный последний блок допускается
+ * iv - регистр обратной связи, по завершении содержит последний блок потока ключа
+ * in и out могут совпадать
+ */
+void aes_core_ofb_xor(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                      unsigned char* out, size_t len);
+
+/**
+ * Шифрование CFB (полный блок) для len байт (ключ из aes_core_set_encrypt_key)
+ * Неполный последний блок допускается
+ * iv - регистр сдвига, по завершении содержит последний полный блок шифртекста
+ * in и out могут совпадать
+ */
+void aes_core_cfb_encrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t len);
+
+/**
+ * CTR: XOR len байт входа с потоком ключа (ключ из aes_core_set_encrypt_key)
+ * Блоки счетчика строятся и шифруются пакетами, неполный последний блок допускается
+ * counter - 128-битный big-endian счетчик, по завершении увеличен на ceil(len/16)
+ * in и out могут совпадать
+ */
+void aes_core_ctr_xor(const aes_core_key_t* ctx, unsigned char* counter, const unsigned char* in,
+                      unsigned char* out, size_t len);
+
+/**
+ * XTS: nblocks полных блоков с твиками T, T*x, T*x^2, ... (ключ данных из aes_core_set_encrypt_key
+ * при encrypt = 1 или из aes_core_set_decrypt_key при encrypt = 0)
+ * С AES-NI/VAES твики вычисляются в регистрах SSE внутри конвейера, иначе - пакетами
+ * tweak - твик первого блока (little-endian), по завершении - твик следующего блока
+ * in и out могут совпадать
+ */
+void aes_core_xts_blocks(const aes_core_key_t* ctx, unsigned char* tweak, const unsigned char* in,
+                         unsigned char* out, size_t nblocks, int encrypt);
+
+/**
+ * GCM: CTR-шифрование nblocks полных блоков и GHASH шифртекста за один проход по данным
+ * (ключ из aes_core_set_encrypt_key). С AES-NI/VAES и PCLMULQDQ раунды AES и умножения
+ * GHASH чередуются в одном цикле, иначе данные обрабатываются порциями, остающимися в кэше
+ * counter - блок счетчика GCM (увеличивается только в младших 32 битах),
+ * y - аккумулятор GHASH; encrypt = 1 для шифрования, 0 для дешифрования
+ * in и out могут совпадать
+ */
+void aes_core_gcm_ctr_ghash(const aes_core_key_t* ctx, const ghash_key_t* gk, unsigned char* counter,
+                            unsigned char* y, const unsigned char* in, unsigned char* out,
+                            size_t nblocks, int encrypt);
+
+#endif /* AES_CORE_H */
@@ -0,0 +1,88 @@
+#ifndef AES_MODE_H
+#define AES_MODE_H
+
+#include <stddef.h>
+#include "ecb.h"
+#include "aes_core.h"
+#include "thread_pool.h"
+
+/**
+ * Инкрементальный интерфейс init/update/final для всех режимов AES-128
+ * Контекст хранит неполный блок и состояние сцепления между вызовами,
+ * поэтому данные можно подавать порциями произвольной длины
+ */
+
+typedef enum {
+    AES_MODE_ECB = 0,
+    AES_MODE_CBC,
+    AES_MODE_CFB,
+    AES_MODE_OFB,
+    AES_MODE_CTR
+} aes_mode_t;
+
+typedef struct {
+    aes_mode_t mode;
+    int encrypt;                        // 1 - шифрование, 0 - дешифрование
+    aes_core_key_t key;
+    thread_pool_t* pool;                // Пул для распараллеливаемых операций (NULL - один поток)
+    unsigned char iv[AES_BLOCK_SIZE];   // Вектор сцепления / регистр сдвига / обратная связь / счетчик
+    unsigned char buf[AES_BLOCK_SIZE];  // ECB/CBC: неполный или удержанный блок; CFB: шифртекст текущего блока
+    unsigned char ks[AES_BLOCK_SIZE];   // CFB/OFB/CTR: поток ключа текущего неполного блока
+    size_t buf_len;                     // ECB/CBC: байт в buf; CFB/OFB/CTR: использовано байт ks (0 - блока нет)
+} aes_mode_ctx_t;
+
+/**
+ * Максимальный объем вывода aes_mode_update для in_len байт входа
+ */
+#define AES_MODE_UPDATE_OUT_SIZE(in_len) ((in_len) + AES_BLOCK_SIZE)
+
+/**
+ * Разбор имени режима ("ecb", "cbc", "cfb", "ofb", "ctr")
+ * Возвращает 0 при успехе, -1 для неизвестного имени
+ */
+int aes_mode_parse(const char* name, aes_mode_t* mode);
+
+/**
+ * Инициализация контекста: encrypt = 1 для шифрования, 0 для дешифрования
+ * iv (16 байт) не используется в режиме ECB и может быть NULL
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_mode_init(aes_mode_ctx_t* ctx, aes_mode_t mode, int encrypt,
+                  const unsigned char* key, const unsigned char* iv);
+
+/**
+ * Подключение пула потоков: ECB, дешифрование CBC/CFB и CTR делят крупные порции между потоками
+ */
+void aes_mode_set_pool(aes_mode_ctx_t* ctx, thread_pool_t* pool);
+
+/**
+ * Произвольный доступ (только CTR): переход к байту offset потока, считая от IV
+ * Вызывается сразу после aes_mode_init, до первого aes_mode_update
+ * Счетчик сдвигается на offset / 16 блоков, первые offset % 16 байт потока ключа пропускаются
+ * Возвращает 0 при успехе, -1 для остальных режимов
+ */
+int aes_mode_seek(aes_mode_ctx_t* ctx, unsigned long long offset);
+
+/**
+ * Обработка очередной порции: out должен вмещать AES_MODE_UPDATE_OUT_SIZE(in_len) байт
+ * out может совпадать с in (обработка на месте), частичное перекрытие не допускается
+ * ECB/CBC выдают только полные блоки; при дешифровании последний блок удерживается до final
+ * Устанавливает out_len; возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_mode_update(aes_mode_ctx_t* ctx, const unsigned char* in, size_t in_len,
+                    unsigned char* out, size_t* out_len);
+
+/**
+ * Завершение: out должен вмещать AES_BLOCK_SIZE байт
+ * ECB/CBC: при шифровании выдает блок с дополнением PKCS#7, при дешифровании
+ * проверяет и снимает дополнение; CFB/OFB/CTR ничего не выдают
+ * Устанавливает out_len; возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_mode_final(aes_mode_ctx_t* ctx, unsigned char* out, size_t* out_len);
+
+/**
+ * Освобождение ключа контекста (после final или при прерывании потока)
+ */
+void aes_mode_cleanup(aes_mode_ctx_t* ctx);
+
+#endif /* AES_MODE_H */
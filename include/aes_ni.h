@@ -0,0 +1,106 @@
+#ifndef AES_NI_H
+#define AES_NI_H
+
+#include <stddef.h>
+
+/* Ядра AES-NI собираются только для x86/x86-64 с GCC-совместимым компилятором */
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTOCORE_HAVE_AESNI 1
+#endif
+
+/* Размер расписания ключей AES-128: 11 раундовых ключей по 16 байт */
+#define AES_NI_ROUND_KEYS_SIZE (11 * 16)
+
+/* Максимальное число независимых потоков в многобуферном CBC */
+#define AES_NI_CBC_LANES 8
+
+/**
+ * Проверка поддержки AES-NI процессором
+ * Возвращает 1 если инструкции доступны, 0 иначе
+ */
+int aes_ni_available(void);
+
+/**
+ * Расширение ключа AES-128
+ * enc_rk - раундовые ключи шифрования, dec_rk - раундовые ключи дешифрования
+ * (в порядке применения, с AESIMC для средних раундов). dec_rk может быть NULL
+ */
+void aes_ni_expand_key128(const unsigned char* key, unsigned char* enc_rk, unsigned char* dec_rk);
+
+/**
+ * Шифрование nblocks независимых блоков (по 8 блоков за итерацию)
+ * in и out могут совпадать
+ */
+void aes_ni_ecb_encrypt(const unsigned char* enc_rk, const unsigned char* in,
+                        unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование nblocks независимых блоков (по 8 блоков за итерацию)
+ * in и out могут совпадать
+ */
+void aes_ni_ecb_decrypt(const unsigned char* dec_rk, const unsigned char* in,
+                        unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CBC: nblocks полных блоков, 8 блоков в конвейере
+ * (каждый блок зависит только от уже известного шифртекста)
+ * iv - вектор сцепления, по завершении содержит последний блок шифртекста
+ * in и out могут совпадать
+ */
+void aes_ni_cbc_decrypt(const unsigned char* dec_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CFB (полный блок): nblocks полных блоков, 8 блоков в конвейере
+ * Используются раундовые ключи шифрования
+ * iv - регистр сдвига, по завершении содержит последний блок шифртекста
+ * in и out могут совпадать
+ */
+void aes_ni_cfb_decrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t nblocks);
+
+/**
+ * OFB: XOR len байт входа с потоком ключа E(iv), E(E(iv)), ...
+ * Регистр обратной связи остается в регистре процессора, поток ключа сразу накладывается на вход
+ * iv по завершении содержит последний блок потока ключа; in и out могут совпадать
+ */
+void aes_ni_ofb_xor(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                    unsigned char* out, size_t len);
+
+/**
+ * Шифрование CFB (полный блок): len байт, неполный последний блок допускается
+ * iv по завершении содержит последний полный блок шифртекста; in и out могут совпадать
+ */
+void aes_ni_cfb_encrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t len);
+
+/**
+ * CTR: XOR len байт входа с потоком ключа E(counter), E(counter+1), ...
+ * Счетчики строятся пакетами по 8 блоков (быстрый путь без переноса в младших 64 битах)
+ * counter - 128-битный big-endian счетчик, по завершении увеличен на ceil(len/16)
+ * in и out могут совпадать
+ */
+void aes_ni_ctr_xor(const unsigned char* enc_rk, unsigned char* counter, const unsigned char* in,
+                    unsigned char* out, size_t len);
+
+/**
+ * XTS: nblocks полных блоков, out = E(in ^ T) ^ T (или D) с твиками T, T*x, T*x^2, ...
+ * rk - раундовые ключи шифрования или дешифрования (encrypt = 1 или 0)
+ * tweak - твик первого блока (little-endian), по завершении - твик следующего блока
+ * in и out могут совпадать
+ */
+void aes_ni_xts_blocks(const unsigned char* rk, unsigned char* tweak, const unsigned char* in,
+                       unsigned char* out, size_t nblocks, int encrypt);
+
+/**
+ * Многобуферное шифрование CBC: nlanes (не более AES_NI_CBC_LANES) независимых потоков
+ * Цепочка внутри потока последовательна, поэтому блоки разных потоков чередуются в конвейере
+ * Поток i шифрует nblocks[i] блоков из in[i] в out[i] с вектором сцепления ivs + 16*i;
+ * по завершении ivs содержит последний блок шифртекста каждого потока
+ * in[i] и out[i] могут совпадать
+ */
+void aes_ni_cbc_encrypt_multi(const unsigned char* enc_rk, unsigned char* ivs,
+                              const unsigned char* const* in, unsigned char* const* out,
+                              const size_t* nblocks, size_t nlanes);
+
+#endif /* AES_NI_H */
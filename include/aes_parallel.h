@@ -0,0 +1,47 @@
+#ifndef AES_PARALLEL_H
+#define AES_PARALLEL_H
+
+#include <stddef.h>
+#include "aes_core.h"
+#include "thread_pool.h"
+
+/**
+ * Многопоточные варианты операций aes_core для распараллеливаемых режимов
+ * Буфер делится на непрерывные участки по числу потоков пула; результат
+ * побайтно совпадает с однопоточным вызовом. При pool == NULL или малом объеме
+ * данных вызывается однопоточная функция aes_core
+ */
+
+/**
+ * Шифрование nblocks независимых блоков (ECB), in и out могут совпадать
+ */
+void aes_par_encrypt_blocks(thread_pool_t* pool, const aes_core_key_t* ctx, const unsigned char* in,
+                            unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование nblocks независимых блоков (ECB), in и out могут совпадать
+ */
+void aes_par_decrypt_blocks(thread_pool_t* pool, const aes_core_key_t* ctx, const unsigned char* in,
+                            unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CBC (см. aes_core_cbc_decrypt)
+ * Вектор сцепления каждого участка - последний блок шифртекста предыдущего участка
+ */
+void aes_par_cbc_decrypt(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* iv,
+                         const unsigned char* in, unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CFB (см. aes_core_cfb_decrypt)
+ */
+void aes_par_cfb_decrypt(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* iv,
+                         const unsigned char* in, unsigned char* out, size_t nblocks);
+
+/**
+ * CTR (см. aes_core_ctr_xor)
+ * Счетчик каждого участка вычисляется через increment_counter_be
+ */
+void aes_par_ctr_xor(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* counter,
+                     const unsigned char* in, unsigned char* out, size_t len);
+
+#endif /* AES_PARALLEL_H */
@@ -0,0 +1,24 @@
+#ifndef AES_PORTABLE_H
+#define AES_PORTABLE_H
+
+#include <stdint.h>
+
+/* Расписание ключей AES-128: 44 32-битных слова (11 раундовых ключей) */
+#define AES_PORTABLE_RK_WORDS 44
+
+/**
+ * Расширение ключа AES-128 (одно расписание для шифрования и дешифрования)
+ */
+void aes_portable_expand_key128(const unsigned char* key, uint32_t* rk);
+
+/**
+ * Шифрование одного 16-байтового блока, in и out могут совпадать
+ */
+void aes_portable_encrypt_block(const uint32_t* rk, const unsigned char* in, unsigned char* out);
+
+/**
+ * Дешифрование одного 16-байтового блока (обратный шифр), in и out могут совпадать
+ */
+void aes_portable_decrypt_block(const uint32_t* rk, const unsigned char* in, unsigned char* out);
+
+#endif /* AES_PORTABLE_H */
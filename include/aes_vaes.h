@@ -0,0 +1,55 @@
+#ifndef AES_VAES_H
+#define AES_VAES_H
+
+#include <stddef.h>
+#include "aes_ni.h"
+
+/*
+ * Ядра VAES/AVX-512: 4 блока в одном 512-битном регистре, 16 блоков за итерацию
+ * Используют те же раундовые ключи, что и AES-NI (aes_ni_expand_key128);
+ * хвосты короче 16 блоков обрабатываются ядрами AES-NI
+ */
+
+/**
+ * Проверка поддержки VAES с AVX-512 (и AES-NI для хвостов)
+ * Возвращает 1 если инструкции доступны, 0 иначе
+ */
+int aes_vaes_available(void);
+
+/**
+ * Шифрование nblocks независимых блоков, in и out могут совпадать
+ */
+void aes_vaes_ecb_encrypt(const unsigned char* enc_rk, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование nblocks независимых блоков, in и out могут совпадать
+ */
+void aes_vaes_ecb_decrypt(const unsigned char* dec_rk, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CBC, семантика как у aes_ni_cbc_decrypt
+ */
+void aes_vaes_cbc_decrypt(const unsigned char* dec_rk, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * Дешифрование CFB (полный блок), семантика как у aes_ni_cfb_decrypt
+ */
+void aes_vaes_cfb_decrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks);
+
+/**
+ * CTR, семантика как у aes_ni_ctr_xor
+ */
+void aes_vaes_ctr_xor(const unsigned char* enc_rk, unsigned char* counter, const unsigned char* in,
+                      unsigned char* out, size_t len);
+
+/**
+ * XTS, семантика как у aes_ni_xts_blocks; твики 16 блоков считаются в регистрах AVX-512
+ */
+void aes_vaes_xts_blocks(const unsigned char* rk, unsigned char* tweak, const unsigned char* in,
+                         unsigned char* out, size_t nblocks, int encrypt);
+
+#endif /* AES_VAES_H */
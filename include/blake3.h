@@ -0,0 +1,53 @@
+#ifndef BLAKE3_H
+#define BLAKE3_H
+
+#include "thread_pool.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * BLAKE3 (unkeyed hash, 256-bit output)
+ * The input is a binary tree of 1 KB chunks: chunks and subtrees are independent,
+ * so they are hashed in SIMD lanes and on the thread pool
+ */
+
+#define BLAKE3_OUT_LEN 32
+#define BLAKE3_BLOCK_LEN 64
+#define BLAKE3_CHUNK_LEN 1024
+#define BLAKE3_MAX_DEPTH 54             // 2^54 chunks = 2^64 bytes
+
+typedef struct {
+    uint32_t cv[8];                     // Chaining value of the current chunk
+    uint64_t chunk_counter;             // Index of the current chunk
+    uint8_t buf[BLAKE3_BLOCK_LEN];      // Block not yet compressed (it may be the last one)
+    size_t buf_len;
+    size_t blocks_compressed;           // Blocks of the current chunk already compressed
+} blake3_chunk_state_t;
+
+typedef struct {
+    blake3_chunk_state_t chunk;         // The chunk being filled (always holds the last input bytes)
+    uint32_t cv_stack[BLAKE3_MAX_DEPTH + 1][8];  // Chaining values of finished subtrees, merged lazily
+    size_t cv_stack_len;
+} blake3_ctx_t;
+
+void blake3_init(blake3_ctx_t* ctx);
+void blake3_update(blake3_ctx_t* ctx, const uint8_t* data, size_t len);
+void blake3_final(const blake3_ctx_t* ctx, uint8_t* hash);
+
+/**
+ * blake3_update with whole subtrees of the input hashed on pool (NULL: calling thread)
+ */
+void blake3_update_parallel(thread_pool_t* pool, blake3_ctx_t* ctx, const uint8_t* data, size_t len);
+
+/**
+ * Hash a file; the next batch is read while the pool hashes the current one
+ * Returns 0 on success, -1 on error
+ */
+int blake3_hash_file(thread_pool_t* pool, const char* filepath, uint8_t* hash);
+
+/**
+ * Active many-chunk kernel: "avx512", "avx2" or "portable"
+ */
+const char* blake3_impl_name(void);
+
+#endif // BLAKE3_H
@@ -0,0 +1,39 @@
+#ifndef BLAKE3_SIMD_H
+#define BLAKE3_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * BLAKE3 compression of several independent inputs at once, selected at runtime by blake3.c
+ * Every input has nblocks 64-byte blocks; input j starts from key[] and uses
+ * counter + j (increment_counter) or counter; flags_start/flags_end are added to the
+ * first/last block. The 32-byte chaining value of input j goes to out + 32 * j
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTOCORE_HAVE_BLAKE3_SIMD 1
+#endif
+
+extern const uint32_t blake3_iv[8];
+extern const uint8_t blake3_msg_schedule[7][16];
+
+// Inputs per call of the kernels
+#define BLAKE3_AVX2_WAYS 8
+#define BLAKE3_AVX512_WAYS 16
+
+/**
+ * Check for AVX2 / AVX-512F
+ * Returns 1 if the instructions are usable, 0 otherwise
+ */
+int blake3_avx2_available(void);
+int blake3_avx512_available(void);
+
+#ifdef CRYPTOCORE_HAVE_BLAKE3_SIMD
+void blake3_hash8_avx2(const uint8_t* const* inputs, size_t nblocks, const uint32_t* key, uint64_t counter,
+                       int increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end, uint8_t* out);
+void blake3_hash16_avx512(const uint8_t* const* inputs, size_t nblocks, const uint32_t* key, uint64_t counter,
+                          int increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end, uint8_t* out);
+#endif
+
+#endif // BLAKE3_SIMD_H
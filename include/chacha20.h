@@ -0,0 +1,45 @@
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Потоковый шифр ChaCha20 (RFC 8439): 256-битный ключ, 96-битный nonce, 32-битный счетчик блоков
+ * Не использует таблиц и AES-NI: постоянное время и высокая скорость на любом процессоре
+ * Реализация выбирается во время выполнения: AVX2 (8 блоков), SSE2 (4 блока) или переносимый C
+ */
+
+#define CHACHA20_KEY_SIZE 32
+#define CHACHA20_NONCE_SIZE 12
+#define CHACHA20_BLOCK_SIZE 64
+
+typedef struct {
+    uint32_t state[16];                     // Константы, ключ, счетчик (слово 12), nonce
+    unsigned char ks[CHACHA20_BLOCK_SIZE];  // Поток ключа текущего неполного блока
+    size_t ks_used;                         // Использовано байт ks (CHACHA20_BLOCK_SIZE - остатка нет)
+} chacha20_ctx_t;
+
+/**
+ * Имя активной реализации ("avx2", "sse2" или "portable")
+ */
+const char* chacha20_impl_name(void);
+
+/**
+ * Инициализация: key - CHACHA20_KEY_SIZE байт, nonce - CHACHA20_NONCE_SIZE байт,
+ * counter - номер первого блока потока ключа
+ */
+void chacha20_init(chacha20_ctx_t* ctx, const unsigned char* key, const unsigned char* nonce, uint32_t counter);
+
+/**
+ * XOR len байт входа с потоком ключа; вызовы можно продолжать с любой длиной
+ * in и out могут совпадать
+ */
+void chacha20_xor(chacha20_ctx_t* ctx, const unsigned char* in, unsigned char* out, size_t len);
+
+/**
+ * Один блок потока ключа для состояния state (счетчик не меняется)
+ */
+void chacha20_block(const uint32_t* state, unsigned char* out);
+
+#endif /* CHACHA20_H */
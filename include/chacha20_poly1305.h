@@ -0,0 +1,77 @@
+#ifndef CHACHA20_POLY1305_H
+#define CHACHA20_POLY1305_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "chacha20.h"
+#include "poly1305.h"
+
+/**
+ * AEAD ChaCha20-Poly1305 (RFC 8439) - альтернатива AES-GCM без AES-NI и PCLMULQDQ
+ * Ключ Poly1305 - первые 32 байта блока 0 потока ChaCha20, данные шифруются с блока 1
+ * Интерфейс повторяет gcm.h
+ */
+
+#define CHACHA20_POLY1305_KEY_SIZE CHACHA20_KEY_SIZE
+#define CHACHA20_POLY1305_NONCE_SIZE CHACHA20_NONCE_SIZE
+#define CHACHA20_POLY1305_TAG_SIZE POLY1305_TAG_SIZE
+
+/* Предел RFC 8439 для одного nonce: 2^32 - 1 блоков по 64 байта (~256 ГБ) */
+#define CHACHA20_POLY1305_MAX_DATA_LEN ((((uint64_t)1 << 32) - 1) * CHACHA20_BLOCK_SIZE)
+
+typedef struct {
+    chacha20_ctx_t chacha;
+    poly1305_ctx_t poly;
+    uint64_t aad_len;
+    uint64_t data_len;
+    int encrypt;                            // 1 - шифрование, 0 - дешифрование
+    int data_started;                       // AAD завершены, идут данные
+} chacha20_poly1305_ctx_t;
+
+/**
+ * Инициализация: key - CHACHA20_POLY1305_KEY_SIZE байт, nonce - CHACHA20_POLY1305_NONCE_SIZE байт
+ * encrypt = 1 для шифрования, 0 для дешифрования
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int chacha20_poly1305_init(chacha20_poly1305_ctx_t* ctx, const unsigned char* key, const unsigned char* nonce, int encrypt);
+
+/**
+ * Дополнительные аутентифицируемые данные (AAD), до первого chacha20_poly1305_update
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int chacha20_poly1305_aad(chacha20_poly1305_ctx_t* ctx, const unsigned char* aad, size_t aad_len);
+
+/**
+ * Шифрование/дешифрование очередной порции: len байт из in в out (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при превышении CHACHA20_POLY1305_MAX_DATA_LEN
+ */
+int chacha20_poly1305_update(chacha20_poly1305_ctx_t* ctx, const unsigned char* in, size_t len, unsigned char* out);
+
+/**
+ * Завершение: вычисление тега аутентификации (CHACHA20_POLY1305_TAG_SIZE байт)
+ */
+void chacha20_poly1305_final(chacha20_poly1305_ctx_t* ctx, unsigned char* tag);
+
+/**
+ * Завершение дешифрования: сравнение вычисленного тега с ожидаемым за постоянное время
+ * Возвращает 0 если тег верен, -1 иначе
+ */
+int chacha20_poly1305_final_verify(chacha20_poly1305_ctx_t* ctx, const unsigned char* expected_tag);
+
+/**
+ * Шифрование в буфер вызывающей стороны (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int chacha20_poly1305_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                                   const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+                                   unsigned char* out, unsigned char* tag);
+
+/**
+ * Дешифрование с проверкой тега (out может совпадать с in)
+ * При неверном теге out обнуляется; возвращает 0 при успехе, -1 при ошибке
+ */
+int chacha20_poly1305_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                                   const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+                                   const unsigned char* tag, unsigned char* out);
+
+#endif /* CHACHA20_POLY1305_H */
@@ -0,0 +1,40 @@
+#ifndef CHACHA20_SIMD_H
+#define CHACHA20_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Векторные ядра ChaCha20: блоки обрабатываются "вертикально" - каждое слово
+ * состояния хранится в отдельном регистре, дорожки регистра - разные блоки
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTOCORE_HAVE_CHACHA_SIMD 1
+#endif
+
+/* Блоков за проход ядер */
+#define CHACHA20_SSE2_BLOCKS 4
+#define CHACHA20_AVX2_BLOCKS 8
+
+/**
+ * Проверка поддержки SSE2 / AVX2
+ * Возвращает 1 если инструкции доступны, 0 иначе
+ */
+int chacha20_sse2_available(void);
+int chacha20_avx2_available(void);
+
+#ifdef CRYPTOCORE_HAVE_CHACHA_SIMD
+/**
+ * XOR nblocks блоков (кратно CHACHA20_SSE2_BLOCKS) с потоком ключа, state[12] увеличивается на nblocks
+ * in и out могут совпадать
+ */
+void chacha20_sse2_xor_blocks(uint32_t* state, const unsigned char* in, unsigned char* out, size_t nblocks);
+
+/**
+ * То же для AVX2: nblocks кратно CHACHA20_AVX2_BLOCKS
+ */
+void chacha20_avx2_xor_blocks(uint32_t* state, const unsigned char* in, unsigned char* out, size_t nblocks);
+#endif
+
+#endif /* CHACHA20_SIMD_H */
@@ -0,0 +1,108 @@
+#ifndef CONTAINER_H
+#define CONTAINER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "thread_pool.h"
+
+/**
+ * Контейнер с разбиением на порции (chunked AEAD, конструкция STREAM)
+ *
+ * [Заголовок 32 байта][Порция 0][Порция 1]...[Порция N-1][Индекс N * 8 байт][Концевик 16 байт]
+ *
+ * Заголовок: "CCAE", версия, AEAD, размер порции, длина открытого текста, префикс nonce
+ * Порция i: шифртекст (chunk_size байт, последняя короче) и тег 16 байт
+ * Nonce порции: префикс (7 байт) || номер порции (32 бита, big-endian) || признак последней (1 байт)
+ * Заголовок целиком входит в AAD каждой порции; перестановка, удаление или обрезка порций
+ * меняют nonce и обнаруживаются проверкой тега
+ * Индекс - смещения порций в файле (little-endian), концевик: "CCIX", число порций, смещение индекса
+ * Порции независимы: шифруются и проверяются параллельно, повреждение порции N обнаруживается
+ * до записи ее открытого текста
+ */
+
+#define CONTAINER_MAGIC "CCAE"
+#define CONTAINER_INDEX_MAGIC "CCIX"
+#define CONTAINER_VERSION 1
+#define CONTAINER_HEADER_SIZE 32
+#define CONTAINER_FOOTER_SIZE 16
+#define CONTAINER_TAG_SIZE 16
+#define CONTAINER_NONCE_PREFIX_SIZE 7
+#define CONTAINER_DEFAULT_CHUNK_SIZE (1024 * 1024)
+#define CONTAINER_MIN_CHUNK_SIZE 4096
+#define CONTAINER_MAX_CHUNK_SIZE (64 * 1024 * 1024)
+
+typedef enum {
+    CONTAINER_AEAD_AES_GCM = 1,
+    CONTAINER_AEAD_CHACHA20_POLY1305 = 2
+} container_aead_t;
+
+typedef struct {
+    container_aead_t aead;
+    uint32_t chunk_size;                                // Байт открытого текста в полной порции
+    uint64_t plain_len;                                 // Длина открытого текста
+    uint64_t chunk_count;                               // Число порций (не меньше 1)
+    unsigned char nonce_prefix[CONTAINER_NONCE_PREFIX_SIZE];
+    unsigned char header[CONTAINER_HEADER_SIZE];        // Закодированный заголовок (AAD порций)
+    unsigned char key[32];
+} container_t;
+
+/**
+ * Размер ключа AEAD: 16 байт для AES-GCM, 32 для ChaCha20-Poly1305
+ */
+size_t container_key_size(container_aead_t aead);
+
+/**
+ * Подготовка контейнера для записи: заголовок кодируется в c->header
+ * Возвращает 0 при успехе, -1 при недопустимых параметрах
+ */
+int container_init(container_t* c, container_aead_t aead, const unsigned char* key, uint32_t chunk_size,
+                   const unsigned char* nonce_prefix, uint64_t plain_len);
+
+/**
+ * Разбор заголовка прочитанного контейнера; aead - ожидаемый алгоритм
+ * Возвращает 0 при успехе, -1 если заголовок поврежден или алгоритм не совпадает
+ */
+int container_parse_header(container_t* c, container_aead_t aead, const unsigned char* key,
+                           const unsigned char* header);
+
+/**
+ * Длина открытого текста порции index и ее смещение в файле
+ */
+size_t container_chunk_plain_len(const container_t* c, uint64_t index);
+uint64_t container_chunk_offset(const container_t* c, uint64_t index);
+
+/**
+ * Смещение индекса и полный размер файла контейнера (с индексом и концевиком)
+ */
+uint64_t container_index_offset(const container_t* c);
+uint64_t container_file_size(const container_t* c);
+
+/**
+ * Запись индекса и концевика: out вмещает chunk_count * 8 + CONTAINER_FOOTER_SIZE байт
+ */
+void container_encode_index(const container_t* c, unsigned char* out);
+
+/**
+ * Проверка индекса и концевика, прочитанных с конца файла (тот же размер, что при записи)
+ * Возвращает 0 если они соответствуют заголовку, -1 иначе
+ */
+int container_check_index(const container_t* c, const unsigned char* index);
+
+/**
+ * Шифрование count порций начиная с first: in - открытый текст порций подряд,
+ * out - запечатанные порции подряд (шифртекст и тег каждой)
+ * При pool != NULL порции распределяются между потоками
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int container_seal_chunks(thread_pool_t* pool, const container_t* c, uint64_t first,
+                          const unsigned char* in, unsigned char* out, size_t count);
+
+/**
+ * Проверка и дешифрование count порций начиная с first (обратное container_seal_chunks)
+ * Возвращает 0 если все теги верны; иначе -1, bad_chunk - номер первой поврежденной порции
+ * (открытый текст поврежденных порций не возвращается)
+ */
+int container_open_chunks(thread_pool_t* pool, const container_t* c, uint64_t first,
+                          const unsigned char* in, unsigned char* out, size_t count, uint64_t* bad_chunk);
+
+#endif /* CONTAINER_H */
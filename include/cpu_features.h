@@ -0,0 +1,30 @@
+#ifndef CPU_FEATURES_H
+#define CPU_FEATURES_H
+
+/**
+ * Возможности процессора, определенные через CPUID (с учетом поддержки ОС для AVX/AVX-512)
+ */
+typedef struct {
+    int sse2;
+    int ssse3;
+    int sse41;
+    int aesni;
+    int pclmul;
+    int avx;
+    int avx2;
+    int avx512f;
+    int avx512bw;
+    int avx512vl;
+    int vaes;
+    int vpclmulqdq;
+    int sha;
+} cpu_features_t;
+
+/**
+ * Получение возможностей текущего процессора
+ * Определение выполняется один раз, результат кэшируется; вызов безопасен из любых потоков
+ * На не-x86 платформах все флаги равны 0
+ */
+const cpu_features_t* cpu_features_get(void);
+
+#endif /* CPU_FEATURES_H */
@@ -6,6 +6,9 @@
 #define AES_BLOCK_SIZE 16
 #define AES_128_KEY_SIZE 16
 
+/* Длина шифртекста ECB/CBC с дополнением PKCS#7 для открытого текста длины len */
+#define AES_PKCS7_PADDED_SIZE(len) (((len) / AES_BLOCK_SIZE + 1) * AES_BLOCK_SIZE)
+
 /**
  * Шифрование данных с использованием AES-128 в режиме ECB с дополнением PKCS#7
  * Возвращает указатель на выделенный буфер с зашифрованными данными, устанавливает output_size
@@ -22,6 +25,51 @@ unsigned char* aes_ecb_encrypt(const unsigned char* plaintext, size_t plaintext_
 unsigned char* aes_ecb_decrypt(const unsigned char* ciphertext, size_t ciphertext_len,
                                 const unsigned char* key, size_t* output_size);
 
+/**
+ * Шифрование ECB с дополнением PKCS#7 в буфер вызывающей стороны, без промежуточных копий
+ * out должен вмещать AES_PKCS7_PADDED_SIZE(plaintext_len) байт; out может совпадать с plaintext
+ * Возвращает 0 при успехе, -1 при ошибке; устанавливает output_size
+ */
+int aes_ecb_encrypt_into(const unsigned char* plaintext, size_t plaintext_len,
+                         const unsigned char* key, unsigned char* out, size_t out_capacity,
+                         size_t* output_size);
+
+/**
+ * Шифрование ECB на месте: data_len байт открытого текста в buf емкостью buf_capacity
+ * (не меньше AES_PKCS7_PADDED_SIZE(data_len))
+ * Возвращает 0 при успехе, -1 при ошибке; устанавливает output_size
+ */
+int aes_ecb_encrypt_inplace(unsigned char* buf, size_t data_len, size_t buf_capacity,
+                            const unsigned char* key, size_t* output_size);
+
+/**
+ * Дешифрование ECB с проверкой дополнения PKCS#7 в буфер вызывающей стороны
+ * Последний блок проверяется первым, поэтому out достаточно вместить сам открытый текст
+ * (не больше ciphertext_len - 1 байт); out может совпадать с ciphertext
+ * Возвращает 0 при успехе, -1 при ошибке; устанавливает output_size
+ */
+int aes_ecb_decrypt_into(const unsigned char* ciphertext, size_t ciphertext_len,
+                         const unsigned char* key, unsigned char* out, size_t out_capacity,
+                         size_t* output_size);
+
+/**
+ * Дешифрование ECB на месте: открытый текст остается в начале buf
+ * Возвращает 0 при успехе, -1 при ошибке; устанавливает output_size
+ */
+int aes_ecb_decrypt_inplace(unsigned char* buf, size_t buf_len, const unsigned char* key,
+                            size_t* output_size);
+
+/**
+ * Построение последнего блока с дополнением PKCS#7 из tail_len (< 16) оставшихся байтов
+ */
+void pkcs7_pad_block(unsigned char* block, const unsigned char* tail, size_t tail_len);
+
+/**
+ * Проверка дополнения PKCS#7 в последнем расшифрованном блоке
+ * Возвращает длину дополнения (1..16) или -1 при ошибке
+ */
+int pkcs7_unpad_length(const unsigned char* block);
+
 /**
  * Преобразование hex-строки в байты
  * Возвращает указатель на выделенный массив байтов, устанавливает size
@@ -2,6 +2,7 @@
 #define FILE_IO_H
 
 #include <stddef.h>
+#include <stdio.h>
 
 /**
  * Чтение всего файла в память
@@ -16,4 +17,46 @@ unsigned char* read_file(const char* filename, size_t* size);
  */
 int write_file(const char* filename, const unsigned char* data, size_t size);
 
+/* Байт файла на поток пула за один пакет (многопоточные хеши файлов) */
+#define FILE_BATCH_PER_THREAD (4 * 1024 * 1024)
+
+/**
+ * Чтение файла пакетами с опережением: пока задания пула обрабатывают cur,
+ * одно дополнительное задание (file_batches_read_ahead) заполняет следующий буфер
+ * Короткое чтение - конец файла (или ошибка чтения, см. file_batches_close)
+ */
+typedef struct {
+    FILE* f;
+    const char* path;
+    unsigned char* cur;                 // Текущий пакет
+    unsigned char* next;                // Буфер для чтения с опережением
+    size_t cap;                         // Размер пакета в байтах
+    size_t len;                         // Байт в cur
+    size_t next_len;                    // Байт в next после file_batches_read_ahead
+    int more;                           // cur полон: следующий пакет читается заранее
+} file_batches_t;
+
+/**
+ * Открытие файла, выделение двух буферов по batch байт и чтение первого пакета
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int file_batches_open(file_batches_t* b, const char* path, size_t batch);
+
+/**
+ * Чтение следующего пакета в next; вызывается одним заданием пула, только при b->more
+ */
+void file_batches_read_ahead(file_batches_t* b);
+
+/**
+ * Переход к прочитанному заранее пакету
+ * Возвращает 1 если следующий пакет есть, 0 если cur был последним
+ */
+int file_batches_next(file_batches_t* b);
+
+/**
+ * Закрытие файла и освобождение буферов
+ * Возвращает 0 при успехе, -1 если при чтении была ошибка
+ */
+int file_batches_close(file_batches_t* b);
+
 #endif /* FILE_IO_H */
@@ -0,0 +1,87 @@
+#ifndef GCM_H
+#define GCM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ecb.h"
+#include "aes_core.h"
+#include "ghash.h"
+
+/**
+ * Режим GCM (Galois/Counter Mode, NIST SP 800-38D) для AES-128
+ * Шифрование CTR и аутентификация GHASH за один проход по данным
+ * Поддерживается рекомендуемый 96-битный IV
+ */
+
+#define AES_GCM_IV_SIZE 12
+#define AES_GCM_TAG_SIZE 16
+
+/* Предел SP 800-38D для одного IV: 2^32 - 2 блока открытого текста (~64 ГБ) */
+#define AES_GCM_MAX_DATA_LEN ((((uint64_t)1 << 32) - 2) * AES_BLOCK_SIZE)
+
+typedef struct {
+    aes_core_key_t key;
+    ghash_key_t ghash;
+    unsigned char j0[AES_BLOCK_SIZE];       // Начальный блок счетчика (IV || 0^31 || 1)
+    unsigned char counter[AES_BLOCK_SIZE];  // Счетчик следующего блока данных
+    unsigned char y[AES_BLOCK_SIZE];        // Аккумулятор GHASH
+    unsigned char buf[AES_BLOCK_SIZE];      // Неполный блок AAD или шифртекста для GHASH
+    unsigned char ks[AES_BLOCK_SIZE];       // Поток ключа текущего неполного блока данных
+    size_t buf_len;                         // Байт в buf (для данных - использовано байт ks)
+    uint64_t aad_len;
+    uint64_t data_len;
+    int encrypt;                            // 1 - шифрование, 0 - дешифрование
+    int data_started;                       // AAD завершены, идут данные
+} aes_gcm_ctx_t;
+
+/**
+ * Инициализация: iv - AES_GCM_IV_SIZE байт, encrypt = 1 для шифрования, 0 для дешифрования
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_gcm_init(aes_gcm_ctx_t* ctx, const unsigned char* key, const unsigned char* iv, int encrypt);
+
+/**
+ * Дополнительные аутентифицируемые данные (AAD), до первого aes_gcm_update
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_gcm_aad(aes_gcm_ctx_t* ctx, const unsigned char* aad, size_t aad_len);
+
+/**
+ * Шифрование/дешифрование очередной порции: len байт из in в out (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при превышении AES_GCM_MAX_DATA_LEN
+ */
+int aes_gcm_update(aes_gcm_ctx_t* ctx, const unsigned char* in, size_t len, unsigned char* out);
+
+/**
+ * Завершение: вычисление тега аутентификации (AES_GCM_TAG_SIZE байт)
+ */
+void aes_gcm_final(aes_gcm_ctx_t* ctx, unsigned char* tag);
+
+/**
+ * Завершение дешифрования: сравнение вычисленного тега с ожидаемым за постоянное время
+ * Возвращает 0 если тег верен, -1 иначе
+ */
+int aes_gcm_final_verify(aes_gcm_ctx_t* ctx, const unsigned char* expected_tag);
+
+/**
+ * Освобождение ключа контекста (после final или при прерывании потока)
+ */
+void aes_gcm_cleanup(aes_gcm_ctx_t* ctx);
+
+/**
+ * Шифрование GCM в буфер вызывающей стороны (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_gcm_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, const unsigned char* aad, size_t aad_len,
+                         unsigned char* out, unsigned char* tag);
+
+/**
+ * Дешифрование GCM с проверкой тега (out может совпадать с in)
+ * При неверном теге out обнуляется; возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_gcm_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, const unsigned char* aad, size_t aad_len,
+                         const unsigned char* tag, unsigned char* out);
+
+#endif /* GCM_H */
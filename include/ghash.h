@@ -0,0 +1,29 @@
+#ifndef GHASH_H
+#define GHASH_H
+
+#include <stddef.h>
+#include "ghash_clmul.h"
+
+/**
+ * Ключ GHASH (умножение в GF(2^128) на H = E_K(0^128))
+ * Ядро выбирается при инициализации: PCLMULQDQ, если доступен, иначе
+ * переносимая реализация с постоянным временем на 64-битных умножениях
+ */
+typedef struct {
+    unsigned char h[16];
+    unsigned char hpow[GHASH_CLMUL_POWERS][16];   // Степени H для PCLMULQDQ
+    int clmul;                                    // 1 - используется PCLMULQDQ
+} ghash_key_t;
+
+/**
+ * Инициализация ключа GHASH из H (16 байт)
+ */
+void ghash_init(ghash_key_t* key, const unsigned char* h);
+
+/**
+ * GHASH nblocks полных блоков: y = (y ^ X1) * H, затем (y ^ X2) * H, ...
+ * y - 16-байтовый аккумулятор
+ */
+void ghash_blocks(const ghash_key_t* key, unsigned char* y, const unsigned char* in, size_t nblocks);
+
+#endif /* GHASH_H */
@@ -0,0 +1,45 @@
+#ifndef GHASH_CLMUL_H
+#define GHASH_CLMUL_H
+
+#include <stddef.h>
+#include "aes_ni.h"
+
+/*
+ * Ядра GHASH на PCLMULQDQ (умножение без переносов) для режима GCM
+ * Элементы поля хранятся с обратным порядком байтов (как их загружает PSHUFB),
+ * степени H^1..H^GHASH_CLMUL_POWERS позволяют редуцировать один раз на 8 блоков
+ */
+
+/* Число предвычисленных степеней H (блоков на одну редукцию) */
+#define GHASH_CLMUL_POWERS 8
+
+/**
+ * Проверка поддержки PCLMULQDQ и SSSE3
+ * Возвращает 1 если инструкции доступны, 0 иначе
+ */
+int ghash_clmul_available(void);
+
+/**
+ * Предвычисление степеней H: hpow - GHASH_CLMUL_POWERS элементов по 16 байт (H^1 первым)
+ */
+void ghash_clmul_init(const unsigned char* h, unsigned char* hpow);
+
+/**
+ * GHASH nblocks полных блоков: y = (y ^ X1) * H ^ X2) * H ...
+ * y - 16-байтовый аккумулятор в обычном порядке байтов
+ */
+void ghash_clmul_blocks(const unsigned char* hpow, unsigned char* y, const unsigned char* in, size_t nblocks);
+
+/**
+ * Совмещенный проход GCM: CTR-шифрование nblocks полных блоков и GHASH шифртекста
+ * Умножения GHASH чередуются с раундами AES восьми блоков счетчика
+ * (при шифровании хешируется шифртекст предыдущей восьмерки)
+ * counter - блок счетчика GCM (увеличивается только в младших 32 битах),
+ * y - аккумулятор GHASH; encrypt = 1 для шифрования, 0 для дешифрования
+ * in и out могут совпадать
+ */
+void aes_ni_gcm_ctr_ghash(const unsigned char* enc_rk, const unsigned char* hpow, unsigned char* counter,
+                          unsigned char* y, const unsigned char* in, unsigned char* out,
+                          size_t nblocks, int encrypt);
+
+#endif /* GHASH_CLMUL_H */
@@ -17,10 +17,65 @@ void sha256_init(sha256_ctx_t* ctx);
 void sha256_update(sha256_ctx_t* ctx, const uint8_t* data, size_t len);
 void sha256_final(sha256_ctx_t* ctx, uint8_t* hash);
 int sha256_hash_file(const char* filepath, uint8_t* hash);  // Returns 0 on success, -1 on error
+const char* sha256_impl_name(void);  // Active compression function: "sha-ni", "avx2" or "portable"
 
-// SHA3-256 using OpenSSL (simpler implementation)
+// Multi-buffer SHA-256: count independent messages hashed in lockstep (16 lanes with AVX-512, 8 with AVX2)
+// digests[i] receives SHA-256 of msgs[i] (lens[i] bytes)
+void sha256_many(const uint8_t* const* msgs, const size_t* lens, size_t count, uint8_t (*digests)[32]);
+
+// SHA-512 context structure, shared by SHA-384 and SHA-512/256 (different IV, truncated output)
+typedef struct {
+    uint64_t state[8];           // Hash state (A, B, C, D, E, F, G, H)
+    uint64_t byte_count;         // Total bytes processed
+    uint8_t buffer[128];         // Current block buffer (1024 bits)
+    size_t buffer_len;           // Bytes in buffer
+    size_t digest_len;           // 64, 48 or 32
+} sha512_ctx_t;
+
+// SHA-512 family functions: pick the variant with its init, then the common update/final
+void sha512_init(sha512_ctx_t* ctx);
+void sha384_init(sha512_ctx_t* ctx);
+void sha512_256_init(sha512_ctx_t* ctx);
+void sha512_update(sha512_ctx_t* ctx, const uint8_t* data, size_t len);
+void sha512_final(sha512_ctx_t* ctx, uint8_t* hash);  // Writes ctx->digest_len bytes
+int sha512_hash_file(const char* filepath, size_t digest_len, uint8_t* hash);  // Returns 0 on success, -1 on error
+
+// Keccak sponge context shared by SHA-3 and SHAKE
+typedef struct {
+    uint64_t state[25];          // Keccak-f[1600] state, lane (x, y) at state[x + 5 * y]
+    size_t rate;                 // Bytes absorbed/squeezed per permutation
+    size_t pos;                  // Bytes used in the current block
+    size_t digest_len;           // SHA-3 digest length (0 for SHAKE)
+    uint8_t suffix;              // Domain separation bits and first padding bit
+    int squeezing;               // Padding applied, output being read
+} sha3_ctx_t;
+
+// Keccak-f[1600] permutation (24 rounds)
+void keccak_f1600(uint64_t* state);
+
+// SHA-3 functions; digest_len is 28, 32, 48 or 64 (SHA3-224/256/384/512)
+void sha3_init(sha3_ctx_t* ctx, size_t digest_len);
+void sha3_update(sha3_ctx_t* ctx, const uint8_t* data, size_t len);
+void sha3_final(sha3_ctx_t* ctx, uint8_t* hash);
+int sha3_hash_file(const char* filepath, size_t digest_len, uint8_t* hash);  // Returns 0 on success, -1 on error
 int sha3_256_hash_file(const char* filepath, uint8_t* hash);  // Returns 0 on success, -1 on error
 
+// SHAKE128/SHAKE256 (security_bits 128 or 256): absorb with sha3_update, then squeeze any
+// amount of output, in as many calls as needed
+void shake_init(sha3_ctx_t* ctx, unsigned int security_bits);
+void shake_squeeze(sha3_ctx_t* ctx, uint8_t* out, size_t len);
+int shake_hash_file(const char* filepath, unsigned int security_bits, uint8_t* out, size_t out_len);
+
+// cSHAKE128/cSHAKE256 (NIST SP 800-185): SHAKE with function name N and customization S
+// absorbed first; continue with sha3_update and shake_squeeze
+void cshake_init(sha3_ctx_t* ctx, unsigned int security_bits, const uint8_t* name, size_t name_len,
+                 const uint8_t* custom, size_t custom_len);
+
+// SP 800-185 helpers: absorb bytepad(encode_string(s), rate); left/right_encode write up to 9 bytes
+void sha3_absorb_bytepad(sha3_ctx_t* ctx, const uint8_t* s, size_t len);
+size_t sp800_185_left_encode(uint8_t* out, uint64_t x);
+size_t sp800_185_right_encode(uint8_t* out, uint64_t x);
+
 // Utility: convert hash to hex string
 void hash_to_hex(const uint8_t* hash, size_t hash_len, char* hex_out);
 
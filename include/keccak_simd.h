@@ -0,0 +1,37 @@
+#ifndef KECCAK_SIMD_H
+#define KECCAK_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Keccak-f[1600] on several independent sponges at once, for callers that hash
+ * many equal-length messages (ParallelHash leaves)
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTOCORE_HAVE_KECCAK_SIMD 1
+#endif
+
+// Round constants, shared with the portable implementation
+extern const uint64_t keccak_rc[24];
+
+// States processed per call of the AVX2 kernel
+#define KECCAK_AVX2_WAYS 4
+
+/**
+ * Check for AVX2
+ * Returns 1 if the instructions are usable, 0 otherwise
+ */
+int keccak_avx2_available(void);
+
+#ifdef CRYPTOCORE_HAVE_KECCAK_SIMD
+/**
+ * Four SHAKE computations side by side: in[j] (len bytes, the same len for all four) is
+ * absorbed at the given rate with SHAKE padding, and out_len bytes (out_len <= rate)
+ * are written to out[j]
+ */
+void keccak_shake_x4_avx2(size_t rate, const uint8_t* const* in, size_t len, uint8_t* const* out, size_t out_len);
+#endif
+
+#endif // KECCAK_SIMD_H
@@ -5,18 +5,85 @@
 #include <stddef.h>
 #include <stdint.h>
 
+/**
+ * Hash functions for HMAC
+ */
+typedef enum {
+    HMAC_SHA256,                  // 64-byte blocks, 32-byte MAC
+    HMAC_SHA384,                  // 128-byte blocks, 48-byte MAC
+    HMAC_SHA512                   // 128-byte blocks, 64-byte MAC
+} hmac_hash_t;
+
+#define HMAC_MAX_BLOCK_SIZE 128
+#define HMAC_MAX_MAC_SIZE 64
+
+/**
+ * Inner or outer hash of HMAC, by hash function
+ */
+typedef union {
+    sha256_ctx_t sha256;
+    sha512_ctx_t sha512;          // SHA-384 and SHA-512
+} hmac_hash_ctx_t;
+
+/**
+ * Prepared HMAC key: hash states right after the (K ⊕ ipad) and (K ⊕ opad) blocks
+ * Computed once per key; every message then starts from a struct copy
+ */
+typedef struct {
+    hmac_hash_t hash;             // Underlying hash function
+    hmac_hash_ctx_t inner;        // Midstate after (K ⊕ ipad)
+    hmac_hash_ctx_t outer;        // Midstate after (K ⊕ opad)
+} hmac_key_t;
+
 /**
  * HMAC context structure
  */
 typedef struct {
-    uint8_t key[64];              // Processed key (always 64 bytes)
-    sha256_ctx_t inner_ctx;       // Inner hash context
-    sha256_ctx_t outer_ctx;       // Outer hash context
+    hmac_key_t key;               // Key midstates (kept for hmac_reset)
+    hmac_hash_ctx_t inner_ctx;    // Inner hash of the current message
     int initialized;               // Initialization flag
 } hmac_ctx_t;
 
 /**
- * Initialize HMAC context with a key
+ * MAC length of HMAC with the given hash function
+ * 
+ * @param hash Hash function
+ * @return 32, 48 or 64 bytes
+ */
+size_t hmac_mac_size(hmac_hash_t hash);
+
+/**
+ * Prepare an HMAC key: process the key and compress the ipad and opad blocks
+ * 
+ * @param key Prepared key to fill
+ * @param hash Hash function (HMAC_SHA256, HMAC_SHA384, HMAC_SHA512)
+ * @param key_bytes Key bytes (can be any length)
+ * @param key_len Length of key in bytes
+ * @return 0 on success, -1 on error
+ */
+int hmac_key_init(hmac_key_t* key, hmac_hash_t hash, const uint8_t* key_bytes, size_t key_len);
+
+/**
+ * Initialize HMAC context from a prepared key (no compression calls)
+ * 
+ * @param ctx HMAC context to initialize
+ * @param key Prepared key
+ */
+void hmac_init_key(hmac_ctx_t* ctx, const hmac_key_t* key);
+
+/**
+ * Initialize HMAC context with a key and a hash function
+ * 
+ * @param ctx HMAC context to initialize
+ * @param hash Hash function (HMAC_SHA256, HMAC_SHA384, HMAC_SHA512)
+ * @param key Key bytes (can be any length)
+ * @param key_len Length of key in bytes
+ * @return 0 on success, -1 on error
+ */
+int hmac_init_alg(hmac_ctx_t* ctx, hmac_hash_t hash, const uint8_t* key, size_t key_len);
+
+/**
+ * Initialize HMAC-SHA256 context with a key
  * 
  * @param ctx HMAC context to initialize
  * @param key Key bytes (can be any length)
@@ -25,6 +92,22 @@ typedef struct {
  */
 int hmac_init(hmac_ctx_t* ctx, const uint8_t* key, size_t key_len);
 
+/**
+ * Start a new message with the same key (also after hmac_final)
+ * 
+ * @param ctx Initialized HMAC context
+ */
+void hmac_reset(hmac_ctx_t* ctx);
+
+/**
+ * Copy a context, including a partly processed message
+ * (e.g. MAC a common prefix once, then clone it for each suffix)
+ * 
+ * @param dst Destination context
+ * @param src Source context
+ */
+void hmac_clone(hmac_ctx_t* dst, const hmac_ctx_t* src);
+
 /**
  * Update HMAC with new data (streaming)
  * 
@@ -38,14 +121,46 @@ void hmac_update(hmac_ctx_t* ctx, const uint8_t* data, size_t len);
  * Finalize HMAC computation
  * 
  * @param ctx HMAC context
- * @param mac Output buffer for MAC (32 bytes for SHA-256)
+ * @param mac Output buffer for MAC (hmac_mac_size(ctx->key.hash) bytes, 32 for SHA-256)
  */
 void hmac_final(hmac_ctx_t* ctx, uint8_t* mac);
 
+/**
+ * Compute HMAC of a buffer with a prepared key (one-shot)
+ * 
+ * @param key Prepared key
+ * @param data Message
+ * @param len Length of message in bytes
+ * @param mac Output buffer for MAC (hmac_mac_size(key->hash) bytes)
+ */
+void hmac_compute(const hmac_key_t* key, const uint8_t* data, size_t len, uint8_t* mac);
+
+/**
+ * Compute HMAC for a file with a prepared key
+ * 
+ * @param filepath Path to input file
+ * @param key Prepared key
+ * @param mac Output buffer for MAC (hmac_mac_size(key->hash) bytes)
+ * @return 0 on success, -1 on error
+ */
+int hmac_file_key(const char* filepath, const hmac_key_t* key, uint8_t* mac);
+
 /**
  * Compute HMAC for a file (convenience function)
  * 
  * @param filepath Path to input file
+ * @param hash Hash function
+ * @param key Key bytes
+ * @param key_len Length of key in bytes
+ * @param mac Output buffer for MAC (hmac_mac_size(hash) bytes)
+ * @return 0 on success, -1 on error
+ */
+int hmac_file_alg(const char* filepath, hmac_hash_t hash, const uint8_t* key, size_t key_len, uint8_t* mac);
+
+/**
+ * Compute HMAC-SHA256 for a file (convenience function)
+ * 
+ * @param filepath Path to input file
  * @param key Key bytes
  * @param key_len Length of key in bytes
  * @param mac Output buffer for MAC (32 bytes)
@@ -61,10 +176,8 @@ typedef struct {
     uint8_t k1[16];               // First subkey
     uint8_t k2[16];               // Second subkey
     uint8_t prev_encrypted[16];  // Previous encrypted CBC-MAC result
-    uint8_t last_block[16];      // Last complete block (not yet encrypted)
-    uint8_t partial_block[16];   // Partial block (incomplete)
-    size_t block_offset;          // Offset in partial block
-    int has_last_block;           // Flag: last block is complete but not encrypted
+    uint8_t partial_block[16];   // Last 1..16 bytes seen (not yet encrypted)
+    size_t block_offset;          // Bytes held in partial_block
     int initialized;              // Initialization flag
 } cmac_ctx_t;
 
@@ -106,5 +219,59 @@ int cmac_final(cmac_ctx_t* ctx, uint8_t* mac);
  */
 int cmac_file(const char* filepath, const uint8_t* key, uint8_t* mac);
 
+/**
+ * KMAC context structure (NIST SP 800-185)
+ */
+typedef struct {
+    sha3_ctx_t sponge;            // cSHAKE sponge, padded key already absorbed
+    size_t mac_len;               // Output length in bytes (bound into the MAC)
+} kmac_ctx_t;
+
+/**
+ * Initialize KMAC128/KMAC256 with a key
+ * 
+ * @param ctx KMAC context to initialize
+ * @param security_bits 128 or 256
+ * @param key Key bytes (can be any length)
+ * @param key_len Length of key in bytes
+ * @param custom Customization string (may be NULL when custom_len is 0)
+ * @param custom_len Length of customization string in bytes
+ * @param mac_len Length of the MAC in bytes
+ * @return 0 on success, -1 on error
+ */
+int kmac_init(kmac_ctx_t* ctx, unsigned int security_bits, const uint8_t* key, size_t key_len,
+              const uint8_t* custom, size_t custom_len, size_t mac_len);
+
+/**
+ * Update KMAC with new data (streaming)
+ * 
+ * @param ctx KMAC context
+ * @param data Data to process
+ * @param len Length of data in bytes
+ */
+void kmac_update(kmac_ctx_t* ctx, const uint8_t* data, size_t len);
+
+/**
+ * Finalize KMAC computation
+ * 
+ * @param ctx KMAC context
+ * @param mac Output buffer for MAC (mac_len bytes)
+ */
+void kmac_final(kmac_ctx_t* ctx, uint8_t* mac);
+
+/**
+ * Compute KMAC for a file (convenience function, empty customization string)
+ * 
+ * @param filepath Path to input file
+ * @param security_bits 128 or 256
+ * @param key Key bytes
+ * @param key_len Length of key in bytes
+ * @param mac Output buffer for MAC
+ * @param mac_len Length of the MAC in bytes
+ * @return 0 on success, -1 on error
+ */
+int kmac_file(const char* filepath, unsigned int security_bits, const uint8_t* key, size_t key_len,
+              uint8_t* mac, size_t mac_len);
+
 #endif // MAC_H
 
@@ -23,6 +23,35 @@ unsigned char* aes_cbc_decrypt(const unsigned char* ciphertext, size_t ciphertex
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size);
 
+/**
+ * Шифрование CBC с дополнением PKCS#7 в буфер вызывающей стороны, без промежуточных копий
+ * out должен вмещать AES_PKCS7_PADDED_SIZE(plaintext_len) байт; out может совпадать с plaintext
+ * Возвращает 0 при успехе, -1 при ошибке; устанавливает output_size
+ */
+int aes_cbc_encrypt_into(const unsigned char* plaintext, size_t plaintext_len,
+                         const unsigned char* key, const unsigned char* iv,
+                         unsigned char* out, size_t out_capacity, size_t* output_size);
+
+/**
+ * Шифрование CBC на месте: data_len байт в buf емкостью не меньше AES_PKCS7_PADDED_SIZE(data_len)
+ */
+int aes_cbc_encrypt_inplace(unsigned char* buf, size_t data_len, size_t buf_capacity,
+                            const unsigned char* key, const unsigned char* iv, size_t* output_size);
+
+/**
+ * Дешифрование CBC с проверкой дополнения PKCS#7 в буфер вызывающей стороны
+ * out достаточно вместить сам открытый текст; out может совпадать с ciphertext
+ */
+int aes_cbc_decrypt_into(const unsigned char* ciphertext, size_t ciphertext_len,
+                         const unsigned char* key, const unsigned char* iv,
+                         unsigned char* out, size_t out_capacity, size_t* output_size);
+
+/**
+ * Дешифрование CBC на месте: открытый текст остается в начале buf
+ */
+int aes_cbc_decrypt_inplace(unsigned char* buf, size_t buf_len, const unsigned char* key,
+                            const unsigned char* iv, size_t* output_size);
+
 /**
  * Режим CFB (Cipher Feedback)
  * Шифрование данных с использованием AES-128 в режиме CFB (полный блок)
@@ -39,6 +68,22 @@ unsigned char* aes_cfb_decrypt(const unsigned char* ciphertext, size_t ciphertex
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size);
 
+/**
+ * CFB в буфер вызывающей стороны: len байт из in в out (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_cfb_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+int aes_cfb_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+
+/**
+ * CFB на месте: len байт buf заменяются результатом
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_cfb_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+int aes_cfb_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+
 /**
  * Режим OFB (Output Feedback)
  * Шифрование данных с использованием AES-128 в режиме OFB
@@ -55,6 +100,22 @@ unsigned char* aes_ofb_decrypt(const unsigned char* ciphertext, size_t ciphertex
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size);
 
+/**
+ * OFB в буфер вызывающей стороны: len байт из in в out (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_ofb_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+int aes_ofb_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+
+/**
+ * OFB на месте: len байт buf заменяются результатом
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_ofb_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+int aes_ofb_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+
 /**
  * Режим CTR (Counter)
  * Шифрование данных с использованием AES-128 в режиме CTR
@@ -71,6 +132,31 @@ unsigned char* aes_ctr_decrypt(const unsigned char* ciphertext, size_t ciphertex
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size);
 
+/**
+ * CTR в буфер вызывающей стороны: len байт из in в out (out может совпадать с in)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_ctr_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+int aes_ctr_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out);
+
+/**
+ * CTR на месте: len байт buf заменяются результатом
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_ctr_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+int aes_ctr_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv);
+
+/**
+ * Произвольный доступ CTR: дешифрование участка потока длиной len, начинающегося
+ * с байта offset шифртекста (без учета заголовка IV); in - шифртекст только этого участка
+ * Счетчик устанавливается в IV + offset / 16, остальной файл не обрабатывается
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_ctr_decrypt_range(const unsigned char* in, size_t len, const unsigned char* key,
+                          const unsigned char* iv, unsigned long long offset, unsigned char* out);
+
 /**
  * Генерация криптографически стойкого случайного IV (16 байт)
  * Возвращает указатель на выделенный буфер с IV
@@ -84,5 +170,10 @@ unsigned char* generate_iv(void);
  */
 void xor_blocks(unsigned char* output, const unsigned char* a, const unsigned char* b, size_t len);
 
+/**
+ * Увеличение 128-битного big-endian счетчика CTR на blocks блоков
+ */
+void increment_counter_be(unsigned char* counter, unsigned long long blocks);
+
 #endif /* MODES_H */
 
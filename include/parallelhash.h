@@ -0,0 +1,52 @@
+#ifndef PARALLELHASH_H
+#define PARALLELHASH_H
+
+#include "hash.h"
+#include "thread_pool.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * ParallelHash128/ParallelHash256 (NIST SP 800-185)
+ * The input is cut into block_size-byte blocks, each block is hashed on its own (SHAKE),
+ * and the chaining values are absorbed in order by cSHAKE(N = "ParallelHash", S).
+ * Blocks are independent: they are spread over the thread pool and the SIMD Keccak lanes.
+ * The digest depends on block_size, so both sides must use the same value
+ */
+
+#define PARALLELHASH_DEFAULT_BLOCK_SIZE 8192
+
+typedef struct {
+    sha3_ctx_t outer;            // cSHAKE over left_encode(B) || chaining values
+    unsigned int security_bits;  // 128 or 256
+    size_t block_size;           // B, in bytes
+    uint64_t blocks;             // Chaining values absorbed so far
+    size_t out_len;              // Output length in bytes (bound into the digest)
+} parallelhash_ctx_t;
+
+/**
+ * Initialize ParallelHash; custom may be NULL when custom_len is 0
+ * Returns 0 on success, -1 on error
+ */
+int parallelhash_init(parallelhash_ctx_t* ctx, unsigned int security_bits, size_t block_size,
+                      const uint8_t* custom, size_t custom_len, size_t out_len);
+
+/**
+ * Hash nblocks consecutive full blocks (nblocks * block_size bytes) on pool (NULL: calling thread)
+ */
+void parallelhash_blocks(thread_pool_t* pool, parallelhash_ctx_t* ctx, const uint8_t* data, size_t nblocks);
+
+/**
+ * Hash the last, shorter block (tail_len < block_size, 0 if there is none) and write out_len bytes
+ */
+void parallelhash_final(parallelhash_ctx_t* ctx, const uint8_t* tail, size_t tail_len, uint8_t* out);
+
+/**
+ * ParallelHash of a file with an empty customization string
+ * The next batch is read while the pool hashes the current one
+ * Returns 0 on success, -1 on error
+ */
+int parallelhash_file(thread_pool_t* pool, const char* filepath, unsigned int security_bits, size_t block_size,
+                      uint8_t* out, size_t out_len);
+
+#endif // PARALLELHASH_H
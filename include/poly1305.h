@@ -0,0 +1,55 @@
+#ifndef POLY1305_H
+#define POLY1305_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define POLY1305_KEY_SIZE 32
+#define POLY1305_TAG_SIZE 16
+
+/**
+ * Poly1305 one-time authenticator context (RFC 8439)
+ * Accumulator and r are kept in 26-bit limbs; r^1..r^4 are precomputed
+ * for the 4-way AVX2 path when the CPU supports it
+ */
+typedef struct {
+    uint32_t r[5];                // Clamped r
+    uint32_t h[5];                // Accumulator
+    uint32_t pad[4];              // s (second key half)
+    uint32_t rpow[4][5];          // r^1, r^2, r^3, r^4 (AVX2 path only)
+    uint8_t buf[16];              // Partial block
+    size_t buf_len;               // Bytes in buf
+    int avx2;                     // 1 if the AVX2 path is used
+} poly1305_ctx_t;
+
+/**
+ * Initialize Poly1305 with a one-time key
+ *
+ * @param ctx Context to initialize
+ * @param key 32-byte key (r || s); must never be reused for another message
+ */
+void poly1305_init(poly1305_ctx_t* ctx, const uint8_t* key);
+
+/**
+ * Update Poly1305 with new data (streaming)
+ *
+ * @param ctx Poly1305 context
+ * @param data Data to process
+ * @param len Length of data in bytes
+ */
+void poly1305_update(poly1305_ctx_t* ctx, const uint8_t* data, size_t len);
+
+/**
+ * Finalize Poly1305 computation and wipe the key material
+ *
+ * @param ctx Poly1305 context
+ * @param tag Output buffer for the tag (16 bytes)
+ */
+void poly1305_final(poly1305_ctx_t* ctx, uint8_t* tag);
+
+/**
+ * Name of the active block implementation ("avx2" or "portable")
+ */
+const char* poly1305_impl_name(void);
+
+#endif /* POLY1305_H */
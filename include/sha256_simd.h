@@ -0,0 +1,55 @@
+#ifndef SHA256_SIMD_H
+#define SHA256_SIMD_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Accelerated SHA-256 compression functions, selected at runtime by sha256.c
+ * All of them take the same arguments as the portable path: nblocks consecutive
+ * 64-byte blocks are folded into state[8]
+ */
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CRYPTOCORE_HAVE_SHA256_SIMD 1
+#endif
+
+// Round constants, shared with the portable implementation
+extern const uint32_t sha256_k[64];
+
+/**
+ * Check for the Intel SHA extensions (with SSSE3/SSE4.1) / AVX2
+ * Returns 1 if the instructions are usable, 0 otherwise
+ */
+int sha256_shani_available(void);
+int sha256_avx2_available(void);
+
+/**
+ * Check for AVX-512F (16-lane multi-buffer kernel)
+ */
+int sha256_avx512_available(void);
+
+// Lanes of the multi-buffer kernels
+#define SHA256_AVX2_LANES 8
+#define SHA256_AVX512_LANES 16
+
+#ifdef CRYPTOCORE_HAVE_SHA256_SIMD
+/**
+ * SHA extensions: sha256rnds2 does two rounds, sha256msg1/msg2 the message schedule
+ */
+void sha256_shani_blocks(uint32_t* state, const uint8_t* data, size_t nblocks);
+
+/**
+ * AVX2: message schedule for two blocks at once (one per 128-bit lane), scalar rounds
+ */
+void sha256_avx2_blocks(uint32_t* state, const uint8_t* data, size_t nblocks);
+
+/**
+ * Multi-buffer: every lane hashes its own message, one block per lane per step, nblocks steps
+ * state holds word w of lane j at state[w * lanes + j]; lane j reads nblocks blocks from data[j]
+ */
+void sha256_x8_avx2_blocks(uint32_t* state, const uint8_t* const* data, size_t nblocks);
+void sha256_x16_avx512_blocks(uint32_t* state, const uint8_t* const* data, size_t nblocks);
+#endif
+
+#endif // SHA256_SIMD_H
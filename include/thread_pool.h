@@ -0,0 +1,40 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <stddef.h>
+
+/**
+ * Пул рабочих потоков для параллельной обработки независимых заданий
+ * Потоки создаются один раз и переиспользуются между вызовами thread_pool_run
+ */
+typedef struct thread_pool thread_pool_t;
+
+/**
+ * Функция задания: arg - общий аргумент, index - номер задания (0..count-1)
+ */
+typedef void (*thread_pool_fn)(void* arg, size_t index);
+
+/**
+ * Создание пула из nthreads потоков (вызывающий поток считается одним из них)
+ * Возвращает NULL при ошибке
+ */
+thread_pool_t* thread_pool_create(int nthreads);
+
+/**
+ * Число потоков, выполняющих задания (включая вызывающий)
+ * Для NULL возвращает 1
+ */
+int thread_pool_size(const thread_pool_t* pool);
+
+/**
+ * Выполнение count заданий fn(arg, 0..count-1) и ожидание их завершения
+ * Вызывающий поток участвует в обработке. Для pool == NULL задания выполняются последовательно
+ */
+void thread_pool_run(thread_pool_t* pool, thread_pool_fn fn, void* arg, size_t count);
+
+/**
+ * Остановка потоков и освобождение пула
+ */
+void thread_pool_destroy(thread_pool_t* pool);
+
+#endif /* THREAD_POOL_H */
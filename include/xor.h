@@ -0,0 +1,18 @@
+#ifndef XOR_H
+#define XOR_H
+
+#include <stddef.h>
+
+/**
+ * XOR двух буферов: out = a ^ b (len байт)
+ * Реализация выбирается во время выполнения: AVX2 (32 байта), SSE2 (16 байт)
+ * или переносимый путь машинными словами. out может совпадать с a или b
+ */
+void xor_bytes(unsigned char* out, const unsigned char* a, const unsigned char* b, size_t len);
+
+/**
+ * Активная реализация xor_bytes: "avx2", "sse2" или "portable"
+ */
+const char* xor_impl_name(void);
+
+#endif /* XOR_H */
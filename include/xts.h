@@ -0,0 +1,51 @@
+#ifndef XTS_H
+#define XTS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "ecb.h"
+#include "aes_core.h"
+#include "thread_pool.h"
+
+/**
+ * Режим XTS-AES-128 (IEEE 1619, NIST SP 800-38E) для шифрования образов дисков
+ * Данные делятся на единицы (секторы) фиксированного размера; твик единицы - ее номер,
+ * поэтому любой сектор шифруется и дешифруется независимо от остальных
+ * Шифртекст той же длины, что и открытый текст; неполный последний блок
+ * обрабатывается заимствованием шифртекста (ciphertext stealing)
+ */
+
+#define AES_XTS_KEY_SIZE 32                 // K1 (данные) || K2 (твик)
+#define AES_XTS_DEFAULT_UNIT_SIZE 4096
+
+typedef struct {
+    aes_core_key_t data_key;                // K1: шифрование или дешифрование блоков
+    aes_core_key_t tweak_key;               // K2: всегда шифрование
+    size_t unit_size;                       // Размер единицы данных в байтах
+    int encrypt;                            // 1 - шифрование, 0 - дешифрование
+} aes_xts_key_t;
+
+/**
+ * Подготовка ключа: key - AES_XTS_KEY_SIZE байт, половины не должны совпадать
+ * unit_size - кратен AES_BLOCK_SIZE (обычно 512 или 4096)
+ * Возвращает 0 при успехе, -1 при ошибке
+ */
+int aes_xts_init(aes_xts_key_t* ctx, const unsigned char* key, size_t unit_size, int encrypt);
+
+/**
+ * Шифрование/дешифрование len байт, начиная с единицы first_unit
+ * Все единицы, кроме последней, полные; последняя не короче AES_BLOCK_SIZE
+ * Начальные твики группы единиц шифруются одним пакетом; при pool != NULL
+ * единицы распределяются между потоками (результат не зависит от числа потоков)
+ * in и out могут совпадать
+ * Возвращает 0 при успехе, -1 если последняя единица короче блока
+ */
+int aes_xts_crypt(thread_pool_t* pool, const aes_xts_key_t* ctx, uint64_t first_unit,
+                  const unsigned char* in, unsigned char* out, size_t len);
+
+/**
+ * Освобождение обоих ключей
+ */
+void aes_xts_cleanup(aes_xts_key_t* ctx);
+
+#endif /* XTS_H */
@@ -4,13 +4,24 @@
 #include <locale.h>
 #include <stdarg.h>
 #include <time.h>
-#include <openssl/aes.h>
 #include "include/ecb.h"
 #include "include/modes.h"
 #include "include/file_io.h"
 #include "include/csprng.h"
 #include "include/hash.h"
 #include "include/mac.h"
+#include "include/parallelhash.h"
+#include "include/blake3.h"
+#include "include/aes_core.h"
+#include "include/aes_mode.h"
+#include "include/gcm.h"
+#include "include/xts.h"
+#include "include/chacha20_poly1305.h"
+#include "include/container.h"
+#include "include/aes_parallel.h"
+#include "include/thread_pool.h"
+#include "include/xor.h"
+#include "include/cpu_features.h"
 
 #ifdef _WIN32
 #include <windows.h>
@@ -36,14 +47,37 @@ typedef struct {
     int dgst;              // Hash mode flag
     int hmac;              // HMAC mode flag
     int cmac;              // AES-CMAC mode flag
+    int kmac;              // KMAC mode flag (--algorithm kmac128|kmac256)
     char* key_hex;
     char* verify_path;     // Path to HMAC/CMAC file for verification
     char* iv_hex;
     char* input_path;
+    char** inputs;         // dgst: all input files (--input FILE [FILE...]), inputs[0] == input_path
+    int input_count;
     char* output_path;
     int recursive;
+    int threads;           // Число потоков для распараллеливаемых режимов (--threads)
+    char* engine;          // Реализация AES (--engine), NULL - выбор по CPUID
+    int version;           // --version: вывести версию и активную реализацию AES
+    size_t sector_size;    // Размер сектора XTS (--sector-size)
+    unsigned long long first_sector; // Номер первого сектора входа XTS (--first-sector)
+    unsigned long long offset;       // Начало дешифруемого участка CTR в байтах шифртекста (--offset)
+    unsigned long long length;       // Длина участка CTR (--length), 0 - до конца файла
+    int range;                       // Указан --offset или --length
+    int chunked;                     // --chunked: контейнер из независимо аутентифицированных порций
+    unsigned long chunk_size;        // Размер порции контейнера (--chunk-size)
+    char* mac;                       // --mac hmac|cmac: encrypt-then-MAC в том же проходе
+    char* mac_key_hex;               // Ключ MAC (--mac-key)
+    unsigned char* mac_key;          // Ключ MAC в байтах (заполняется в main)
+    size_t mac_key_len;
 } cli_args_t;
 
+/* Версия программы для --version */
+#define CRYPTOCORE_VERSION "1.0"
+
+/* Верхняя граница --threads */
+#define MAX_THREADS 256
+
 typedef struct {
     char* original_name;
     char* encrypted_name;
@@ -137,405 +171,389 @@ static int calc_percent(unsigned long long processed, unsigned long long total)
     if (p > 100.0) p = 100.0;
     return (int)(p + 0.5);
 }
-static void increment_counter_be(unsigned char* counter, unsigned long long blocks) {
-    for (int i = 0; i < 16; i++) {
-        unsigned int idx = 15 - i;
-        unsigned int add = (unsigned int)(blocks & 0xFF);
-        unsigned int sum = counter[idx] + add;
-        counter[idx] = (unsigned char)(sum & 0xFF);
-        blocks >>= 8;
-        if ((sum >> 8) == 0 && blocks == 0) break;
-    }
-}
+/* Пул потоков для распараллеливаемых режимов (NULL при --threads 1) */
+static thread_pool_t* g_pool = NULL;
 
-static int stream_encrypt_ctr_file(const char* in_path, const char* out_path, unsigned char* key, unsigned char* iv, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; // 4 MB
-    FILE* in = fopen(in_path, "rb");
-    if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb");
-    if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    if (fwrite(iv, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV to '%s'", out_path); fclose(in); fclose(out); return 1; }
+/**
+ * Размер порции чтения: 4 MB на каждый поток пула
+ */
+static size_t stream_chunk_size(void) {
+    return (size_t)thread_pool_size(g_pool) * 4 * 1024 * 1024;
+}
 
-    unsigned char* in_buf = (unsigned char*)malloc(CHUNK);
-    unsigned char* out_buf = (unsigned char*)malloc(CHUNK);
-    if (!in_buf || !out_buf) { log_error("Error: failed to allocate buffers"); if (in_buf) free(in_buf); if (out_buf) free(out_buf); fclose(in); fclose(out); return 1; }
+/* Encrypt-then-MAC (--mac): HMAC-SHA256 или AES-CMAC по байтам файла шифртекста (IV и шифртекст), пока порция в кэше */
+typedef struct { int cmac; hmac_ctx_t hmac; cmac_ctx_t cm; } mac_stream_t;
+static int mac_stream_init(mac_stream_t* m, const char* alg, const unsigned char* key, size_t key_len) { m->cmac = strcmp(alg, "cmac") == 0; return m->cmac ? cmac_init(&m->cm, key) : hmac_init(&m->hmac, key, key_len); }
+static void mac_stream_update(mac_stream_t* m, const unsigned char* data, size_t n) { if (!m || n == 0) return; if (m->cmac) cmac_update(&m->cm, data, n); else hmac_update(&m->hmac, data, n); }
+static size_t mac_stream_final(mac_stream_t* m, unsigned char* mac) { if (m->cmac) { cmac_final(&m->cm, mac); return 16; } hmac_final(&m->hmac, mac); return 32; }
+static const char* mac_stream_name(const mac_stream_t* m) { return m->cmac ? "CMAC" : "HMAC"; }
+/* Сравнение тега без раннего выхода; 0 - совпадает */
+static int mac_stream_verify(mac_stream_t* m, const unsigned char* expected) { unsigned char tag[32], diff = 0; size_t tag_len = mac_stream_final(m, tag); for (size_t i = 0; i < tag_len; i++) diff |= (unsigned char)(tag[i] ^ expected[i]); return diff != 0 ? -1 : 0; }
 
-    unsigned long long processed = 0ULL;
-    unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(in_buf); free(out_buf); fclose(in); fclose(out); return 1; }
+/**
+ * Общий потоковый цикл для всех режимов: порции читаются в один буфер и обрабатываются
+ * aes_mode_update на месте; неполные блоки и состояние сцепления хранит контекст
+ * expected_mac (дешифрование с --mac): тег всего шифртекста сверяется до снятия дополнения
+ */
+static int stream_mode_loop(aes_mode_ctx_t* ctx, FILE* in, FILE* out, unsigned long long total, mac_stream_t* mac, const unsigned char* expected_mac, size_t* written) {
+    const size_t CHUNK = stream_chunk_size(); // 4 MB на поток
+    unsigned char* buf = (unsigned char*)malloc(AES_MODE_UPDATE_OUT_SIZE(CHUNK));
+    if (!buf) { log_error("Error: failed to allocate buffer"); return 1; }
+    unsigned long long processed = 0ULL; size_t out_len = 0;
     while (1) {
-        size_t n = fread(in_buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(in_buf); free(out_buf); fclose(in); fclose(out); return 1; } break; }
-        size_t out_size = 0;
-        unsigned char iv_local[AES_BLOCK_SIZE];
-        memcpy(iv_local, iv, AES_BLOCK_SIZE);
-        unsigned char* enc = aes_ctr_encrypt(in_buf, n, key, iv_local, &out_size);
-        if (!enc || out_size != n) { log_error("Error: CTR chunk encrypt failed"); free(in_buf); free(out_buf); fclose(in); fclose(out); if (enc) free(enc); return 1; }
-        if (fwrite(enc, 1, out_size, out) != out_size) { log_error("Error: failed to write output chunk"); free(in_buf); free(out_buf); fclose(in); fclose(out); free(enc); return 1; }
-        free(enc);
-        unsigned long long blocks = (n + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
-        increment_counter_be(iv, blocks);
-        processed += (unsigned long long)n;
-        int percent = calc_percent(processed, total);
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
+        size_t n = fread(buf, 1, CHUNK, in);
+        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); return 1; } break; }
+        if (!ctx->encrypt) mac_stream_update(mac, buf, n); // MAC по шифртексту: до дешифрования на месте
+        aes_mode_update(ctx, buf, n, buf, &out_len);
+        if (ctx->encrypt) mac_stream_update(mac, buf, out_len);
+        if (fwrite(buf, 1, out_len, out) != out_len) { log_error("Error: failed to write output chunk"); free(buf); return 1; }
+        *written += out_len; processed += (unsigned long long)n;
+        int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
     }
     printf("\n");
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(in_buf); free(out_buf); fclose(in); fclose(out); return 1; }
-    if (out_total) *out_total = (size_t)(processed + AES_BLOCK_SIZE);
-    free(in_buf); free(out_buf); fclose(in); fclose(out); return 0;
+    if (processed == 0ULL && total > 0ULL) { log_error("Error: no data was processed"); free(buf); return 1; }
+    // Ошибка дополнения до проверки MAC отличала бы подделку с неверным PKCS#7 (оракул дополнения)
+    if (expected_mac && mac_stream_verify(mac, expected_mac) != 0) { log_error("Error: %s verification failed, the ciphertext was modified or the MAC key is wrong", mac_stream_name(mac)); free(buf); return 1; }
+    if (aes_mode_final(ctx, buf, &out_len) != 0) { log_error("Error: invalid padding or truncated ciphertext"); free(buf); return 1; }
+    if (fwrite(buf, 1, out_len, out) != out_len) { log_error("Error: failed to write last block"); free(buf); return 1; }
+    if (ctx->encrypt) mac_stream_update(mac, buf, out_len);
+    *written += out_len;
+    free(buf); return 0;
 }
 
-static int stream_decrypt_ctr_file(const char* in_path, const char* out_path, unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; // 4 MB
-    FILE* in = fopen(in_path, "rb");
-    if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb");
-    if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    unsigned char iv[AES_BLOCK_SIZE];
-    if (fread(iv, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: input too small to contain IV"); fclose(in); fclose(out); return 1; }
+/* Streaming encrypt: IV (кроме ECB) записывается в начало файла; mac (может быть NULL) получает все записанные байты */
+static int stream_encrypt_file(aes_mode_t mode, const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* iv, mac_stream_t* mac, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path); // пустой файл допустим: ECB/CBC дают один блок дополнения
+    aes_mode_ctx_t ctx; if (aes_mode_init(&ctx, mode, 1, key, iv) != 0) { log_error("Error: AES_set_encrypt_key failed"); return 1; }
+    aes_mode_set_pool(&ctx, g_pool);
+    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); aes_mode_cleanup(&ctx); return 1; }
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aes_mode_cleanup(&ctx); return 1; }
+    size_t written = 0;
+    if (mode != AES_MODE_ECB) {
+        if (fwrite(iv, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV to '%s'", out_path); fclose(in); fclose(out); aes_mode_cleanup(&ctx); return 1; }
+        written = AES_BLOCK_SIZE;
+        mac_stream_update(mac, iv, AES_BLOCK_SIZE);
+    }
+    int rc = stream_mode_loop(&ctx, in, out, total, mac, NULL, &written);
+    aes_mode_cleanup(&ctx);
+    if (rc == 0 && out_total) *out_total = written;
+    fclose(in); fclose(out); return rc;
+}
 
-    unsigned char* in_buf = (unsigned char*)malloc(CHUNK);
-    if (!in_buf) { log_error("Error: failed to allocate buffer"); fclose(in); fclose(out); return 1; }
-    unsigned long long processed = 0ULL;
+/* Streaming decrypt: IV берется из --iv (файл без заголовка) или из первых 16 байт файла
+ * При любой ошибке (MAC, дополнение, ввод-вывод) выходной файл удаляется */
+static int stream_decrypt_file(aes_mode_t mode, const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* iv_arg, mac_stream_t* mac, const unsigned char* expected_mac, size_t* out_total) {
     unsigned long long total = get_file_size64_path(in_path);
-    if (total < AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); free(in_buf); fclose(in); fclose(out); return 1; }
-    total -= AES_BLOCK_SIZE;
-    fseek(in, AES_BLOCK_SIZE, SEEK_SET);
-    while (1) {
-        size_t n = fread(in_buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(in_buf); fclose(in); fclose(out); return 1; } break; }
-        size_t out_size = 0;
-        unsigned char iv_local[AES_BLOCK_SIZE]; memcpy(iv_local, iv, AES_BLOCK_SIZE);
-        unsigned char* dec = aes_ctr_decrypt(in_buf, n, key, iv_local, &out_size);
-        if (!dec || out_size != n) { log_error("Error: CTR chunk decrypt failed"); free(in_buf); fclose(in); fclose(out); if (dec) free(dec); return 1; }
-        if (fwrite(dec, 1, out_size, out) != out_size) { log_error("Error: failed to write output chunk"); free(in_buf); fclose(in); fclose(out); free(dec); return 1; }
-        free(dec);
-        unsigned long long blocks = (n + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
-        increment_counter_be(iv, blocks);
-        processed += (unsigned long long)n;
-        int percent = calc_percent(processed, total);
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
+    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
+    unsigned char iv[AES_BLOCK_SIZE];
+    if (mode != AES_MODE_ECB) {
+        if (iv_arg) memcpy(iv, iv_arg, AES_BLOCK_SIZE);
+        else {
+            if (total < AES_BLOCK_SIZE || fread(iv, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); fclose(in); return 1; }
+            total -= AES_BLOCK_SIZE;
+            mac_stream_update(mac, iv, AES_BLOCK_SIZE);
+        }
     }
-    printf("\n");
-    if (processed == 0ULL && total > 0ULL) { log_error("Error: no data was processed"); free(in_buf); fclose(in); fclose(out); return 1; }
-    if (out_total) *out_total = (size_t)processed;
-    free(in_buf); fclose(in); fclose(out); return 0;
+    aes_mode_ctx_t ctx; if (aes_mode_init(&ctx, mode, 0, key, iv) != 0) { log_error("Error: AES_set_decrypt_key failed"); fclose(in); return 1; }
+    aes_mode_set_pool(&ctx, g_pool);
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aes_mode_cleanup(&ctx); return 1; }
+    size_t written = 0;
+    int rc = stream_mode_loop(&ctx, in, out, total, mac, expected_mac, &written);
+    aes_mode_cleanup(&ctx);
+    fclose(in);
+    if (fclose(out) != 0 && rc == 0) { log_error("Error: failed to write output file '%s'", out_path); rc = 1; }
+    if (rc != 0) { remove(out_path); return rc; }
+    if (out_total) *out_total = written;
+    return 0;
+}
+
+/* Файл MAC рядом с шифртекстом: <файл>.mac в формате вывода dgst ("<hex> <файл>") */
+static char* mac_sidecar_path(const char* path) {
+    char* p = (char*)malloc(strlen(path) + 5);
+    if (p) sprintf(p, "%s.mac", path);
+    return p;
+}
+
+/* 64-bit seek helper (парный к get_file_size64_path) */
+static int fseek64(FILE* f, unsigned long long offset) {
+#if defined(_WIN32)
+    return _fseeki64(f, (long long)offset, SEEK_SET);
+#else
+    return fseeko(f, (off_t)offset, SEEK_SET);
+#endif
 }
 
-/* Streaming for ECB (PKCS#7) */
-static int stream_encrypt_ecb_file(const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; // 4 MB
+/* Streaming CTR range decrypt: чтение начинается сразу с нужного участка, счетчик сдвигается на offset / 16 блоков */
+static int stream_decrypt_ctr_range(const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* iv_arg, unsigned long long offset, unsigned long long length, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
     FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK + AES_BLOCK_SIZE);
-    unsigned char out_block[AES_BLOCK_SIZE];
-    size_t carry_len = 0; unsigned char carry[AES_BLOCK_SIZE];
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(buf); fclose(in); fclose(out); return 1; }
-    while (1) {
-        size_t n = fread(buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t offset = 0;
-        if (carry_len > 0) {
-            size_t need = AES_BLOCK_SIZE - carry_len;
-            size_t to_copy = (n < need) ? n : need;
-            memcpy(carry + carry_len, buf, to_copy);
-            carry_len += to_copy; offset += to_copy;
-            if (carry_len == AES_BLOCK_SIZE) {
-                AES_encrypt(carry, out_block, &aes_key);
-                if (fwrite(out_block, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write output block"); fclose(in); fclose(out); free(buf); return 1; }
-                carry_len = 0;
-            }
-        }
-        while (offset + AES_BLOCK_SIZE <= n) {
-            AES_encrypt(buf + offset, out_block, &aes_key);
-            if (fwrite(out_block, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write output block"); fclose(in); fclose(out); free(buf); return 1; }
-            offset += AES_BLOCK_SIZE;
-        }
-        if (offset < n) { carry_len = n - offset; memcpy(carry, buf + offset, carry_len); }
-        processed += (unsigned long long)n;
-        int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
+    unsigned char iv[AES_BLOCK_SIZE]; unsigned long long header = 0ULL;
+    if (iv_arg) memcpy(iv, iv_arg, AES_BLOCK_SIZE);
+    else {
+        if (total < AES_BLOCK_SIZE || fread(iv, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); fclose(in); return 1; }
+        header = AES_BLOCK_SIZE; total -= AES_BLOCK_SIZE;
+    }
+    if (offset > total || (length > 0ULL && length > total - offset)) { log_error("Error: range %llu+%llu is outside the %llu-byte ciphertext of '%s'", offset, length, total, in_path); fclose(in); return 1; }
+    if (length == 0ULL) length = total - offset;
+    if (fseek64(in, header + offset) != 0) { log_error("Error: failed to seek in '%s'", in_path); fclose(in); return 1; }
+    aes_mode_ctx_t ctx; if (aes_mode_init(&ctx, AES_MODE_CTR, 0, key, iv) != 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); return 1; }
+    if (aes_mode_seek(&ctx, offset) != 0) { aes_mode_cleanup(&ctx); fclose(in); return 1; }
+    aes_mode_set_pool(&ctx, g_pool);
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aes_mode_cleanup(&ctx); return 1; }
+    const size_t CHUNK = stream_chunk_size();
+    unsigned char* buf = (unsigned char*)malloc(CHUNK);
+    if (!buf) { log_error("Error: failed to allocate buffer"); fclose(in); fclose(out); aes_mode_cleanup(&ctx); return 1; }
+    unsigned long long processed = 0ULL; size_t written = 0, out_len = 0; int rc = 0;
+    while (processed < length) {
+        size_t want = (length - processed < (unsigned long long)CHUNK) ? (size_t)(length - processed) : CHUNK;
+        size_t n = fread(buf, 1, want, in);
+        if (n == 0) { log_error("Error reading input file"); rc = 1; break; }
+        aes_mode_update(&ctx, buf, n, buf, &out_len);
+        if (fwrite(buf, 1, out_len, out) != out_len) { log_error("Error: failed to write output chunk"); rc = 1; break; }
+        written += out_len; processed += (unsigned long long)n;
+        int percent = calc_percent(processed, length); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, length); fflush(stdout);
     }
     printf("\n");
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    // finalize padding
-    unsigned char pad = (unsigned char)(AES_BLOCK_SIZE - carry_len);
-    for (size_t i = carry_len; i < AES_BLOCK_SIZE; i++) carry[i] = pad;
-    AES_encrypt(carry, out_block, &aes_key);
-    fwrite(out_block, 1, AES_BLOCK_SIZE, out);
-    if (out_total) { /* processed bytes rounded up to block + one pad block */ *out_total = (size_t)(((processed / AES_BLOCK_SIZE) * AES_BLOCK_SIZE) + AES_BLOCK_SIZE); }
-    free(buf); fclose(in); fclose(out); return 0;
+    if (rc == 0 && out_total) *out_total = written;
+    aes_mode_cleanup(&ctx);
+    free(buf); fclose(in); fclose(out); return rc;
 }
 
-static int stream_decrypt_ecb_file(const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; // 4 MB
-    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    AES_KEY aes_key; if (AES_set_decrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_decrypt_key failed"); fclose(in); fclose(out); return 1; }
+/* AEAD (gcm, chacha20-poly1305): заголовок файла - nonce (12 байт) и тег (16 байт), затем шифртекст той же длины, что и открытый текст */
+#define AEAD_NONCE_SIZE AES_GCM_IV_SIZE
+#define AEAD_TAG_SIZE AES_GCM_TAG_SIZE
+#define AEAD_HEADER_SIZE (AEAD_NONCE_SIZE + AEAD_TAG_SIZE)
+typedef struct { int chacha; aes_gcm_ctx_t gcm; chacha20_poly1305_ctx_t cp; } aead_ctx_t;
+static const char* aead_name(int chacha) { return chacha ? "ChaCha20-Poly1305" : "GCM"; }
+static unsigned long long aead_max_len(int chacha) { return chacha ? CHACHA20_POLY1305_MAX_DATA_LEN : AES_GCM_MAX_DATA_LEN; }
+static int aead_init(aead_ctx_t* ctx, int chacha, const unsigned char* key, const unsigned char* nonce, int encrypt) { ctx->chacha = chacha; return chacha ? chacha20_poly1305_init(&ctx->cp, key, nonce, encrypt) : aes_gcm_init(&ctx->gcm, key, nonce, encrypt); }
+static int aead_update(aead_ctx_t* ctx, unsigned char* buf, size_t n) { return ctx->chacha ? chacha20_poly1305_update(&ctx->cp, buf, n, buf) : aes_gcm_update(&ctx->gcm, buf, n, buf); }
+static void aead_final(aead_ctx_t* ctx, unsigned char* tag) { if (ctx->chacha) chacha20_poly1305_final(&ctx->cp, tag); else aes_gcm_final(&ctx->gcm, tag); }
+static int aead_final_verify(aead_ctx_t* ctx, const unsigned char* tag) { return ctx->chacha ? chacha20_poly1305_final_verify(&ctx->cp, tag) : aes_gcm_final_verify(&ctx->gcm, tag); }
+static void aead_cleanup(aead_ctx_t* ctx) { if (!ctx->chacha) aes_gcm_cleanup(&ctx->gcm); }
+static int stream_aead_loop(aead_ctx_t* ctx, FILE* in, FILE* out, unsigned long long total, size_t* written) {
+    const size_t CHUNK = 4 * 1024 * 1024; // Аутентификация последовательна: пул потоков не используется
     unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned char block[AES_BLOCK_SIZE], prev_block[AES_BLOCK_SIZE]; int have_prev = 0;
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(buf); fclose(in); fclose(out); return 1; }
+    if (!buf) { log_error("Error: failed to allocate buffer"); return 1; }
+    unsigned long long processed = 0ULL;
     while (1) {
         size_t n = fread(buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t offset = 0;
-        // ensure n is multiple of block for all but possibly last chunk; keep one block in prev
-        while (offset + AES_BLOCK_SIZE <= n) {
-            memcpy(block, buf + offset, AES_BLOCK_SIZE);
-            offset += AES_BLOCK_SIZE;
-            if (have_prev) {
-                unsigned char plain[AES_BLOCK_SIZE];
-                AES_decrypt(prev_block, plain, &aes_key);
-                if (fwrite(plain, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write output block"); free(buf); fclose(in); fclose(out); return 1; }
-            }
-            memcpy(prev_block, block, AES_BLOCK_SIZE); have_prev = 1;
-        }
-        processed += n;
+        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); return 1; } break; }
+        if (aead_update(ctx, buf, n) != 0) { free(buf); return 1; }
+        if (fwrite(buf, 1, n, out) != n) { log_error("Error: failed to write output chunk"); free(buf); return 1; }
+        *written += n; processed += (unsigned long long)n;
         int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
     }
     printf("\n");
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (!have_prev) { log_error("Error: input too small"); free(buf); fclose(in); fclose(out); return 1; }
-    // finalize: decrypt last block and remove padding
-    unsigned char last_plain[AES_BLOCK_SIZE];
-    AES_decrypt(prev_block, last_plain, &aes_key);
-    unsigned char pad = last_plain[AES_BLOCK_SIZE - 1];
-    if (pad == 0 || pad > AES_BLOCK_SIZE) { log_error("Error: invalid padding"); free(buf); fclose(in); fclose(out); return 1; }
-    for (int i = 0; i < pad; i++) if (last_plain[AES_BLOCK_SIZE - 1 - i] != pad) { log_error("Error: invalid padding"); free(buf); fclose(in); fclose(out); return 1; }
-    if (fwrite(last_plain, 1, AES_BLOCK_SIZE - pad, out) != AES_BLOCK_SIZE - pad) { log_error("Error: failed to write last block"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) { long out_size = ftell(out); if (out_size < 0) out_size = 0; *out_total = (size_t)out_size; }
-    free(buf); fclose(in); fclose(out); return 0;
+    free(buf); return 0;
 }
 
-/* Streaming for CBC (PKCS#7, with IV header) */
-static int stream_encrypt_cbc_file(const char* in_path, const char* out_path, const unsigned char* key, unsigned char* iv_in, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024;
-    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char iv[AES_BLOCK_SIZE]; memcpy(iv, iv_in, AES_BLOCK_SIZE);
-    if (fwrite(iv, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK + AES_BLOCK_SIZE);
-    unsigned char carry[AES_BLOCK_SIZE]; size_t carry_len = 0;
-    unsigned char block[AES_BLOCK_SIZE], cipher[AES_BLOCK_SIZE];
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(buf); fclose(in); fclose(out); return 1; }
-    while (1) {
-        size_t n = fread(buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t offset = 0;
-        if (carry_len > 0) {
-            size_t need = AES_BLOCK_SIZE - carry_len; size_t to_copy = (n < need) ? n : need;
-            memcpy(carry + carry_len, buf, to_copy); carry_len += to_copy; offset += to_copy;
-            if (carry_len == AES_BLOCK_SIZE) {
-                xor_blocks(block, carry, iv, AES_BLOCK_SIZE); AES_encrypt(block, cipher, &aes_key); if (fwrite(cipher, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } memcpy(iv, cipher, AES_BLOCK_SIZE); carry_len = 0;
-            }
-        }
-        while (offset + AES_BLOCK_SIZE <= n) {
-            xor_blocks(block, buf + offset, iv, AES_BLOCK_SIZE); AES_encrypt(block, cipher, &aes_key); if (fwrite(cipher, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } memcpy(iv, cipher, AES_BLOCK_SIZE); offset += AES_BLOCK_SIZE;
-        }
-        if (offset < n) { carry_len = n - offset; memcpy(carry, buf + offset, carry_len); }
-        processed += (unsigned long long)n; int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
-    }
-    printf("\n");
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    // finalize pad
-    unsigned char pad = (unsigned char)(AES_BLOCK_SIZE - carry_len);
-    for (size_t i = carry_len; i < AES_BLOCK_SIZE; i++) carry[i] = pad;
-    xor_blocks(block, carry, iv, AES_BLOCK_SIZE); AES_encrypt(block, cipher, &aes_key); fwrite(cipher, 1, AES_BLOCK_SIZE, out);
-    if (out_total) *out_total = (size_t)(processed + AES_BLOCK_SIZE * 2); // IV + data + padding block
-    free(buf); fclose(in); fclose(out); return 0;
+/* Streaming AEAD encrypt: тег вычисляется в том же проходе и дописывается в заголовок после nonce */
+static int stream_encrypt_aead_file(int chacha, const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* nonce, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
+    if (total > aead_max_len(chacha)) { log_error("Error: '%s' exceeds the %s limit of %llu bytes per nonce", in_path, aead_name(chacha), aead_max_len(chacha)); return 1; }
+    aead_ctx_t ctx; if (aead_init(&ctx, chacha, key, nonce, 1) != 0) { log_error("Error: failed to set %s key", aead_name(chacha)); return 1; }
+    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); aead_cleanup(&ctx); return 1; }
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aead_cleanup(&ctx); return 1; }
+    unsigned char tag[AEAD_TAG_SIZE] = {0};
+    if (fwrite(nonce, 1, AEAD_NONCE_SIZE, out) != AEAD_NONCE_SIZE || fwrite(tag, 1, AEAD_TAG_SIZE, out) != AEAD_TAG_SIZE) { log_error("Error: failed to write %s header to '%s'", aead_name(chacha), out_path); fclose(in); fclose(out); aead_cleanup(&ctx); return 1; }
+    size_t written = AEAD_HEADER_SIZE;
+    int rc = stream_aead_loop(&ctx, in, out, total, &written);
+    if (rc == 0) aead_final(&ctx, tag);
+    aead_cleanup(&ctx);
+    if (rc == 0) {
+        if (fseek(out, AEAD_NONCE_SIZE, SEEK_SET) != 0 || fwrite(tag, 1, AEAD_TAG_SIZE, out) != AEAD_TAG_SIZE) { log_error("Error: failed to write %s tag to '%s'", aead_name(chacha), out_path); rc = 1; }
+    }
+    if (rc == 0 && out_total) *out_total = written;
+    fclose(in); if (fclose(out) != 0) rc = 1; return rc;
 }
 
-static int stream_decrypt_cbc_file(const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024;
+/* Streaming AEAD decrypt: при неверном теге выходной файл удаляется */
+static int stream_decrypt_aead_file(int chacha, const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
     FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    unsigned char iv[AES_BLOCK_SIZE]; if (fread(iv, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: input too small for IV"); fclose(in); fclose(out); return 1; }
-    AES_KEY aes_key; if (AES_set_decrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_decrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned char prev_cipher[AES_BLOCK_SIZE]; int have_prev = 0;
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path); 
-    if (total < AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); free(buf); fclose(in); fclose(out); return 1; }
-    total -= AES_BLOCK_SIZE; fseek(in, AES_BLOCK_SIZE, SEEK_SET);
-    while (1) {
-        size_t n = fread(buf, 1, CHUNK, in);
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t offset = 0;
-        while (offset + AES_BLOCK_SIZE <= n) {
-            unsigned char cur_ciph[AES_BLOCK_SIZE]; memcpy(cur_ciph, buf + offset, AES_BLOCK_SIZE); offset += AES_BLOCK_SIZE;
-            if (have_prev) {
-                unsigned char temp[AES_BLOCK_SIZE], plain[AES_BLOCK_SIZE]; AES_decrypt(prev_cipher, temp, &aes_key); xor_blocks(plain, temp, iv, AES_BLOCK_SIZE); if (fwrite(plain, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } memcpy(iv, prev_cipher, AES_BLOCK_SIZE);
-            }
-            memcpy(prev_cipher, cur_ciph, AES_BLOCK_SIZE); have_prev = 1;
-        }
-        processed += (unsigned long long)n; int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
-    }
-    printf("\n");
-    if (processed == 0ULL && total > 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (!have_prev) { log_error("Error: no ciphertext blocks"); free(buf); fclose(in); fclose(out); return 1; }
-    unsigned char temp[AES_BLOCK_SIZE], last_plain[AES_BLOCK_SIZE]; AES_decrypt(prev_cipher, temp, &aes_key); xor_blocks(last_plain, temp, iv, AES_BLOCK_SIZE);
-    unsigned char pad = last_plain[AES_BLOCK_SIZE - 1]; if (pad == 0 || pad > AES_BLOCK_SIZE) { log_error("Error: invalid padding"); free(buf); fclose(in); fclose(out); return 1; }
-    for (int i = 0; i < pad; i++) if (last_plain[AES_BLOCK_SIZE - 1 - i] != pad) { log_error("Error: invalid padding"); free(buf); fclose(in); fclose(out); return 1; }
-    if (fwrite(last_plain, 1, AES_BLOCK_SIZE - pad, out) != AES_BLOCK_SIZE - pad) { log_error("Error: write last"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) *out_total = (size_t)processed; // approximation
-    free(buf); fclose(in); fclose(out); return 0;
+    unsigned char header[AEAD_HEADER_SIZE];
+    if (total < AEAD_HEADER_SIZE || fread(header, 1, AEAD_HEADER_SIZE, in) != AEAD_HEADER_SIZE) { log_error("Error: file too small (no %s nonce and tag)", aead_name(chacha)); fclose(in); return 1; }
+    total -= AEAD_HEADER_SIZE;
+    aead_ctx_t ctx; if (aead_init(&ctx, chacha, key, header, 0) != 0) { log_error("Error: failed to set %s key", aead_name(chacha)); fclose(in); return 1; }
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aead_cleanup(&ctx); return 1; }
+    size_t written = 0;
+    int rc = stream_aead_loop(&ctx, in, out, total, &written);
+    if (rc == 0 && aead_final_verify(&ctx, header + AEAD_NONCE_SIZE) != 0) { log_error("Error: authentication failed, '%s' was modified or the key is wrong", in_path); rc = 1; }
+    aead_cleanup(&ctx);
+    fclose(in); fclose(out);
+    if (rc != 0) { remove(out_path); return rc; }
+    if (out_total) *out_total = written;
+    return 0;
 }
 
-/* Streaming for CFB (full-block segment) */
-static int stream_encrypt_cfb_file(const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* iv_in, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; 
-    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    if (fwrite(iv_in, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV"); fclose(in); fclose(out); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned char sr[AES_BLOCK_SIZE]; memcpy(sr, iv_in, AES_BLOCK_SIZE);
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(buf); fclose(in); fclose(out); return 1; }
-    while (1) { 
-        size_t n = fread(buf, 1, CHUNK, in); 
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t i = 0; 
-        while (i + AES_BLOCK_SIZE <= n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(sr, ks, &aes_key); 
-            unsigned char ct[AES_BLOCK_SIZE]; xor_blocks(ct, buf + i, ks, AES_BLOCK_SIZE); 
-            if (fwrite(ct, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(sr, ct, AES_BLOCK_SIZE); i += AES_BLOCK_SIZE; 
-        } 
-        if (i < n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(sr, ks, &aes_key); 
-            size_t rem = n - i; unsigned char ct[AES_BLOCK_SIZE]; 
-            xor_blocks(ct, buf + i, ks, rem); 
-            if (fwrite(ct, 1, rem, out) != rem) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(sr, ct, rem); 
-        } 
-        processed += (unsigned long long)n; 
-        int percent = calc_percent(processed, total); 
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); 
-        fflush(stdout);
-    } 
-    printf("\n"); 
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) { *out_total = (size_t)(processed + AES_BLOCK_SIZE); } 
-    free(buf); fclose(in); fclose(out); return 0; 
+/* Chunked container (--chunked): порции читаются пакетами по 4 MB на поток и обрабатываются параллельно */
+static size_t container_batch_chunks(size_t chunk_size) {
+    size_t n = stream_chunk_size() / chunk_size;
+    return n > 0 ? n : 1;
 }
 
-static int stream_decrypt_cfb_file(const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; 
-    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    unsigned char sr[AES_BLOCK_SIZE]; if (fread(sr, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: input too small for IV"); fclose(in); fclose(out); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path); 
-    if (total < AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); free(buf); fclose(in); fclose(out); return 1; }
-    total -= AES_BLOCK_SIZE; fseek(in, AES_BLOCK_SIZE, SEEK_SET);
-    while (1) { 
-        size_t n = fread(buf, 1, CHUNK, in); 
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t i = 0; 
-        while (i + AES_BLOCK_SIZE <= n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(sr, ks, &aes_key); 
-            unsigned char pt[AES_BLOCK_SIZE]; xor_blocks(pt, buf + i, ks, AES_BLOCK_SIZE); 
-            if (fwrite(pt, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(sr, buf + i, AES_BLOCK_SIZE); i += AES_BLOCK_SIZE; 
-        } 
-        if (i < n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(sr, ks, &aes_key); 
-            size_t rem = n - i; unsigned char pt[AES_BLOCK_SIZE]; 
-            xor_blocks(pt, buf + i, ks, rem); 
-            if (fwrite(pt, 1, rem, out) != rem) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(sr, buf + i, rem); 
-        } 
-        processed += (unsigned long long)n; 
-        int percent = calc_percent(processed, total); 
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); 
-        fflush(stdout);
-    } 
-    printf("\n"); 
-    if (processed == 0ULL && total > 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) { *out_total = (size_t)processed; } 
-    free(buf); fclose(in); fclose(out); return 0; 
+/* Полное чтение want байт (fread может вернуть меньше до конца файла) */
+static size_t read_full(FILE* in, unsigned char* buf, size_t want) {
+    size_t n = 0, r;
+    while (n < want && (r = fread(buf + n, 1, want - n, in)) > 0) n += r;
+    return n;
 }
 
-/* Streaming for OFB */
-static int stream_encrypt_ofb_file(const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* iv_in, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; 
+static int stream_encrypt_container_file(int chacha, const char* in_path, const char* out_path, const unsigned char* key, const unsigned char* nonce, size_t chunk_size, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
+    container_t c; if (container_init(&c, chacha ? CONTAINER_AEAD_CHACHA20_POLY1305 : CONTAINER_AEAD_AES_GCM, key, (uint32_t)chunk_size, nonce, total) != 0) return 1;
     FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
     FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    if (fwrite(iv_in, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV"); fclose(in); fclose(out); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
-    unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned char feedback[AES_BLOCK_SIZE]; memcpy(feedback, iv_in, AES_BLOCK_SIZE);
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path);
-    if (total == 0ULL) { log_error("Error: empty or unreadable file '%s'", in_path); free(buf); fclose(in); fclose(out); return 1; }
-    while (1) { 
-        size_t n = fread(buf, 1, CHUNK, in); 
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t i = 0; 
-        while (i + AES_BLOCK_SIZE <= n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(feedback, ks, &aes_key); 
-            unsigned char ct[AES_BLOCK_SIZE]; xor_blocks(ct, buf + i, ks, AES_BLOCK_SIZE); 
-            if (fwrite(ct, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(feedback, ks, AES_BLOCK_SIZE); i += AES_BLOCK_SIZE; 
-        } 
-        if (i < n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(feedback, ks, &aes_key); 
-            size_t rem = n - i; unsigned char ct[AES_BLOCK_SIZE]; 
-            xor_blocks(ct, buf + i, ks, rem); 
-            if (fwrite(ct, 1, rem, out) != rem) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(feedback, ks, AES_BLOCK_SIZE); 
-        } 
-        processed += (unsigned long long)n; 
-        int percent = calc_percent(processed, total); 
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); 
-        fflush(stdout);
-    } 
-    printf("\n"); 
-    if (processed == 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) { *out_total = (size_t)(processed + AES_BLOCK_SIZE); } 
-    free(buf); fclose(in); fclose(out); return 0; 
+    size_t batch = container_batch_chunks(chunk_size), index_size = (size_t)c.chunk_count * 8 + CONTAINER_FOOTER_SIZE;
+    unsigned char* plain = (unsigned char*)malloc(batch * chunk_size);
+    unsigned char* sealed = (unsigned char*)malloc(batch * (chunk_size + CONTAINER_TAG_SIZE));
+    unsigned char* index = (unsigned char*)malloc(index_size);
+    int rc = 0;
+    if (!plain || !sealed || !index) { log_error("Error: failed to allocate buffer"); rc = 1; }
+    if (rc == 0 && fwrite(c.header, 1, CONTAINER_HEADER_SIZE, out) != CONTAINER_HEADER_SIZE) { log_error("Error: failed to write container header to '%s'", out_path); rc = 1; }
+    unsigned long long processed = 0ULL; size_t written = CONTAINER_HEADER_SIZE;
+    for (uint64_t chunk = 0; rc == 0 && chunk < c.chunk_count; ) {
+        size_t count = (c.chunk_count - chunk < batch) ? (size_t)(c.chunk_count - chunk) : batch;
+        size_t want = 0, sealed_len = 0;
+        for (size_t k = 0; k < count; k++) { size_t len = container_chunk_plain_len(&c, chunk + k); want += len; sealed_len += len + CONTAINER_TAG_SIZE; }
+        if (read_full(in, plain, want) != want) { log_error("Error reading input file (size changed while encrypting?)"); rc = 1; break; }
+        if (container_seal_chunks(g_pool, &c, chunk, plain, sealed, count) != 0) { rc = 1; break; }
+        if (fwrite(sealed, 1, sealed_len, out) != sealed_len) { log_error("Error: failed to write output chunk"); rc = 1; break; }
+        written += sealed_len; processed += (unsigned long long)want; chunk += count;
+        int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
+    }
+    printf("\n");
+    if (rc == 0) {
+        container_encode_index(&c, index);
+        if (fwrite(index, 1, index_size, out) != index_size) { log_error("Error: failed to write container index to '%s'", out_path); rc = 1; }
+        written += index_size;
+    }
+    if (rc == 0 && out_total) *out_total = written;
+    free(plain); free(sealed); free(index);
+    fclose(in); if (fclose(out) != 0) rc = 1;
+    if (rc != 0) remove(out_path);
+    return rc;
 }
 
-static int stream_decrypt_ofb_file(const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
-    const size_t CHUNK = 4 * 1024 * 1024; 
+/* Chunked container decrypt: пакет записывается только после проверки тегов всех его порций */
+static int stream_decrypt_container_file(int chacha, const char* in_path, const char* out_path, const unsigned char* key, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
     FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); return 1; }
-    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); return 1; }
-    unsigned char feedback[AES_BLOCK_SIZE]; if (fread(feedback, 1, AES_BLOCK_SIZE, in) != AES_BLOCK_SIZE) { log_error("Error: input too small for IV"); fclose(in); fclose(out); return 1; }
-    AES_KEY aes_key; if (AES_set_encrypt_key(key, 128, &aes_key) < 0) { log_error("Error: AES_set_encrypt_key failed"); fclose(in); fclose(out); return 1; }
+    unsigned char header[CONTAINER_HEADER_SIZE]; container_t c;
+    if (total < CONTAINER_HEADER_SIZE || fread(header, 1, CONTAINER_HEADER_SIZE, in) != CONTAINER_HEADER_SIZE) { log_error("Error: file too small (no container header)"); fclose(in); return 1; }
+    if (container_parse_header(&c, chacha ? CONTAINER_AEAD_CHACHA20_POLY1305 : CONTAINER_AEAD_AES_GCM, key, header) != 0) { fclose(in); return 1; }
+    if (container_file_size(&c) != total) { log_error("Error: container '%s' is truncated or has trailing data", in_path); fclose(in); return 1; }
+    size_t index_size = (size_t)c.chunk_count * 8 + CONTAINER_FOOTER_SIZE;
+    unsigned char* index = (unsigned char*)malloc(index_size);
+    if (!index) { log_error("Error: failed to allocate buffer"); fclose(in); return 1; }
+    int bad_index = fseek64(in, container_index_offset(&c)) != 0 || read_full(in, index, index_size) != index_size || container_check_index(&c, index) != 0;
+    free(index);
+    if (bad_index || fseek64(in, CONTAINER_HEADER_SIZE) != 0) { log_error("Error: container index of '%s' is damaged", in_path); fclose(in); return 1; }
+    size_t batch = container_batch_chunks(c.chunk_size);
+    unsigned char* sealed = (unsigned char*)malloc(batch * ((size_t)c.chunk_size + CONTAINER_TAG_SIZE));
+    unsigned char* plain = (unsigned char*)malloc(batch * (size_t)c.chunk_size);
+    FILE* out = (sealed && plain) ? fopen(out_path, "wb") : NULL;
+    if (!out) { log_error(sealed && plain ? "Error: failed to open output file '%s'" : "Error: failed to allocate buffer", out_path); free(sealed); free(plain); fclose(in); return 1; }
+    unsigned long long processed = 0ULL; size_t written = 0; int rc = 0;
+    for (uint64_t chunk = 0; chunk < c.chunk_count; ) {
+        size_t count = (c.chunk_count - chunk < batch) ? (size_t)(c.chunk_count - chunk) : batch;
+        size_t plain_len = 0, sealed_len = 0;
+        for (size_t k = 0; k < count; k++) { size_t len = container_chunk_plain_len(&c, chunk + k); plain_len += len; sealed_len += len + CONTAINER_TAG_SIZE; }
+        if (read_full(in, sealed, sealed_len) != sealed_len) { log_error("Error reading input file"); rc = 1; break; }
+        uint64_t bad = 0;
+        if (container_open_chunks(g_pool, &c, chunk, sealed, plain, count, &bad) != 0) { log_error("Error: authentication failed for chunk %llu of '%s'", (unsigned long long)bad, in_path); rc = 1; break; }
+        if (fwrite(plain, 1, plain_len, out) != plain_len) { log_error("Error: failed to write output chunk"); rc = 1; break; }
+        written += plain_len; processed += (unsigned long long)plain_len; chunk += count;
+        int percent = calc_percent(processed, c.plain_len); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, (unsigned long long)c.plain_len); fflush(stdout);
+    }
+    printf("\n");
+    free(sealed); free(plain); fclose(in); fclose(out);
+    if (rc != 0) { remove(out_path); return rc; }
+    if (out_total) *out_total = written;
+    return 0;
+}
+
+/* Streaming XTS: без заголовка, сектор N файла лежит по смещению N * sector_size; порции кратны сектору */
+static int stream_xts_file(const char* in_path, const char* out_path, const unsigned char* key, int encrypt, size_t sector_size, unsigned long long first_sector, size_t* out_total) {
+    unsigned long long total = get_file_size64_path(in_path);
+    unsigned long long last = total % sector_size;
+    if ((last > 0ULL && last < AES_BLOCK_SIZE) || (total > 0ULL && total < AES_BLOCK_SIZE)) { log_error("Error: XTS needs at least %d bytes in the last sector of '%s'", AES_BLOCK_SIZE, in_path); return 1; }
+    aes_xts_key_t ctx; if (aes_xts_init(&ctx, key, sector_size, encrypt) != 0) { log_error("Error: failed to set XTS key"); return 1; }
+    FILE* in = fopen(in_path, "rb"); if (!in) { log_error("Error: failed to open input file '%s'", in_path); aes_xts_cleanup(&ctx); return 1; }
+    FILE* out = fopen(out_path, "wb"); if (!out) { log_error("Error: failed to open output file '%s'", out_path); fclose(in); aes_xts_cleanup(&ctx); return 1; }
+    const size_t CHUNK = stream_chunk_size(); // 4 MB на поток, кратно 512 и 4096
     unsigned char* buf = (unsigned char*)malloc(CHUNK);
-    unsigned long long processed = 0ULL; unsigned long long total = get_file_size64_path(in_path); 
-    if (total < AES_BLOCK_SIZE) { log_error("Error: file too small (no IV)"); free(buf); fclose(in); fclose(out); return 1; }
-    total -= AES_BLOCK_SIZE; fseek(in, AES_BLOCK_SIZE, SEEK_SET);
-    while (1) { 
-        size_t n = fread(buf, 1, CHUNK, in); 
-        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); free(buf); fclose(in); fclose(out); return 1; } break; }
-        size_t i = 0; 
-        while (i + AES_BLOCK_SIZE <= n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(feedback, ks, &aes_key); 
-            unsigned char pt[AES_BLOCK_SIZE]; xor_blocks(pt, buf + i, ks, AES_BLOCK_SIZE); 
-            if (fwrite(pt, 1, AES_BLOCK_SIZE, out) != AES_BLOCK_SIZE) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(feedback, ks, AES_BLOCK_SIZE); i += AES_BLOCK_SIZE; 
-        } 
-        if (i < n) { 
-            unsigned char ks[AES_BLOCK_SIZE]; AES_encrypt(feedback, ks, &aes_key); 
-            size_t rem = n - i; unsigned char pt[AES_BLOCK_SIZE]; 
-            xor_blocks(pt, buf + i, ks, rem); 
-            if (fwrite(pt, 1, rem, out) != rem) { log_error("Error: write"); free(buf); fclose(in); fclose(out); return 1; } 
-            memcpy(feedback, ks, AES_BLOCK_SIZE); 
-        } 
-        processed += (unsigned long long)n; 
-        int percent = calc_percent(processed, total); 
-        printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); 
-        fflush(stdout);
-    } 
-    printf("\n"); 
-    if (processed == 0ULL && total > 0ULL) { log_error("Error: no data was processed"); free(buf); fclose(in); fclose(out); return 1; }
-    if (out_total) { *out_total = (size_t)processed; } 
-    free(buf); fclose(in); fclose(out); return 0; 
+    if (!buf) { log_error("Error: failed to allocate buffer"); fclose(in); fclose(out); aes_xts_cleanup(&ctx); return 1; }
+    unsigned long long processed = 0ULL, sector = first_sector; size_t written = 0; int rc = 0;
+    while (rc == 0) {
+        size_t n = 0, r;
+        while (n < CHUNK && (r = fread(buf + n, 1, CHUNK - n, in)) > 0) n += r; // порция заканчивается на границе сектора
+        if (n == 0) { if (ferror(in)) { log_error("Error reading input file"); rc = 1; } break; }
+        if (aes_xts_crypt(g_pool, &ctx, sector, buf, buf, n) != 0) { rc = 1; break; }
+        if (fwrite(buf, 1, n, out) != n) { log_error("Error: failed to write output chunk"); rc = 1; break; }
+        written += n; processed += (unsigned long long)n; sector += n / sector_size;
+        int percent = calc_percent(processed, total); printf("\rProgress: %3d%%, Processed: %llu / %llu bytes", percent, processed, total); fflush(stdout);
+    }
+    printf("\n");
+    if (rc == 0 && out_total) *out_total = written;
+    aes_xts_cleanup(&ctx);
+    free(buf); fclose(in); fclose(out); return rc;
+}
+
+/* Multi-buffer CBC: several independent files share the AES pipeline */
+#define CBC_MULTI_FILES 8
+static int stream_encrypt_cbc_files(char** in_paths, char** out_paths, int count, const unsigned char* key, int* results) {
+    const size_t LANE_CHUNK = 1024 * 1024; // 1 MB на файл за проход (кратно блоку)
+    aes_core_key_t aes_key; if (aes_core_set_encrypt_key(&aes_key, key) < 0) { log_error("Error: AES_set_encrypt_key failed"); return 1; }
+    FILE* in[CBC_MULTI_FILES] = {0}; FILE* out[CBC_MULTI_FILES] = {0}; unsigned char* buf[CBC_MULTI_FILES] = {0};
+    size_t carry_len[CBC_MULTI_FILES] = {0}; int active[CBC_MULTI_FILES] = {0}; unsigned char iv[CBC_MULTI_FILES][AES_BLOCK_SIZE];
+    aes_cbc_stream_t streams[CBC_MULTI_FILES]; int lane_file[CBC_MULTI_FILES];
+    for (int i = 0; i < count; i++) {
+        results[i] = 1;
+        in[i] = fopen(in_paths[i], "rb"); if (!in[i]) { log_error("Error: failed to open input file '%s'", in_paths[i]); continue; }
+        out[i] = fopen(out_paths[i], "wb"); if (!out[i]) { log_error("Error: failed to open output file '%s'", out_paths[i]); continue; }
+        buf[i] = (unsigned char*)malloc(LANE_CHUNK + 2 * AES_BLOCK_SIZE); if (!buf[i]) { log_error("Error: failed to allocate buffer"); continue; }
+        if (generate_random_iv(iv[i]) != 0) { log_error("Error: failed to generate cryptographically secure IV"); continue; }
+        if (fwrite(iv[i], 1, AES_BLOCK_SIZE, out[i]) != AES_BLOCK_SIZE) { log_error("Error: failed to write IV"); continue; }
+        log_info("Encrypt '%s' -> '%s' (mode: cbc, multi-buffer)", in_paths[i], out_paths[i]);
+        active[i] = 1;
+    }
+    int remaining = 0; for (int i = 0; i < count; i++) remaining += active[i];
+    while (remaining > 0) {
+        // Каждый активный файл дает порцию блоков; файл, достигший конца, добавляет дополнение PKCS#7
+        int nlanes = 0; int finished[CBC_MULTI_FILES] = {0};
+        for (int i = 0; i < count; i++) {
+            if (!active[i]) continue;
+            size_t n = fread(buf[i] + carry_len[i], 1, LANE_CHUNK, in[i]);
+            if (n < LANE_CHUNK && ferror(in[i])) { log_error("Error reading input file '%s'", in_paths[i]); active[i] = 0; remaining--; continue; }
+            size_t avail = carry_len[i] + n;
+            if (n < LANE_CHUNK) {
+                unsigned char pad = (unsigned char)(AES_BLOCK_SIZE - avail % AES_BLOCK_SIZE);
+                memset(buf[i] + avail, pad, pad); avail += pad; finished[i] = 1;
+            }
+            streams[nlanes].in = buf[i]; streams[nlanes].out = buf[i]; streams[nlanes].nblocks = avail / AES_BLOCK_SIZE;
+            memcpy(streams[nlanes].iv, iv[i], AES_BLOCK_SIZE);
+            lane_file[nlanes] = i; carry_len[i] = avail % AES_BLOCK_SIZE; nlanes++;
+        }
+        aes_core_cbc_encrypt_multi(&aes_key, streams, (size_t)nlanes);
+        for (int l = 0; l < nlanes; l++) {
+            int i = lane_file[l]; size_t bytes = streams[l].nblocks * AES_BLOCK_SIZE;
+            memcpy(iv[i], streams[l].iv, AES_BLOCK_SIZE);
+            if (fwrite(buf[i], 1, bytes, out[i]) != bytes) { log_error("Error: failed to write output chunk to '%s'", out_paths[i]); active[i] = 0; remaining--; continue; }
+            memmove(buf[i], buf[i] + bytes, carry_len[i]);
+            if (finished[i]) { results[i] = 0; active[i] = 0; remaining--; }
+        }
+    }
+    // Ошибка сброса буфера при закрытии (например, диск заполнен) - файл не зашифрован, частичный вывод удаляется
+    for (int i = 0; i < count; i++) {
+        if (buf[i]) free(buf[i]);
+        if (in[i]) fclose(in[i]);
+        if (out[i] && fclose(out[i]) != 0 && results[i] == 0) { log_error("Error: failed to write output file '%s'", out_paths[i]); results[i] = 1; }
+        if (out[i] && results[i] != 0) remove(out_paths[i]);
+    }
+    aes_core_key_clear(&aes_key);
+    return 0;
 }
 
 static void log_info(const char* fmt, ...) {
@@ -574,16 +592,28 @@ void print_usage(const char* program_name) {
     
     fprintf(stderr, "=== ENCRYPTION/DECRYPTION MODE ===\n");
     fprintf(stderr, "Required options:\n");
-    fprintf(stderr, "  --algorithm ALG        Encryption algorithm (supported: aes)\n");
-    fprintf(stderr, "  --mode MODE            Mode (ecb, cbc, cfb, ofb, ctr)\n");
+    fprintf(stderr, "  --algorithm ALG        Encryption algorithm (supported: aes, chacha20)\n");
+    fprintf(stderr, "  --mode MODE            Mode (ecb, cbc, cfb, ofb, ctr, gcm, xts); optional for chacha20\n");
     fprintf(stderr, "  --encrypt              Perform encryption\n");
     fprintf(stderr, "  --decrypt              Perform decryption\n");
-    fprintf(stderr, "  --key KEY              Encryption/Decryption key (hex string, 32 chars for AES-128)\n");
+    fprintf(stderr, "  --key KEY              Encryption/Decryption key (hex string, 32 chars for AES-128, 64 for xts and chacha20)\n");
     fprintf(stderr, "  --input FILE           Path to input file or directory\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Optional:\n");
     fprintf(stderr, "  --output FILE          Path to output file or directory (default: <input>.enc or <input>.dec)\n");
     fprintf(stderr, "  --iv IV                Initialization Vector (decrypt only, hex string, 32 chars)\n");
+    fprintf(stderr, "  --threads N            Worker threads for ecb, ctr, xts and cbc/cfb decryption (default: 1)\n");
+    fprintf(stderr, "  --sector-size N        XTS sector (data unit) size: 512 or 4096 (default: 4096)\n");
+    fprintf(stderr, "  --first-sector N       XTS sector number of the first input byte (default: 0)\n");
+    fprintf(stderr, "  --mac hmac|cmac        ecb/cbc/cfb/ofb/ctr: MAC of the output file in the same pass, written to <output>.mac\n");
+    fprintf(stderr, "                         (decryption verifies <input>.mac or --verify FILE)\n");
+    fprintf(stderr, "  --mac-key KEY          MAC key as hex (CMAC: 32 hex chars); generated on encryption if omitted\n");
+    fprintf(stderr, "  --chunked              gcm/chacha20: chunked container, each chunk authenticated, parallel with --threads\n");
+    fprintf(stderr, "  --chunk-size N         Container chunk size in bytes, %d..%d (default: %d)\n", CONTAINER_MIN_CHUNK_SIZE, CONTAINER_MAX_CHUNK_SIZE, CONTAINER_DEFAULT_CHUNK_SIZE);
+    fprintf(stderr, "  --offset N             ctr decrypt: first ciphertext byte to decrypt, not counting the IV (default: 0)\n");
+    fprintf(stderr, "  --length N             ctr decrypt: number of bytes to decrypt (default: to the end of the file)\n");
+    fprintf(stderr, "  --engine NAME          AES engine: portable, aesni, vaes, openssl, bitsliced (default: best for this CPU)\n");
+    fprintf(stderr, "  --version              Print version and the active AES engine and ChaCha20 implementation\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Notes:\n");
     fprintf(stderr, "  - On encryption a key can be generated automatically (mouse/CSPRNG)\n");
@@ -592,6 +622,10 @@ void print_usage(const char* program_name) {
     fprintf(stderr, "  - For cbc, cfb, ofb, ctr:\n");
     fprintf(stderr, "    * Encryption: IV is generated automatically and prepended to the file\n");
     fprintf(stderr, "    * Decryption: IV is read from the beginning of the file or provided via --iv\n");
+    fprintf(stderr, "  - For gcm: a 12-byte nonce and the 16-byte authentication tag are prepended to the file;\n");
+    fprintf(stderr, "    decryption fails and removes the output if the data was modified\n");
+    fprintf(stderr, "  - For chacha20 (ChaCha20-Poly1305): same layout and checks as gcm, 256-bit key\n");
+    fprintf(stderr, "  - For xts: no header, output has the input size; each sector is encrypted independently\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Examples:\n");
     fprintf(stderr, "  Encrypt directory:\n");
@@ -601,35 +635,103 @@ void print_usage(const char* program_name) {
     
     fprintf(stderr, "=== HASH MODE (dgst command) ===\n");
     fprintf(stderr, "Required options:\n");
-    fprintf(stderr, "  --algorithm ALG        Hash algorithm (sha256, sha3-256)\n");
+    fprintf(stderr, "  --algorithm ALG        Hash algorithm (sha256, sha384, sha512, sha512-256, sha3-256, sha3-512,\n");
+    fprintf(stderr, "                         shake128, shake256,\n");
+    fprintf(stderr, "                         parallelhash128, parallelhash256, blake3)\n");
     fprintf(stderr, "  --input FILE           Path to input file\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Optional:\n");
     fprintf(stderr, "  --output FILE          Write hash to file instead of stdout\n");
-    fprintf(stderr, "  --hmac                 Enable HMAC mode (requires --key)\n");
+    fprintf(stderr, "  --threads N            parallelhash128/256, blake3: hash blocks on N threads (default: 1)\n");
+    fprintf(stderr, "  --hmac                 Enable HMAC mode (requires --key; sha256, sha384 or sha512)\n");
     fprintf(stderr, "  --cmac                 Enable AES-CMAC mode (requires --key, 32 hex chars for AES-128)\n");
-    fprintf(stderr, "  --key KEY              Key for HMAC/CMAC (hex string, arbitrary length for HMAC, 32 chars for CMAC)\n");
-    fprintf(stderr, "  --verify FILE          Verify HMAC/CMAC against value in file\n");
+    fprintf(stderr, "  --kmac                 Enable KMAC mode (--algorithm kmac128|kmac256, requires --key)\n");
+    fprintf(stderr, "  --key KEY              Key for HMAC/CMAC/KMAC (hex string, arbitrary length for HMAC/KMAC, 32 chars for CMAC)\n");
+    fprintf(stderr, "  --verify FILE          Verify HMAC/CMAC/KMAC against value in file\n");
     fprintf(stderr, "\n");
     fprintf(stderr, "Examples:\n");
     fprintf(stderr, "  Compute SHA-256 hash:\n");
     fprintf(stderr, "    %s dgst --algorithm sha256 --input document.pdf\n\n", program_name);
     fprintf(stderr, "  Compute SHA3-256 hash and save to file:\n");
     fprintf(stderr, "    %s dgst --algorithm sha3-256 --input backup.tar --output backup.sha3\n\n", program_name);
+    fprintf(stderr, "  Hash a large image on 8 threads (ParallelHash256, 8 KB blocks):\n");
+    fprintf(stderr, "    %s dgst --algorithm parallelhash256 --threads 8 --input disk.img\n\n", program_name);
+    fprintf(stderr, "  Fast non-FIPS checksum of a large file (BLAKE3, SIMD and threads):\n");
+    fprintf(stderr, "    %s dgst --algorithm blake3 --threads 8 --input disk.img\n\n", program_name);
+    fprintf(stderr, "  Hash many files at once (directories: files directly inside):\n");
+    fprintf(stderr, "    %s dgst --algorithm sha256 --input objects/*.bin\n\n", program_name);
     fprintf(stderr, "  Generate HMAC:\n");
     fprintf(stderr, "    %s dgst --algorithm sha256 --hmac --key 00112233445566778899aabbccddeeff --input message.txt\n\n", program_name);
+    fprintf(stderr, "  Generate HMAC-SHA512:\n");
+    fprintf(stderr, "    %s dgst --algorithm sha512 --hmac --key 00112233445566778899aabbccddeeff --input message.txt\n\n", program_name);
     fprintf(stderr, "  Generate AES-CMAC:\n");
     fprintf(stderr, "    %s dgst --cmac --key 2b7e151628aed2a6abf7158809cf4f3c --input message.txt\n\n", program_name);
+    fprintf(stderr, "  Generate KMAC256:\n");
+    fprintf(stderr, "    %s dgst --algorithm kmac256 --kmac --key 00112233445566778899aabbccddeeff --input message.txt\n\n", program_name);
     fprintf(stderr, "  Verify HMAC/CMAC:\n");
     fprintf(stderr, "    %s dgst --algorithm sha256 --hmac --key 00112233445566778899aabbccddeeff --input message.txt --verify expected_hmac.txt\n", program_name);
 }
 
+/**
+ * Вывод версии и реализаций AES и ChaCha20 (--version)
+ */
+static void print_version(void) {
+    printf("CryptoCore %s\n", CRYPTOCORE_VERSION);
+    printf("AES engine: %s\n", aes_engine_name(aes_engine_active()));
+    printf("Available engines:");
+    for (int e = 0; e < AES_ENGINE_COUNT; e++) {
+        if (aes_engine_available((aes_engine_t)e)) {
+            printf(" %s", aes_engine_name((aes_engine_t)e));
+        }
+    }
+    printf("\n");
+    printf("ChaCha20: %s, Poly1305: %s\n", chacha20_impl_name(), poly1305_impl_name());
+    printf("SHA-256: %s\n", sha256_impl_name());
+    printf("BLAKE3: %s\n", blake3_impl_name());
+    printf("XOR: %s\n", xor_impl_name());
+}
+
+/**
+ * Применение --engine до подготовки любых ключей
+ * Возвращает 0 при успехе, -1 если реализация неизвестна или недоступна
+ */
+static int apply_engine(const char* name) {
+    aes_engine_t engine;
+    if (aes_engine_parse(name, &engine) != 0) {
+        fprintf(stderr, "Error: unknown AES engine '%s' (expected portable, aesni, vaes, openssl or bitsliced)\n", name);
+        return -1;
+    }
+    if (aes_engine_select(engine) != 0) {
+        fprintf(stderr, "Error: AES engine '%s' is not supported by this CPU\n", name);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Выбор всех реализаций в главном потоке до создания пула: возможности процессора,
+ * реализация AES (после --engine), XOR, ChaCha20, Poly1305, SHA-256 и BLAKE3
+ * Рабочие потоки затем только читают уже опубликованные указатели
+ */
+static void resolve_dispatch(void) {
+    cpu_features_get();
+    aes_engine_active();
+    xor_impl_name();
+    chacha20_impl_name();
+    poly1305_impl_name();
+    sha256_impl_name();
+    blake3_impl_name();
+}
+
 /**
  * Разбор аргументов командной строки
  */
 int parse_args(int argc, char* argv[], cli_args_t* args) {
     // Инициализация аргументов
     memset(args, 0, sizeof(cli_args_t));
+    args->threads = 1;
+    args->sector_size = AES_XTS_DEFAULT_UNIT_SIZE;
+    args->chunk_size = CONTAINER_DEFAULT_CHUNK_SIZE;
 
     // Check for dgst command
     if (argc > 1 && strcmp(argv[1], "dgst") == 0) {
@@ -677,16 +779,110 @@ int parse_args(int argc, char* argv[], cli_args_t* args) {
                 return -1;
             }
             args->input_path = argv[++i];
+            args->inputs = &argv[i];
+            args->input_count = 1;
+            // dgst: following arguments without "--" are more input files (batch hashing)
+            while (args->dgst && i + 1 < argc && strncmp(argv[i + 1], "--", 2) != 0) {
+                i++;
+                args->input_count++;
+            }
         } else if (strcmp(argv[i], "--output") == 0) {
             if (i + 1 >= argc) {
                 fprintf(stderr, "Ошибка: --output требует аргумент\n");
                 return -1;
             }
             args->output_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --threads requires an argument\n");
+                return -1;
+            }
+            char* end = NULL;
+            long n = strtol(argv[++i], &end, 10);
+            if (!end || *end != '\0' || n < 1 || n > MAX_THREADS) {
+                fprintf(stderr, "Error: --threads must be a number from 1 to %d\n", MAX_THREADS);
+                return -1;
+            }
+            args->threads = (int)n;
+        } else if (strcmp(argv[i], "--engine") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --engine requires an argument\n");
+                return -1;
+            }
+            args->engine = argv[++i];
+        } else if (strcmp(argv[i], "--sector-size") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --sector-size requires an argument\n");
+                return -1;
+            }
+            const char* v = argv[++i];
+            if (strcmp(v, "512") != 0 && strcmp(v, "4096") != 0) {
+                fprintf(stderr, "Error: --sector-size must be 512 or 4096\n");
+                return -1;
+            }
+            args->sector_size = (size_t)atoi(v);
+        } else if (strcmp(argv[i], "--first-sector") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --first-sector requires an argument\n");
+                return -1;
+            }
+            char* end = NULL;
+            const char* v = argv[++i];
+            args->first_sector = strtoull(v, &end, 10);
+            if (!end || *end != '\0' || *v == '-' || *v == '\0') {
+                fprintf(stderr, "Error: --first-sector must be a non-negative number\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--offset") == 0 || strcmp(argv[i], "--length") == 0) {
+            const char* opt = argv[i];
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: %s requires an argument\n", opt);
+                return -1;
+            }
+            char* end = NULL;
+            const char* v = argv[++i];
+            unsigned long long n = strtoull(v, &end, 10);
+            if (!end || *end != '\0' || *v == '-' || *v == '\0') {
+                fprintf(stderr, "Error: %s must be a non-negative number\n", opt);
+                return -1;
+            }
+            if (strcmp(opt, "--offset") == 0) args->offset = n; else args->length = n;
+            args->range = 1;
+        } else if (strcmp(argv[i], "--chunked") == 0) {
+            args->chunked = 1;
+        } else if (strcmp(argv[i], "--chunk-size") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --chunk-size requires an argument\n");
+                return -1;
+            }
+            char* end = NULL;
+            const char* v = argv[++i];
+            args->chunk_size = strtoul(v, &end, 10);
+            if (!end || *end != '\0' || *v == '-' || args->chunk_size < CONTAINER_MIN_CHUNK_SIZE ||
+                args->chunk_size > CONTAINER_MAX_CHUNK_SIZE) {
+                fprintf(stderr, "Error: --chunk-size must be %d..%d bytes\n", CONTAINER_MIN_CHUNK_SIZE, CONTAINER_MAX_CHUNK_SIZE);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--mac") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --mac requires an argument\n");
+                return -1;
+            }
+            args->mac = argv[++i];
+        } else if (strcmp(argv[i], "--mac-key") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --mac-key requires an argument\n");
+                return -1;
+            }
+            args->mac_key_hex = argv[++i];
+        } else if (strcmp(argv[i], "--version") == 0) {
+            args->version = 1;
         } else if (strcmp(argv[i], "--hmac") == 0) {
             args->hmac = 1;
         } else if (strcmp(argv[i], "--cmac") == 0) {
             args->cmac = 1;
+        } else if (strcmp(argv[i], "--kmac") == 0) {
+            args->kmac = 1;
         } else if (strcmp(argv[i], "--verify") == 0) {
             if (i + 1 >= argc) {
                 fprintf(stderr, "Error: --verify requires an argument\n");
@@ -709,7 +905,9 @@ int mode_requires_iv(const char* mode) {
     return strcmp(mode, "cbc") == 0 ||
            strcmp(mode, "cfb") == 0 ||
            strcmp(mode, "ofb") == 0 ||
-           strcmp(mode, "ctr") == 0;
+           strcmp(mode, "ctr") == 0 ||
+           strcmp(mode, "gcm") == 0 ||
+           strcmp(mode, "chacha20-poly1305") == 0;
 }
 
 /**
@@ -721,6 +919,14 @@ int validate_args(cli_args_t* args) {
         fprintf(stderr, "Error: --algorithm is required\n");
         return -1;
     }
+    // ChaCha20 используется только как AEAD ChaCha20-Poly1305: --mode можно не указывать
+    if (strcmp(args->algorithm, "chacha20") == 0) {
+        if (args->mode && strcmp(args->mode, "chacha20-poly1305") != 0) {
+            fprintf(stderr, "Error: mode '%s' is not supported for chacha20 (only chacha20-poly1305)\n", args->mode);
+            return -1;
+        }
+        args->mode = "chacha20-poly1305";
+    }
     if (!args->mode) {
         fprintf(stderr, "Error: --mode is required\n");
         return -1;
@@ -768,34 +974,85 @@ int validate_args(cli_args_t* args) {
     }
 
     // Проверка алгоритма
-    if (strcmp(args->algorithm, "aes") != 0) {
-        fprintf(stderr, "Error: unsupported algorithm '%s'. Only 'aes' is supported.\n", args->algorithm);
+    int chacha = strcmp(args->algorithm, "chacha20") == 0;
+    if (strcmp(args->algorithm, "aes") != 0 && !chacha) {
+        fprintf(stderr, "Error: unsupported algorithm '%s'. Supported: aes, chacha20.\n", args->algorithm);
         return -1;
     }
 
     // Проверка режима
     if (strcmp(args->mode, "ecb") != 0 && strcmp(args->mode, "cbc") != 0 &&
         strcmp(args->mode, "cfb") != 0 && strcmp(args->mode, "ofb") != 0 &&
-        strcmp(args->mode, "ctr") != 0) {
-        fprintf(stderr, "Error: unsupported mode '%s'. Supported: ecb, cbc, cfb, ofb, ctr.\n", args->mode);
+        strcmp(args->mode, "ctr") != 0 && strcmp(args->mode, "gcm") != 0 &&
+        strcmp(args->mode, "xts") != 0 && !chacha) {
+        fprintf(stderr, "Error: unsupported mode '%s'. Supported: ecb, cbc, cfb, ofb, ctr, gcm, xts.\n", args->mode);
         return -1;
     }
 
     // Проверка длины ключа
     if (args->key_hex) {
     size_t key_len = strlen(args->key_hex);
-    if (key_len != 32) {
+    if (strcmp(args->mode, "xts") == 0 && key_len != AES_XTS_KEY_SIZE * 2) {
+        fprintf(stderr, "Error: XTS-AES-128 key must be 64 hex chars (data key || tweak key)\n");
+        fprintf(stderr, "       Provided key length: %zu chars\n", key_len);
+        return -1;
+    }
+    if (chacha && key_len != CHACHA20_KEY_SIZE * 2) {
+        fprintf(stderr, "Error: ChaCha20-Poly1305 key must be 64 hex chars (32 bytes)\n");
+        fprintf(stderr, "       Provided key length: %zu chars\n", key_len);
+        return -1;
+    }
+    if (strcmp(args->mode, "xts") != 0 && !chacha && key_len != 32) {
         fprintf(stderr, "Error: AES-128 key must be 32 hex chars (16 bytes)\n");
         fprintf(stderr, "       Provided key length: %zu chars\n", key_len);
         return -1;
         }
     }
 
+    // Контейнер с порциями строится только на AEAD-режимах
+    if (args->chunked && strcmp(args->mode, "gcm") != 0 && !chacha) {
+        fprintf(stderr, "Error: --chunked requires an AEAD mode (gcm or chacha20)\n");
+        return -1;
+    }
+
+    // Произвольный доступ: только дешифрование CTR, где счетчик блока вычисляется по смещению
+    if (args->range && (!args->decrypt || strcmp(args->mode, "ctr") != 0)) {
+        fprintf(stderr, "Error: --offset/--length are only supported for ctr decryption\n");
+        return -1;
+    }
+
+    // Encrypt-then-MAC: режимы без собственной аутентификации, весь файл за один проход
+    if (args->mac) {
+        if (strcmp(args->mac, "hmac") != 0 && strcmp(args->mac, "cmac") != 0) {
+            fprintf(stderr, "Error: --mac must be hmac or cmac\n");
+            return -1;
+        }
+        if (strcmp(args->mode, "gcm") == 0 || chacha || strcmp(args->mode, "xts") == 0 || args->chunked || args->range) {
+            fprintf(stderr, "Error: --mac is supported for ecb, cbc, cfb, ofb and ctr (gcm and chacha20 are already authenticated)\n");
+            return -1;
+        }
+        if (!args->mac_key_hex && !args->encrypt) {
+            fprintf(stderr, "Error: --mac-key is required for decryption with --mac\n");
+            return -1;
+        }
+        if (args->mac_key_hex && strcmp(args->mac, "cmac") == 0 && strlen(args->mac_key_hex) != 32) {
+            fprintf(stderr, "Error: CMAC key must be 32 hex chars (16 bytes)\n");
+            return -1;
+        }
+    } else if (args->mac_key_hex) {
+        fprintf(stderr, "Error: --mac-key requires --mac\n");
+        return -1;
+    }
+
     // Проверка IV
     if (args->iv_hex) {
         if (args->encrypt) {
             fprintf(stderr, "Предупреждение: --iv игнорируется при шифровании (IV генерируется автоматически)\n");
             args->iv_hex = NULL;
+        } else if (strcmp(args->mode, "gcm") == 0 || chacha) {
+            // Nonce AEAD аутентифицируется вместе с тегом и всегда читается из заголовка файла
+            fprintf(stderr, "Error: --iv is not supported for %s (nonce is read from the file)\n", args->mode);
+            return -1;
         } else {
             // Проверка длины IV
             size_t iv_len = strlen(args->iv_hex);
@@ -1057,14 +1314,266 @@ static int read_expected_mac(const char* filepath, char* mac_out, int max_len) {
     return 0;
 }
 
+/* Plain dgst algorithms; SHAKE/ParallelHash output is twice the security level */
+#define DGST_ALGORITHMS "sha256, sha384, sha512, sha512-256, sha3-256, sha3-512, shake128, shake256, parallelhash128, parallelhash256, blake3"
+
+static size_t dgst_digest_len(const char* algorithm) {
+    if (strcmp(algorithm, "sha256") == 0 || strcmp(algorithm, "sha512-256") == 0 || strcmp(algorithm, "sha3-256") == 0 ||
+        strcmp(algorithm, "shake128") == 0 || strcmp(algorithm, "parallelhash128") == 0 ||
+        strcmp(algorithm, "blake3") == 0) {
+        return 32;
+    }
+    if (strcmp(algorithm, "sha384") == 0) {
+        return 48;
+    }
+    if (strcmp(algorithm, "sha512") == 0 || strcmp(algorithm, "sha3-512") == 0 || strcmp(algorithm, "shake256") == 0 ||
+        strcmp(algorithm, "parallelhash256") == 0) {
+        return 64;
+    }
+    return 0;
+}
+
+static int dgst_hash_file(const char* algorithm, const char* path, uint8_t* hash) {
+    size_t len = dgst_digest_len(algorithm);
+    if (strcmp(algorithm, "sha256") == 0) {
+        return sha256_hash_file(path, hash);
+    }
+    if (strncmp(algorithm, "sha3-", 5) == 0) {
+        return sha3_hash_file(path, len, hash);
+    }
+    if (strcmp(algorithm, "sha384") == 0 || strncmp(algorithm, "sha512", 6) == 0) {
+        return sha512_hash_file(path, len, hash);
+    }
+    if (strncmp(algorithm, "parallelhash", 12) == 0) {
+        // Blocks are hashed on the --threads pool
+        return parallelhash_file(g_pool, path, len == 32 ? 128 : 256, PARALLELHASH_DEFAULT_BLOCK_SIZE, hash, len);
+    }
+    if (strcmp(algorithm, "blake3") == 0) {
+        return blake3_hash_file(g_pool, path, hash);
+    }
+    return shake_hash_file(path, strcmp(algorithm, "shake128") == 0 ? 128 : 256, hash, len);
+}
+
+/**
+ * HMAC key from --algorithm and --key: ipad/opad blocks are compressed once, then reused per file
+ */
+static int dgst_hmac_key(const cli_args_t* args, hmac_key_t* key) {
+    hmac_hash_t hash;
+    // HMAC over the SHA-2 family (RFC 2104, RFC 4868)
+    if (strcmp(args->algorithm, "sha256") == 0) {
+        hash = HMAC_SHA256;
+    } else if (strcmp(args->algorithm, "sha384") == 0) {
+        hash = HMAC_SHA384;
+    } else if (strcmp(args->algorithm, "sha512") == 0) {
+        hash = HMAC_SHA512;
+    } else {
+        fprintf(stderr, "Error: HMAC is only supported with sha256, sha384 and sha512 algorithms\n");
+        return -1;
+    }
+    if (!args->key_hex) {
+        fprintf(stderr, "Error: --key is required when --hmac, --cmac or --kmac is specified\n");
+        return -1;
+    }
+    
+    size_t key_size = 0;
+    unsigned char* key_bytes = hex_to_bytes(args->key_hex, &key_size);
+    if (!key_bytes) {
+        fprintf(stderr, "Error: Invalid key format\n");
+        return -1;
+    }
+    int rc = hmac_key_init(key, hash, key_bytes, key_size);
+    memset(key_bytes, 0, key_size);
+    free(key_bytes);
+    return rc;
+}
+
+/* Batch dgst: small files are read whole and hashed together by sha256_many */
+#define DGST_BATCH_BYTES (16 * 1024 * 1024)     // File data buffered per sha256_many call
+#define DGST_BATCH_FILES 1024                   // Files per sha256_many call
+#define DGST_BATCH_MAX_FILE (1024 * 1024)       // Larger files are streamed one by one
+
+typedef struct {
+    const char* paths[DGST_BATCH_FILES];
+    const uint8_t* msgs[DGST_BATCH_FILES];
+    size_t lens[DGST_BATCH_FILES];
+    uint8_t digests[DGST_BATCH_FILES][32];
+    size_t count;
+    uint8_t* data;                              // File contents, back to back
+    size_t used;
+} dgst_batch_t;
+
+static void dgst_print(FILE* out, const uint8_t* hash, size_t len, const char* path) {
+    char hex_hash[129];
+    hash_to_hex(hash, len, hex_hash);
+    fprintf(out, "%s %s\n", hex_hash, path);
+}
+
+static void dgst_flush(dgst_batch_t* b, FILE* out) {
+    sha256_many(b->msgs, b->lens, b->count, b->digests);
+    for (size_t i = 0; i < b->count; i++) {
+        dgst_print(out, b->digests[i], 32, b->paths[i]);
+    }
+    b->count = 0;
+    b->used = 0;
+}
+
+/**
+ * Hash several files (or HMAC them with hmac_key); output lines follow the input order
+ * Returns 0 if every file was hashed, 1 otherwise (the remaining files are still hashed)
+ */
+static int dgst_many(const char* algorithm, const hmac_key_t* hmac_key, char** paths, int count, FILE* out) {
+    int sha256 = strcmp(algorithm, "sha256") == 0 && !hmac_key;
+    size_t digest_len = hmac_key ? hmac_mac_size(hmac_key->hash) : dgst_digest_len(algorithm);
+    if (digest_len == 0) {
+        fprintf(stderr, "Error: Unsupported hash algorithm '%s'\n", algorithm);
+        fprintf(stderr, "Supported: " DGST_ALGORITHMS "\n");
+        return 1;
+    }
+    
+    dgst_batch_t* b = (dgst_batch_t*)calloc(1, sizeof(dgst_batch_t));
+    if (b) {
+        b->data = (uint8_t*)malloc(DGST_BATCH_BYTES);
+    }
+    if (!b || !b->data) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        free(b);
+        return 1;
+    }
+    
+    int result = 0;
+    for (int i = 0; i < count; i++) {
+        unsigned long long size = get_file_size64_path(paths[i]);
+        
+        // Large files (and other algorithms, HMAC) are streamed; the pending batch is printed first to keep the order
+        if (!sha256 || size > DGST_BATCH_MAX_FILE) {
+            uint8_t hash[64];
+            if (b->count > 0) {
+                dgst_flush(b, out);
+            }
+            int rc = hmac_key ? hmac_file_key(paths[i], hmac_key, hash) : dgst_hash_file(algorithm, paths[i], hash);
+            if (rc != 0) {
+                result = 1;
+                continue;
+            }
+            dgst_print(out, hash, digest_len, paths[i]);
+            continue;
+        }
+        
+        if (b->count == DGST_BATCH_FILES || b->used + size > DGST_BATCH_BYTES) {
+            dgst_flush(b, out);
+        }
+        FILE* f = fopen(paths[i], "rb");
+        if (!f) {
+            fprintf(stderr, "Error: Failed to open file '%s'\n", paths[i]);
+            result = 1;
+            continue;
+        }
+        size_t n = fread(b->data + b->used, 1, (size_t)size, f);
+        int read_error = ferror(f);
+        fclose(f);
+        if (read_error) {
+            fprintf(stderr, "Error: Failed to read file '%s'\n", paths[i]);
+            result = 1;
+            continue;
+        }
+        b->paths[b->count] = paths[i];
+        b->msgs[b->count] = b->data + b->used;
+        b->lens[b->count] = n;
+        b->count++;
+        b->used += n;
+    }
+    if (b->count > 0) {
+        dgst_flush(b, out);
+    }
+    
+    free(b->data);
+    free(b);
+    return result;
+}
+
+static int compare_names(const void* a, const void* b) {
+    return strcmp(*(const char* const*)a, *(const char* const*)b);
+}
+
+/**
+ * dgst over several --input files and/or directories (regular files directly inside them)
+ */
+static int dgst_inputs(cli_args_t* args) {
+    char** paths = NULL;
+    int count = 0;
+    hmac_key_t hmac_key;
+    
+    if (args->hmac && dgst_hmac_key(args, &hmac_key) != 0) {
+        return 1;
+    }
+    
+    for (int i = 0; i < args->input_count; i++) {
+        const char* input = args->inputs[i];
+        char** files = NULL;
+        int n = 1;
+        if (is_directory(input)) {
+            files = get_files_in_directory(input, &n);
+            if (!files) {
+                continue;  // Empty directory
+            }
+            qsort(files, (size_t)n, sizeof(char*), compare_names);  // readdir order is arbitrary
+        }
+        char** grown = (char**)realloc(paths, (size_t)(count + n) * sizeof(char*));
+        if (!grown) {
+            fprintf(stderr, "Error: Failed to allocate memory\n");
+            free_file_list(files, files ? n : 0);
+            free_file_list(paths, count);
+            return 1;
+        }
+        paths = grown;
+        if (!files) {
+            paths[count] = (char*)malloc(strlen(input) + 1);
+            strcpy(paths[count++], input);
+            continue;
+        }
+        size_t dir_len = strlen(input);
+        int has_sep = dir_len > 0 && (input[dir_len - 1] == '/' || input[dir_len - 1] == '\\');
+        for (int j = 0; j < n; j++) {
+            paths[count] = (char*)malloc(dir_len + strlen(files[j]) + 2);
+#ifdef _WIN32
+            sprintf(paths[count++], has_sep ? "%s%s" : "%s\\%s", input, files[j]);
+#else
+            sprintf(paths[count++], has_sep ? "%s%s" : "%s/%s", input, files[j]);
+#endif
+        }
+        free_file_list(files, n);
+    }
+    if (count == 0) {
+        fprintf(stderr, "Error: No files to hash\n");
+        return 1;
+    }
+    
+    FILE* out = stdout;
+    if (args->output_path) {
+        out = fopen(args->output_path, "w");
+        if (!out) {
+            fprintf(stderr, "Error: Failed to open output file '%s'\n", args->output_path);
+            free_file_list(paths, count);
+            return 1;
+        }
+    }
+    int result = dgst_many(args->algorithm, args->hmac ? &hmac_key : NULL, paths, count, out);
+    if (out != stdout) {
+        fclose(out);
+    }
+    free_file_list(paths, count);
+    return result;
+}
+
 /**
  * Handle dgst command for computing file hashes and HMACs
  */
 int handle_dgst_command(cli_args_t* args) {
-    uint8_t hash[32];
+    uint8_t hash[64];
     uint8_t* key_bytes = NULL;
     size_t key_size = 0;
-    char hex_hash[65];
+    hmac_hash_t hmac_hash = HMAC_SHA256;
+    char hex_hash[129];
     
     // Validate arguments
     if (!args->algorithm) {
@@ -1077,39 +1586,38 @@ int handle_dgst_command(cli_args_t* args) {
         return 1;
     }
     
+    // Several inputs or a directory: batch hashing, one line per file
+    if (args->input_count > 1 || is_directory(args->input_path)) {
+        if (args->cmac || args->kmac || args->verify_path) {
+            fprintf(stderr, "Error: --cmac, --kmac and --verify take a single --input file\n");
+            return 1;
+        }
+        return dgst_inputs(args);
+    }
+    
     // HMAC/CMAC mode validation
-    if (args->hmac || args->cmac) {
+    if (args->hmac || args->cmac || args->kmac) {
         if (!args->key_hex) {
-            fprintf(stderr, "Error: --key is required when --hmac or --cmac is specified\n");
+            fprintf(stderr, "Error: --key is required when --hmac, --cmac or --kmac is specified\n");
             return 1;
         }
         
-        if (args->hmac && args->cmac) {
-            fprintf(stderr, "Error: --hmac and --cmac cannot be used together\n");
+        if (args->hmac + args->cmac + args->kmac > 1) {
+            fprintf(stderr, "Error: --hmac, --cmac and --kmac cannot be used together\n");
             return 1;
         }
         
         if (args->hmac) {
-            // Only SHA-256 is supported for HMAC (as per requirements)
-            if (strcmp(args->algorithm, "sha256") != 0) {
-                fprintf(stderr, "Error: HMAC is only supported with sha256 algorithm\n");
-                return 1;
-            }
-            
-            // Convert key from hex
-            key_bytes = hex_to_bytes(args->key_hex, &key_size);
-            if (!key_bytes) {
-                fprintf(stderr, "Error: Invalid key format\n");
+            hmac_key_t hmac_key;
+            if (dgst_hmac_key(args, &hmac_key) != 0) {
                 return 1;
             }
+            hmac_hash = hmac_key.hash;
             
             // Compute HMAC
-            if (hmac_file(args->input_path, key_bytes, key_size, hash) != 0) {
-                free(key_bytes);
+            if (hmac_file_key(args->input_path, &hmac_key, hash) != 0) {
                 return 1;
             }
-            
-            free(key_bytes);
         } else if (args->cmac) {
             // CMAC requires AES-128 key (32 hex characters = 16 bytes)
             key_bytes = hex_to_bytes(args->key_hex, &key_size);
@@ -1135,35 +1643,55 @@ int handle_dgst_command(cli_args_t* args) {
             memcpy(hash, cmac_result, 16);
             memset(hash + 16, 0, 16);  // Zero out remaining bytes
             
+            free(key_bytes);
+        } else if (args->kmac) {
+            // KMAC128 -> 256-bit MAC, KMAC256 -> 512-bit MAC
+            int kmac128 = strcmp(args->algorithm, "kmac128") == 0;
+            if (!kmac128 && strcmp(args->algorithm, "kmac256") != 0) {
+                fprintf(stderr, "Error: KMAC requires --algorithm kmac128 or kmac256\n");
+                return 1;
+            }
+            
+            key_bytes = hex_to_bytes(args->key_hex, &key_size);
+            if (!key_bytes) {
+                fprintf(stderr, "Error: Invalid key format\n");
+                return 1;
+            }
+            
+            if (kmac_file(args->input_path, kmac128 ? 128 : 256, key_bytes, key_size,
+                          hash, kmac128 ? 32 : 64) != 0) {
+                free(key_bytes);
+                return 1;
+            }
+            
             free(key_bytes);
         }
     } else {
         // Regular hash computation
-        int hash_result = -1;
-        if (strcmp(args->algorithm, "sha256") == 0) {
-            hash_result = sha256_hash_file(args->input_path, hash);
-        } else if (strcmp(args->algorithm, "sha3-256") == 0) {
-            hash_result = sha3_256_hash_file(args->input_path, hash);
-        } else {
+        if (dgst_digest_len(args->algorithm) == 0) {
             fprintf(stderr, "Error: Unsupported hash algorithm '%s'\n", args->algorithm);
-            fprintf(stderr, "Supported: sha256, sha3-256\n");
+            fprintf(stderr, "Supported: " DGST_ALGORITHMS "\n");
             return 1;
         }
         
-        if (hash_result != 0) {
+        if (dgst_hash_file(args->algorithm, args->input_path, hash) != 0) {
             return 1;
         }
     }
     
     // Determine output length based on mode
-    int mac_len = (args->cmac) ? 16 : 32;
+    int mac_len = args->cmac ? 16 : (args->hmac ? (int)hmac_mac_size(hmac_hash) : (int)dgst_digest_len(args->algorithm));
+    if (args->kmac) {
+        mac_len = strcmp(args->algorithm, "kmac128") == 0 ? 32 : 64;
+    }
+    const char* mac_name = args->cmac ? "CMAC" : (args->kmac ? "KMAC" : "HMAC");
     hash_to_hex(hash, mac_len, hex_hash);
     hex_hash[mac_len * 2] = '\0';  // Ensure null termination
     
     // Verification mode
     if (args->verify_path) {
-        char expected_mac[65];
-        int expected_len = (args->cmac) ? 32 : 64;
+        char expected_mac[129];
+        int expected_len = mac_len * 2;
         
         if (read_expected_mac(args->verify_path, expected_mac, expected_len) != 0) {
             return 1;
@@ -1184,18 +1712,10 @@ int handle_dgst_command(cli_args_t* args) {
         }
         
         if (match) {
-            if (args->cmac) {
-                printf("[OK] CMAC verification successful\n");
-            } else {
-                printf("[OK] HMAC verification successful\n");
-            }
+            printf("[OK] %s verification successful\n", mac_name);
             return 0;
         } else {
-            if (args->cmac) {
-                fprintf(stderr, "[ERROR] CMAC verification failed\n");
-            } else {
-                fprintf(stderr, "[ERROR] HMAC verification failed\n");
-            }
+            fprintf(stderr, "[ERROR] %s verification failed\n", mac_name);
             return 1;
         }
     }
@@ -1242,9 +1762,30 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // Реализация AES выбирается до подготовки первого ключа, все реализации - до запуска пула потоков
+    if (args.engine && apply_engine(args.engine) != 0) {
+        return 1;
+    }
+    resolve_dispatch();
+
+    if (args.version) {
+        print_version();
+        return 0;
+    }
+
     // Handle dgst command separately
     if (args.dgst) {
-        return handle_dgst_command(&args);
+        // Пул потоков для ParallelHash
+        if (args.threads > 1) {
+            g_pool = thread_pool_create(args.threads);
+            if (!g_pool) {
+                log_error("Error: failed to start %d worker threads", args.threads);
+                return 1;
+            }
+        }
+        result = handle_dgst_command(&args);
+        if (g_pool) { thread_pool_destroy(g_pool); g_pool = NULL; }
+        return result;
     }
 
     if (validate_args(&args) != 0) {
@@ -1253,6 +1794,12 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    // XTS использует два ключа AES-128: для данных и для твиков; ChaCha20 - 256-битный ключ
+    size_t key_len = AES_128_KEY_SIZE;
+    const char* key_name = "AES-128";
+    if (strcmp(args.mode, "xts") == 0) { key_len = AES_XTS_KEY_SIZE; key_name = "XTS-AES-128"; }
+    else if (strcmp(args.mode, "chacha20-poly1305") == 0) { key_len = CHACHA20_POLY1305_KEY_SIZE; key_name = "ChaCha20-Poly1305"; }
+
     // Генерация ключа согласно Sprint 3 требованиям
     if (args.key_hex) {
         // Используем предоставленный ключ
@@ -1264,31 +1811,32 @@ int main(int argc, char* argv[]) {
     if (!key) {
         goto cleanup;
     }
-    if (key_size != AES_128_KEY_SIZE) {
-        log_error("Error: key must be exactly %d bytes for AES-128", AES_128_KEY_SIZE);
+    if (key_size != key_len) {
+        log_error("Error: key must be exactly %zu bytes for %s", key_len, key_name);
         goto cleanup;
     }
 
         // Проверка на слабые ключи
-        if (is_weak_key(key, AES_128_KEY_SIZE)) {
+        if (is_weak_key(key, key_len)) {
             log_error("Warning: weak key detected. Use a cryptographically strong key.");
         }
     } else if (args.encrypt) {
         // Sprint 3: Генерация случайного ключа при шифровании
-        key = (unsigned char*)malloc(AES_128_KEY_SIZE);
+        key = (unsigned char*)malloc(key_len);
         if (!key) {
             log_error("Error: failed to allocate memory for key");
                 goto cleanup;
             }
         
-        if (generate_aes_key(key) != 0) {
+        if (generate_aes_key(key) != 0 ||
+            (key_len > AES_128_KEY_SIZE && generate_aes_key(key + AES_128_KEY_SIZE) != 0)) {
             log_error("Error: failed to generate cryptographically secure key");
             goto cleanup;
         }
         
         // Преобразуем ключ в hex для вывода
-        key_hex = malloc(AES_128_KEY_SIZE * 2 + 1);
-        for (int i = 0; i < AES_128_KEY_SIZE; i++) {
+        key_hex = malloc(key_len * 2 + 1);
+        for (size_t i = 0; i < key_len; i++) {
             sprintf(key_hex + i * 2, "%02x", key[i]);
         }
         
@@ -1300,7 +1848,49 @@ int main(int argc, char* argv[]) {
                     goto cleanup;
                 }
 
+    // Ключ MAC независим от ключа шифрования; при шифровании без --mac-key генерируется
+    if (args.mac) {
+        if (args.mac_key_hex) {
+            args.mac_key = hex_to_bytes(args.mac_key_hex, &args.mac_key_len);
+            if (!args.mac_key || args.mac_key_len == 0) {
+                log_error("Error: invalid MAC key");
+                goto cleanup;
+            }
+            if (args.mac_key_len == key_len && memcmp(args.mac_key, key, key_len) == 0) {
+                log_error("Warning: MAC key equals the encryption key. Use independent keys.");
+            }
+        } else {
+            args.mac_key_len = strcmp(args.mac, "cmac") == 0 ? AES_128_KEY_SIZE : 2 * AES_128_KEY_SIZE;
+            args.mac_key = (unsigned char*)malloc(args.mac_key_len);
+            if (!args.mac_key || generate_aes_key(args.mac_key) != 0 ||
+                (args.mac_key_len > AES_128_KEY_SIZE && generate_aes_key(args.mac_key + AES_128_KEY_SIZE) != 0)) {
+                log_error("Error: failed to generate cryptographically secure MAC key");
+                goto cleanup;
+            }
+            char mac_key_hex[2 * 2 * AES_128_KEY_SIZE + 1];
+            hash_to_hex(args.mac_key, args.mac_key_len, mac_key_hex);
+            printf("[INFO] Generated random MAC key: %s\n", mac_key_hex);
+        }
+    }
+
+    // Пул потоков создается один раз и используется всеми потоковыми функциями
+    if (args.threads > 1) {
+        g_pool = thread_pool_create(args.threads);
+        if (!g_pool) {
+            log_error("Error: failed to start %d worker threads", args.threads);
+            goto cleanup;
+        }
+    }
+
     // Проверяем, является ли входной путь директорией
+    if (args.range && is_directory(args.input_path)) {
+        log_error("Error: --offset/--length apply to a single file, not a directory");
+        goto cleanup;
+    }
+    if (args.mac && is_directory(args.input_path)) {
+        log_error("Error: --mac applies to a single file, not a directory");
+        goto cleanup;
+    }
     if (is_directory(args.input_path)) {
         if (args.encrypt) {
             result = encrypt_directory(&args, key, key_hex);
@@ -1317,8 +1907,10 @@ int main(int argc, char* argv[]) {
     }
 
 cleanup:
+    if (g_pool) { thread_pool_destroy(g_pool); g_pool = NULL; }
     if (key) free(key);
     if (key_hex) free(key_hex);
+    if (args.mac_key) free(args.mac_key);
     return result;
 }
 
@@ -1326,311 +1918,146 @@ cleanup:
  * Шифрование одного файла
  */
 int encrypt_single_file(cli_args_t* args, unsigned char* key, const char* key_hex) {
-    unsigned char* input_data = NULL;
-    unsigned char* output_data = NULL;
-    unsigned char* iv = NULL;
-    size_t input_size, output_size;
-    int result = 1;
-    int needs_iv = mode_requires_iv(args->mode);
-    
+    unsigned char iv[AES_BLOCK_SIZE];
+    aes_mode_t mode = AES_MODE_ECB;
+    int gcm = strcmp(args->mode, "gcm") == 0;
+    int xts = strcmp(args->mode, "xts") == 0;
+    int chacha = strcmp(args->mode, "chacha20-poly1305") == 0;
+
     (void)key_hex;  // Не используется в функции одиночного файла
 
-    // Потоковая обработка (4MB) для всех режимов
-    if (strcmp(args->mode, "ctr") == 0) {
-        int needs_iv_stream = 1;
-        unsigned char* iv_local = NULL;
-        if (needs_iv_stream) {
-            iv_local = malloc(AES_BLOCK_SIZE);
-            if (!iv_local) goto cleanup;
-            if (generate_random_iv(iv_local) != 0) { log_error("Error: failed to generate cryptographically secure IV"); goto cleanup; }
-        }
-        log_info("Encrypt '%s' -> '%s' (mode: ctr, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb();
-        clock_t t_start = clock();
-        size_t out_total = 0;
-        int sres = stream_encrypt_ctr_file(args->input_path, args->output_path, key, iv_local, &out_total);
-        clock_t t_end = clock();
-        double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC;
-        double mem_after_mb = get_memory_used_mb();
-        if (iv_local) free(iv_local);
-        if (sres != 0) goto cleanup;
-        double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-        log_info("Success! Processed -> %zu bytes", out_total);
-        log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)",
-                 elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0;
-        goto cleanup;
-    }
-    if (strcmp(args->mode, "ecb") == 0) {
-        log_info("Encrypt '%s' -> '%s' (mode: ecb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_encrypt_ecb_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-        log_info("Success! Processed -> %zu bytes", out_total);
-        log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "cbc") == 0) {
-        unsigned char iv_local[AES_BLOCK_SIZE]; if (generate_random_iv(iv_local) != 0) { log_error("Error: failed to generate cryptographically secure IV"); goto cleanup; }
-        log_info("Encrypt '%s' -> '%s' (mode: cbc, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_encrypt_cbc_file(args->input_path, args->output_path, key, iv_local, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-        log_info("Success! Processed -> %zu bytes", out_total);
-        log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "cfb") == 0) {
-        unsigned char iv_local[AES_BLOCK_SIZE]; if (generate_random_iv(iv_local) != 0) { log_error("Error: failed to generate cryptographically secure IV"); goto cleanup; }
-        log_info("Encrypt '%s' -> '%s' (mode: cfb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_encrypt_cfb_file(args->input_path, args->output_path, key, iv_local, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-        log_info("Success! Processed -> %zu bytes", out_total);
-        log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "ofb") == 0) {
-        unsigned char iv_local[AES_BLOCK_SIZE]; if (generate_random_iv(iv_local) != 0) { log_error("Error: failed to generate cryptographically secure IV"); goto cleanup; }
-        log_info("Encrypt '%s' -> '%s' (mode: ofb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_encrypt_ofb_file(args->input_path, args->output_path, key, iv_local, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-        log_info("Success! Processed -> %zu bytes", out_total);
-        log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-
-    // Чтение входного файла
-    double mem_before_mb = get_memory_used_mb();
-    clock_t t_start = clock();
-    input_data = read_file(args->input_path, &input_size);
-    if (!input_data) {
-            goto cleanup;
-        }
-        
-    // Sprint 3: Генерация IV с использованием CSPRNG
-    if (needs_iv) {
-        iv = malloc(AES_BLOCK_SIZE);
-        if (!iv) {
-            goto cleanup;
-        }
-        if (generate_random_iv(iv) != 0) {
-            fprintf(stderr, "Error: failed to generate cryptographically secure IV\n");
-            goto cleanup;
-        }
+    if (!gcm && !xts && !chacha && aes_mode_parse(args->mode, &mode) != 0) {
+        log_error("Error: unsupported mode '%s'", args->mode);
+        return 1;
     }
 
-    // Шифрование
-    log_info("Encrypt '%s' -> '%s' (mode: %s)", args->input_path, args->output_path, args->mode);
-    
-    if (strcmp(args->mode, "ecb") == 0) {
-            output_data = aes_ecb_encrypt(input_data, input_size, key, &output_size);
-    } else if (strcmp(args->mode, "cbc") == 0) {
-            output_data = aes_cbc_encrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "cfb") == 0) {
-            output_data = aes_cfb_encrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "ofb") == 0) {
-            output_data = aes_ofb_encrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "ctr") == 0) {
-            output_data = aes_ctr_encrypt(input_data, input_size, key, iv, &output_size);
-    }
-
-    if (!output_data) {
-        goto cleanup;
+    // Sprint 3: Генерация IV с использованием CSPRNG (для GCM и ChaCha20-Poly1305 используются первые 12 байт)
+    if (mode_requires_iv(args->mode) && generate_random_iv(iv) != 0) {
+        log_error("Error: failed to generate cryptographically secure IV");
+        return 1;
     }
 
-    // Добавляем IV в начало файла для режимов с IV
-    if (needs_iv) {
-        unsigned char* final_output = malloc(AES_BLOCK_SIZE + output_size);
-        if (!final_output) {
-            goto cleanup;
+    mac_stream_t mac_ctx, *mac = NULL;
+    if (args->mac) {
+        if (mac_stream_init(&mac_ctx, args->mac, args->mac_key, args->mac_key_len) != 0) {
+            log_error("Error: failed to initialize %s", args->mac);
+            return 1;
         }
-        
-        memcpy(final_output, iv, AES_BLOCK_SIZE);
-        memcpy(final_output + AES_BLOCK_SIZE, output_data, output_size);
-        
-        free(output_data);
-        output_data = final_output;
-        output_size += AES_BLOCK_SIZE;
-    }
-
-    // Запись выходного файла
-    if (write_file(args->output_path, output_data, output_size) != 0) {
-        goto cleanup;
+        mac = &mac_ctx;
     }
 
+    // Потоковая обработка (4MB на поток) для всех режимов
+    log_info("Encrypt '%s' -> '%s' (mode: %s, streaming)", args->input_path, args->output_path, args->mode);
+    double mem_before_mb = get_memory_used_mb();
+    clock_t t_start = clock();
+    size_t out_total = 0;
+    int sres;
+    if (args->chunked) sres = stream_encrypt_container_file(chacha, args->input_path, args->output_path, key, iv, args->chunk_size, &out_total);
+    else if (gcm || chacha) sres = stream_encrypt_aead_file(chacha, args->input_path, args->output_path, key, iv, &out_total);
+    else if (xts) sres = stream_xts_file(args->input_path, args->output_path, key, 1, args->sector_size, args->first_sector, &out_total);
+    else sres = stream_encrypt_file(mode, args->input_path, args->output_path, key, iv, mac, &out_total);
     clock_t t_end = clock();
     double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC;
     double mem_after_mb = get_memory_used_mb();
-    double mbps = (elapsed_sec > 0.0) ? ((double)output_size / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed %zu bytes -> %zu bytes", input_size, output_size);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (diff: %.2f MB)",
+    if (sres != 0) return 1;
+    if (mac) {
+        // MAC шифртекста вычислен в том же проходе: отдельный dgst --hmac/--cmac не нужен
+        unsigned char tag[32];
+        char tag_hex[65];
+        size_t tag_len = mac_stream_final(mac, tag);
+        hash_to_hex(tag, tag_len, tag_hex);
+        char* mac_path = mac_sidecar_path(args->output_path);
+        FILE* f = mac_path ? fopen(mac_path, "w") : NULL;
+        if (!f) {
+            log_error("Error: failed to open MAC file '%s'", mac_path ? mac_path : args->output_path);
+            free(mac_path);
+            return 1;
+        }
+        fprintf(f, "%s %s\n", tag_hex, args->output_path);
+        fclose(f);
+        log_info("%s written to '%s'", mac_stream_name(mac), mac_path);
+        free(mac_path);
+    }
+    double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
+    log_info("Success! Processed -> %zu bytes", out_total);
+    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)",
              elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-    result = 0;
-
-cleanup:
-    if (iv) free(iv);
-    if (input_data) free(input_data);
-    if (output_data) free(output_data);
-    return result;
+    return 0;
 }
 
 /**
  * Дешифрование одного файла
  */
 int decrypt_single_file(cli_args_t* args, unsigned char* key, const char* key_hex) {
-    unsigned char* input_data = NULL;
-    unsigned char* output_data = NULL;
     unsigned char* iv = NULL;
-    size_t input_size, output_size;
+    aes_mode_t mode = AES_MODE_ECB;
+    int gcm = strcmp(args->mode, "gcm") == 0;
+    int xts = strcmp(args->mode, "xts") == 0;
+    int chacha = strcmp(args->mode, "chacha20-poly1305") == 0;
     int result = 1;
-    int needs_iv = mode_requires_iv(args->mode);
-    
+
     (void)key_hex;  // Не используется в функции одиночного файла
 
-    // Чтение входного файла
-    input_data = read_file(args->input_path, &input_size);
-    if (!input_data) {
-        goto cleanup;
+    if (!gcm && !xts && !chacha && aes_mode_parse(args->mode, &mode) != 0) {
+        log_error("Error: unsupported mode '%s'", args->mode);
+        return 1;
     }
 
-    // Извлечение IV из файла для режимов с IV
-    if (needs_iv) {
-        if (args->iv_hex) {
-            // IV предоставлен через командную строку
-            size_t iv_size;
-            iv = hex_to_bytes(args->iv_hex, &iv_size);
-            if (!iv || iv_size != AES_BLOCK_SIZE) {
-                fprintf(stderr, "Error: invalid IV\n");
-                goto cleanup;
-            }
-        } else {
-            // IV читается из начала файла
-            if (input_size < AES_BLOCK_SIZE) {
-                fprintf(stderr, "Error: file is too small to contain IV\n");
-                goto cleanup;
-            }
-            
-            iv = malloc(AES_BLOCK_SIZE);
-            if (!iv) {
-                goto cleanup;
-            }
-            memcpy(iv, input_data, AES_BLOCK_SIZE);
-            
-            // Убираем IV из входных данных
-            unsigned char* temp = malloc(input_size - AES_BLOCK_SIZE);
-            if (!temp) {
-                goto cleanup;
-            }
-            memcpy(temp, input_data + AES_BLOCK_SIZE, input_size - AES_BLOCK_SIZE);
-            free(input_data);
-            input_data = temp;
-            input_size -= AES_BLOCK_SIZE;
+    // IV из командной строки: файл содержит только шифртекст; иначе IV читается из начала файла
+    if (!gcm && !chacha && mode_requires_iv(args->mode) && args->iv_hex) {
+        size_t iv_size;
+        iv = hex_to_bytes(args->iv_hex, &iv_size);
+        if (!iv || iv_size != AES_BLOCK_SIZE) {
+            fprintf(stderr, "Error: invalid IV\n");
+            goto cleanup;
         }
     }
 
-    // Потоковая обработка для всех режимов
-    if (strcmp(args->mode, "ctr") == 0) {
-    log_info("Decrypt '%s' -> '%s' (mode: ctr, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb();
-        clock_t t_start = clock();
-        size_t out_total = 0;
-        int sres = stream_decrypt_ctr_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock();
-        double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC;
-        double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup;
-        double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed -> %zu bytes", out_total);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)",
-                 elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0;
-        goto cleanup;
-    }
-    if (strcmp(args->mode, "ecb") == 0) {
-    log_info("Decrypt '%s' -> '%s' (mode: ecb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_decrypt_ecb_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed -> %zu bytes", out_total);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "cbc") == 0) {
-    log_info("Decrypt '%s' -> '%s' (mode: cbc, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_decrypt_cbc_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed -> %zu bytes", out_total);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "cfb") == 0) {
-    log_info("Decrypt '%s' -> '%s' (mode: cfb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_decrypt_cfb_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed -> %zu bytes", out_total);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
-    }
-    if (strcmp(args->mode, "ofb") == 0) {
-    log_info("Decrypt '%s' -> '%s' (mode: ofb, streaming)", args->input_path, args->output_path);
-        double mem_before_mb = get_memory_used_mb(); clock_t t_start = clock(); size_t out_total = 0;
-        int sres = stream_decrypt_ofb_file(args->input_path, args->output_path, key, &out_total);
-        clock_t t_end = clock(); double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC; double mem_after_mb = get_memory_used_mb();
-        if (sres != 0) goto cleanup; double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
-    log_info("Success! Processed -> %zu bytes", out_total);
-    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)", elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
-        result = 0; goto cleanup;
+    // Ожидаемый MAC читается до дешифрования: без файла MAC обработка не начинается
+    mac_stream_t mac_ctx, *mac = NULL;
+    unsigned char expected_tag[32];
+    if (args->mac) {
+        if (mac_stream_init(&mac_ctx, args->mac, args->mac_key, args->mac_key_len) != 0) {
+            log_error("Error: failed to initialize %s", args->mac);
+            goto cleanup;
+        }
+        mac = &mac_ctx;
+        int tag_hex_len = mac_ctx.cmac ? 32 : 64;
+        char tag_hex[65];
+        char* mac_path = args->verify_path ? NULL : mac_sidecar_path(args->input_path);
+        int rc = read_expected_mac(args->verify_path ? args->verify_path : mac_path, tag_hex, tag_hex_len);
+        free(mac_path);
+        size_t tag_len = 0;
+        unsigned char* tag = rc == 0 ? hex_to_bytes(tag_hex, &tag_len) : NULL;
+        if (!tag) goto cleanup;
+        memcpy(expected_tag, tag, tag_len);
+        free(tag);
     }
 
-    // Дешифрование
+    // Потоковая обработка для всех режимов
+    log_info("Decrypt '%s' -> '%s' (mode: %s, streaming)", args->input_path, args->output_path, args->mode);
     double mem_before_mb = get_memory_used_mb();
     clock_t t_start = clock();
-    log_info("Decrypt '%s' -> '%s' (mode: %s)", args->input_path, args->output_path, args->mode);
-    
-    if (strcmp(args->mode, "ecb") == 0) {
-        output_data = aes_ecb_decrypt(input_data, input_size, key, &output_size);
-    } else if (strcmp(args->mode, "cbc") == 0) {
-        output_data = aes_cbc_decrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "cfb") == 0) {
-        output_data = aes_cfb_decrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "ofb") == 0) {
-        output_data = aes_ofb_decrypt(input_data, input_size, key, iv, &output_size);
-    } else if (strcmp(args->mode, "ctr") == 0) {
-        output_data = aes_ctr_decrypt(input_data, input_size, key, iv, &output_size);
-    }
-
-    if (!output_data) {
-        goto cleanup;
-    }
-
-    // Запись выходного файла
-    if (write_file(args->output_path, output_data, output_size) != 0) {
-        goto cleanup;
-    }
-
+    size_t out_total = 0;
+    int sres;
+    if (args->chunked) sres = stream_decrypt_container_file(chacha, args->input_path, args->output_path, key, &out_total);
+    else if (gcm || chacha) sres = stream_decrypt_aead_file(chacha, args->input_path, args->output_path, key, &out_total);
+    else if (xts) sres = stream_xts_file(args->input_path, args->output_path, key, 0, args->sector_size, args->first_sector, &out_total);
+    else if (args->range) sres = stream_decrypt_ctr_range(args->input_path, args->output_path, key, iv, args->offset, args->length, &out_total);
+    else sres = stream_decrypt_file(mode, args->input_path, args->output_path, key, iv, mac, mac ? expected_tag : NULL, &out_total);
     clock_t t_end = clock();
     double elapsed_sec = (double)(t_end - t_start) / CLOCKS_PER_SEC;
     double mem_after_mb = get_memory_used_mb();
-    log_info("Success! Processed %zu bytes -> %zu bytes", input_size, output_size);
-    log_info("Time: %.3f s, Memory: %.2f MB -> %.2f MB (diff %.2f MB)",
-             elapsed_sec, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
+    if (sres != 0) goto cleanup;
+    if (mac) log_info("%s verification successful", mac_stream_name(mac));
+    double mbps = (elapsed_sec > 0.0) ? ((double)out_total / (1024.0 * 1024.0)) / elapsed_sec : 0.0;
+    log_info("Success! Processed -> %zu bytes", out_total);
+    log_info("Time: %.3f s, Speed: %.2f MB/s, Memory: %.2f MB -> %.2f MB (Δ %.2f MB)",
+             elapsed_sec, mbps, mem_before_mb, mem_after_mb, mem_after_mb - mem_before_mb);
     result = 0;
 
 cleanup:
     if (iv) free(iv);
-    if (input_data) free(input_data);
-    if (output_data) free(output_data);
     return result;
 }
 
@@ -1663,6 +2090,20 @@ int encrypt_directory(cli_args_t* args, unsigned char* key, const char* key_hex)
 
     printf("Found %d files to encrypt\n", file_count);
 
+    // Сначала собираем новые имена всех файлов, затем шифруем
+    char** in_paths = calloc(file_count, sizeof(char*));
+    char** out_paths = calloc(file_count, sizeof(char*));
+    char** new_names = calloc(file_count, sizeof(char*));
+    const char** orig_names = calloc(file_count, sizeof(char*));
+    int* results = calloc(file_count, sizeof(int));
+    int job_count = 0;
+    if (!mappings || !in_paths || !out_paths || !new_names || !orig_names || !results) {
+        fprintf(stderr, "Error: failed to allocate memory\n");
+        free(mappings); free(in_paths); free(out_paths); free(new_names); free(orig_names); free(results);
+        free_file_list(files, file_count);
+        return 1;
+    }
+
     for (int i = 0; i < file_count; i++) {
         char input_file_path[512];
         char output_file_path[512];
@@ -1686,24 +2127,48 @@ int encrypt_directory(cli_args_t* args, unsigned char* key, const char* key_hex)
         snprintf(output_file_path, sizeof(output_file_path), "%s/%s", args->output_path, new_name);
 #endif
         
-        // Сохраняем маппинг
-        mappings[success_count].original_name = malloc(strlen(files[i]) + 1);
-        strcpy(mappings[success_count].original_name, files[i]);
-        mappings[success_count].encrypted_name = malloc(strlen(new_name) + 1);
-        strcpy(mappings[success_count].encrypted_name, new_name);
-        
-        // Создаем временные аргументы для обработки файла
-        cli_args_t temp_args = *args;
-        temp_args.input_path = input_file_path;
-        temp_args.output_path = output_file_path;
-        
-        if (encrypt_single_file(&temp_args, key, key_hex) == 0) {
+        in_paths[job_count] = malloc(strlen(input_file_path) + 1);
+        strcpy(in_paths[job_count], input_file_path);
+        out_paths[job_count] = malloc(strlen(output_file_path) + 1);
+        strcpy(out_paths[job_count], output_file_path);
+        orig_names[job_count] = files[i];
+        new_names[job_count] = new_name;
+        results[job_count] = 1;
+        job_count++;
+    }
+
+    if (strcmp(args->mode, "cbc") == 0) {
+        // CBC: до CBC_MULTI_FILES файлов шифруются одновременно (многобуферный режим)
+        for (int first = 0; first < job_count; first += CBC_MULTI_FILES) {
+            int n = (job_count - first < CBC_MULTI_FILES) ? job_count - first : CBC_MULTI_FILES;
+            stream_encrypt_cbc_files(in_paths + first, out_paths + first, n, key, results + first);
+            print_progress_bar(first + n, job_count);
+        }
+    } else {
+        for (int j = 0; j < job_count; j++) {
+            // Создаем временные аргументы для обработки файла
+            cli_args_t temp_args = *args;
+            temp_args.input_path = in_paths[j];
+            temp_args.output_path = out_paths[j];
+            results[j] = encrypt_single_file(&temp_args, key, key_hex);
+            print_progress_bar(j + 1, job_count);
+        }
+    }
+
+    // Сохраняем маппинг успешно зашифрованных файлов
+    for (int j = 0; j < job_count; j++) {
+        if (results[j] == 0) {
+            mappings[success_count].original_name = malloc(strlen(orig_names[j]) + 1);
+            strcpy(mappings[success_count].original_name, orig_names[j]);
+            mappings[success_count].encrypted_name = new_names[j];
+            new_names[j] = NULL;
             success_count++;
         }
-        print_progress_bar(i + 1, file_count);
-        
-        free(new_name);
+        free(in_paths[j]);
+        free(out_paths[j]);
+        if (new_names[j]) free(new_names[j]);
     }
+    free(in_paths); free(out_paths); free(new_names); free(orig_names); free(results);
 
     // Прогресс переносом строки после бара
     printf("\n");
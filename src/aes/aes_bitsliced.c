@@ -0,0 +1,532 @@
+#include "../../include/aes_bitsliced.h"
+#include <string.h>
+
+/*
+ * Представление состояния: 4 блока в 8 словах q[0..7], слово q[b] - плоскость бита b.
+ * В плоскости бит с номером 16*r + 4*c + k - бит байта (строка r, столбец c) блока k.
+ * Тогда ShiftRows - поворот 4-битных групп внутри 16-битной строки,
+ * а соседняя строка столбца для MixColumns получается поворотом слова на 16 бит.
+ * Подход и схема S-блока (Boyar-Peralta) - как в aes_ct64 из BearSSL.
+ */
+
+static inline uint32_t load_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void store_le32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+static inline uint64_t rotr16(uint64_t x) {
+    return (x >> 16) | (x << 48);
+}
+
+static inline uint64_t rotr32(uint64_t x) {
+    return (x >> 32) | (x << 32);
+}
+
+/**
+ * S-блок AES над 8 плоскостями (схема Boyar-Peralta, 113 логических операций)
+ */
+static void bitslice_sbox(uint64_t* q) {
+    uint64_t x0, x1, x2, x3, x4, x5, x6, x7;
+    uint64_t y1, y2, y3, y4, y5, y6, y7, y8, y9;
+    uint64_t y10, y11, y12, y13, y14, y15, y16, y17, y18, y19;
+    uint64_t y20, y21;
+    uint64_t z0, z1, z2, z3, z4, z5, z6, z7, z8, z9;
+    uint64_t z10, z11, z12, z13, z14, z15, z16, z17;
+    uint64_t t0, t1, t2, t3, t4, t5, t6, t7, t8, t9;
+    uint64_t t10, t11, t12, t13, t14, t15, t16, t17, t18, t19;
+    uint64_t t20, t21, t22, t23, t24, t25, t26, t27, t28, t29;
+    uint64_t t30, t31, t32, t33, t34, t35, t36, t37, t38, t39;
+    uint64_t t40, t41, t42, t43, t44, t45, t46, t47, t48, t49;
+    uint64_t t50, t51, t52, t53, t54, t55, t56, t57, t58, t59;
+    uint64_t t60, t61, t62, t63, t64, t65, t66, t67;
+    uint64_t s0, s1, s2, s3, s4, s5, s6, s7;
+
+    x0 = q[7];
+    x1 = q[6];
+    x2 = q[5];
+    x3 = q[4];
+    x4 = q[3];
+    x5 = q[2];
+    x6 = q[1];
+    x7 = q[0];
+
+    // Верхнее линейное преобразование
+    y14 = x3 ^ x5;
+    y13 = x0 ^ x6;
+    y9 = x0 ^ x3;
+    y8 = x0 ^ x5;
+    t0 = x1 ^ x2;
+    y1 = t0 ^ x7;
+    y4 = y1 ^ x3;
+    y12 = y13 ^ y14;
+    y2 = y1 ^ x0;
+    y5 = y1 ^ x6;
+    y3 = y5 ^ y8;
+    t1 = x4 ^ y12;
+    y15 = t1 ^ x5;
+    y20 = t1 ^ x1;
+    y6 = y15 ^ x7;
+    y10 = y15 ^ t0;
+    y11 = y20 ^ y9;
+    y7 = x7 ^ y11;
+    y17 = y10 ^ y11;
+    y19 = y10 ^ y8;
+    y16 = t0 ^ y11;
+    y21 = y13 ^ y16;
+    y18 = x0 ^ y16;
+
+    // Нелинейная часть (инверсия в GF(2^8))
+    t2 = y12 & y15;
+    t3 = y3 & y6;
+    t4 = t3 ^ t2;
+    t5 = y4 & x7;
+    t6 = t5 ^ t2;
+    t7 = y13 & y16;
+    t8 = y5 & y1;
+    t9 = t8 ^ t7;
+    t10 = y2 & y7;
+    t11 = t10 ^ t7;
+    t12 = y9 & y11;
+    t13 = y14 & y17;
+    t14 = t13 ^ t12;
+    t15 = y8 & y10;
+    t16 = t15 ^ t12;
+    t17 = t4 ^ t14;
+    t18 = t6 ^ t16;
+    t19 = t9 ^ t14;
+    t20 = t11 ^ t16;
+    t21 = t17 ^ y20;
+    t22 = t18 ^ y19;
+    t23 = t19 ^ y21;
+    t24 = t20 ^ y18;
+
+    t25 = t21 ^ t22;
+    t26 = t21 & t23;
+    t27 = t24 ^ t26;
+    t28 = t25 & t27;
+    t29 = t28 ^ t22;
+    t30 = t23 ^ t24;
+    t31 = t22 ^ t26;
+    t32 = t31 & t30;
+    t33 = t32 ^ t24;
+    t34 = t23 ^ t33;
+    t35 = t27 ^ t33;
+    t36 = t24 & t35;
+    t37 = t36 ^ t34;
+    t38 = t27 ^ t36;
+    t39 = t29 & t38;
+    t40 = t25 ^ t39;
+
+    t41 = t40 ^ t37;
+    t42 = t29 ^ t33;
+    t43 = t29 ^ t40;
+    t44 = t33 ^ t37;
+    t45 = t42 ^ t41;
+    z0 = t44 & y15;
+    z1 = t37 & y6;
+    z2 = t33 & x7;
+    z3 = t43 & y16;
+    z4 = t40 & y1;
+    z5 = t29 & y7;
+    z6 = t42 & y11;
+    z7 = t45 & y17;
+    z8 = t41 & y10;
+    z9 = t44 & y12;
+    z10 = t37 & y3;
+    z11 = t33 & y4;
+    z12 = t43 & y13;
+    z13 = t40 & y5;
+    z14 = t29 & y2;
+    z15 = t42 & y9;
+    z16 = t45 & y14;
+    z17 = t41 & y8;
+
+    // Нижнее линейное преобразование (с аффинной константой 0x63)
+    t46 = z15 ^ z16;
+    t47 = z10 ^ z11;
+    t48 = z5 ^ z13;
+    t49 = z9 ^ z10;
+    t50 = z2 ^ z12;
+    t51 = z2 ^ z5;
+    t52 = z7 ^ z8;
+    t53 = z0 ^ z3;
+    t54 = z6 ^ z7;
+    t55 = z16 ^ z17;
+    t56 = z12 ^ t48;
+    t57 = t50 ^ t53;
+    t58 = z4 ^ t46;
+    t59 = z3 ^ t54;
+    t60 = t46 ^ t57;
+    t61 = z14 ^ t57;
+    t62 = t52 ^ t58;
+    t63 = t49 ^ t58;
+    t64 = z4 ^ t59;
+    t65 = t61 ^ t62;
+    t66 = z1 ^ t63;
+    s0 = t59 ^ t63;
+    s6 = t56 ^ ~t62;
+    s7 = t48 ^ ~t60;
+    t67 = t64 ^ t65;
+    s3 = t53 ^ t66;
+    s4 = t51 ^ t66;
+    s5 = t47 ^ t65;
+    s1 = t64 ^ ~s3;
+    s2 = t55 ^ ~t67;
+
+    q[7] = s0;
+    q[6] = s1;
+    q[5] = s2;
+    q[4] = s3;
+    q[3] = s4;
+    q[2] = s5;
+    q[1] = s6;
+    q[0] = s7;
+}
+
+/**
+ * Обратное аффинное преобразование S-блока: B(x ^ 0x63), B - матрица, обратная аффинной
+ */
+static void inv_affine(uint64_t* q) {
+    uint64_t q0 = ~q[0], q1 = ~q[1], q2 = q[2], q3 = q[3];
+    uint64_t q4 = q[4], q5 = ~q[5], q6 = ~q[6], q7 = q[7];
+
+    q[7] = q1 ^ q4 ^ q6;
+    q[6] = q0 ^ q3 ^ q5;
+    q[5] = q7 ^ q2 ^ q4;
+    q[4] = q6 ^ q1 ^ q3;
+    q[3] = q5 ^ q0 ^ q2;
+    q[2] = q4 ^ q7 ^ q1;
+    q[1] = q3 ^ q6 ^ q0;
+    q[0] = q2 ^ q5 ^ q7;
+}
+
+/**
+ * Обратный S-блок через прямой: S^-1(x) = B(S(B(x ^ 0x63)) ^ 0x63)
+ */
+static void bitslice_inv_sbox(uint64_t* q) {
+    inv_affine(q);
+    bitslice_sbox(q);
+    inv_affine(q);
+}
+
+#define SWAPN(cl, ch, s, x, y) do { \
+        uint64_t a_ = (x), b_ = (y); \
+        (x) = (a_ & (uint64_t)(cl)) | ((b_ & (uint64_t)(cl)) << (s)); \
+        (y) = ((a_ & (uint64_t)(ch)) >> (s)) | (b_ & (uint64_t)(ch)); \
+    } while (0)
+
+#define SWAP2(x, y) SWAPN(0x5555555555555555ULL, 0xAAAAAAAAAAAAAAAAULL, 1, x, y)
+#define SWAP4(x, y) SWAPN(0x3333333333333333ULL, 0xCCCCCCCCCCCCCCCCULL, 2, x, y)
+#define SWAP8(x, y) SWAPN(0x0F0F0F0F0F0F0F0FULL, 0xF0F0F0F0F0F0F0F0ULL, 4, x, y)
+
+/**
+ * Транспонирование битовых матриц 8x8 между восемью словами (самообратное)
+ */
+static void ortho(uint64_t* q) {
+    SWAP2(q[0], q[1]);
+    SWAP2(q[2], q[3]);
+    SWAP2(q[4], q[5]);
+    SWAP2(q[6], q[7]);
+
+    SWAP4(q[0], q[2]);
+    SWAP4(q[1], q[3]);
+    SWAP4(q[4], q[6]);
+    SWAP4(q[5], q[7]);
+
+    SWAP8(q[0], q[4]);
+    SWAP8(q[1], q[5]);
+    SWAP8(q[2], q[6]);
+    SWAP8(q[3], q[7]);
+}
+
+/**
+ * Чередование байтов блока: столбцы 0 и 2 в q0, столбцы 1 и 3 в q1
+ */
+static inline void interleave_in(uint64_t* q0, uint64_t* q1, const unsigned char* block) {
+    uint64_t x0 = load_le32(block), x1 = load_le32(block + 4);
+    uint64_t x2 = load_le32(block + 8), x3 = load_le32(block + 12);
+
+    x0 |= (x0 << 16);
+    x1 |= (x1 << 16);
+    x2 |= (x2 << 16);
+    x3 |= (x3 << 16);
+    x0 &= 0x0000FFFF0000FFFFULL;
+    x1 &= 0x0000FFFF0000FFFFULL;
+    x2 &= 0x0000FFFF0000FFFFULL;
+    x3 &= 0x0000FFFF0000FFFFULL;
+    x0 |= (x0 << 8);
+    x1 |= (x1 << 8);
+    x2 |= (x2 << 8);
+    x3 |= (x3 << 8);
+    x0 &= 0x00FF00FF00FF00FFULL;
+    x1 &= 0x00FF00FF00FF00FFULL;
+    x2 &= 0x00FF00FF00FF00FFULL;
+    x3 &= 0x00FF00FF00FF00FFULL;
+    *q0 = x0 | (x2 << 8);
+    *q1 = x1 | (x3 << 8);
+}
+
+static inline void interleave_out(unsigned char* block, uint64_t q0, uint64_t q1) {
+    uint64_t x0 = q0 & 0x00FF00FF00FF00FFULL;
+    uint64_t x1 = q1 & 0x00FF00FF00FF00FFULL;
+    uint64_t x2 = (q0 >> 8) & 0x00FF00FF00FF00FFULL;
+    uint64_t x3 = (q1 >> 8) & 0x00FF00FF00FF00FFULL;
+
+    x0 |= (x0 >> 8);
+    x1 |= (x1 >> 8);
+    x2 |= (x2 >> 8);
+    x3 |= (x3 >> 8);
+    x0 &= 0x0000FFFF0000FFFFULL;
+    x1 &= 0x0000FFFF0000FFFFULL;
+    x2 &= 0x0000FFFF0000FFFFULL;
+    x3 &= 0x0000FFFF0000FFFFULL;
+    store_le32(block, (uint32_t)x0 | (uint32_t)(x0 >> 16));
+    store_le32(block + 4, (uint32_t)x1 | (uint32_t)(x1 >> 16));
+    store_le32(block + 8, (uint32_t)x2 | (uint32_t)(x2 >> 16));
+    store_le32(block + 12, (uint32_t)x3 | (uint32_t)(x3 >> 16));
+}
+
+/**
+ * Перевод 4 блоков (64 байта) в битово-срезовое представление
+ */
+static void load_blocks(uint64_t* q, const unsigned char* in) {
+    for (int k = 0; k < 4; k++) {
+        interleave_in(&q[k], &q[k + 4], in + k * 16);
+    }
+    ortho(q);
+}
+
+static void store_blocks(unsigned char* out, uint64_t* q) {
+    ortho(q);
+    for (int k = 0; k < 4; k++) {
+        interleave_out(out + k * 16, q[k], q[k + 4]);
+    }
+}
+
+static inline void add_round_key(uint64_t* q, const uint64_t* sk) {
+    for (int b = 0; b < 8; b++) {
+        q[b] ^= sk[b];
+    }
+}
+
+static inline void shift_rows(uint64_t* q) {
+    for (int b = 0; b < 8; b++) {
+        uint64_t x = q[b];
+        q[b] = (x & 0x000000000000FFFFULL)
+             | ((x & 0x00000000FFF00000ULL) >> 4)
+             | ((x & 0x00000000000F0000ULL) << 12)
+             | ((x & 0x0000FF0000000000ULL) >> 8)
+             | ((x & 0x000000FF00000000ULL) << 8)
+             | ((x & 0xF000000000000000ULL) >> 12)
+             | ((x & 0x0FFF000000000000ULL) << 4);
+    }
+}
+
+static inline void inv_shift_rows(uint64_t* q) {
+    for (int b = 0; b < 8; b++) {
+        uint64_t x = q[b];
+        q[b] = (x & 0x000000000000FFFFULL)
+             | ((x & 0x000000000FFF0000ULL) << 4)
+             | ((x & 0x00000000F0000000ULL) >> 12)
+             | ((x & 0x0000FF0000000000ULL) >> 8)
+             | ((x & 0x000000FF00000000ULL) << 8)
+             | ((x & 0x000F000000000000ULL) << 12)
+             | ((x & 0xFFF0000000000000ULL) >> 4);
+    }
+}
+
+/**
+ * Умножение каждого байта на x в GF(2^8): сдвиг плоскостей с приведением по 0x1b
+ */
+static inline void xtime_planes(uint64_t* q) {
+    uint64_t hi = q[7];
+    q[7] = q[6];
+    q[6] = q[5];
+    q[5] = q[4];
+    q[4] = q[3] ^ hi;
+    q[3] = q[2] ^ hi;
+    q[2] = q[1];
+    q[1] = q[0] ^ hi;
+    q[0] = hi;
+}
+
+static void mix_columns(uint64_t* q) {
+    // b = 2*(a0 ^ a1) ^ a1 ^ (a2 ^ a3); строка r+1 - поворот на 16, строки r+2 и r+3 - на 32
+    uint64_t t[8], r[8];
+    for (int b = 0; b < 8; b++) {
+        r[b] = rotr16(q[b]);
+        t[b] = q[b] ^ r[b];
+    }
+    uint64_t t7 = t[7];
+    uint64_t d[8];
+    d[0] = t7;
+    d[1] = t[0] ^ t7;
+    d[2] = t[1];
+    d[3] = t[2] ^ t7;
+    d[4] = t[3] ^ t7;
+    d[5] = t[4];
+    d[6] = t[5];
+    d[7] = t[6];
+    for (int b = 0; b < 8; b++) {
+        q[b] = d[b] ^ r[b] ^ rotr32(t[b]);
+    }
+}
+
+static void inv_mix_columns(uint64_t* q) {
+    // InvMixColumns = MixColumns после умножения на {04}x^2 + {05}
+    uint64_t t[8];
+    for (int b = 0; b < 8; b++) {
+        t[b] = q[b] ^ rotr32(q[b]);
+    }
+    xtime_planes(t);
+    xtime_planes(t);
+    for (int b = 0; b < 8; b++) {
+        q[b] ^= t[b];
+    }
+    mix_columns(q);
+}
+
+/**
+ * Шифрование двух наборов по 4 блока (8 блоков) в битово-срезовом виде
+ */
+static void encrypt8(const uint64_t* sk, uint64_t* a, uint64_t* b) {
+    add_round_key(a, sk);
+    add_round_key(b, sk);
+    for (int round = 1; round < 10; round++) {
+        bitslice_sbox(a);
+        bitslice_sbox(b);
+        shift_rows(a);
+        shift_rows(b);
+        mix_columns(a);
+        mix_columns(b);
+        add_round_key(a, sk + round * 8);
+        add_round_key(b, sk + round * 8);
+    }
+    bitslice_sbox(a);
+    bitslice_sbox(b);
+    shift_rows(a);
+    shift_rows(b);
+    add_round_key(a, sk + 80);
+    add_round_key(b, sk + 80);
+}
+
+static void decrypt8(const uint64_t* sk, uint64_t* a, uint64_t* b) {
+    add_round_key(a, sk + 80);
+    add_round_key(b, sk + 80);
+    for (int round = 9; round > 0; round--) {
+        inv_shift_rows(a);
+        inv_shift_rows(b);
+        bitslice_inv_sbox(a);
+        bitslice_inv_sbox(b);
+        add_round_key(a, sk + round * 8);
+        add_round_key(b, sk + round * 8);
+        inv_mix_columns(a);
+        inv_mix_columns(b);
+    }
+    inv_shift_rows(a);
+    inv_shift_rows(b);
+    bitslice_inv_sbox(a);
+    bitslice_inv_sbox(b);
+    add_round_key(a, sk);
+    add_round_key(b, sk);
+}
+
+/**
+ * SubWord расписания ключей через битово-срезовый S-блок (без таблиц)
+ */
+static uint32_t sub_word(uint32_t w) {
+    uint64_t q[8];
+    memset(q, 0, sizeof(q));
+    q[0] = w;
+    ortho(q);
+    bitslice_sbox(q);
+    ortho(q);
+    return (uint32_t)q[0];
+}
+
+void aes_bitsliced_expand_key128(const unsigned char* key, uint64_t* sk) {
+    static const uint32_t RCON[10] = { 0x01, 0x02, 0x04, 0x08, 0x10, 0x20, 0x40, 0x80, 0x1b, 0x36 };
+    unsigned char rk[11 * 16];
+
+    uint32_t w[44];
+    for (int i = 0; i < 4; i++) {
+        w[i] = load_le32(key + 4 * i);
+    }
+    for (int i = 4; i < 44; i++) {
+        uint32_t t = w[i - 1];
+        if (i % 4 == 0) {
+            t = sub_word((t >> 8) | (t << 24)) ^ RCON[i / 4 - 1];
+        }
+        w[i] = w[i - 4] ^ t;
+    }
+    for (int i = 0; i < 44; i++) {
+        store_le32(rk + 4 * i, w[i]);
+    }
+
+    // Раундовый ключ размножается во все 4 блока набора
+    for (int round = 0; round < 11; round++) {
+        unsigned char rep[4 * 16];
+        for (int k = 0; k < 4; k++) {
+            memcpy(rep + k * 16, rk + round * 16, 16);
+        }
+        load_blocks(sk + round * 8, rep);
+        memset(rep, 0, sizeof(rep));
+    }
+
+    memset(w, 0, sizeof(w));
+    memset(rk, 0, sizeof(rk));
+}
+
+/**
+ * Общий цикл по пакетам из 8 блоков; неполный пакет проходит через буфер
+ */
+static void crypt_blocks(const uint64_t* sk, const unsigned char* in, unsigned char* out,
+                         size_t nblocks, int decrypt) {
+    unsigned char buf[AES_BITSLICED_BLOCKS * 16];
+    uint64_t a[8], b[8];
+
+    while (nblocks > 0) {
+        size_t n = (nblocks < AES_BITSLICED_BLOCKS) ? nblocks : AES_BITSLICED_BLOCKS;
+        const unsigned char* src = in;
+        if (n < AES_BITSLICED_BLOCKS) {
+            memset(buf, 0, sizeof(buf));
+            memcpy(buf, in, n * 16);
+            src = buf;
+        }
+
+        load_blocks(a, src);
+        load_blocks(b, src + 64);
+        if (decrypt) {
+            decrypt8(sk, a, b);
+        } else {
+            encrypt8(sk, a, b);
+        }
+
+        if (n < AES_BITSLICED_BLOCKS) {
+            store_blocks(buf, a);
+            store_blocks(buf + 64, b);
+            memcpy(out, buf, n * 16);
+        } else {
+            store_blocks(out, a);
+            store_blocks(out + 64, b);
+        }
+
+        in += n * 16;
+        out += n * 16;
+        nblocks -= n;
+    }
+}
+
+void aes_bitsliced_encrypt(const uint64_t* sk, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    crypt_blocks(sk, in, out, nblocks, 0);
+}
+
+void aes_bitsliced_decrypt(const uint64_t* sk, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    crypt_blocks(sk, in, out, nblocks, 1);
+}
@@ -0,0 +1,664 @@
+#include "../../include/aes_core.h"
+#include "../../include/aes_vaes.h"
+#include "../../include/modes.h"
+#include <openssl/evp.h>
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Размер пакета блоков для переносимого пути */
+#define AES_CORE_BATCH 8
+
+/* Наибольшая порция для EVP_CipherUpdate (длина типа int, кратная блоку) */
+#define AES_CORE_EVP_CHUNK (INT_MAX & ~(AES_BLOCK_SIZE - 1))
+
+/* Порция совмещенного прохода GCM без PCLMULQDQ-ядра: 16 КБ остаются в кэше между CTR и GHASH */
+#define AES_CORE_GCM_CHUNK_BLOCKS 1024
+
+/* Пакет твиков XTS для реализаций без собственного ядра (2 КБ) */
+#define AES_CORE_XTS_BATCH 128
+
+static const char* const ENGINE_NAMES[AES_ENGINE_COUNT] = { "portable", "aesni", "vaes", "openssl", "bitsliced" };
+
+/* Активная реализация, -1 - еще не выбрана; чтение и запись атомарные */
+static int g_engine = -1;
+
+int aes_engine_available(aes_engine_t engine) {
+    switch (engine) {
+        case AES_ENGINE_PORTABLE: return 1;
+        case AES_ENGINE_AESNI:    return aes_ni_available();
+        case AES_ENGINE_VAES:     return aes_vaes_available();
+        case AES_ENGINE_OPENSSL:  return EVP_aes_128_ecb() != NULL;
+        case AES_ENGINE_BITSLICED: return 1;
+        default:                  return 0;
+    }
+}
+
+const char* aes_engine_name(aes_engine_t engine) {
+    if ((int)engine < 0 || engine >= AES_ENGINE_COUNT) {
+        return "unknown";
+    }
+    return ENGINE_NAMES[engine];
+}
+
+int aes_engine_parse(const char* name, aes_engine_t* engine) {
+    for (int i = 0; i < AES_ENGINE_COUNT; i++) {
+        if (strcmp(name, ENGINE_NAMES[i]) == 0) {
+            *engine = (aes_engine_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int aes_engine_select(aes_engine_t engine) {
+    if (!aes_engine_available(engine)) {
+        return -1;
+    }
+    __atomic_store_n(&g_engine, (int)engine, __ATOMIC_RELEASE);
+    return 0;
+}
+
+aes_engine_t aes_engine_active(void) {
+    int engine = __atomic_load_n(&g_engine, __ATOMIC_ACQUIRE);
+    if (engine >= 0) {
+        return (aes_engine_t)engine;
+    }
+
+    // Выбор в локальной переменной и одна публикация: другой поток не увидит промежуточный portable
+    static const aes_engine_t preference[] = { AES_ENGINE_VAES, AES_ENGINE_AESNI, AES_ENGINE_BITSLICED };
+    engine = AES_ENGINE_PORTABLE;
+    for (size_t i = 0; i < sizeof(preference) / sizeof(preference[0]); i++) {
+        if (aes_engine_available(preference[i])) {
+            engine = (int)preference[i];
+            break;
+        }
+    }
+
+    // Если --engine успел выбрать реализацию, она остается
+    int expected = -1;
+    if (!__atomic_compare_exchange_n(&g_engine, &expected, engine, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        engine = expected;
+    }
+    return (aes_engine_t)engine;
+}
+
+/**
+ * Сбой OpenSSL EVP посреди операции: выход не заполнен, продолжать нельзя
+ */
+static void evp_fail(void) {
+    fprintf(stderr, "Error: OpenSSL EVP AES operation failed\n");
+    abort();
+}
+
+/**
+ * EVP_CipherUpdate порциями длины int; сбой завершает процесс
+ */
+static void evp_update(EVP_CIPHER_CTX* evp, const unsigned char* in, unsigned char* out, size_t len) {
+    while (len > 0) {
+        int n = (len > (size_t)AES_CORE_EVP_CHUNK) ? AES_CORE_EVP_CHUNK : (int)len;
+        int out_len = 0;
+        if (EVP_CipherUpdate(evp, out, &out_len, in, n) != 1 || out_len != n) {
+            evp_fail();
+        }
+        in += n;
+        out += n;
+        len -= (size_t)n;
+    }
+}
+
+/**
+ * Однократный проход OpenSSL EVP по len байт в режиме с вектором состояния
+ * iv по завершении содержит обновленное состояние режима; сбой завершает процесс
+ */
+static void evp_crypt(const EVP_CIPHER* cipher, int enc, const unsigned char* key, unsigned char* iv,
+                      const unsigned char* in, unsigned char* out, size_t len) {
+    EVP_CIPHER_CTX* evp = EVP_CIPHER_CTX_new();
+    if (!evp || EVP_CipherInit_ex(evp, cipher, NULL, key, iv, enc) != 1) {
+        evp_fail();
+    }
+    EVP_CIPHER_CTX_set_padding(evp, 0);
+    evp_update(evp, in, out, len);
+
+#if OPENSSL_VERSION_NUMBER >= 0x30000000L
+    if (EVP_CIPHER_CTX_get_updated_iv(evp, iv, AES_BLOCK_SIZE) != 1) {
+        evp_fail();
+    }
+#else
+    memcpy(iv, EVP_CIPHER_CTX_iv(evp), AES_BLOCK_SIZE);
+#endif
+    EVP_CIPHER_CTX_free(evp);
+}
+
+/**
+ * Контекст ECB для ключа: создается один раз при подготовке ключа
+ * Обновление полными блоками без дополнения не меняет состояние контекста,
+ * поэтому один ключ могут использовать несколько потоков пула
+ */
+static int evp_ecb_init(aes_core_key_t* ctx, const unsigned char* key, int enc) {
+    ctx->evp = EVP_CIPHER_CTX_new();
+    if (!ctx->evp || EVP_CipherInit_ex(ctx->evp, EVP_aes_128_ecb(), NULL, key, NULL, enc) != 1) {
+        aes_core_key_clear(ctx);
+        return -1;
+    }
+    EVP_CIPHER_CTX_set_padding(ctx->evp, 0);
+    memcpy(ctx->key, key, AES_128_KEY_SIZE);
+    return 0;
+}
+
+/**
+ * Шифрование одного блока для последовательных режимов (переносимая и битово-срезовая реализации)
+ */
+static inline void encrypt_one(const aes_core_key_t* ctx, const unsigned char* in, unsigned char* out) {
+    if (ctx->engine == AES_ENGINE_BITSLICED) {
+        aes_bitsliced_encrypt(ctx->bitsliced_rk, in, out, 1);
+    } else {
+        aes_portable_encrypt_block(ctx->portable_rk, in, out);
+    }
+}
+
+int aes_core_set_encrypt_key(aes_core_key_t* ctx, const unsigned char* key) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->engine = aes_engine_active();
+
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_AESNI:
+        case AES_ENGINE_VAES:
+            aes_ni_expand_key128(key, ctx->ni_rk, NULL);
+            return 0;
+#endif
+        case AES_ENGINE_OPENSSL:
+            return evp_ecb_init(ctx, key, 1);
+        case AES_ENGINE_BITSLICED:
+            aes_bitsliced_expand_key128(key, ctx->bitsliced_rk);
+            return 0;
+        case AES_ENGINE_PORTABLE:
+            aes_portable_expand_key128(key, ctx->portable_rk);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+int aes_core_set_decrypt_key(aes_core_key_t* ctx, const unsigned char* key) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->engine = aes_engine_active();
+
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_AESNI:
+        case AES_ENGINE_VAES: {
+            unsigned char enc_rk[AES_NI_ROUND_KEYS_SIZE];
+            aes_ni_expand_key128(key, enc_rk, ctx->ni_rk);
+            memset(enc_rk, 0, sizeof(enc_rk));
+            return 0;
+        }
+#endif
+        case AES_ENGINE_OPENSSL:
+            return evp_ecb_init(ctx, key, 0);
+        case AES_ENGINE_BITSLICED:
+            aes_bitsliced_expand_key128(key, ctx->bitsliced_rk);
+            return 0;
+        case AES_ENGINE_PORTABLE:
+            // Обратный шифр использует то же расписание в обратном порядке
+            aes_portable_expand_key128(key, ctx->portable_rk);
+            return 0;
+        default:
+            return -1;
+    }
+}
+
+void aes_core_key_clear(aes_core_key_t* ctx) {
+    if (ctx->evp) {
+        EVP_CIPHER_CTX_free(ctx->evp);
+    }
+    memset(ctx, 0, sizeof(*ctx));
+}
+
+void aes_core_encrypt_blocks(const aes_core_key_t* ctx, const unsigned char* in,
+                             unsigned char* out, size_t nblocks) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+            aes_vaes_ecb_encrypt(ctx->ni_rk, in, out, nblocks);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_ecb_encrypt(ctx->ni_rk, in, out, nblocks);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            evp_update(ctx->evp, in, out, nblocks * AES_BLOCK_SIZE);
+            return;
+        case AES_ENGINE_BITSLICED:
+            aes_bitsliced_encrypt(ctx->bitsliced_rk, in, out, nblocks);
+            return;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < nblocks; i++) {
+        aes_portable_encrypt_block(ctx->portable_rk, in + i * AES_BLOCK_SIZE, out + i * AES_BLOCK_SIZE);
+    }
+}
+
+void aes_core_decrypt_blocks(const aes_core_key_t* ctx, const unsigned char* in,
+                             unsigned char* out, size_t nblocks) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+            aes_vaes_ecb_decrypt(ctx->ni_rk, in, out, nblocks);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_ecb_decrypt(ctx->ni_rk, in, out, nblocks);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            evp_update(ctx->evp, in, out, nblocks * AES_BLOCK_SIZE);
+            return;
+        case AES_ENGINE_BITSLICED:
+            aes_bitsliced_decrypt(ctx->bitsliced_rk, in, out, nblocks);
+            return;
+        default:
+            break;
+    }
+
+    for (size_t i = 0; i < nblocks; i++) {
+        aes_portable_decrypt_block(ctx->portable_rk, in + i * AES_BLOCK_SIZE, out + i * AES_BLOCK_SIZE);
+    }
+}
+
+void aes_core_cbc_encrypt_multi(const aes_core_key_t* ctx, aes_cbc_stream_t* streams, size_t nstreams) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+    // Последовательная цепочка не выигрывает от 512-битных регистров: VAES использует ядро AES-NI
+    if (ctx->engine == AES_ENGINE_AESNI || ctx->engine == AES_ENGINE_VAES) {
+        for (size_t first = 0; first < nstreams; first += AES_NI_CBC_LANES) {
+            size_t n = nstreams - first;
+            if (n > AES_NI_CBC_LANES) n = AES_NI_CBC_LANES;
+
+            unsigned char ivs[AES_NI_CBC_LANES * AES_BLOCK_SIZE];
+            const unsigned char* in[AES_NI_CBC_LANES];
+            unsigned char* out[AES_NI_CBC_LANES];
+            size_t nblocks[AES_NI_CBC_LANES];
+            for (size_t i = 0; i < n; i++) {
+                aes_cbc_stream_t* st = &streams[first + i];
+                memcpy(ivs + i * AES_BLOCK_SIZE, st->iv, AES_BLOCK_SIZE);
+                in[i] = st->in;
+                out[i] = st->out;
+                nblocks[i] = st->nblocks;
+            }
+            aes_ni_cbc_encrypt_multi(ctx->ni_rk, ivs, in, out, nblocks, n);
+            for (size_t i = 0; i < n; i++) {
+                memcpy(streams[first + i].iv, ivs + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+            }
+        }
+        return;
+    }
+#endif
+
+    if (ctx->engine == AES_ENGINE_OPENSSL) {
+        for (size_t i = 0; i < nstreams; i++) {
+            aes_cbc_stream_t* st = &streams[i];
+            evp_crypt(EVP_aes_128_cbc(), 1, ctx->key, st->iv, st->in, st->out, st->nblocks * AES_BLOCK_SIZE);
+        }
+        return;
+    }
+
+    if (ctx->engine == AES_ENGINE_BITSLICED) {
+        // Очередные блоки до 8 потоков шифруются одним проходом битово-срезового ядра
+        for (size_t first = 0; first < nstreams; first += AES_BITSLICED_BLOCKS) {
+            size_t n = nstreams - first;
+            if (n > AES_BITSLICED_BLOCKS) n = AES_BITSLICED_BLOCKS;
+
+            size_t longest = 0;
+            for (size_t i = 0; i < n; i++) {
+                if (streams[first + i].nblocks > longest) longest = streams[first + i].nblocks;
+            }
+
+            unsigned char lanes[AES_BITSLICED_BLOCKS * AES_BLOCK_SIZE];
+            memset(lanes, 0, sizeof(lanes));
+            for (size_t b = 0; b < longest; b++) {
+                for (size_t i = 0; i < n; i++) {
+                    aes_cbc_stream_t* st = &streams[first + i];
+                    if (b < st->nblocks) {
+                        xor_blocks(lanes + i * AES_BLOCK_SIZE, st->in + b * AES_BLOCK_SIZE, st->iv, AES_BLOCK_SIZE);
+                    }
+                }
+                aes_bitsliced_encrypt(ctx->bitsliced_rk, lanes, lanes, n);
+                for (size_t i = 0; i < n; i++) {
+                    aes_cbc_stream_t* st = &streams[first + i];
+                    if (b < st->nblocks) {
+                        memcpy(st->out + b * AES_BLOCK_SIZE, lanes + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+                        memcpy(st->iv, lanes + i * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+                    }
+                }
+            }
+        }
+        return;
+    }
+
+    // Переносимый путь: потоки шифруются по очереди
+    for (size_t i = 0; i < nstreams; i++) {
+        aes_cbc_stream_t* st = &streams[i];
+        unsigned char block[AES_BLOCK_SIZE];
+        for (size_t b = 0; b < st->nblocks; b++) {
+            xor_blocks(block, st->in + b * AES_BLOCK_SIZE, st->iv, AES_BLOCK_SIZE);
+            aes_portable_encrypt_block(ctx->portable_rk, block, st->out + b * AES_BLOCK_SIZE);
+            memcpy(st->iv, st->out + b * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+    }
+}
+
+void aes_core_cbc_decrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+            aes_vaes_cbc_decrypt(ctx->ni_rk, iv, in, out, nblocks);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_cbc_decrypt(ctx->ni_rk, iv, in, out, nblocks);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            evp_crypt(EVP_aes_128_cbc(), 0, ctx->key, iv, in, out, nblocks * AES_BLOCK_SIZE);
+            return;
+        default:
+            break;
+    }
+
+    // chain = IV || C[0..n-1]: копия нужна, чтобы out мог совпадать с in
+    unsigned char chain[(AES_CORE_BATCH + 1) * AES_BLOCK_SIZE];
+    while (nblocks > 0) {
+        size_t n = (nblocks < AES_CORE_BATCH) ? nblocks : AES_CORE_BATCH;
+        memcpy(chain, iv, AES_BLOCK_SIZE);
+        memcpy(chain + AES_BLOCK_SIZE, in, n * AES_BLOCK_SIZE);
+        aes_core_decrypt_blocks(ctx, in, out, n);
+        xor_blocks(out, out, chain, n * AES_BLOCK_SIZE);
+        memcpy(iv, chain + n * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        nblocks -= n;
+    }
+}
+
+void aes_core_cfb_decrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+            aes_vaes_cfb_decrypt(ctx->ni_rk, iv, in, out, nblocks);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_cfb_decrypt(ctx->ni_rk, iv, in, out, nblocks);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            evp_crypt(EVP_aes_128_cfb128(), 0, ctx->key, iv, in, out, nblocks * AES_BLOCK_SIZE);
+            return;
+        default:
+            break;
+    }
+
+    // Поток ключа пакета = E(IV || C[0..n-2])
+    unsigned char chain[AES_CORE_BATCH * AES_BLOCK_SIZE];
+    while (nblocks > 0) {
+        size_t n = (nblocks < AES_CORE_BATCH) ? nblocks : AES_CORE_BATCH;
+        memcpy(chain, iv, AES_BLOCK_SIZE);
+        memcpy(chain + AES_BLOCK_SIZE, in, (n - 1) * AES_BLOCK_SIZE);
+        memcpy(iv, in + (n - 1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        aes_core_encrypt_blocks(ctx, chain, chain, n);
+        xor_blocks(out, in, chain, n * AES_BLOCK_SIZE);
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        nblocks -= n;
+    }
+}
+
+void aes_core_ofb_xor(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                      unsigned char* out, size_t len) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_AESNI:
+        case AES_ENGINE_VAES:
+            aes_ni_ofb_xor(ctx->ni_rk, iv, in, out, len);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            evp_crypt(EVP_aes_128_ofb(), 1, ctx->key, iv, in, out, len);
+            return;
+        default:
+            break;
+    }
+
+    // Регистр обратной связи шифруется на месте и сам служит потоком ключа
+    while (len > 0) {
+        size_t n = (len < AES_BLOCK_SIZE) ? len : AES_BLOCK_SIZE;
+        encrypt_one(ctx, iv, iv);
+        xor_blocks(out, in, iv, n);
+        in += n;
+        out += n;
+        len -= n;
+    }
+}
+
+void aes_core_cfb_encrypt(const aes_core_key_t* ctx, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t len) {
+    unsigned char ks[AES_BLOCK_SIZE];
+
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_AESNI:
+        case AES_ENGINE_VAES:
+            aes_ni_cfb_encrypt(ctx->ni_rk, iv, in, out, len);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL: {
+            // Неполный блок отдельно: регистр EVP после него содержит смесь шифртекста и IV
+            size_t full = len - len % AES_BLOCK_SIZE;
+            evp_crypt(EVP_aes_128_cfb128(), 1, ctx->key, iv, in, out, full);
+            if (full < len) {
+                evp_update(ctx->evp, iv, ks, AES_BLOCK_SIZE);
+                xor_blocks(out + full, in + full, ks, len - full);
+            }
+            return;
+        }
+        default:
+            break;
+    }
+
+    while (len >= AES_BLOCK_SIZE) {
+        encrypt_one(ctx, iv, iv);
+        xor_blocks(iv, iv, in, AES_BLOCK_SIZE);
+        memcpy(out, iv, AES_BLOCK_SIZE);
+        in += AES_BLOCK_SIZE;
+        out += AES_BLOCK_SIZE;
+        len -= AES_BLOCK_SIZE;
+    }
+    if (len > 0) {
+        encrypt_one(ctx, iv, ks);
+        xor_blocks(out, in, ks, len);
+    }
+}
+
+/**
+ * Запись 64-битного значения в big-endian
+ */
+static inline void store_be64(unsigned char* b, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        b[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+/**
+ * Заполнение n блоков счетчика начиная с hi||lo (big-endian)
+ * Если младшая половина не переполняется в пределах пакета (одна проверка на пакет),
+ * старшая половина общая для всех блоков, а младшие - lo + j простым сложением
+ */
+static void fill_counter_blocks(unsigned char* blocks, uint64_t* hi, uint64_t* lo, size_t n) {
+    if (*lo <= UINT64_MAX - n) {
+        store_be64(blocks, *hi);
+        store_be64(blocks + 8, *lo);
+        for (size_t j = 1; j < n; j++) {
+            unsigned char* b = blocks + j * AES_BLOCK_SIZE;
+            memcpy(b, blocks, 8);
+            store_be64(b + 8, *lo + j);
+        }
+        *lo += n;
+        return;
+    }
+
+    // Пакет пересекает 2^64: перенос проверяется на каждом блоке
+    for (size_t j = 0; j < n; j++) {
+        unsigned char* b = blocks + j * AES_BLOCK_SIZE;
+        store_be64(b, *hi);
+        store_be64(b + 8, *lo);
+        if (++(*lo) == 0) {
+            (*hi)++;
+        }
+    }
+}
+
+void aes_core_ctr_xor(const aes_core_key_t* ctx, unsigned char* counter, const unsigned char* in,
+                      unsigned char* out, size_t len) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+            aes_vaes_ctr_xor(ctx->ni_rk, counter, in, out, len);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_ctr_xor(ctx->ni_rk, counter, in, out, len);
+            return;
+#endif
+        case AES_ENGINE_OPENSSL:
+            // Счетчик EVP увеличивается и на неполном последнем блоке, как здесь
+            evp_crypt(EVP_aes_128_ctr(), 1, ctx->key, counter, in, out, len);
+            return;
+        default:
+            break;
+    }
+
+    uint64_t hi = 0, lo = 0;
+    for (int i = 0; i < 8; i++) {
+        hi = (hi << 8) | counter[i];
+        lo = (lo << 8) | counter[8 + i];
+    }
+
+    unsigned char keystream[AES_CORE_BATCH * AES_BLOCK_SIZE];
+    while (len > 0) {
+        size_t nbytes = (len < sizeof(keystream)) ? len : sizeof(keystream);
+        size_t n = (nbytes + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE;
+        fill_counter_blocks(keystream, &hi, &lo, n);
+        aes_core_encrypt_blocks(ctx, keystream, keystream, n);
+        xor_blocks(out, in, keystream, nbytes);
+        in += nbytes;
+        out += nbytes;
+        len -= nbytes;
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+}
+
+void aes_core_xts_blocks(const aes_core_key_t* ctx, unsigned char* tweak, const unsigned char* in,
+                         unsigned char* out, size_t nblocks, int encrypt) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+    switch (ctx->engine) {
+        case AES_ENGINE_VAES:
+            aes_vaes_xts_blocks(ctx->ni_rk, tweak, in, out, nblocks, encrypt);
+            return;
+        case AES_ENGINE_AESNI:
+            aes_ni_xts_blocks(ctx->ni_rk, tweak, in, out, nblocks, encrypt);
+            return;
+        default:
+            break;
+    }
+#endif
+
+    // Твик как два 64-битных little-endian слова; умножение на x - сдвиг с переносом
+    uint64_t lo = 0, hi = 0;
+    for (int i = 7; i >= 0; i--) {
+        lo = (lo << 8) | tweak[i];
+        hi = (hi << 8) | tweak[8 + i];
+    }
+
+    unsigned char tw[AES_CORE_XTS_BATCH * AES_BLOCK_SIZE];
+    while (nblocks > 0) {
+        size_t n = (nblocks < AES_CORE_XTS_BATCH) ? nblocks : AES_CORE_XTS_BATCH;
+        for (size_t i = 0; i < n; i++) {
+            unsigned char* t = tw + i * AES_BLOCK_SIZE;
+            for (int k = 0; k < 8; k++) {
+                t[k] = (unsigned char)(lo >> (8 * k));
+                t[8 + k] = (unsigned char)(hi >> (8 * k));
+            }
+            uint64_t carry = hi >> 63;
+            hi = (hi << 1) | (lo >> 63);
+            lo = (lo << 1) ^ (0x87 & (0 - carry));
+        }
+        xor_blocks(out, in, tw, n * AES_BLOCK_SIZE);
+        if (encrypt) {
+            aes_core_encrypt_blocks(ctx, out, out, n);
+        } else {
+            aes_core_decrypt_blocks(ctx, out, out, n);
+        }
+        xor_blocks(out, out, tw, n * AES_BLOCK_SIZE);
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        nblocks -= n;
+    }
+
+    for (int i = 0; i < 8; i++) {
+        tweak[i] = (unsigned char)lo;
+        tweak[8 + i] = (unsigned char)hi;
+        lo >>= 8;
+        hi >>= 8;
+    }
+}
+
+void aes_core_gcm_ctr_ghash(const aes_core_key_t* ctx, const ghash_key_t* gk, unsigned char* counter,
+                            unsigned char* y, const unsigned char* in, unsigned char* out,
+                            size_t nblocks, int encrypt) {
+    switch (ctx->engine) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+        case AES_ENGINE_VAES:
+        case AES_ENGINE_AESNI:
+            if (gk->clmul) {
+                aes_ni_gcm_ctr_ghash(ctx->ni_rk, &gk->hpow[0][0], counter, y, in, out, nblocks, encrypt);
+                return;
+            }
+            break;
+#endif
+        default:
+            break;
+    }
+
+    while (nblocks > 0) {
+        // Порция не пересекает переполнение младших 32 бит счетчика: перенос в старшие
+        // 96 бит, который делает aes_core_ctr_xor, затем отменяется (inc32 из GCM)
+        uint32_t ctr32 = ((uint32_t)counter[12] << 24) | ((uint32_t)counter[13] << 16) |
+                         ((uint32_t)counter[14] << 8) | (uint32_t)counter[15];
+        uint64_t until_wrap = (uint64_t)UINT32_MAX - ctr32 + 1;
+        size_t n = (nblocks < AES_CORE_GCM_CHUNK_BLOCKS) ? nblocks : AES_CORE_GCM_CHUNK_BLOCKS;
+        if ((uint64_t)n > until_wrap) {
+            n = (size_t)until_wrap;
+        }
+
+        unsigned char prefix[12];
+        memcpy(prefix, counter, sizeof(prefix));
+        if (!encrypt) {
+            ghash_blocks(gk, y, in, n);
+        }
+        aes_core_ctr_xor(ctx, counter, in, out, n * AES_BLOCK_SIZE);
+        if (encrypt) {
+            ghash_blocks(gk, y, out, n);
+        }
+        memcpy(counter, prefix, sizeof(prefix));
+
+        in += n * AES_BLOCK_SIZE;
+        out += n * AES_BLOCK_SIZE;
+        nblocks -= n;
+    }
+}
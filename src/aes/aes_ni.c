@@ -0,0 +1,533 @@
+#include "../../include/aes_ni.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_AESNI
+
+#include <stdint.h>
+#include <wmmintrin.h>
+#include <emmintrin.h>
+
+#define AESNI_TARGET __attribute__((target("aes,sse2")))
+
+/* Количество блоков, одновременно находящихся в конвейере AES-NI */
+#define AESNI_LANES 8
+
+int aes_ni_available(void) {
+    return cpu_features_get()->aesni;
+}
+
+/**
+ * Один шаг расширения ключа AES-128
+ */
+static inline AESNI_TARGET __m128i expand_step(__m128i key, __m128i assist) {
+    assist = _mm_shuffle_epi32(assist, _MM_SHUFFLE(3, 3, 3, 3));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    key = _mm_xor_si128(key, _mm_slli_si128(key, 4));
+    return _mm_xor_si128(key, assist);
+}
+
+/* aeskeygenassist требует константу времени компиляции */
+#define EXPAND_ROUND(rk, i, rcon) \
+    rk[i] = expand_step(rk[i - 1], _mm_aeskeygenassist_si128(rk[i - 1], rcon))
+
+AESNI_TARGET
+void aes_ni_expand_key128(const unsigned char* key, unsigned char* enc_rk, unsigned char* dec_rk) {
+    __m128i rk[11];
+
+    rk[0] = _mm_loadu_si128((const __m128i*)key);
+    EXPAND_ROUND(rk, 1, 0x01);
+    EXPAND_ROUND(rk, 2, 0x02);
+    EXPAND_ROUND(rk, 3, 0x04);
+    EXPAND_ROUND(rk, 4, 0x08);
+    EXPAND_ROUND(rk, 5, 0x10);
+    EXPAND_ROUND(rk, 6, 0x20);
+    EXPAND_ROUND(rk, 7, 0x40);
+    EXPAND_ROUND(rk, 8, 0x80);
+    EXPAND_ROUND(rk, 9, 0x1b);
+    EXPAND_ROUND(rk, 10, 0x36);
+
+    for (int i = 0; i < 11; i++) {
+        _mm_storeu_si128((__m128i*)(enc_rk + i * 16), rk[i]);
+    }
+
+    if (dec_rk) {
+        // Обратный порядок ключей, средние раунды через InvMixColumns (схема Equivalent Inverse Cipher)
+        _mm_storeu_si128((__m128i*)dec_rk, rk[10]);
+        for (int i = 1; i < 10; i++) {
+            _mm_storeu_si128((__m128i*)(dec_rk + i * 16), _mm_aesimc_si128(rk[10 - i]));
+        }
+        _mm_storeu_si128((__m128i*)(dec_rk + 10 * 16), rk[0]);
+    }
+}
+
+static inline AESNI_TARGET void load_round_keys(const unsigned char* rk_bytes, __m128i* rk) {
+    for (int i = 0; i < 11; i++) {
+        rk[i] = _mm_loadu_si128((const __m128i*)(rk_bytes + i * 16));
+    }
+}
+
+AESNI_TARGET
+void aes_ni_ecb_encrypt(const unsigned char* enc_rk, const unsigned char* in,
+                        unsigned char* out, size_t nblocks) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+
+    // Основной цикл: 8 независимых блоков чередуются, чтобы скрыть задержку AESENC
+    while (nblocks >= AESNI_LANES) {
+        __m128i b[AESNI_LANES];
+        for (int j = 0; j < AESNI_LANES; j++) {
+            b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + j * 16)), rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesenc_si128(b[j], rk[r]);
+            }
+        }
+        for (int j = 0; j < AESNI_LANES; j++) {
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_aesenclast_si128(b[j], rk[10]));
+        }
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        nblocks -= AESNI_LANES;
+    }
+
+    // Хвост (менее 8 блоков)
+    while (nblocks > 0) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesenc_si128(b, rk[r]);
+        }
+        _mm_storeu_si128((__m128i*)out, _mm_aesenclast_si128(b, rk[10]));
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+}
+
+AESNI_TARGET
+void aes_ni_ecb_decrypt(const unsigned char* dec_rk, const unsigned char* in,
+                        unsigned char* out, size_t nblocks) {
+    __m128i rk[11];
+    load_round_keys(dec_rk, rk);
+
+    while (nblocks >= AESNI_LANES) {
+        __m128i b[AESNI_LANES];
+        for (int j = 0; j < AESNI_LANES; j++) {
+            b[j] = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + j * 16)), rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesdec_si128(b[j], rk[r]);
+            }
+        }
+        for (int j = 0; j < AESNI_LANES; j++) {
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_aesdeclast_si128(b[j], rk[10]));
+        }
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        nblocks -= AESNI_LANES;
+    }
+
+    while (nblocks > 0) {
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((const __m128i*)in), rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesdec_si128(b, rk[r]);
+        }
+        _mm_storeu_si128((__m128i*)out, _mm_aesdeclast_si128(b, rk[10]));
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+}
+
+AESNI_TARGET
+void aes_ni_cbc_decrypt(const unsigned char* dec_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t nblocks) {
+    __m128i rk[11];
+    load_round_keys(dec_rk, rk);
+    __m128i prev = _mm_loadu_si128((const __m128i*)iv);
+
+    while (nblocks >= AESNI_LANES) {
+        // Шифртекст сохраняется в регистрах до записи - допускается дешифрование на месте
+        __m128i c[AESNI_LANES], b[AESNI_LANES];
+        for (int j = 0; j < AESNI_LANES; j++) {
+            c[j] = _mm_loadu_si128((const __m128i*)(in + j * 16));
+            b[j] = _mm_xor_si128(c[j], rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesdec_si128(b[j], rk[r]);
+            }
+        }
+        for (int j = 0; j < AESNI_LANES; j++) {
+            b[j] = _mm_aesdeclast_si128(b[j], rk[10]);
+        }
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(b[0], prev));
+        for (int j = 1; j < AESNI_LANES; j++) {
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_xor_si128(b[j], c[j - 1]));
+        }
+        prev = c[AESNI_LANES - 1];
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        nblocks -= AESNI_LANES;
+    }
+
+    while (nblocks > 0) {
+        __m128i c = _mm_loadu_si128((const __m128i*)in);
+        __m128i b = _mm_xor_si128(c, rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesdec_si128(b, rk[r]);
+        }
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_aesdeclast_si128(b, rk[10]), prev));
+        prev = c;
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+
+    _mm_storeu_si128((__m128i*)iv, prev);
+}
+
+AESNI_TARGET
+void aes_ni_cfb_decrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t nblocks) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+    __m128i prev = _mm_loadu_si128((const __m128i*)iv);
+
+    while (nblocks >= AESNI_LANES) {
+        // Поток ключа для блока j - шифрование блока шифртекста j-1, все 8 известны заранее
+        __m128i c[AESNI_LANES], b[AESNI_LANES];
+        for (int j = 0; j < AESNI_LANES; j++) {
+            c[j] = _mm_loadu_si128((const __m128i*)(in + j * 16));
+        }
+        b[0] = _mm_xor_si128(prev, rk[0]);
+        for (int j = 1; j < AESNI_LANES; j++) {
+            b[j] = _mm_xor_si128(c[j - 1], rk[0]);
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesenc_si128(b[j], rk[r]);
+            }
+        }
+        for (int j = 0; j < AESNI_LANES; j++) {
+            b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_xor_si128(b[j], c[j]));
+        }
+        prev = c[AESNI_LANES - 1];
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        nblocks -= AESNI_LANES;
+    }
+
+    while (nblocks > 0) {
+        __m128i c = _mm_loadu_si128((const __m128i*)in);
+        __m128i b = _mm_xor_si128(prev, rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesenc_si128(b, rk[r]);
+        }
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(_mm_aesenclast_si128(b, rk[10]), c));
+        prev = c;
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+
+    _mm_storeu_si128((__m128i*)iv, prev);
+}
+
+AESNI_TARGET
+void aes_ni_cbc_encrypt_multi(const unsigned char* enc_rk, unsigned char* ivs,
+                              const unsigned char* const* in, unsigned char* const* out,
+                              const size_t* nblocks, size_t nlanes) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+
+    // Активные потоки: номер потока и текущее значение цепочки
+    size_t lane[AES_NI_CBC_LANES];
+    __m128i chain[AES_NI_CBC_LANES];
+    size_t k = 0;
+    for (size_t i = 0; i < nlanes; i++) {
+        if (nblocks[i] > 0) {
+            lane[k] = i;
+            chain[k] = _mm_loadu_si128((const __m128i*)(ivs + i * 16));
+            k++;
+        }
+    }
+
+    size_t done = 0;
+    while (k > 0) {
+        // Все активные потоки обрабатываются вместе до завершения самого короткого
+        size_t step = nblocks[lane[0]] - done;
+        for (size_t j = 1; j < k; j++) {
+            if (nblocks[lane[j]] - done < step) step = nblocks[lane[j]] - done;
+        }
+
+        for (size_t s = 0; s < step; s++) {
+            size_t pos = (done + s) * 16;
+            for (size_t j = 0; j < k; j++) {
+                __m128i p = _mm_loadu_si128((const __m128i*)(in[lane[j]] + pos));
+                chain[j] = _mm_xor_si128(_mm_xor_si128(p, chain[j]), rk[0]);
+            }
+            for (int r = 1; r < 10; r++) {
+                for (size_t j = 0; j < k; j++) {
+                    chain[j] = _mm_aesenc_si128(chain[j], rk[r]);
+                }
+            }
+            for (size_t j = 0; j < k; j++) {
+                chain[j] = _mm_aesenclast_si128(chain[j], rk[10]);
+                _mm_storeu_si128((__m128i*)(out[lane[j]] + pos), chain[j]);
+            }
+        }
+        done += step;
+
+        // Завершенные потоки сохраняют цепочку и выбывают из конвейера
+        size_t kept = 0;
+        for (size_t j = 0; j < k; j++) {
+            if (nblocks[lane[j]] == done) {
+                _mm_storeu_si128((__m128i*)(ivs + lane[j] * 16), chain[j]);
+            } else {
+                lane[kept] = lane[j];
+                chain[kept] = chain[j];
+                kept++;
+            }
+        }
+        k = kept;
+    }
+}
+
+/**
+ * Одно шифрование блока раундовыми ключами шифрования
+ */
+static inline AESNI_TARGET __m128i encrypt_one(__m128i b, const __m128i* rk) {
+    b = _mm_xor_si128(b, rk[0]);
+    for (int r = 1; r < 10; r++) {
+        b = _mm_aesenc_si128(b, rk[r]);
+    }
+    return _mm_aesenclast_si128(b, rk[10]);
+}
+
+/**
+ * XOR неполного последнего блока с потоком ключа
+ */
+static inline AESNI_TARGET void xor_tail(__m128i ks, const unsigned char* in, unsigned char* out, size_t len) {
+    unsigned char tmp[16];
+    _mm_storeu_si128((__m128i*)tmp, ks);
+    for (size_t i = 0; i < len; i++) {
+        out[i] = in[i] ^ tmp[i];
+    }
+}
+
+AESNI_TARGET
+void aes_ni_ofb_xor(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                    unsigned char* out, size_t len) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+
+    __m128i reg = _mm_loadu_si128((const __m128i*)iv);
+    while (len >= 16) {
+        reg = encrypt_one(reg, rk);
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(reg, _mm_loadu_si128((const __m128i*)in)));
+        in += 16;
+        out += 16;
+        len -= 16;
+    }
+    if (len > 0) {
+        reg = encrypt_one(reg, rk);
+        xor_tail(reg, in, out, len);
+    }
+    _mm_storeu_si128((__m128i*)iv, reg);
+}
+
+AESNI_TARGET
+void aes_ni_cfb_encrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                        unsigned char* out, size_t len) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+
+    __m128i reg = _mm_loadu_si128((const __m128i*)iv);
+    while (len >= 16) {
+        // Шифртекст блока сразу становится регистром сдвига для следующего
+        reg = _mm_xor_si128(encrypt_one(reg, rk), _mm_loadu_si128((const __m128i*)in));
+        _mm_storeu_si128((__m128i*)out, reg);
+        in += 16;
+        out += 16;
+        len -= 16;
+    }
+    if (len > 0) {
+        xor_tail(encrypt_one(reg, rk), in, out, len);
+    }
+    _mm_storeu_si128((__m128i*)iv, reg);
+}
+
+static inline uint64_t load_be64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void store_be64(unsigned char* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+/**
+ * Блок счетчика hi||lo (big-endian) в регистре: 64-битные половины
+ * в памяти хранятся в обратном порядке байтов относительно little-endian
+ */
+static inline AESNI_TARGET __m128i counter_block(uint64_t hi_swapped, uint64_t lo) {
+    return _mm_set_epi64x((long long)__builtin_bswap64(lo), (long long)hi_swapped);
+}
+
+AESNI_TARGET
+void aes_ni_ctr_xor(const unsigned char* enc_rk, unsigned char* counter, const unsigned char* in,
+                    unsigned char* out, size_t len) {
+    __m128i rk[11];
+    load_round_keys(enc_rk, rk);
+
+    uint64_t hi = load_be64(counter);
+    uint64_t lo = load_be64(counter + 8);
+    uint64_t hi_swapped = __builtin_bswap64(hi);
+
+    while (len >= AESNI_LANES * 16) {
+        __m128i b[AESNI_LANES];
+        if (lo <= UINT64_MAX - AESNI_LANES) {
+            // Быстрый путь: перенос из младших 64 бит невозможен на всем пакете
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_xor_si128(counter_block(hi_swapped, lo + (uint64_t)j), rk[0]);
+            }
+            lo += AESNI_LANES;
+        } else {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_xor_si128(counter_block(hi_swapped, lo), rk[0]);
+                if (++lo == 0) {
+                    hi_swapped = __builtin_bswap64(++hi);
+                }
+            }
+        }
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesenc_si128(b[j], rk[r]);
+            }
+        }
+        // Поток ключа сразу накладывается на вход 128-битным XOR
+        for (int j = 0; j < AESNI_LANES; j++) {
+            b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+            __m128i d = _mm_loadu_si128((const __m128i*)(in + j * 16));
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_xor_si128(b[j], d));
+        }
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        len -= AESNI_LANES * 16;
+    }
+
+    while (len > 0) {
+        __m128i b = _mm_xor_si128(counter_block(hi_swapped, lo), rk[0]);
+        if (++lo == 0) {
+            hi_swapped = __builtin_bswap64(++hi);
+        }
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesenc_si128(b, rk[r]);
+        }
+        b = _mm_aesenclast_si128(b, rk[10]);
+
+        if (len >= 16) {
+            _mm_storeu_si128((__m128i*)out, _mm_xor_si128(b, _mm_loadu_si128((const __m128i*)in)));
+            in += 16;
+            out += 16;
+            len -= 16;
+        } else {
+            // Неполный последний блок
+            unsigned char ks[16];
+            _mm_storeu_si128((__m128i*)ks, b);
+            for (size_t i = 0; i < len; i++) {
+                out[i] = in[i] ^ ks[i];
+            }
+            len = 0;
+        }
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+}
+
+/**
+ * Умножение твика XTS на x в GF(2^128) без ветвлений: 32-битные слова сдвигаются влево,
+ * старший бит каждого слова переносится в следующее, а из старшего слова - как 0x87
+ */
+static inline AESNI_TARGET __m128i xts_mul_alpha(__m128i t) {
+    const __m128i poly = _mm_set_epi32(1, 1, 1, 0x87);
+    __m128i carry = _mm_shuffle_epi32(_mm_srai_epi32(t, 31), 0x93);
+    return _mm_xor_si128(_mm_add_epi32(t, t), _mm_and_si128(carry, poly));
+}
+
+AESNI_TARGET
+void aes_ni_xts_blocks(const unsigned char* rk_bytes, unsigned char* tweak, const unsigned char* in,
+                       unsigned char* out, size_t nblocks, int encrypt) {
+    __m128i rk[11];
+    load_round_keys(rk_bytes, rk);
+    __m128i t = _mm_loadu_si128((const __m128i*)tweak);
+
+    // Твики восьми блоков вычисляются в регистрах, пока предыдущая восьмерка в конвейере
+    while (nblocks >= AESNI_LANES) {
+        __m128i tw[AESNI_LANES], b[AESNI_LANES];
+        for (int j = 0; j < AESNI_LANES; j++) {
+            tw[j] = t;
+            t = xts_mul_alpha(t);
+            b[j] = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*)(in + j * 16)), tw[j]), rk[0]);
+        }
+        if (encrypt) {
+            for (int r = 1; r < 10; r++) {
+                for (int j = 0; j < AESNI_LANES; j++) {
+                    b[j] = _mm_aesenc_si128(b[j], rk[r]);
+                }
+            }
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+            }
+        } else {
+            for (int r = 1; r < 10; r++) {
+                for (int j = 0; j < AESNI_LANES; j++) {
+                    b[j] = _mm_aesdec_si128(b[j], rk[r]);
+                }
+            }
+            for (int j = 0; j < AESNI_LANES; j++) {
+                b[j] = _mm_aesdeclast_si128(b[j], rk[10]);
+            }
+        }
+        for (int j = 0; j < AESNI_LANES; j++) {
+            _mm_storeu_si128((__m128i*)(out + j * 16), _mm_xor_si128(b[j], tw[j]));
+        }
+        in += AESNI_LANES * 16;
+        out += AESNI_LANES * 16;
+        nblocks -= AESNI_LANES;
+    }
+
+    while (nblocks > 0) {
+        __m128i b = _mm_xor_si128(_mm_xor_si128(_mm_loadu_si128((const __m128i*)in), t), rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = encrypt ? _mm_aesenc_si128(b, rk[r]) : _mm_aesdec_si128(b, rk[r]);
+        }
+        b = encrypt ? _mm_aesenclast_si128(b, rk[10]) : _mm_aesdeclast_si128(b, rk[10]);
+        _mm_storeu_si128((__m128i*)out, _mm_xor_si128(b, t));
+        t = xts_mul_alpha(t);
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+
+    _mm_storeu_si128((__m128i*)tweak, t);
+}
+
+#else /* !CRYPTOCORE_HAVE_AESNI */
+
+int aes_ni_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_AESNI */
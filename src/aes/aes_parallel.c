@@ -0,0 +1,158 @@
+#include "../../include/aes_parallel.h"
+#include "../../include/modes.h"
+#include <string.h>
+
+/* Минимальный участок на поток (64 КБ): меньшие объемы не окупают синхронизацию */
+#define AES_PAR_MIN_BLOCKS 4096
+
+/* Верхняя граница числа участков за один вызов */
+#define AES_PAR_MAX_SLICES 256
+
+typedef enum {
+    PAR_ECB_ENCRYPT,
+    PAR_ECB_DECRYPT,
+    PAR_CBC_DECRYPT,
+    PAR_CFB_DECRYPT,
+    PAR_CTR
+} par_op_t;
+
+/**
+ * Участок буфера, обрабатываемый одним заданием
+ */
+typedef struct {
+    const unsigned char* in;
+    unsigned char* out;
+    size_t len;                             // Длина участка в байтах
+    unsigned char iv[AES_BLOCK_SIZE];       // Вектор сцепления / счетчик участка
+} par_slice_t;
+
+typedef struct {
+    par_op_t op;
+    const aes_core_key_t* ctx;
+    par_slice_t* slices;
+} par_job_t;
+
+static void run_slice(void* arg, size_t index) {
+    par_job_t* job = (par_job_t*)arg;
+    par_slice_t* s = &job->slices[index];
+    size_t nblocks = s->len / AES_BLOCK_SIZE;
+
+    switch (job->op) {
+    case PAR_ECB_ENCRYPT:
+        aes_core_encrypt_blocks(job->ctx, s->in, s->out, nblocks);
+        break;
+    case PAR_ECB_DECRYPT:
+        aes_core_decrypt_blocks(job->ctx, s->in, s->out, nblocks);
+        break;
+    case PAR_CBC_DECRYPT:
+        aes_core_cbc_decrypt(job->ctx, s->iv, s->in, s->out, nblocks);
+        break;
+    case PAR_CFB_DECRYPT:
+        aes_core_cfb_decrypt(job->ctx, s->iv, s->in, s->out, nblocks);
+        break;
+    case PAR_CTR:
+        aes_core_ctr_xor(job->ctx, s->iv, s->in, s->out, s->len);
+        break;
+    }
+}
+
+/**
+ * Число участков для nblocks блоков: по одному на поток, не меньше AES_PAR_MIN_BLOCKS каждый
+ */
+static size_t slice_count(thread_pool_t* pool, size_t nblocks) {
+    size_t n = (size_t)thread_pool_size(pool);
+    size_t by_size = nblocks / AES_PAR_MIN_BLOCKS;
+    if (n > by_size) n = by_size;
+    if (n > AES_PAR_MAX_SLICES) n = AES_PAR_MAX_SLICES;
+    return n;
+}
+
+/**
+ * Разбиение len байт на nslices участков, кратных блоку (кроме хвоста последнего участка)
+ * Вектор сцепления/счетчик участка заполняется до запуска: при работе на месте
+ * предыдущий участок перезапишет свой шифртекст
+ */
+static void split_and_run(thread_pool_t* pool, par_op_t op, const aes_core_key_t* ctx,
+                          const unsigned char* iv, const unsigned char* in, unsigned char* out,
+                          size_t len, size_t nslices) {
+    par_slice_t slices[AES_PAR_MAX_SLICES];
+    size_t total_blocks = len / AES_BLOCK_SIZE;
+    size_t per_slice = total_blocks / nslices;
+    size_t offset = 0;
+
+    for (size_t i = 0; i < nslices; i++) {
+        par_slice_t* s = &slices[i];
+        size_t blocks = (i + 1 < nslices) ? per_slice : total_blocks - per_slice * (nslices - 1);
+        s->in = in + offset;
+        s->out = out + offset;
+        s->len = (i + 1 < nslices) ? blocks * AES_BLOCK_SIZE : len - offset;
+
+        if (op == PAR_CTR) {
+            memcpy(s->iv, iv, AES_BLOCK_SIZE);
+            increment_counter_be(s->iv, (unsigned long long)(offset / AES_BLOCK_SIZE));
+        } else if (op == PAR_CBC_DECRYPT || op == PAR_CFB_DECRYPT) {
+            memcpy(s->iv, (i == 0) ? iv : in + offset - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+        }
+        offset += s->len;
+    }
+
+    par_job_t job = { op, ctx, slices };
+    thread_pool_run(pool, run_slice, &job, nslices);
+}
+
+void aes_par_encrypt_blocks(thread_pool_t* pool, const aes_core_key_t* ctx, const unsigned char* in,
+                            unsigned char* out, size_t nblocks) {
+    size_t nslices = slice_count(pool, nblocks);
+    if (nslices <= 1) {
+        aes_core_encrypt_blocks(ctx, in, out, nblocks);
+        return;
+    }
+    split_and_run(pool, PAR_ECB_ENCRYPT, ctx, NULL, in, out, nblocks * AES_BLOCK_SIZE, nslices);
+}
+
+void aes_par_decrypt_blocks(thread_pool_t* pool, const aes_core_key_t* ctx, const unsigned char* in,
+                            unsigned char* out, size_t nblocks) {
+    size_t nslices = slice_count(pool, nblocks);
+    if (nslices <= 1) {
+        aes_core_decrypt_blocks(ctx, in, out, nblocks);
+        return;
+    }
+    split_and_run(pool, PAR_ECB_DECRYPT, ctx, NULL, in, out, nblocks * AES_BLOCK_SIZE, nslices);
+}
+
+void aes_par_cbc_decrypt(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* iv,
+                         const unsigned char* in, unsigned char* out, size_t nblocks) {
+    size_t nslices = slice_count(pool, nblocks);
+    if (nslices <= 1) {
+        aes_core_cbc_decrypt(ctx, iv, in, out, nblocks);
+        return;
+    }
+    unsigned char next_iv[AES_BLOCK_SIZE];
+    memcpy(next_iv, in + (nblocks - 1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    split_and_run(pool, PAR_CBC_DECRYPT, ctx, iv, in, out, nblocks * AES_BLOCK_SIZE, nslices);
+    memcpy(iv, next_iv, AES_BLOCK_SIZE);
+}
+
+void aes_par_cfb_decrypt(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* iv,
+                         const unsigned char* in, unsigned char* out, size_t nblocks) {
+    size_t nslices = slice_count(pool, nblocks);
+    if (nslices <= 1) {
+        aes_core_cfb_decrypt(ctx, iv, in, out, nblocks);
+        return;
+    }
+    unsigned char next_iv[AES_BLOCK_SIZE];
+    memcpy(next_iv, in + (nblocks - 1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE);
+    split_and_run(pool, PAR_CFB_DECRYPT, ctx, iv, in, out, nblocks * AES_BLOCK_SIZE, nslices);
+    memcpy(iv, next_iv, AES_BLOCK_SIZE);
+}
+
+void aes_par_ctr_xor(thread_pool_t* pool, const aes_core_key_t* ctx, unsigned char* counter,
+                     const unsigned char* in, unsigned char* out, size_t len) {
+    size_t nslices = slice_count(pool, len / AES_BLOCK_SIZE);
+    if (nslices <= 1) {
+        aes_core_ctr_xor(ctx, counter, in, out, len);
+        return;
+    }
+    split_and_run(pool, PAR_CTR, ctx, counter, in, out, len, nslices);
+    increment_counter_be(counter, (unsigned long long)((len + AES_BLOCK_SIZE - 1) / AES_BLOCK_SIZE));
+}
@@ -0,0 +1,281 @@
+#include "../../include/aes_vaes.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_AESNI
+
+#include <stdint.h>
+#include <immintrin.h>
+
+#define VAES_TARGET __attribute__((target("aes,avx512f,vaes")))
+
+/* Блоков за итерацию: 4 регистра по 4 блока */
+#define VAES_REGS 4
+#define VAES_BLOCKS (VAES_REGS * 4)
+
+int aes_vaes_available(void) {
+    const cpu_features_t* f = cpu_features_get();
+    return f->vaes && f->avx512f && f->aesni;
+}
+
+/**
+ * Раундовые ключи, размноженные во все четыре 128-битные дорожки
+ */
+static inline VAES_TARGET void broadcast_round_keys(const unsigned char* rk_bytes, __m512i* rk) {
+    for (int i = 0; i < 11; i++) {
+        rk[i] = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)(rk_bytes + i * 16)));
+    }
+}
+
+static inline VAES_TARGET void encrypt_regs(__m512i* b, const __m512i* rk) {
+    for (int j = 0; j < VAES_REGS; j++) {
+        b[j] = _mm512_xor_si512(b[j], rk[0]);
+    }
+    for (int r = 1; r < 10; r++) {
+        for (int j = 0; j < VAES_REGS; j++) {
+            b[j] = _mm512_aesenc_epi128(b[j], rk[r]);
+        }
+    }
+    for (int j = 0; j < VAES_REGS; j++) {
+        b[j] = _mm512_aesenclast_epi128(b[j], rk[10]);
+    }
+}
+
+static inline VAES_TARGET void decrypt_regs(__m512i* b, const __m512i* rk) {
+    for (int j = 0; j < VAES_REGS; j++) {
+        b[j] = _mm512_xor_si512(b[j], rk[0]);
+    }
+    for (int r = 1; r < 10; r++) {
+        for (int j = 0; j < VAES_REGS; j++) {
+            b[j] = _mm512_aesdec_epi128(b[j], rk[r]);
+        }
+    }
+    for (int j = 0; j < VAES_REGS; j++) {
+        b[j] = _mm512_aesdeclast_epi128(b[j], rk[10]);
+    }
+}
+
+/**
+ * Предыдущие блоки шифртекста для CBC/CFB: (prev_last, c0, c1, c2) из регистров prev и cur
+ * Все значения берутся из регистров, поэтому out может совпадать с in
+ */
+static inline VAES_TARGET void chain_regs(__m512i iv, const __m512i* c, __m512i* prev) {
+    prev[0] = _mm512_alignr_epi32(c[0], iv, 12);
+    for (int j = 1; j < VAES_REGS; j++) {
+        prev[j] = _mm512_alignr_epi32(c[j], c[j - 1], 12);
+    }
+}
+
+VAES_TARGET
+void aes_vaes_ecb_encrypt(const unsigned char* enc_rk, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    __m512i rk[11];
+    broadcast_round_keys(enc_rk, rk);
+
+    while (nblocks >= VAES_BLOCKS) {
+        __m512i b[VAES_REGS];
+        for (int j = 0; j < VAES_REGS; j++) {
+            b[j] = _mm512_loadu_si512((const void*)(in + j * 64));
+        }
+        encrypt_regs(b, rk);
+        for (int j = 0; j < VAES_REGS; j++) {
+            _mm512_storeu_si512((void*)(out + j * 64), b[j]);
+        }
+        in += VAES_BLOCKS * 16;
+        out += VAES_BLOCKS * 16;
+        nblocks -= VAES_BLOCKS;
+    }
+
+    aes_ni_ecb_encrypt(enc_rk, in, out, nblocks);
+}
+
+VAES_TARGET
+void aes_vaes_ecb_decrypt(const unsigned char* dec_rk, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    __m512i rk[11];
+    broadcast_round_keys(dec_rk, rk);
+
+    while (nblocks >= VAES_BLOCKS) {
+        __m512i b[VAES_REGS];
+        for (int j = 0; j < VAES_REGS; j++) {
+            b[j] = _mm512_loadu_si512((const void*)(in + j * 64));
+        }
+        decrypt_regs(b, rk);
+        for (int j = 0; j < VAES_REGS; j++) {
+            _mm512_storeu_si512((void*)(out + j * 64), b[j]);
+        }
+        in += VAES_BLOCKS * 16;
+        out += VAES_BLOCKS * 16;
+        nblocks -= VAES_BLOCKS;
+    }
+
+    aes_ni_ecb_decrypt(dec_rk, in, out, nblocks);
+}
+
+VAES_TARGET
+void aes_vaes_cbc_decrypt(const unsigned char* dec_rk, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    __m512i rk[11];
+    broadcast_round_keys(dec_rk, rk);
+
+    // Вектор сцепления в старшей дорожке: alignr сдвигает его на место блока 0
+    __m512i chain = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)iv));
+
+    while (nblocks >= VAES_BLOCKS) {
+        __m512i c[VAES_REGS], b[VAES_REGS], prev[VAES_REGS];
+        for (int j = 0; j < VAES_REGS; j++) {
+            c[j] = _mm512_loadu_si512((const void*)(in + j * 64));
+            b[j] = c[j];
+        }
+        chain_regs(chain, c, prev);
+        decrypt_regs(b, rk);
+        for (int j = 0; j < VAES_REGS; j++) {
+            _mm512_storeu_si512((void*)(out + j * 64), _mm512_xor_si512(b[j], prev[j]));
+        }
+        chain = c[VAES_REGS - 1];
+        in += VAES_BLOCKS * 16;
+        out += VAES_BLOCKS * 16;
+        nblocks -= VAES_BLOCKS;
+    }
+
+    _mm_storeu_si128((__m128i*)iv, _mm512_extracti32x4_epi32(chain, 3));
+    aes_ni_cbc_decrypt(dec_rk, iv, in, out, nblocks);
+}
+
+VAES_TARGET
+void aes_vaes_cfb_decrypt(const unsigned char* enc_rk, unsigned char* iv, const unsigned char* in,
+                          unsigned char* out, size_t nblocks) {
+    __m512i rk[11];
+    broadcast_round_keys(enc_rk, rk);
+
+    __m512i chain = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)iv));
+
+    while (nblocks >= VAES_BLOCKS) {
+        __m512i c[VAES_REGS], ks[VAES_REGS];
+        for (int j = 0; j < VAES_REGS; j++) {
+            c[j] = _mm512_loadu_si512((const void*)(in + j * 64));
+        }
+        // Поток ключа = E(IV || C[0..14])
+        chain_regs(chain, c, ks);
+        encrypt_regs(ks, rk);
+        for (int j = 0; j < VAES_REGS; j++) {
+            _mm512_storeu_si512((void*)(out + j * 64), _mm512_xor_si512(ks[j], c[j]));
+        }
+        chain = c[VAES_REGS - 1];
+        in += VAES_BLOCKS * 16;
+        out += VAES_BLOCKS * 16;
+        nblocks -= VAES_BLOCKS;
+    }
+
+    _mm_storeu_si128((__m128i*)iv, _mm512_extracti32x4_epi32(chain, 3));
+    aes_ni_cfb_decrypt(enc_rk, iv, in, out, nblocks);
+}
+
+static inline uint64_t load_be64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void store_be64(unsigned char* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+VAES_TARGET
+void aes_vaes_ctr_xor(const unsigned char* enc_rk, unsigned char* counter, const unsigned char* in,
+                      unsigned char* out, size_t len) {
+    __m512i rk[11];
+    broadcast_round_keys(enc_rk, rk);
+
+    uint64_t hi = load_be64(counter);
+    uint64_t lo = load_be64(counter + 8);
+
+    // Основной цикл только без переноса в старшие 64 бита; остальное делают ядра AES-NI
+    while (len >= VAES_BLOCKS * 16 && lo <= UINT64_MAX - VAES_BLOCKS) {
+        long long hs = (long long)__builtin_bswap64(hi);
+        __m512i b[VAES_REGS];
+        for (int j = 0; j < VAES_REGS; j++) {
+            uint64_t base = lo + (uint64_t)(j * 4);
+            b[j] = _mm512_set_epi64((long long)__builtin_bswap64(base + 3), hs,
+                                    (long long)__builtin_bswap64(base + 2), hs,
+                                    (long long)__builtin_bswap64(base + 1), hs,
+                                    (long long)__builtin_bswap64(base), hs);
+        }
+        lo += VAES_BLOCKS;
+        encrypt_regs(b, rk);
+        for (int j = 0; j < VAES_REGS; j++) {
+            __m512i d = _mm512_loadu_si512((const void*)(in + j * 64));
+            _mm512_storeu_si512((void*)(out + j * 64), _mm512_xor_si512(b[j], d));
+        }
+        in += VAES_BLOCKS * 16;
+        out += VAES_BLOCKS * 16;
+        len -= VAES_BLOCKS * 16;
+    }
+
+    store_be64(counter, hi);
+    store_be64(counter + 8, lo);
+    aes_ni_ctr_xor(enc_rk, counter, in, out, len);
+}
+
+/**
+ * Умножение на x^k (k < 8) твиков XTS во всех четырех дорожках: 32-битные слова сдвигаются
+ * на k, старшие биты переносятся в следующее слово; выдвинутые из дорожки биты c
+ * возвращаются в младшее слово как c * (x^7 + x^2 + x + 1) без переносов
+ */
+static inline VAES_TARGET __m512i xts_mul_xk(__m512i t, int k) {
+    const __m512i low_word = _mm512_set4_epi32(0, 0, 0, -1);
+    __m512i carry = _mm512_shuffle_epi32(_mm512_srli_epi32(t, 32 - k), (_MM_PERM_ENUM)0x93);
+    __m512i c = _mm512_and_si512(carry, low_word);
+    __m512i red = _mm512_xor_si512(_mm512_xor_si512(c, _mm512_slli_epi32(c, 1)),
+                                   _mm512_xor_si512(_mm512_slli_epi32(c, 2), _mm512_slli_epi32(c, 7)));
+    return _mm512_xor_si512(_mm512_xor_si512(_mm512_slli_epi32(t, k), _mm512_andnot_si512(low_word, carry)), red);
+}
+
+VAES_TARGET
+void aes_vaes_xts_blocks(const unsigned char* rk_bytes, unsigned char* tweak, const unsigned char* in,
+                         unsigned char* out, size_t nblocks, int encrypt) {
+    __m512i rk[11];
+    broadcast_round_keys(rk_bytes, rk);
+
+    if (nblocks >= VAES_BLOCKS) {
+        // Дорожки регистра - твики четырех соседних блоков: T, T*x, T*x^2, T*x^3
+        __m512i t = _mm512_broadcast_i32x4(_mm_loadu_si128((const __m128i*)tweak));
+        __m512i t1 = xts_mul_xk(t, 1), t2 = xts_mul_xk(t, 2), t3 = xts_mul_xk(t, 3);
+        t = _mm512_mask_blend_epi64(0xC0, _mm512_mask_blend_epi64(0x30, _mm512_mask_blend_epi64(0x0C, t, t1), t2), t3);
+
+        while (nblocks >= VAES_BLOCKS) {
+            __m512i tw[VAES_REGS], b[VAES_REGS];
+            for (int j = 0; j < VAES_REGS; j++) {
+                tw[j] = t;
+                t = xts_mul_xk(t, 4);
+                b[j] = _mm512_xor_si512(_mm512_loadu_si512((const void*)(in + j * 64)), tw[j]);
+            }
+            if (encrypt) {
+                encrypt_regs(b, rk);
+            } else {
+                decrypt_regs(b, rk);
+            }
+            for (int j = 0; j < VAES_REGS; j++) {
+                _mm512_storeu_si512((void*)(out + j * 64), _mm512_xor_si512(b[j], tw[j]));
+            }
+            in += VAES_BLOCKS * 16;
+            out += VAES_BLOCKS * 16;
+            nblocks -= VAES_BLOCKS;
+        }
+        _mm_storeu_si128((__m128i*)tweak, _mm512_castsi512_si128(t));
+    }
+
+    aes_ni_xts_blocks(rk_bytes, tweak, in, out, nblocks, encrypt);
+}
+
+#else /* !CRYPTOCORE_HAVE_AESNI */
+
+int aes_vaes_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_AESNI */
@@ -0,0 +1,231 @@
+#include "../../include/ghash_clmul.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_AESNI
+
+#include <stdint.h>
+#include <wmmintrin.h>
+#include <emmintrin.h>
+#include <tmmintrin.h>
+
+#define CLMUL_TARGET __attribute__((target("pclmul,sse2,ssse3")))
+#define GCM_TARGET __attribute__((target("aes,pclmul,sse2,ssse3")))
+
+/* Блоков счетчика в конвейере AES совмещенного прохода */
+#define GCM_LANES GHASH_CLMUL_POWERS
+
+int ghash_clmul_available(void) {
+    const cpu_features_t* f = cpu_features_get();
+    return f->pclmul && f->ssse3;
+}
+
+/**
+ * Разворот порядка байтов: GHASH работает с битами в обратном порядке
+ */
+static inline CLMUL_TARGET __m128i bswap128(__m128i x) {
+    const __m128i mask = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    return _mm_shuffle_epi8(x, mask);
+}
+
+/**
+ * Накопление 256-битного произведения a*b без редукции: четыре PCLMULQDQ,
+ * средние члены складываются в mid
+ */
+static inline CLMUL_TARGET void clmul_acc(__m128i a, __m128i b, __m128i* lo, __m128i* mid, __m128i* hi) {
+    *lo = _mm_xor_si128(*lo, _mm_clmulepi64_si128(a, b, 0x00));
+    *hi = _mm_xor_si128(*hi, _mm_clmulepi64_si128(a, b, 0x11));
+    *mid = _mm_xor_si128(*mid, _mm_xor_si128(_mm_clmulepi64_si128(a, b, 0x10),
+                                             _mm_clmulepi64_si128(a, b, 0x01)));
+}
+
+/**
+ * Редукция накопленного произведения по модулю x^128 + x^7 + x^2 + x + 1
+ * (сдвиг на бит из-за отраженного представления, затем две фазы редукции)
+ */
+static inline CLMUL_TARGET __m128i reduce(__m128i lo, __m128i mid, __m128i hi) {
+    lo = _mm_xor_si128(lo, _mm_slli_si128(mid, 8));
+    hi = _mm_xor_si128(hi, _mm_srli_si128(mid, 8));
+
+    __m128i t7 = _mm_srli_epi32(lo, 31);
+    __m128i t8 = _mm_srli_epi32(hi, 31);
+    lo = _mm_slli_epi32(lo, 1);
+    hi = _mm_slli_epi32(hi, 1);
+    __m128i t9 = _mm_srli_si128(t7, 12);
+    t8 = _mm_slli_si128(t8, 4);
+    t7 = _mm_slli_si128(t7, 4);
+    lo = _mm_or_si128(lo, t7);
+    hi = _mm_or_si128(_mm_or_si128(hi, t8), t9);
+
+    t7 = _mm_xor_si128(_mm_xor_si128(_mm_slli_epi32(lo, 31), _mm_slli_epi32(lo, 30)), _mm_slli_epi32(lo, 25));
+    t8 = _mm_srli_si128(t7, 4);
+    t7 = _mm_slli_si128(t7, 12);
+    lo = _mm_xor_si128(lo, t7);
+
+    __m128i t2 = _mm_xor_si128(_mm_xor_si128(_mm_srli_epi32(lo, 1), _mm_srli_epi32(lo, 2)), _mm_srli_epi32(lo, 7));
+    t2 = _mm_xor_si128(t2, t8);
+    lo = _mm_xor_si128(lo, t2);
+    return _mm_xor_si128(hi, lo);
+}
+
+static inline CLMUL_TARGET __m128i gfmul(__m128i a, __m128i b) {
+    __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    clmul_acc(a, b, &lo, &mid, &hi);
+    return reduce(lo, mid, hi);
+}
+
+static inline CLMUL_TARGET void load_powers(const unsigned char* hpow, __m128i* h) {
+    for (int i = 0; i < GHASH_CLMUL_POWERS; i++) {
+        h[i] = _mm_loadu_si128((const __m128i*)(hpow + i * 16));
+    }
+}
+
+/**
+ * Восемь блоков (уже в отраженном порядке) за одну редукцию: X1*H^8 ^ X2*H^7 ^ ... ^ X8*H
+ */
+static inline CLMUL_TARGET __m128i ghash_lanes(__m128i y, const __m128i* x, const __m128i* h) {
+    __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+    clmul_acc(_mm_xor_si128(x[0], y), h[GHASH_CLMUL_POWERS - 1], &lo, &mid, &hi);
+    for (int j = 1; j < GHASH_CLMUL_POWERS; j++) {
+        clmul_acc(x[j], h[GHASH_CLMUL_POWERS - 1 - j], &lo, &mid, &hi);
+    }
+    return reduce(lo, mid, hi);
+}
+
+CLMUL_TARGET
+void ghash_clmul_init(const unsigned char* h, unsigned char* hpow) {
+    __m128i h1 = bswap128(_mm_loadu_si128((const __m128i*)h));
+    __m128i p = h1;
+    for (int i = 0; i < GHASH_CLMUL_POWERS; i++) {
+        _mm_storeu_si128((__m128i*)(hpow + i * 16), p);
+        p = gfmul(p, h1);
+    }
+}
+
+CLMUL_TARGET
+void ghash_clmul_blocks(const unsigned char* hpow, unsigned char* y, const unsigned char* in, size_t nblocks) {
+    __m128i h[GHASH_CLMUL_POWERS];
+    load_powers(hpow, h);
+    __m128i acc = bswap128(_mm_loadu_si128((const __m128i*)y));
+
+    while (nblocks >= GHASH_CLMUL_POWERS) {
+        __m128i x[GHASH_CLMUL_POWERS];
+        for (int j = 0; j < GHASH_CLMUL_POWERS; j++) {
+            x[j] = bswap128(_mm_loadu_si128((const __m128i*)(in + j * 16)));
+        }
+        acc = ghash_lanes(acc, x, h);
+        in += GHASH_CLMUL_POWERS * 16;
+        nblocks -= GHASH_CLMUL_POWERS;
+    }
+    while (nblocks > 0) {
+        acc = gfmul(_mm_xor_si128(acc, bswap128(_mm_loadu_si128((const __m128i*)in))), h[0]);
+        in += 16;
+        nblocks--;
+    }
+
+    _mm_storeu_si128((__m128i*)y, bswap128(acc));
+}
+
+/**
+ * Блок счетчика GCM: первые 12 байт неизменны, последние 4 - big-endian ctr32
+ */
+static inline GCM_TARGET __m128i gcm_counter_block(__m128i prefix, uint32_t ctr32) {
+    return _mm_or_si128(prefix, _mm_set_epi32((int)__builtin_bswap32(ctr32), 0, 0, 0));
+}
+
+GCM_TARGET
+void aes_ni_gcm_ctr_ghash(const unsigned char* enc_rk, const unsigned char* hpow, unsigned char* counter,
+                          unsigned char* y, const unsigned char* in, unsigned char* out,
+                          size_t nblocks, int encrypt) {
+    __m128i rk[11];
+    for (int i = 0; i < 11; i++) {
+        rk[i] = _mm_loadu_si128((const __m128i*)(enc_rk + i * 16));
+    }
+    __m128i h[GHASH_CLMUL_POWERS];
+    load_powers(hpow, h);
+    __m128i acc = bswap128(_mm_loadu_si128((const __m128i*)y));
+
+    const __m128i prefix_mask = _mm_set_epi32(0, -1, -1, -1);
+    __m128i prefix = _mm_and_si128(_mm_loadu_si128((const __m128i*)counter), prefix_mask);
+    uint32_t ctr32 = ((uint32_t)counter[12] << 24) | ((uint32_t)counter[13] << 16) |
+                     ((uint32_t)counter[14] << 8) | (uint32_t)counter[15];
+
+    // Блоки, ожидающие GHASH: шифртекст прошлой восьмерки (шифрование) или вход текущей (дешифрование)
+    __m128i pend[GCM_LANES];
+    int pending = 0;
+
+    while (nblocks >= GCM_LANES) {
+        __m128i b[GCM_LANES];
+        for (int j = 0; j < GCM_LANES; j++) {
+            b[j] = _mm_xor_si128(gcm_counter_block(prefix, ctr32 + (uint32_t)j), rk[0]);
+        }
+        ctr32 += GCM_LANES;
+        if (!encrypt) {
+            for (int j = 0; j < GCM_LANES; j++) {
+                pend[j] = bswap128(_mm_loadu_si128((const __m128i*)(in + j * 16)));
+            }
+            pending = 1;
+        }
+
+        // Раунды AES и умножения GHASH независимы и выполняются вперемешку
+        __m128i lo = _mm_setzero_si128(), mid = _mm_setzero_si128(), hi = _mm_setzero_si128();
+        for (int r = 1; r < 10; r++) {
+            for (int j = 0; j < GCM_LANES; j++) {
+                b[j] = _mm_aesenc_si128(b[j], rk[r]);
+            }
+            if (pending && r <= GCM_LANES) {
+                __m128i x = (r == 1) ? _mm_xor_si128(pend[0], acc) : pend[r - 1];
+                clmul_acc(x, h[GCM_LANES - r], &lo, &mid, &hi);
+            }
+        }
+        if (pending) {
+            acc = reduce(lo, mid, hi);
+        }
+
+        for (int j = 0; j < GCM_LANES; j++) {
+            b[j] = _mm_aesenclast_si128(b[j], rk[10]);
+            __m128i c = _mm_xor_si128(b[j], _mm_loadu_si128((const __m128i*)(in + j * 16)));
+            _mm_storeu_si128((__m128i*)(out + j * 16), c);
+            if (encrypt) {
+                pend[j] = bswap128(c);
+            }
+        }
+        pending = encrypt;
+        in += GCM_LANES * 16;
+        out += GCM_LANES * 16;
+        nblocks -= GCM_LANES;
+    }
+
+    // Шифртекст последней восьмерки еще не хеширован
+    if (pending) {
+        acc = ghash_lanes(acc, pend, h);
+    }
+
+    while (nblocks > 0) {
+        __m128i b = _mm_xor_si128(gcm_counter_block(prefix, ctr32++), rk[0]);
+        for (int r = 1; r < 10; r++) {
+            b = _mm_aesenc_si128(b, rk[r]);
+        }
+        b = _mm_aesenclast_si128(b, rk[10]);
+        __m128i d = _mm_loadu_si128((const __m128i*)in);
+        __m128i c = _mm_xor_si128(b, d);
+        _mm_storeu_si128((__m128i*)out, c);
+        acc = gfmul(_mm_xor_si128(acc, bswap128(encrypt ? c : d)), h[0]);
+        in += 16;
+        out += 16;
+        nblocks--;
+    }
+
+    _mm_storeu_si128((__m128i*)y, bswap128(acc));
+    counter[12] = (unsigned char)(ctr32 >> 24);
+    counter[13] = (unsigned char)(ctr32 >> 16);
+    counter[14] = (unsigned char)(ctr32 >> 8);
+    counter[15] = (unsigned char)ctr32;
+}
+
+#else /* !CRYPTOCORE_HAVE_AESNI */
+
+int ghash_clmul_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_AESNI */
@@ -0,0 +1,147 @@
+#include "../../include/chacha20.h"
+#include "../../include/chacha20_simd.h"
+#include "../../include/xor.h"
+#include <string.h>
+
+typedef void (*chacha20_blocks_fn_t)(uint32_t*, const unsigned char*, unsigned char*, size_t);
+
+static uint32_t load_le32(const unsigned char* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+    p[2] = (unsigned char)(v >> 16);
+    p[3] = (unsigned char)(v >> 24);
+}
+
+#define ROTL32(x, n) (((x) << (n)) | ((x) >> (32 - (n))))
+
+#define QR(a, b, c, d)                              \
+    do {                                            \
+        a += b; d ^= a; d = ROTL32(d, 16);          \
+        c += d; b ^= c; b = ROTL32(b, 12);          \
+        a += b; d ^= a; d = ROTL32(d, 8);           \
+        c += d; b ^= c; b = ROTL32(b, 7);           \
+    } while (0)
+
+void chacha20_block(const uint32_t* state, unsigned char* out) {
+    uint32_t x[16];
+    memcpy(x, state, sizeof(x));
+    for (int round = 0; round < 10; round++) {
+        // Столбцы, затем диагонали
+        QR(x[0], x[4], x[8], x[12]);
+        QR(x[1], x[5], x[9], x[13]);
+        QR(x[2], x[6], x[10], x[14]);
+        QR(x[3], x[7], x[11], x[15]);
+        QR(x[0], x[5], x[10], x[15]);
+        QR(x[1], x[6], x[11], x[12]);
+        QR(x[2], x[7], x[8], x[13]);
+        QR(x[3], x[4], x[9], x[14]);
+    }
+    for (int i = 0; i < 16; i++) {
+        store_le32(out + 4 * i, x[i] + state[i]);
+    }
+}
+
+/**
+ * Переносимый путь: блок потока ключа, затем XOR словами
+ */
+static void xor_blocks_portable(uint32_t* state, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    unsigned char ks[CHACHA20_BLOCK_SIZE];
+    for (size_t i = 0; i < nblocks; i++) {
+        chacha20_block(state, ks);
+        xor_bytes(out, in, ks, CHACHA20_BLOCK_SIZE);
+        state[12]++;
+        in += CHACHA20_BLOCK_SIZE;
+        out += CHACHA20_BLOCK_SIZE;
+    }
+}
+
+typedef struct {
+    chacha20_blocks_fn_t fn;
+    size_t width;                       // Блоков за вызов ядра
+    const char* name;
+} chacha20_impl_t;
+
+static const chacha20_impl_t impl_portable = { xor_blocks_portable, 1, "portable" };
+#ifdef CRYPTOCORE_HAVE_CHACHA_SIMD
+static const chacha20_impl_t impl_sse2 = { chacha20_sse2_xor_blocks, CHACHA20_SSE2_BLOCKS, "sse2" };
+static const chacha20_impl_t impl_avx2 = { chacha20_avx2_xor_blocks, CHACHA20_AVX2_BLOCKS, "avx2" };
+#endif
+
+/* Выбор один раз; указатель читается и публикуется атомарно */
+static const chacha20_impl_t* active_impl = NULL;
+
+static const chacha20_impl_t* get_impl(void) {
+    const chacha20_impl_t* impl = __atomic_load_n(&active_impl, __ATOMIC_ACQUIRE);
+    if (impl) {
+        return impl;
+    }
+    impl = &impl_portable;
+#ifdef CRYPTOCORE_HAVE_CHACHA_SIMD
+    if (chacha20_avx2_available()) {
+        impl = &impl_avx2;
+    } else if (chacha20_sse2_available()) {
+        impl = &impl_sse2;
+    }
+#endif
+    __atomic_store_n(&active_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+const char* chacha20_impl_name(void) {
+    return get_impl()->name;
+}
+
+void chacha20_init(chacha20_ctx_t* ctx, const unsigned char* key, const unsigned char* nonce, uint32_t counter) {
+    // "expand 32-byte k"
+    ctx->state[0] = 0x61707865;
+    ctx->state[1] = 0x3320646e;
+    ctx->state[2] = 0x79622d32;
+    ctx->state[3] = 0x6b206574;
+    for (int i = 0; i < 8; i++) {
+        ctx->state[4 + i] = load_le32(key + 4 * i);
+    }
+    ctx->state[12] = counter;
+    for (int i = 0; i < 3; i++) {
+        ctx->state[13 + i] = load_le32(nonce + 4 * i);
+    }
+    ctx->ks_used = CHACHA20_BLOCK_SIZE;
+}
+
+void chacha20_xor(chacha20_ctx_t* ctx, const unsigned char* in, unsigned char* out, size_t len) {
+    // Остаток потока ключа предыдущего вызова
+    if (ctx->ks_used < CHACHA20_BLOCK_SIZE && len > 0) {
+        size_t take = CHACHA20_BLOCK_SIZE - ctx->ks_used;
+        if (take > len) {
+            take = len;
+        }
+        xor_bytes(out, in, ctx->ks + ctx->ks_used, take);
+        ctx->ks_used += take;
+        in += take;
+        out += take;
+        len -= take;
+    }
+
+    // Полные группы блоков - векторное ядро, оставшиеся полные блоки - по одному
+    const chacha20_impl_t* impl = get_impl();
+    size_t nblocks = len / CHACHA20_BLOCK_SIZE;
+    size_t bulk = nblocks - nblocks % impl->width;
+    if (bulk > 0) {
+        impl->fn(ctx->state, in, out, bulk);
+    }
+    xor_blocks_portable(ctx->state, in + bulk * CHACHA20_BLOCK_SIZE, out + bulk * CHACHA20_BLOCK_SIZE, nblocks - bulk);
+    in += nblocks * CHACHA20_BLOCK_SIZE;
+    out += nblocks * CHACHA20_BLOCK_SIZE;
+    len -= nblocks * CHACHA20_BLOCK_SIZE;
+
+    // Хвост: поток ключа следующего блока сохраняется для следующего вызова
+    if (len > 0) {
+        chacha20_block(ctx->state, ctx->ks);
+        ctx->state[12]++;
+        xor_bytes(out, in, ctx->ks, len);
+        ctx->ks_used = len;
+    }
+}
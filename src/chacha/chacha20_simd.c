@@ -0,0 +1,190 @@
+#include "../../include/chacha20_simd.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_CHACHA_SIMD
+
+#include <immintrin.h>
+
+#define SSE2_TARGET __attribute__((target("sse2")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+int chacha20_sse2_available(void) {
+    return cpu_features_get()->sse2;
+}
+
+int chacha20_avx2_available(void) {
+    return cpu_features_get()->avx2;
+}
+
+/* ---------------- SSE2: 4 блока ---------------- */
+
+/* Сдвиги SSE2 принимают только константы */
+#define ROTL128(x, n) _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - (n)))
+
+#define QR128(a, b, c, d)                                                   \
+    do {                                                                    \
+        a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL128(d, 16); \
+        c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL128(b, 12); \
+        a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL128(d, 8);  \
+        c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL128(b, 7);  \
+    } while (0)
+
+/**
+ * Транспонирование 4x4 слов: на входе слова 4g..4g+3 по дорожкам-блокам,
+ * на выходе по 16 байт блоков 0..3, которые XOR-ятся с входом
+ */
+static inline SSE2_TARGET void store4_sse2(__m128i a0, __m128i a1, __m128i a2, __m128i a3,
+                                           const unsigned char* in, unsigned char* out) {
+    __m128i t0 = _mm_unpacklo_epi32(a0, a1);
+    __m128i t1 = _mm_unpacklo_epi32(a2, a3);
+    __m128i t2 = _mm_unpackhi_epi32(a0, a1);
+    __m128i t3 = _mm_unpackhi_epi32(a2, a3);
+    __m128i r[4];
+    r[0] = _mm_unpacklo_epi64(t0, t1);
+    r[1] = _mm_unpackhi_epi64(t0, t1);
+    r[2] = _mm_unpacklo_epi64(t2, t3);
+    r[3] = _mm_unpackhi_epi64(t2, t3);
+    for (int j = 0; j < 4; j++) {
+        __m128i m = _mm_loadu_si128((const __m128i*)(in + j * 64));
+        _mm_storeu_si128((__m128i*)(out + j * 64), _mm_xor_si128(m, r[j]));
+    }
+}
+
+SSE2_TARGET
+void chacha20_sse2_xor_blocks(uint32_t* state, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    const __m128i lane_ctr = _mm_setr_epi32(0, 1, 2, 3);
+    for (; nblocks >= CHACHA20_SSE2_BLOCKS; nblocks -= CHACHA20_SSE2_BLOCKS) {
+        __m128i s[16], x[16];
+        for (int i = 0; i < 16; i++) {
+            s[i] = _mm_set1_epi32((int)state[i]);
+        }
+        s[12] = _mm_add_epi32(s[12], lane_ctr);
+        for (int i = 0; i < 16; i++) {
+            x[i] = s[i];
+        }
+
+        for (int round = 0; round < 10; round++) {
+            QR128(x[0], x[4], x[8], x[12]);
+            QR128(x[1], x[5], x[9], x[13]);
+            QR128(x[2], x[6], x[10], x[14]);
+            QR128(x[3], x[7], x[11], x[15]);
+            QR128(x[0], x[5], x[10], x[15]);
+            QR128(x[1], x[6], x[11], x[12]);
+            QR128(x[2], x[7], x[8], x[13]);
+            QR128(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] = _mm_add_epi32(x[i], s[i]);
+        }
+
+        for (int g = 0; g < 4; g++) {
+            store4_sse2(x[4 * g], x[4 * g + 1], x[4 * g + 2], x[4 * g + 3], in + 16 * g, out + 16 * g);
+        }
+        state[12] += CHACHA20_SSE2_BLOCKS;
+        in += CHACHA20_SSE2_BLOCKS * 64;
+        out += CHACHA20_SSE2_BLOCKS * 64;
+    }
+}
+
+/* ---------------- AVX2: 8 блоков ---------------- */
+
+static inline AVX2_TARGET __m256i rotl256_16(__m256i x) {
+    const __m256i shuf = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                          2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    return _mm256_shuffle_epi8(x, shuf);
+}
+
+static inline AVX2_TARGET __m256i rotl256_8(__m256i x) {
+    const __m256i shuf = _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                          3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14);
+    return _mm256_shuffle_epi8(x, shuf);
+}
+
+#define ROTL256(x, n) _mm256_or_si256(_mm256_slli_epi32(x, n), _mm256_srli_epi32(x, 32 - (n)))
+
+/* Повороты на 16 и 8 - перестановка байт (одна инструкция вместо трех) */
+#define QR256(a, b, c, d)                                                                  \
+    do {                                                                                   \
+        a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = rotl256_16(d);         \
+        c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = ROTL256(b, 12);        \
+        a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); d = rotl256_8(d);          \
+        c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); b = ROTL256(b, 7);         \
+    } while (0)
+
+/**
+ * Транспонирование 4x4 внутри каждой 128-битной половины:
+ * r[j] = (слова 4g..4g+3 блока j | те же слова блока 4+j)
+ */
+static inline AVX2_TARGET void transpose4_avx2(__m256i a0, __m256i a1, __m256i a2, __m256i a3, __m256i* r) {
+    __m256i t0 = _mm256_unpacklo_epi32(a0, a1);
+    __m256i t1 = _mm256_unpacklo_epi32(a2, a3);
+    __m256i t2 = _mm256_unpackhi_epi32(a0, a1);
+    __m256i t3 = _mm256_unpackhi_epi32(a2, a3);
+    r[0] = _mm256_unpacklo_epi64(t0, t1);
+    r[1] = _mm256_unpackhi_epi64(t0, t1);
+    r[2] = _mm256_unpacklo_epi64(t2, t3);
+    r[3] = _mm256_unpackhi_epi64(t2, t3);
+}
+
+static inline AVX2_TARGET void xor_store32(const unsigned char* in, unsigned char* out, __m256i ks) {
+    __m256i m = _mm256_loadu_si256((const __m256i*)in);
+    _mm256_storeu_si256((__m256i*)out, _mm256_xor_si256(m, ks));
+}
+
+AVX2_TARGET
+void chacha20_avx2_xor_blocks(uint32_t* state, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    const __m256i lane_ctr = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    for (; nblocks >= CHACHA20_AVX2_BLOCKS; nblocks -= CHACHA20_AVX2_BLOCKS) {
+        __m256i s[16], x[16];
+        for (int i = 0; i < 16; i++) {
+            s[i] = _mm256_set1_epi32((int)state[i]);
+        }
+        s[12] = _mm256_add_epi32(s[12], lane_ctr);
+        for (int i = 0; i < 16; i++) {
+            x[i] = s[i];
+        }
+
+        for (int round = 0; round < 10; round++) {
+            QR256(x[0], x[4], x[8], x[12]);
+            QR256(x[1], x[5], x[9], x[13]);
+            QR256(x[2], x[6], x[10], x[14]);
+            QR256(x[3], x[7], x[11], x[15]);
+            QR256(x[0], x[5], x[10], x[15]);
+            QR256(x[1], x[6], x[11], x[12]);
+            QR256(x[2], x[7], x[8], x[13]);
+            QR256(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; i++) {
+            x[i] = _mm256_add_epi32(x[i], s[i]);
+        }
+
+        // q[g][j]: слова группы g блоков j (младшая половина) и 4+j (старшая)
+        __m256i q[4][4];
+        for (int g = 0; g < 4; g++) {
+            transpose4_avx2(x[4 * g], x[4 * g + 1], x[4 * g + 2], x[4 * g + 3], q[g]);
+        }
+        for (int j = 0; j < 4; j++) {
+            const unsigned char* ib = in + j * 64;
+            unsigned char* ob = out + j * 64;
+            xor_store32(ib, ob, _mm256_permute2x128_si256(q[0][j], q[1][j], 0x20));
+            xor_store32(ib + 32, ob + 32, _mm256_permute2x128_si256(q[2][j], q[3][j], 0x20));
+            xor_store32(ib + 256, ob + 256, _mm256_permute2x128_si256(q[0][j], q[1][j], 0x31));
+            xor_store32(ib + 288, ob + 288, _mm256_permute2x128_si256(q[2][j], q[3][j], 0x31));
+        }
+        state[12] += CHACHA20_AVX2_BLOCKS;
+        in += CHACHA20_AVX2_BLOCKS * 64;
+        out += CHACHA20_AVX2_BLOCKS * 64;
+    }
+}
+
+#else /* !CRYPTOCORE_HAVE_CHACHA_SIMD */
+
+int chacha20_sse2_available(void) {
+    return 0;
+}
+
+int chacha20_avx2_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_CHACHA_SIMD */
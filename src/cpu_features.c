@@ -0,0 +1,75 @@
+#include "../include/cpu_features.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <cpuid.h>
+#define CPU_FEATURES_X86 1
+#endif
+
+static cpu_features_t g_features;
+// 0 - не определены, 1 - определяются одним из потоков, 2 - g_features опубликованы
+static int g_state = 0;
+
+#ifdef CPU_FEATURES_X86
+/**
+ * Чтение XCR0: какие регистровые состояния сохраняет ОС
+ */
+static unsigned long long read_xcr0(void) {
+    unsigned int eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return ((unsigned long long)edx << 32) | eax;
+}
+#endif
+
+static void detect_features(cpu_features_t* f) {
+    memset(f, 0, sizeof(*f));
+#ifdef CPU_FEATURES_X86
+    unsigned int eax, ebx, ecx, edx;
+    if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+        return;
+    }
+
+    f->sse2 = (edx >> 26) & 1;
+    f->ssse3 = (ecx >> 9) & 1;
+    f->sse41 = (ecx >> 19) & 1;
+    f->pclmul = (ecx >> 1) & 1;
+    f->aesni = (ecx >> 25) & 1;
+
+    // AVX допустим только если ОС сохраняет XMM/YMM (и ZMM для AVX-512)
+    int osxsave = (ecx >> 27) & 1;
+    unsigned long long xcr0 = osxsave ? read_xcr0() : 0ULL;
+    int os_avx = (xcr0 & 0x06) == 0x06;
+    int os_avx512 = (xcr0 & 0xe6) == 0xe6;
+    f->avx = ((ecx >> 28) & 1) && os_avx;
+
+    if (__get_cpuid_max(0, NULL) >= 7) {
+        __cpuid_count(7, 0, eax, ebx, ecx, edx);
+        f->avx2 = f->avx && ((ebx >> 5) & 1);
+        f->avx512f = os_avx512 && ((ebx >> 16) & 1);
+        f->avx512bw = f->avx512f && ((ebx >> 30) & 1);
+        f->avx512vl = f->avx512f && ((ebx >> 31) & 1);
+        f->sha = (ebx >> 29) & 1;
+        f->vaes = f->avx && ((ecx >> 9) & 1);
+        f->vpclmulqdq = f->avx && ((ecx >> 10) & 1);
+    }
+#endif
+}
+
+const cpu_features_t* cpu_features_get(void) {
+    if (__atomic_load_n(&g_state, __ATOMIC_ACQUIRE) == 2) {
+        return &g_features;
+    }
+
+    // Определение в локальную структуру и однократная публикация: читатель не видит частично заполненные флаги
+    int expected = 0;
+    if (__atomic_compare_exchange_n(&g_state, &expected, 1, 0, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        cpu_features_t f;
+        detect_features(&f);
+        g_features = f;
+        __atomic_store_n(&g_state, 2, __ATOMIC_RELEASE);
+    } else {
+        while (__atomic_load_n(&g_state, __ATOMIC_ACQUIRE) != 2) {
+        }
+    }
+    return &g_features;
+}
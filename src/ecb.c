@@ -1,140 +1,155 @@
 #include "../include/ecb.h"
+#include "../include/aes_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
-#include <openssl/aes.h>
-
-/**
- * Применение дополнения PKCS#7 к открытому тексту
- */
-static unsigned char* apply_pkcs7_padding(const unsigned char* data, size_t data_len, size_t* padded_len) {
-    // Вычисление необходимого дополнения
-    size_t padding_bytes = AES_BLOCK_SIZE - (data_len % AES_BLOCK_SIZE);
-    *padded_len = data_len + padding_bytes;
-
-    unsigned char* padded = (unsigned char*)malloc(*padded_len);
-    if (!padded) {
-        fprintf(stderr, "Error: Failed to allocate memory\n");
-        return NULL;
-    }
-
-    // Копирование исходных данных
-    memcpy(padded, data, data_len);
 
-    // Добавление байтов дополнения (каждый байт содержит длину дополнения)
-    for (size_t i = 0; i < padding_bytes; i++) {
-        padded[data_len + i] = (unsigned char)padding_bytes;
-    }
-
-    return padded;
+void pkcs7_pad_block(unsigned char* block, const unsigned char* tail, size_t tail_len) {
+    // Каждый байт дополнения содержит длину дополнения (1..16)
+    unsigned char padding_bytes = (unsigned char)(AES_BLOCK_SIZE - tail_len);
+    memcpy(block, tail, tail_len);
+    memset(block + tail_len, padding_bytes, padding_bytes);
 }
 
-/**
- * Удаление и проверка дополнения PKCS#7
- */
-static unsigned char* remove_pkcs7_padding(const unsigned char* data, size_t data_len, size_t* unpadded_len) {
-    if (data_len == 0 || data_len % AES_BLOCK_SIZE != 0) {
-        fprintf(stderr, "Error: Invalid ciphertext length for decryption\n");
-        return NULL;
-    }
-
+int pkcs7_unpad_length(const unsigned char* block) {
     // Получение длины дополнения из последнего байта
-    unsigned char padding_len = data[data_len - 1];
+    unsigned char padding_len = block[AES_BLOCK_SIZE - 1];
 
     // Проверка длины дополнения
     if (padding_len == 0 || padding_len > AES_BLOCK_SIZE) {
         fprintf(stderr, "Error: Invalid PKCS#7 padding\n");
-        return NULL;
+        return -1;
     }
 
     // Проверка корректности всех байтов дополнения
-    for (size_t i = data_len - padding_len; i < data_len; i++) {
-        if (data[i] != padding_len) {
+    for (size_t i = AES_BLOCK_SIZE - padding_len; i < AES_BLOCK_SIZE; i++) {
+        if (block[i] != padding_len) {
             fprintf(stderr, "Error: Invalid PKCS#7 padding\n");
-            return NULL;
+            return -1;
         }
     }
 
-    *unpadded_len = data_len - padding_len;
+    return padding_len;
+}
 
-    unsigned char* unpadded = (unsigned char*)malloc(*unpadded_len);
-    if (!unpadded) {
-        fprintf(stderr, "Error: Failed to allocate memory\n");
-        return NULL;
+int aes_ecb_encrypt_into(const unsigned char* plaintext, size_t plaintext_len,
+                         const unsigned char* key, unsigned char* out, size_t out_capacity,
+                         size_t* output_size) {
+    size_t padded_len = AES_PKCS7_PADDED_SIZE(plaintext_len);
+    if (out_capacity < padded_len) {
+        fprintf(stderr, "Error: Output buffer too small (%zu bytes required)\n", padded_len);
+        return -1;
     }
 
-    memcpy(unpadded, data, *unpadded_len);
-    return unpadded;
+    // Настройка ключа AES
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
+    }
+
+    // Дополнение PKCS#7 затрагивает только последний блок: он собирается отдельно
+    // до того, как шифрование на месте перезапишет буфер
+    size_t full = plaintext_len - plaintext_len % AES_BLOCK_SIZE;
+    unsigned char last[AES_BLOCK_SIZE];
+    pkcs7_pad_block(last, plaintext + full, plaintext_len - full);
+
+    // Шифрование всех полных блоков одним пакетом (блоки ECB независимы)
+    aes_core_encrypt_blocks(&aes_key, plaintext, out, full / AES_BLOCK_SIZE);
+    aes_core_encrypt_blocks(&aes_key, last, out + full, 1);
+    aes_core_key_clear(&aes_key);
+
+    *output_size = padded_len;
+    return 0;
 }
 
-unsigned char* aes_ecb_encrypt(const unsigned char* plaintext, size_t plaintext_len,
-                                const unsigned char* key, size_t* output_size) {
-    // Применение дополнения PKCS#7
-    size_t padded_len;
-    unsigned char* padded = apply_pkcs7_padding(plaintext, plaintext_len, &padded_len);
-    if (!padded) {
-        return NULL;
+int aes_ecb_encrypt_inplace(unsigned char* buf, size_t data_len, size_t buf_capacity,
+                            const unsigned char* key, size_t* output_size) {
+    return aes_ecb_encrypt_into(buf, data_len, key, buf, buf_capacity, output_size);
+}
+
+int aes_ecb_decrypt_into(const unsigned char* ciphertext, size_t ciphertext_len,
+                         const unsigned char* key, unsigned char* out, size_t out_capacity,
+                         size_t* output_size) {
+    if (ciphertext_len == 0 || ciphertext_len % AES_BLOCK_SIZE != 0) {
+        fprintf(stderr, "Error: Ciphertext length must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
+        return -1;
     }
 
+    // Настройка ключа AES
+    aes_core_key_t aes_key;
+    if (aes_core_set_decrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES decryption key\n");
+        return -1;
+    }
+
+    // Сначала последний блок: длина дополнения определяет размер результата
+    size_t full = ciphertext_len - AES_BLOCK_SIZE;
+    unsigned char last[AES_BLOCK_SIZE];
+    aes_core_decrypt_blocks(&aes_key, ciphertext + full, last, 1);
+    int padding_len = pkcs7_unpad_length(last);
+    if (padding_len < 0) {
+        aes_core_key_clear(&aes_key);
+        return -1;
+    }
+
+    size_t plain_len = ciphertext_len - (size_t)padding_len;
+    if (out_capacity < plain_len) {
+        fprintf(stderr, "Error: Output buffer too small (%zu bytes required)\n", plain_len);
+        aes_core_key_clear(&aes_key);
+        return -1;
+    }
+
+    // Остальные блоки дешифруются одним пакетом прямо в выходной буфер
+    aes_core_decrypt_blocks(&aes_key, ciphertext, out, full / AES_BLOCK_SIZE);
+    memcpy(out + full, last, AES_BLOCK_SIZE - (size_t)padding_len);
+    aes_core_key_clear(&aes_key);
+
+    *output_size = plain_len;
+    return 0;
+}
+
+int aes_ecb_decrypt_inplace(unsigned char* buf, size_t buf_len, const unsigned char* key,
+                            size_t* output_size) {
+    return aes_ecb_decrypt_into(buf, buf_len, key, buf, buf_len, output_size);
+}
+
+unsigned char* aes_ecb_encrypt(const unsigned char* plaintext, size_t plaintext_len,
+                                const unsigned char* key, size_t* output_size) {
     // Выделение буфера для выходных данных
+    size_t padded_len = AES_PKCS7_PADDED_SIZE(plaintext_len);
     unsigned char* ciphertext = (unsigned char*)malloc(padded_len);
     if (!ciphertext) {
         fprintf(stderr, "Error: Failed to allocate memory\n");
-        free(padded);
         return NULL;
     }
 
-    // Настройка ключа AES
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES encryption key\n");
-        free(padded);
+    if (aes_ecb_encrypt_into(plaintext, plaintext_len, key, ciphertext, padded_len, output_size) != 0) {
         free(ciphertext);
         return NULL;
     }
-
-    // Шифрование каждого блока
-    for (size_t i = 0; i < padded_len; i += AES_BLOCK_SIZE) {
-        AES_encrypt(padded + i, ciphertext + i, &aes_key);
-    }
-
-    free(padded);
-    *output_size = padded_len;
     return ciphertext;
 }
 
 unsigned char* aes_ecb_decrypt(const unsigned char* ciphertext, size_t ciphertext_len,
                                 const unsigned char* key, size_t* output_size) {
-    if (ciphertext_len % AES_BLOCK_SIZE != 0) {
+    if (ciphertext_len == 0 || ciphertext_len % AES_BLOCK_SIZE != 0) {
         fprintf(stderr, "Error: Ciphertext length must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
         return NULL;
     }
 
-    // Выделение буфера для дешифрованных данных (с дополнением)
-    unsigned char* decrypted_padded = (unsigned char*)malloc(ciphertext_len);
-    if (!decrypted_padded) {
+    // Выделение буфера для дешифрованных данных (открытый текст короче шифртекста)
+    unsigned char* plaintext = (unsigned char*)malloc(ciphertext_len);
+    if (!plaintext) {
         fprintf(stderr, "Error: Failed to allocate memory\n");
         return NULL;
     }
 
-    // Настройка ключа AES
-    AES_KEY aes_key;
-    if (AES_set_decrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES decryption key\n");
-        free(decrypted_padded);
+    if (aes_ecb_decrypt_into(ciphertext, ciphertext_len, key, plaintext, ciphertext_len, output_size) != 0) {
+        free(plaintext);
         return NULL;
     }
-
-    // Дешифрование каждого блока
-    for (size_t i = 0; i < ciphertext_len; i += AES_BLOCK_SIZE) {
-        AES_decrypt(ciphertext + i, decrypted_padded + i, &aes_key);
-    }
-
-    // Удаление дополнения PKCS#7
-    unsigned char* plaintext = remove_pkcs7_padding(decrypted_padded, ciphertext_len, output_size);
-    free(decrypted_padded);
-
     return plaintext;
 }
 
@@ -66,3 +66,55 @@ int write_file(const char* filename, const unsigned char* data, size_t size) {
     fclose(file);
     return 0;
 }
+
+int file_batches_open(file_batches_t* b, const char* path, size_t batch) {
+    memset(b, 0, sizeof(*b));
+    b->f = fopen(path, "rb");
+    if (!b->f) {
+        fprintf(stderr, "Error: Failed to open file '%s'\n", path);
+        return -1;
+    }
+    b->path = path;
+    b->cap = batch;
+    b->cur = (unsigned char*)malloc(batch);
+    b->next = (unsigned char*)malloc(batch);
+    if (!b->cur || !b->next) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        file_batches_close(b);
+        return -1;
+    }
+    b->len = fread(b->cur, 1, batch, b->f);
+    b->more = b->len == batch;
+    return 0;
+}
+
+void file_batches_read_ahead(file_batches_t* b) {
+    b->next_len = fread(b->next, 1, b->cap, b->f);
+}
+
+int file_batches_next(file_batches_t* b) {
+    if (!b->more) {
+        return 0;
+    }
+    unsigned char* t = b->cur;
+    b->cur = b->next;
+    b->next = t;
+    b->len = b->next_len;
+    b->more = b->len == b->cap;
+    return 1;
+}
+
+int file_batches_close(file_batches_t* b) {
+    int failed = 0;
+    if (b->f) {
+        failed = ferror(b->f);
+        fclose(b->f);
+        if (failed) {
+            fprintf(stderr, "Error: Failed to read file '%s'\n", b->path);
+        }
+    }
+    free(b->cur);
+    free(b->next);
+    memset(b, 0, sizeof(*b));
+    return failed ? -1 : 0;
+}
@@ -0,0 +1,455 @@
+#include "../../include/blake3.h"
+#include "../../include/blake3_simd.h"
+#include "../../include/file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Domain flags of the compression function
+#define CHUNK_START 1
+#define CHUNK_END 2
+#define PARENT 4
+#define ROOT 8
+
+#define BLAKE3_SUBTREE_CHUNKS 64                // Chunks per pool job (64 KB, a power of two)
+#define BLAKE3_SUBTREE_SLICE 256                // Subtrees per pool run (chaining values on the stack)
+
+// Same words as the SHA-256 initial state
+const uint32_t blake3_iv[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+// Message word order of each of the 7 rounds
+const uint8_t blake3_msg_schedule[7][16] = {
+    { 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15 },
+    { 2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8 },
+    { 3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1 },
+    { 10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6 },
+    { 12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4 },
+    { 9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7 },
+    { 11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13 },
+};
+
+static uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+#define ROTR32(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+#define G(a, b, c, d, mx, my)                               \
+    do {                                                    \
+        v[a] += v[b] + (mx); v[d] = ROTR32(v[d] ^ v[a], 16); \
+        v[c] += v[d]; v[b] = ROTR32(v[b] ^ v[c], 12);       \
+        v[a] += v[b] + (my); v[d] = ROTR32(v[d] ^ v[a], 8);  \
+        v[c] += v[d]; v[b] = ROTR32(v[b] ^ v[c], 7);        \
+    } while (0)
+
+/**
+ * The compression function; v receives the full 16-word state after the 7 rounds
+ */
+static void compress_state(uint32_t* v, const uint32_t* cv, const uint8_t* block, uint32_t block_len,
+                           uint64_t counter, uint8_t flags) {
+    uint32_t m[16];
+    for (int i = 0; i < 16; i++) {
+        m[i] = load_le32(block + 4 * i);
+    }
+    for (int i = 0; i < 8; i++) {
+        v[i] = cv[i];
+    }
+    for (int i = 0; i < 4; i++) {
+        v[8 + i] = blake3_iv[i];
+    }
+    v[12] = (uint32_t)counter;
+    v[13] = (uint32_t)(counter >> 32);
+    v[14] = block_len;
+    v[15] = flags;
+
+    for (int r = 0; r < 7; r++) {
+        const uint8_t* s = blake3_msg_schedule[r];
+        // Columns, then diagonals
+        G(0, 4, 8, 12, m[s[0]], m[s[1]]);
+        G(1, 5, 9, 13, m[s[2]], m[s[3]]);
+        G(2, 6, 10, 14, m[s[4]], m[s[5]]);
+        G(3, 7, 11, 15, m[s[6]], m[s[7]]);
+        G(0, 5, 10, 15, m[s[8]], m[s[9]]);
+        G(1, 6, 11, 12, m[s[10]], m[s[11]]);
+        G(2, 7, 8, 13, m[s[12]], m[s[13]]);
+        G(3, 4, 9, 14, m[s[14]], m[s[15]]);
+    }
+}
+
+static void compress_in_place(uint32_t* cv, const uint8_t* block, uint32_t block_len, uint64_t counter,
+                              uint8_t flags) {
+    uint32_t v[16];
+    compress_state(v, cv, block, block_len, counter, flags);
+    for (int i = 0; i < 8; i++) {
+        cv[i] = v[i] ^ v[i + 8];
+    }
+}
+
+typedef void (*blake3_many_fn_t)(const uint8_t* const*, size_t, const uint32_t*, uint64_t, int, uint8_t, uint8_t,
+                                 uint8_t, uint8_t*);
+
+/**
+ * Portable path: the inputs one after another, same arguments as the SIMD kernels
+ */
+static void hash_many_portable(const uint8_t* const* inputs, size_t nblocks, const uint32_t* key, uint64_t counter,
+                               int increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                               uint8_t* out) {
+    const uint8_t* input = inputs[0];
+    uint32_t cv[8];
+    memcpy(cv, key, sizeof(cv));
+    uint8_t block_flags = flags | flags_start;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        if (blk + 1 == nblocks) {
+            block_flags |= flags_end;
+        }
+        compress_in_place(cv, input + BLAKE3_BLOCK_LEN * blk, BLAKE3_BLOCK_LEN, counter, block_flags);
+        block_flags = flags;
+    }
+    (void)increment_counter;
+    for (int i = 0; i < 8; i++) {
+        store_le32(out + 4 * i, cv[i]);
+    }
+}
+
+typedef struct blake3_impl {
+    blake3_many_fn_t fn;
+    size_t ways;                        // Inputs per kernel call
+    const char* name;
+    const struct blake3_impl* narrower; // Kernel for what is left over (NULL for portable)
+} blake3_impl_t;
+
+static const blake3_impl_t impl_portable = { hash_many_portable, 1, "portable", NULL };
+#ifdef CRYPTOCORE_HAVE_BLAKE3_SIMD
+static const blake3_impl_t impl_avx2 = { blake3_hash8_avx2, BLAKE3_AVX2_WAYS, "avx2", &impl_portable };
+// Every AVX-512F CPU also has AVX2
+static const blake3_impl_t impl_avx512 = { blake3_hash16_avx512, BLAKE3_AVX512_WAYS, "avx512", &impl_avx2 };
+#endif
+
+/* Selected once; the pointer is read and published atomically */
+static const blake3_impl_t* active_impl = NULL;
+
+static const blake3_impl_t* get_impl(void) {
+    const blake3_impl_t* impl = __atomic_load_n(&active_impl, __ATOMIC_ACQUIRE);
+    if (impl) {
+        return impl;
+    }
+    impl = &impl_portable;
+#ifdef CRYPTOCORE_HAVE_BLAKE3_SIMD
+    if (blake3_avx512_available()) {
+        impl = &impl_avx512;
+    } else if (blake3_avx2_available()) {
+        impl = &impl_avx2;
+    }
+#endif
+    __atomic_store_n(&active_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+const char* blake3_impl_name(void) {
+    return get_impl()->name;
+}
+
+/**
+ * count inputs of nblocks blocks each: the widest kernel first, then narrower ones for the rest
+ */
+static void hash_many(const uint8_t* const* inputs, size_t count, size_t nblocks, const uint32_t* key,
+                      uint64_t counter, int increment_counter, uint8_t flags, uint8_t flags_start,
+                      uint8_t flags_end, uint8_t* out) {
+    for (const blake3_impl_t* impl = get_impl(); impl && count > 0; impl = impl->narrower) {
+        while (count >= impl->ways) {
+            impl->fn(inputs, nblocks, key, counter, increment_counter, flags, flags_start, flags_end, out);
+            inputs += impl->ways;
+            out += BLAKE3_OUT_LEN * impl->ways;
+            count -= impl->ways;
+            if (increment_counter) {
+                counter += impl->ways;
+            }
+        }
+    }
+}
+
+static void chunk_init(blake3_chunk_state_t* cs, uint64_t chunk_counter) {
+    memcpy(cs->cv, blake3_iv, sizeof(cs->cv));
+    cs->chunk_counter = chunk_counter;
+    cs->buf_len = 0;
+    cs->blocks_compressed = 0;
+}
+
+static size_t chunk_len(const blake3_chunk_state_t* cs) {
+    return BLAKE3_BLOCK_LEN * cs->blocks_compressed + cs->buf_len;
+}
+
+static void chunk_update(blake3_chunk_state_t* cs, const uint8_t* data, size_t len) {
+    while (len > 0) {
+        // A full buffer is compressed only once more input shows it is not the last block
+        if (cs->buf_len == BLAKE3_BLOCK_LEN) {
+            compress_in_place(cs->cv, cs->buf, BLAKE3_BLOCK_LEN, cs->chunk_counter,
+                              cs->blocks_compressed == 0 ? CHUNK_START : 0);
+            cs->blocks_compressed++;
+            cs->buf_len = 0;
+        }
+        size_t take = BLAKE3_BLOCK_LEN - cs->buf_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(cs->buf + cs->buf_len, data, take);
+        cs->buf_len += take;
+        data += take;
+        len -= take;
+    }
+}
+
+// Input of one compression not done yet: the last block of a chunk or a parent node
+typedef struct {
+    uint32_t cv[8];
+    uint8_t block[BLAKE3_BLOCK_LEN];
+    uint32_t block_len;
+    uint64_t counter;
+    uint8_t flags;
+} blake3_output_t;
+
+static blake3_output_t chunk_output(const blake3_chunk_state_t* cs) {
+    blake3_output_t o;
+    memcpy(o.cv, cs->cv, sizeof(o.cv));
+    memset(o.block, 0, sizeof(o.block));
+    memcpy(o.block, cs->buf, cs->buf_len);
+    o.block_len = (uint32_t)cs->buf_len;
+    o.counter = cs->chunk_counter;
+    o.flags = (cs->blocks_compressed == 0 ? CHUNK_START : 0) | CHUNK_END;
+    return o;
+}
+
+static blake3_output_t parent_output(const uint32_t* left, const uint32_t* right) {
+    blake3_output_t o;
+    memcpy(o.cv, blake3_iv, sizeof(o.cv));
+    for (int i = 0; i < 8; i++) {
+        store_le32(o.block + 4 * i, left[i]);
+        store_le32(o.block + 32 + 4 * i, right[i]);
+    }
+    o.block_len = BLAKE3_BLOCK_LEN;
+    o.counter = 0;
+    o.flags = PARENT;
+    return o;
+}
+
+static void output_cv(const blake3_output_t* o, uint32_t* cv) {
+    memcpy(cv, o->cv, 8 * sizeof(uint32_t));
+    compress_in_place(cv, o->block, o->block_len, o->counter, o->flags);
+}
+
+/**
+ * Merge finished subtrees until the stack holds one entry per set bit of total_chunks
+ * (the chunks to the left of whatever comes next)
+ */
+static void merge_cv_stack(blake3_ctx_t* ctx, uint64_t total_chunks) {
+    size_t keep = 0;
+    for (uint64_t c = total_chunks; c; c &= c - 1) {
+        keep++;
+    }
+    while (ctx->cv_stack_len > keep) {
+        uint32_t* left = ctx->cv_stack[ctx->cv_stack_len - 2];
+        blake3_output_t parent = parent_output(left, ctx->cv_stack[ctx->cv_stack_len - 1]);
+        output_cv(&parent, left);
+        ctx->cv_stack_len--;
+    }
+}
+
+/**
+ * Push the chaining value of a subtree that starts at chunk_counter
+ * Merging is lazy: a pushed entry may be the rightmost subtree, whose parent is the root
+ */
+static void push_cv(blake3_ctx_t* ctx, const uint32_t* cv, uint64_t chunk_counter) {
+    merge_cv_stack(ctx, chunk_counter);
+    memcpy(ctx->cv_stack[ctx->cv_stack_len++], cv, 8 * sizeof(uint32_t));
+}
+
+/**
+ * Chaining value of nchunks (a power of two, at most BLAKE3_SUBTREE_CHUNKS) whole chunks:
+ * all chunks in SIMD lanes, then each parent level the same way
+ */
+static void subtree_cv(const uint8_t* input, uint64_t chunk_counter, size_t nchunks, uint32_t* cv) {
+    const uint8_t* ptr[BLAKE3_SUBTREE_CHUNKS] = { NULL };
+    uint8_t cvs[2][BLAKE3_SUBTREE_CHUNKS * BLAKE3_OUT_LEN];
+    int cur = 0;
+
+    for (size_t j = 0; j < nchunks; j++) {
+        ptr[j] = input + j * BLAKE3_CHUNK_LEN;
+    }
+    hash_many(ptr, nchunks, BLAKE3_CHUNK_LEN / BLAKE3_BLOCK_LEN, blake3_iv, chunk_counter, 1, 0,
+              CHUNK_START, CHUNK_END, cvs[cur]);
+
+    // Each pair of chaining values is the single block of a parent node
+    while (nchunks > 1) {
+        nchunks /= 2;
+        for (size_t j = 0; j < nchunks; j++) {
+            ptr[j] = cvs[cur] + j * 2 * BLAKE3_OUT_LEN;
+        }
+        hash_many(ptr, nchunks, 1, blake3_iv, 0, 0, PARENT, 0, 0, cvs[1 - cur]);
+        cur = 1 - cur;
+    }
+    for (int i = 0; i < 8; i++) {
+        cv[i] = load_le32(cvs[cur] + 4 * i);
+    }
+}
+
+typedef struct {
+    const uint8_t* input;
+    uint64_t chunk_counter;
+    size_t nchunks;
+    uint32_t cv[8];
+} blake3_subtree_t;
+
+typedef struct {
+    blake3_subtree_t* trees;
+    file_batches_t* ra;                         // If set, job 0 reads the next file batch
+} subtree_job_t;
+
+static void run_subtree(void* arg, size_t index) {
+    subtree_job_t* job = (subtree_job_t*)arg;
+    if (job->ra) {
+        if (index == 0) {
+            file_batches_read_ahead(job->ra);
+            return;
+        }
+        index--;
+    }
+    blake3_subtree_t* t = &job->trees[index];
+    subtree_cv(t->input, t->chunk_counter, t->nchunks, t->cv);
+}
+
+/**
+ * Hash the whole subtrees at the start of data (the chunk state must be empty) and push them;
+ * at least one byte is left for the chunk state. With ra set, the next batch is read during the first pool run
+ * Returns the number of bytes consumed
+ */
+static size_t hash_subtrees(thread_pool_t* pool, blake3_ctx_t* ctx, const uint8_t* data, size_t len,
+                            file_batches_t* ra) {
+    blake3_subtree_t trees[BLAKE3_SUBTREE_SLICE];
+    uint64_t counter = ctx->chunk.chunk_counter;
+    size_t done = 0;
+
+    do {
+        size_t n = 0;
+        while (n < BLAKE3_SUBTREE_SLICE && len - done > BLAKE3_CHUNK_LEN) {
+            // Largest power of two that leaves input over and keeps the subtree aligned in the tree
+            size_t nchunks = BLAKE3_SUBTREE_CHUNKS;
+            while (nchunks > 1 && ((uint64_t)nchunks * BLAKE3_CHUNK_LEN >= len - done || (counter & (nchunks - 1)) != 0)) {
+                nchunks /= 2;
+            }
+            trees[n].input = data + done;
+            trees[n].chunk_counter = counter;
+            trees[n].nchunks = nchunks;
+            n++;
+            done += nchunks * BLAKE3_CHUNK_LEN;
+            counter += nchunks;
+        }
+
+        // Kernel is resolved on this thread before the jobs fan out to the pool
+        get_impl();
+        subtree_job_t job = { trees, ra };
+        thread_pool_run(pool, run_subtree, &job, n + (ra ? 1 : 0));
+        ra = NULL;
+        for (size_t i = 0; i < n; i++) {
+            push_cv(ctx, trees[i].cv, trees[i].chunk_counter);
+        }
+    } while (len - done > BLAKE3_CHUNK_LEN);
+
+    chunk_init(&ctx->chunk, counter);
+    return done;
+}
+
+static void update(thread_pool_t* pool, blake3_ctx_t* ctx, const uint8_t* data, size_t len, file_batches_t* ra) {
+    // Top up the current chunk; it is finished only once more input follows
+    if (chunk_len(&ctx->chunk) > 0) {
+        size_t take = BLAKE3_CHUNK_LEN - chunk_len(&ctx->chunk);
+        if (take > len) {
+            take = len;
+        }
+        chunk_update(&ctx->chunk, data, take);
+        data += take;
+        len -= take;
+        if (len > 0) {
+            uint32_t cv[8];
+            blake3_output_t o = chunk_output(&ctx->chunk);
+            output_cv(&o, cv);
+            push_cv(ctx, cv, ctx->chunk.chunk_counter);
+            chunk_init(&ctx->chunk, ctx->chunk.chunk_counter + 1);
+        }
+    }
+
+    // More than one chunk left: whole subtrees, the last bytes stay in the chunk state
+    if (len > BLAKE3_CHUNK_LEN) {
+        size_t done = hash_subtrees(pool, ctx, data, len, ra);
+        data += done;
+        len -= done;
+        ra = NULL;
+    }
+    if (ra) {
+        file_batches_read_ahead(ra);
+    }
+    chunk_update(&ctx->chunk, data, len);
+
+    // The chunk state is not empty, so every stacked subtree has input to its right
+    merge_cv_stack(ctx, ctx->chunk.chunk_counter);
+}
+
+void blake3_init(blake3_ctx_t* ctx) {
+    chunk_init(&ctx->chunk, 0);
+    ctx->cv_stack_len = 0;
+}
+
+void blake3_update(blake3_ctx_t* ctx, const uint8_t* data, size_t len) {
+    update(NULL, ctx, data, len, NULL);
+}
+
+void blake3_update_parallel(thread_pool_t* pool, blake3_ctx_t* ctx, const uint8_t* data, size_t len) {
+    update(pool, ctx, data, len, NULL);
+}
+
+void blake3_final(const blake3_ctx_t* ctx, uint8_t* hash) {
+    // The last chunk is the right edge of the tree: fold in the stacked subtrees from the top
+    blake3_output_t o = chunk_output(&ctx->chunk);
+    for (size_t i = ctx->cv_stack_len; i > 0; i--) {
+        uint32_t cv[8];
+        output_cv(&o, cv);
+        o = parent_output(ctx->cv_stack[i - 1], cv);
+    }
+
+    uint32_t v[16];
+    compress_state(v, o.cv, o.block, o.block_len, o.counter, (uint8_t)(o.flags | ROOT));
+    for (int i = 0; i < 8; i++) {
+        store_le32(hash + 4 * i, v[i] ^ v[i + 8]);
+    }
+}
+
+int blake3_hash_file(thread_pool_t* pool, const char* filepath, uint8_t* hash) {
+    if (!filepath || !hash) {
+        return -1;
+    }
+    // Whole subtrees per batch keep the chunk counter aligned across batches
+    file_batches_t b;
+    if (file_batches_open(&b, filepath, (size_t)thread_pool_size(pool) * FILE_BATCH_PER_THREAD) != 0) {
+        return -1;
+    }
+
+    blake3_ctx_t ctx;
+    blake3_init(&ctx);
+    do {
+        update(pool, &ctx, b.cur, b.len, b.more ? &b : NULL);
+    } while (file_batches_next(&b));
+
+    if (file_batches_close(&b) != 0) {
+        return -1;
+    }
+    blake3_final(&ctx, hash);
+    return 0;
+}
@@ -0,0 +1,234 @@
+#include "../../include/blake3_simd.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_BLAKE3_SIMD
+
+#include <immintrin.h>
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+int blake3_avx2_available(void) {
+    return cpu_features_get()->avx2;
+}
+
+int blake3_avx512_available(void) {
+    return cpu_features_get()->avx512f;
+}
+
+/*
+ * One G function per 32-bit lane: word i of input j lives in lane j of v[i] / m[i]
+ * AVX2 rotates by 16 and 8 with a byte shuffle, by 12 and 7 with shifts
+ */
+#define ROTR32X8(x, n) _mm256_or_si256(_mm256_srli_epi32((x), (n)), _mm256_slli_epi32((x), 32 - (n)))
+
+#define G8(a, b, c, d, mx, my)                                                                  \
+    do {                                                                                        \
+        v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), (mx));                            \
+        v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), rot16);                        \
+        v[c] = _mm256_add_epi32(v[c], v[d]);                                                    \
+        v[b] = ROTR32X8(_mm256_xor_si256(v[b], v[c]), 12);                                      \
+        v[a] = _mm256_add_epi32(_mm256_add_epi32(v[a], v[b]), (my));                            \
+        v[d] = _mm256_shuffle_epi8(_mm256_xor_si256(v[d], v[a]), rot8);                         \
+        v[c] = _mm256_add_epi32(v[c], v[d]);                                                    \
+        v[b] = ROTR32X8(_mm256_xor_si256(v[b], v[c]), 7);                                       \
+    } while (0)
+
+static inline AVX2_TARGET void transpose8_avx2(__m256i* r) {
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/**
+ * Message words of one block from 8 inputs (little-endian, no byte swap): m[i] = word i of inputs 0..7
+ */
+static inline AVX2_TARGET void load8_avx2(__m256i* m, const uint8_t* const* inputs, size_t offset) {
+    for (int half = 0; half < 2; half++) {
+        for (int j = 0; j < 8; j++) {
+            m[8 * half + j] = _mm256_loadu_si256((const __m256i*)(inputs[j] + offset + 32 * half));
+        }
+        transpose8_avx2(m + 8 * half);
+    }
+}
+
+/**
+ * Per-input block counters: low and high words, input j gets counter + j when incrementing
+ */
+static void counter_words(uint64_t counter, int increment_counter, int ways, uint32_t* lo, uint32_t* hi) {
+    for (int j = 0; j < ways; j++) {
+        uint64_t c = counter + (increment_counter ? (uint64_t)j : 0);
+        lo[j] = (uint32_t)c;
+        hi[j] = (uint32_t)(c >> 32);
+    }
+}
+
+AVX2_TARGET void blake3_hash8_avx2(const uint8_t* const* inputs, size_t nblocks, const uint32_t* key, uint64_t counter,
+                                   int increment_counter, uint8_t flags, uint8_t flags_start, uint8_t flags_end,
+                                   uint8_t* out) {
+    const __m256i rot16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13);
+    const __m256i rot8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12,
+                                          1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12);
+    uint32_t lo[8], hi[8];
+    counter_words(counter, increment_counter, 8, lo, hi);
+    const __m256i ctr_lo = _mm256_loadu_si256((const __m256i*)lo);
+    const __m256i ctr_hi = _mm256_loadu_si256((const __m256i*)hi);
+
+    __m256i h[8];
+    for (int i = 0; i < 8; i++) {
+        h[i] = _mm256_set1_epi32((int)key[i]);
+    }
+    uint8_t block_flags = flags | flags_start;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        if (blk + 1 == nblocks) {
+            block_flags |= flags_end;
+        }
+        __m256i m[16], v[16];
+        load8_avx2(m, inputs, 64 * blk);
+        for (int i = 0; i < 8; i++) {
+            v[i] = h[i];
+        }
+        for (int i = 0; i < 4; i++) {
+            v[8 + i] = _mm256_set1_epi32((int)blake3_iv[i]);
+        }
+        v[12] = ctr_lo;
+        v[13] = ctr_hi;
+        v[14] = _mm256_set1_epi32(64);
+        v[15] = _mm256_set1_epi32(block_flags);
+
+        for (int r = 0; r < 7; r++) {
+            const uint8_t* s = blake3_msg_schedule[r];
+            // Columns, then diagonals
+            G8(0, 4, 8, 12, m[s[0]], m[s[1]]);
+            G8(1, 5, 9, 13, m[s[2]], m[s[3]]);
+            G8(2, 6, 10, 14, m[s[4]], m[s[5]]);
+            G8(3, 7, 11, 15, m[s[6]], m[s[7]]);
+            G8(0, 5, 10, 15, m[s[8]], m[s[9]]);
+            G8(1, 6, 11, 12, m[s[10]], m[s[11]]);
+            G8(2, 7, 8, 13, m[s[12]], m[s[13]]);
+            G8(3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+        for (int i = 0; i < 8; i++) {
+            h[i] = _mm256_xor_si256(v[i], v[i + 8]);
+        }
+        block_flags = flags;
+    }
+
+    // h[i] holds word i of every input: transpose back to one chaining value per row
+    transpose8_avx2(h);
+    for (int j = 0; j < 8; j++) {
+        _mm256_storeu_si256((__m256i*)(out + 32 * j), h[j]);
+    }
+}
+
+#define G16(a, b, c, d, mx, my)                                                                 \
+    do {                                                                                        \
+        v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), (mx));                            \
+        v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 16);                              \
+        v[c] = _mm512_add_epi32(v[c], v[d]);                                                    \
+        v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 12);                              \
+        v[a] = _mm512_add_epi32(_mm512_add_epi32(v[a], v[b]), (my));                            \
+        v[d] = _mm512_ror_epi32(_mm512_xor_si512(v[d], v[a]), 8);                               \
+        v[c] = _mm512_add_epi32(v[c], v[d]);                                                    \
+        v[b] = _mm512_ror_epi32(_mm512_xor_si512(v[b], v[c]), 7);                               \
+    } while (0)
+
+AVX512_TARGET void blake3_hash16_avx512(const uint8_t* const* inputs, size_t nblocks, const uint32_t* key,
+                                        uint64_t counter, int increment_counter, uint8_t flags, uint8_t flags_start,
+                                        uint8_t flags_end, uint8_t* out) {
+    uint32_t lo[16], hi[16];
+    counter_words(counter, increment_counter, 16, lo, hi);
+    const __m512i ctr_lo = _mm512_loadu_si512((const void*)lo);
+    const __m512i ctr_hi = _mm512_loadu_si512((const void*)hi);
+
+    __m512i h[8];
+    for (int i = 0; i < 8; i++) {
+        h[i] = _mm512_set1_epi32((int)key[i]);
+    }
+    uint8_t block_flags = flags | flags_start;
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        if (blk + 1 == nblocks) {
+            block_flags |= flags_end;
+        }
+        // Inputs 0..7 and 8..15 are transposed as two AVX2 groups and joined per word
+        __m512i m[16], v[16];
+        __m256i mlo[16], mhi[16];
+        load8_avx2(mlo, inputs, 64 * blk);
+        load8_avx2(mhi, inputs + 8, 64 * blk);
+        for (int i = 0; i < 16; i++) {
+            m[i] = _mm512_inserti64x4(_mm512_castsi256_si512(mlo[i]), mhi[i], 1);
+        }
+        for (int i = 0; i < 8; i++) {
+            v[i] = h[i];
+        }
+        for (int i = 0; i < 4; i++) {
+            v[8 + i] = _mm512_set1_epi32((int)blake3_iv[i]);
+        }
+        v[12] = ctr_lo;
+        v[13] = ctr_hi;
+        v[14] = _mm512_set1_epi32(64);
+        v[15] = _mm512_set1_epi32(block_flags);
+
+        for (int r = 0; r < 7; r++) {
+            const uint8_t* s = blake3_msg_schedule[r];
+            G16(0, 4, 8, 12, m[s[0]], m[s[1]]);
+            G16(1, 5, 9, 13, m[s[2]], m[s[3]]);
+            G16(2, 6, 10, 14, m[s[4]], m[s[5]]);
+            G16(3, 7, 11, 15, m[s[6]], m[s[7]]);
+            G16(0, 5, 10, 15, m[s[8]], m[s[9]]);
+            G16(1, 6, 11, 12, m[s[10]], m[s[11]]);
+            G16(2, 7, 8, 13, m[s[12]], m[s[13]]);
+            G16(3, 4, 9, 14, m[s[14]], m[s[15]]);
+        }
+        for (int i = 0; i < 8; i++) {
+            h[i] = _mm512_xor_si512(v[i], v[i + 8]);
+        }
+        block_flags = flags;
+    }
+
+    __m256i hlo[8], hhi[8];
+    for (int i = 0; i < 8; i++) {
+        hlo[i] = _mm512_castsi512_si256(h[i]);
+        hhi[i] = _mm512_extracti64x4_epi64(h[i], 1);
+    }
+    transpose8_avx2(hlo);
+    transpose8_avx2(hhi);
+    for (int j = 0; j < 8; j++) {
+        _mm256_storeu_si256((__m256i*)(out + 32 * j), hlo[j]);
+        _mm256_storeu_si256((__m256i*)(out + 32 * (8 + j)), hhi[j]);
+    }
+}
+
+#else
+
+int blake3_avx2_available(void) {
+    return 0;
+}
+
+int blake3_avx512_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_BLAKE3_SIMD */
@@ -0,0 +1,169 @@
+#include "../../include/keccak_simd.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_KECCAK_SIMD
+
+#include <immintrin.h>
+#include <string.h>
+
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+int keccak_avx2_available(void) {
+    return cpu_features_get()->avx2;
+}
+
+// AVX2 has no 64-bit rotate: shifts, or a byte shuffle for multiples of 8
+#define ROTL64X4(x, n) _mm256_or_si256(_mm256_slli_epi64((x), (n)), _mm256_srli_epi64((x), 64 - (n)))
+#define ROTL64_8(x) _mm256_shuffle_epi8((x), rot8)
+#define ROTL64_56(x) _mm256_shuffle_epi8((x), rot56)
+
+/*
+ * Keccak-f[1600] on four independent states, one per 64-bit lane of a YMM register
+ * s[i] holds lane i of all four states
+ */
+AVX2_TARGET static void keccak_f1600_x4(__m256i* s) {
+    const __m256i rot8 = _mm256_setr_epi8(7, 0, 1, 2, 3, 4, 5, 6, 15, 8, 9, 10, 11, 12, 13, 14,
+                                          7, 0, 1, 2, 3, 4, 5, 6, 15, 8, 9, 10, 11, 12, 13, 14);
+    const __m256i rot56 = _mm256_setr_epi8(1, 2, 3, 4, 5, 6, 7, 0, 9, 10, 11, 12, 13, 14, 15, 8,
+                                           1, 2, 3, 4, 5, 6, 7, 0, 9, 10, 11, 12, 13, 14, 15, 8);
+    __m256i a00, a01, a02, a03, a04, a05, a06, a07, a08, a09, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24;
+    __m256i b00, b01, b02, b03, b04, b05, b06, b07, b08, b09, b10, b11, b12, b13, b14, b15, b16, b17, b18, b19, b20, b21, b22, b23, b24;
+    __m256i c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;
+
+    a00 = s[0]; a01 = s[1]; a02 = s[2]; a03 = s[3]; a04 = s[4];
+    a05 = s[5]; a06 = s[6]; a07 = s[7]; a08 = s[8]; a09 = s[9];
+    a10 = s[10]; a11 = s[11]; a12 = s[12]; a13 = s[13]; a14 = s[14];
+    a15 = s[15]; a16 = s[16]; a17 = s[17]; a18 = s[18]; a19 = s[19];
+    a20 = s[20]; a21 = s[21]; a22 = s[22]; a23 = s[23]; a24 = s[24];
+
+    for (int round = 0; round < 24; round++) {
+        c0 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a00, a05), _mm256_xor_si256(a10, a15)), a20);
+        c1 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a01, a06), _mm256_xor_si256(a11, a16)), a21);
+        c2 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a02, a07), _mm256_xor_si256(a12, a17)), a22);
+        c3 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a03, a08), _mm256_xor_si256(a13, a18)), a23);
+        c4 = _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a04, a09), _mm256_xor_si256(a14, a19)), a24);
+        d0 = _mm256_xor_si256(c4, ROTL64X4(c1, 1));
+        d1 = _mm256_xor_si256(c0, ROTL64X4(c2, 1));
+        d2 = _mm256_xor_si256(c1, ROTL64X4(c3, 1));
+        d3 = _mm256_xor_si256(c2, ROTL64X4(c4, 1));
+        d4 = _mm256_xor_si256(c3, ROTL64X4(c0, 1));
+        b00 = _mm256_xor_si256(a00, d0);
+        b01 = ROTL64X4(_mm256_xor_si256(a06, d1), 44);
+        b02 = ROTL64X4(_mm256_xor_si256(a12, d2), 43);
+        b03 = ROTL64X4(_mm256_xor_si256(a18, d3), 21);
+        b04 = ROTL64X4(_mm256_xor_si256(a24, d4), 14);
+        b05 = ROTL64X4(_mm256_xor_si256(a03, d3), 28);
+        b06 = ROTL64X4(_mm256_xor_si256(a09, d4), 20);
+        b07 = ROTL64X4(_mm256_xor_si256(a10, d0), 3);
+        b08 = ROTL64X4(_mm256_xor_si256(a16, d1), 45);
+        b09 = ROTL64X4(_mm256_xor_si256(a22, d2), 61);
+        b10 = ROTL64X4(_mm256_xor_si256(a01, d1), 1);
+        b11 = ROTL64X4(_mm256_xor_si256(a07, d2), 6);
+        b12 = ROTL64X4(_mm256_xor_si256(a13, d3), 25);
+        b13 = ROTL64_8(_mm256_xor_si256(a19, d4));
+        b14 = ROTL64X4(_mm256_xor_si256(a20, d0), 18);
+        b15 = ROTL64X4(_mm256_xor_si256(a04, d4), 27);
+        b16 = ROTL64X4(_mm256_xor_si256(a05, d0), 36);
+        b17 = ROTL64X4(_mm256_xor_si256(a11, d1), 10);
+        b18 = ROTL64X4(_mm256_xor_si256(a17, d2), 15);
+        b19 = ROTL64_56(_mm256_xor_si256(a23, d3));
+        b20 = ROTL64X4(_mm256_xor_si256(a02, d2), 62);
+        b21 = ROTL64X4(_mm256_xor_si256(a08, d3), 55);
+        b22 = ROTL64X4(_mm256_xor_si256(a14, d4), 39);
+        b23 = ROTL64X4(_mm256_xor_si256(a15, d0), 41);
+        b24 = ROTL64X4(_mm256_xor_si256(a21, d1), 2);
+        a00 = _mm256_xor_si256(b00, _mm256_andnot_si256(b01, b02));
+        a01 = _mm256_xor_si256(b01, _mm256_andnot_si256(b02, b03));
+        a02 = _mm256_xor_si256(b02, _mm256_andnot_si256(b03, b04));
+        a03 = _mm256_xor_si256(b03, _mm256_andnot_si256(b04, b00));
+        a04 = _mm256_xor_si256(b04, _mm256_andnot_si256(b00, b01));
+        a05 = _mm256_xor_si256(b05, _mm256_andnot_si256(b06, b07));
+        a06 = _mm256_xor_si256(b06, _mm256_andnot_si256(b07, b08));
+        a07 = _mm256_xor_si256(b07, _mm256_andnot_si256(b08, b09));
+        a08 = _mm256_xor_si256(b08, _mm256_andnot_si256(b09, b05));
+        a09 = _mm256_xor_si256(b09, _mm256_andnot_si256(b05, b06));
+        a10 = _mm256_xor_si256(b10, _mm256_andnot_si256(b11, b12));
+        a11 = _mm256_xor_si256(b11, _mm256_andnot_si256(b12, b13));
+        a12 = _mm256_xor_si256(b12, _mm256_andnot_si256(b13, b14));
+        a13 = _mm256_xor_si256(b13, _mm256_andnot_si256(b14, b10));
+        a14 = _mm256_xor_si256(b14, _mm256_andnot_si256(b10, b11));
+        a15 = _mm256_xor_si256(b15, _mm256_andnot_si256(b16, b17));
+        a16 = _mm256_xor_si256(b16, _mm256_andnot_si256(b17, b18));
+        a17 = _mm256_xor_si256(b17, _mm256_andnot_si256(b18, b19));
+        a18 = _mm256_xor_si256(b18, _mm256_andnot_si256(b19, b15));
+        a19 = _mm256_xor_si256(b19, _mm256_andnot_si256(b15, b16));
+        a20 = _mm256_xor_si256(b20, _mm256_andnot_si256(b21, b22));
+        a21 = _mm256_xor_si256(b21, _mm256_andnot_si256(b22, b23));
+        a22 = _mm256_xor_si256(b22, _mm256_andnot_si256(b23, b24));
+        a23 = _mm256_xor_si256(b23, _mm256_andnot_si256(b24, b20));
+        a24 = _mm256_xor_si256(b24, _mm256_andnot_si256(b20, b21));
+        a00 = _mm256_xor_si256(a00, _mm256_set1_epi64x((long long)keccak_rc[round]));
+    }
+
+    s[0] = a00; s[1] = a01; s[2] = a02; s[3] = a03; s[4] = a04;
+    s[5] = a05; s[6] = a06; s[7] = a07; s[8] = a08; s[9] = a09;
+    s[10] = a10; s[11] = a11; s[12] = a12; s[13] = a13; s[14] = a14;
+    s[15] = a15; s[16] = a16; s[17] = a17; s[18] = a18; s[19] = a19;
+    s[20] = a20; s[21] = a21; s[22] = a22; s[23] = a23; s[24] = a24;
+}
+
+// Lane i of four byte strings, one per 64-bit element
+AVX2_TARGET static inline __m256i load_lanes(const uint8_t* const* p, size_t offset) {
+    uint64_t v[4];
+    for (int j = 0; j < 4; j++) {
+        memcpy(&v[j], p[j] + offset, 8);
+    }
+    return _mm256_loadu_si256((const __m256i*)v);
+}
+
+AVX2_TARGET void keccak_shake_x4_avx2(size_t rate, const uint8_t* const* in, size_t len, uint8_t* const* out, size_t out_len) {
+    __m256i s[25];
+    size_t lanes = rate / 8;
+    for (int i = 0; i < 25; i++) {
+        s[i] = _mm256_setzero_si256();
+    }
+
+    // Full blocks straight from the inputs
+    size_t offset = 0;
+    for (; len - offset >= rate; offset += rate) {
+        for (size_t i = 0; i < lanes; i++) {
+            s[i] = _mm256_xor_si256(s[i], load_lanes(in, offset + 8 * i));
+        }
+        keccak_f1600_x4(s);
+    }
+
+    // Last partial block with the SHAKE suffix and pad10*1
+    uint8_t pad[4][200];
+    const uint8_t* pad_ptr[4];
+    size_t rem = len - offset;
+    for (int j = 0; j < 4; j++) {
+        memset(pad[j], 0, rate);
+        memcpy(pad[j], in[j] + offset, rem);
+        pad[j][rem] ^= 0x1f;
+        pad[j][rate - 1] ^= 0x80;
+        pad_ptr[j] = pad[j];
+    }
+    for (size_t i = 0; i < lanes; i++) {
+        s[i] = _mm256_xor_si256(s[i], load_lanes(pad_ptr, 8 * i));
+    }
+    keccak_f1600_x4(s);
+
+    // Output fits in one block
+    uint64_t v[25][4];
+    for (size_t i = 0; i < (out_len + 7) / 8; i++) {
+        _mm256_storeu_si256((__m256i*)v[i], s[i]);
+    }
+    for (int j = 0; j < 4; j++) {
+        for (size_t k = 0; k < out_len; k++) {
+            out[j][k] = (uint8_t)(v[k / 8][j] >> (8 * (k % 8)));
+        }
+    }
+}
+
+#else
+
+int keccak_avx2_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_KECCAK_SIMD */
@@ -0,0 +1,163 @@
+#include "../../include/parallelhash.h"
+#include "../../include/keccak_simd.h"
+#include "../../include/file_io.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PH_GROUP 4                          // Blocks per job (one 4-way Keccak call)
+#define PH_SLICE 256                        // Blocks per parallelhash_blocks round (chaining values on the stack)
+
+typedef struct {
+    unsigned int security_bits;
+    size_t block_size;
+    const uint8_t* data;
+    size_t nblocks;
+    uint8_t* cv;                            // nblocks chaining values
+    int x4;                                 // 4-way AVX2 kernel usable
+    file_batches_t* ra;                     // If set, job 0 reads the next file batch
+} leaf_job_t;
+
+static void leaf_hash(unsigned int security_bits, const uint8_t* data, size_t len, uint8_t* cv) {
+    sha3_ctx_t ctx;
+    shake_init(&ctx, security_bits);
+    sha3_update(&ctx, data, len);
+    shake_squeeze(&ctx, cv, security_bits / 4);
+}
+
+/**
+ * Absorb the chaining value of the final partial block (if any)
+ */
+static void absorb_tail(parallelhash_ctx_t* ctx, const uint8_t* tail, size_t tail_len) {
+    if (tail_len > 0) {
+        uint8_t cv[64];
+        leaf_hash(ctx->security_bits, tail, tail_len, cv);
+        sha3_update(&ctx->outer, cv, ctx->security_bits / 4);
+        ctx->blocks++;
+    }
+}
+
+static void run_leaf_group(void* arg, size_t index) {
+    leaf_job_t* job = (leaf_job_t*)arg;
+    if (job->ra) {
+        if (index == 0) {
+            file_batches_read_ahead(job->ra);
+            return;
+        }
+        index--;
+    }
+
+    size_t cv_len = job->security_bits / 4;
+    size_t first = index * PH_GROUP;
+    size_t n = job->nblocks - first < PH_GROUP ? job->nblocks - first : PH_GROUP;
+    const uint8_t* in = job->data + first * job->block_size;
+    uint8_t* cv = job->cv + first * cv_len;
+
+#ifdef CRYPTOCORE_HAVE_KECCAK_SIMD
+    if (job->x4 && n == KECCAK_AVX2_WAYS) {
+        const uint8_t* p[KECCAK_AVX2_WAYS];
+        uint8_t* o[KECCAK_AVX2_WAYS];
+        for (int j = 0; j < KECCAK_AVX2_WAYS; j++) {
+            p[j] = in + j * job->block_size;
+            o[j] = cv + j * cv_len;
+        }
+        keccak_shake_x4_avx2(200 - cv_len, p, job->block_size, o, cv_len);
+        return;
+    }
+#endif
+    for (size_t j = 0; j < n; j++) {
+        leaf_hash(job->security_bits, in + j * job->block_size, job->block_size, cv + j * cv_len);
+    }
+}
+
+/**
+ * Chaining values of nblocks full blocks into cv, then absorbed in block order
+ * With ra set, one extra job reads the next file batch
+ */
+static void hash_blocks(thread_pool_t* pool, parallelhash_ctx_t* ctx, const uint8_t* data, size_t nblocks,
+                        uint8_t* cv, file_batches_t* ra) {
+    leaf_job_t job = { ctx->security_bits, ctx->block_size, data, nblocks, cv, keccak_avx2_available(), ra };
+    size_t groups = (nblocks + PH_GROUP - 1) / PH_GROUP;
+    thread_pool_run(pool, run_leaf_group, &job, groups + (ra ? 1 : 0));
+
+    sha3_update(&ctx->outer, cv, nblocks * (ctx->security_bits / 4));
+    ctx->blocks += nblocks;
+}
+
+int parallelhash_init(parallelhash_ctx_t* ctx, unsigned int security_bits, size_t block_size,
+                      const uint8_t* custom, size_t custom_len, size_t out_len) {
+    if (!ctx || (!custom && custom_len > 0)) {
+        return -1;
+    }
+    if (security_bits != 128 && security_bits != 256) {
+        fprintf(stderr, "Error: ParallelHash security level must be 128 or 256 bits\n");
+        return -1;
+    }
+    if (block_size == 0) {
+        fprintf(stderr, "Error: ParallelHash block size must be positive\n");
+        return -1;
+    }
+
+    cshake_init(&ctx->outer, security_bits, (const uint8_t*)"ParallelHash", 12, custom, custom_len);
+    uint8_t enc[9];
+    sha3_update(&ctx->outer, enc, sp800_185_left_encode(enc, block_size));
+    ctx->security_bits = security_bits;
+    ctx->block_size = block_size;
+    ctx->blocks = 0;
+    ctx->out_len = out_len;
+    return 0;
+}
+
+void parallelhash_blocks(thread_pool_t* pool, parallelhash_ctx_t* ctx, const uint8_t* data, size_t nblocks) {
+    uint8_t cv[PH_SLICE * 64];
+    while (nblocks > 0) {
+        size_t n = nblocks < PH_SLICE ? nblocks : PH_SLICE;
+        hash_blocks(pool, ctx, data, n, cv, NULL);
+        data += n * ctx->block_size;
+        nblocks -= n;
+    }
+}
+
+void parallelhash_final(parallelhash_ctx_t* ctx, const uint8_t* tail, size_t tail_len, uint8_t* out) {
+    uint8_t enc[9];
+    absorb_tail(ctx, tail, tail_len);
+    sha3_update(&ctx->outer, enc, sp800_185_right_encode(enc, ctx->blocks));
+    sha3_update(&ctx->outer, enc, sp800_185_right_encode(enc, (uint64_t)ctx->out_len * 8));
+    shake_squeeze(&ctx->outer, out, ctx->out_len);
+}
+
+int parallelhash_file(thread_pool_t* pool, const char* filepath, unsigned int security_bits, size_t block_size,
+                      uint8_t* out, size_t out_len) {
+    parallelhash_ctx_t ctx;
+    if (!filepath || !out || parallelhash_init(&ctx, security_bits, block_size, NULL, 0, out_len) != 0) {
+        return -1;
+    }
+
+    // Whole blocks per batch, so only the final read can leave a partial block
+    size_t batch = (size_t)thread_pool_size(pool) * FILE_BATCH_PER_THREAD;
+    batch = batch < block_size ? block_size : batch - batch % block_size;
+
+    uint8_t* cv = (uint8_t*)malloc(batch / block_size * (security_bits / 4));
+    if (!cv) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return -1;
+    }
+    file_batches_t b;
+    if (file_batches_open(&b, filepath, batch) != 0) {
+        free(cv);
+        return -1;
+    }
+
+    do {
+        hash_blocks(pool, &ctx, b.cur, b.len / block_size, cv, b.more ? &b : NULL);
+    } while (file_batches_next(&b));
+
+    // The partial block is still in the last batch buffer
+    absorb_tail(&ctx, b.cur + b.len - b.len % block_size, b.len % block_size);
+    free(cv);
+    if (file_batches_close(&b) != 0) {
+        return -1;
+    }
+    parallelhash_final(&ctx, NULL, 0, out);
+    return 0;
+}
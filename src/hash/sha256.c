@@ -1,10 +1,11 @@
 #include "../../include/hash.h"
+#include "../../include/sha256_simd.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 
 // SHA-256 constants (first 32 bits of fractional parts of cube roots of first 64 primes)
-static const uint32_t K[64] = {
+const uint32_t sha256_k[64] = {
     0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
     0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
     0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
@@ -41,73 +42,137 @@ void sha256_init(sha256_ctx_t* ctx) {
     ctx->buffer_len = 0;
 }
 
-// Process one 512-bit block
-static void sha256_transform(sha256_ctx_t* ctx, const uint8_t* block) {
+// One round; the caller rotates the roles of a..h instead of moving the values
+#define ROUND(a, b, c, d, e, f, g, h, k, w)                         \
+    do {                                                            \
+        uint32_t t1 = (h) + BSIG1(e) + CH(e, f, g) + (k) + (w);     \
+        (d) += t1;                                                  \
+        (h) = t1 + BSIG0(a) + MAJ(a, b, c);                         \
+    } while (0)
+
+// Process nblocks consecutive 512-bit blocks; the state stays in locals between blocks
+static void sha256_blocks_portable(uint32_t* state, const uint8_t* data, size_t nblocks) {
     uint32_t W[64];
-    uint32_t a, b, c, d, e, f, g, h;
-    uint32_t T1, T2;
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
     int i;
     
-    // Prepare message schedule (W[0..63])
-    for (i = 0; i < 16; i++) {
-        W[i] = ((uint32_t)block[i * 4] << 24) |
-               ((uint32_t)block[i * 4 + 1] << 16) |
-               ((uint32_t)block[i * 4 + 2] << 8) |
-               ((uint32_t)block[i * 4 + 3]);
+    while (nblocks-- > 0) {
+        // Prepare message schedule (W[0..63])
+        for (i = 0; i < 16; i++) {
+            W[i] = ((uint32_t)data[i * 4] << 24) |
+                   ((uint32_t)data[i * 4 + 1] << 16) |
+                   ((uint32_t)data[i * 4 + 2] << 8) |
+                   ((uint32_t)data[i * 4 + 3]);
+        }
+        for (i = 16; i < 64; i++) {
+            W[i] = SSIG1(W[i - 2]) + W[i - 7] + SSIG0(W[i - 15]) + W[i - 16];
+        }
+        
+        uint32_t a0 = a, b0 = b, c0 = c, d0 = d, e0 = e, f0 = f, g0 = g, h0 = h;
+        
+        // Main loop (64 rounds, 8 per iteration)
+        for (i = 0; i < 64; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, sha256_k[i + 0], W[i + 0]);
+            ROUND(h, a, b, c, d, e, f, g, sha256_k[i + 1], W[i + 1]);
+            ROUND(g, h, a, b, c, d, e, f, sha256_k[i + 2], W[i + 2]);
+            ROUND(f, g, h, a, b, c, d, e, sha256_k[i + 3], W[i + 3]);
+            ROUND(e, f, g, h, a, b, c, d, sha256_k[i + 4], W[i + 4]);
+            ROUND(d, e, f, g, h, a, b, c, sha256_k[i + 5], W[i + 5]);
+            ROUND(c, d, e, f, g, h, a, b, sha256_k[i + 6], W[i + 6]);
+            ROUND(b, c, d, e, f, g, h, a, sha256_k[i + 7], W[i + 7]);
+        }
+        
+        a += a0; b += b0; c += c0; d += d0;
+        e += e0; f += f0; g += g0; h += h0;
+        data += 64;
     }
     
-    for (i = 16; i < 64; i++) {
-        W[i] = SSIG1(W[i - 2]) + W[i - 7] + SSIG0(W[i - 15]) + W[i - 16];
+    // Update hash state
+    state[0] = a;
+    state[1] = b;
+    state[2] = c;
+    state[3] = d;
+    state[4] = e;
+    state[5] = f;
+    state[6] = g;
+    state[7] = h;
+}
+
+typedef void (*sha256_blocks_fn_t)(uint32_t*, const uint8_t*, size_t);
+
+typedef struct {
+    sha256_blocks_fn_t fn;
+    const char* name;
+} sha256_impl_t;
+
+static const sha256_impl_t impl_portable = { sha256_blocks_portable, "portable" };
+#ifdef CRYPTOCORE_HAVE_SHA256_SIMD
+static const sha256_impl_t impl_shani = { sha256_shani_blocks, "sha-ni" };
+static const sha256_impl_t impl_avx2 = { sha256_avx2_blocks, "avx2" };
+#endif
+
+// Selected once; the pointer is read and published atomically
+static const sha256_impl_t* active_impl = NULL;
+
+static const sha256_impl_t* get_impl(void) {
+    const sha256_impl_t* impl = __atomic_load_n(&active_impl, __ATOMIC_ACQUIRE);
+    if (impl) {
+        return impl;
     }
-    
-    // Initialize working variables
-    a = ctx->state[0];
-    b = ctx->state[1];
-    c = ctx->state[2];
-    d = ctx->state[3];
-    e = ctx->state[4];
-    f = ctx->state[5];
-    g = ctx->state[6];
-    h = ctx->state[7];
-    
-    // Main loop (64 rounds)
-    for (i = 0; i < 64; i++) {
-        T1 = h + BSIG1(e) + CH(e, f, g) + K[i] + W[i];
-        T2 = BSIG0(a) + MAJ(a, b, c);
-        h = g;
-        g = f;
-        f = e;
-        e = d + T1;
-        d = c;
-        c = b;
-        b = a;
-        a = T1 + T2;
+    impl = &impl_portable;
+#ifdef CRYPTOCORE_HAVE_SHA256_SIMD
+    if (sha256_shani_available()) {
+        impl = &impl_shani;
+    } else if (sha256_avx2_available()) {
+        impl = &impl_avx2;
     }
-    
-    // Update hash state
-    ctx->state[0] += a;
-    ctx->state[1] += b;
-    ctx->state[2] += c;
-    ctx->state[3] += d;
-    ctx->state[4] += e;
-    ctx->state[5] += f;
-    ctx->state[6] += g;
-    ctx->state[7] += h;
+#endif
+    __atomic_store_n(&active_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+const char* sha256_impl_name(void) {
+    return get_impl()->name;
+}
+
+static void sha256_transform_blocks(uint32_t* state, const uint8_t* data, size_t nblocks) {
+    get_impl()->fn(state, data, nblocks);
 }
 
 // Update hash with new data
+// Full blocks are hashed straight from the caller's buffer; only the head and tail are copied
 void sha256_update(sha256_ctx_t* ctx, const uint8_t* data, size_t len) {
-    size_t i;
-    
-    for (i = 0; i < len; i++) {
-        ctx->buffer[ctx->buffer_len++] = data[i];
-        
-        // Process block when buffer is full
-        if (ctx->buffer_len == 64) {
-            sha256_transform(ctx, ctx->buffer);
-            ctx->bit_count += 512;
-            ctx->buffer_len = 0;
+    // Complete a partially filled buffer first
+    if (ctx->buffer_len > 0 && len > 0) {
+        size_t take = 64 - ctx->buffer_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buffer + ctx->buffer_len, data, take);
+        ctx->buffer_len += take;
+        data += take;
+        len -= take;
+        if (ctx->buffer_len < 64) {
+            return;
         }
+        sha256_transform_blocks(ctx->state, ctx->buffer, 1);
+        ctx->bit_count += 512;
+        ctx->buffer_len = 0;
+    }
+    
+    size_t nblocks = len / 64;
+    if (nblocks > 0) {
+        sha256_transform_blocks(ctx->state, data, nblocks);
+        ctx->bit_count += (uint64_t)nblocks * 512;
+        data += nblocks * 64;
+        len -= nblocks * 64;
+    }
+    
+    // Keep the tail for the next call
+    if (len > 0) {
+        memcpy(ctx->buffer, data, len);
+        ctx->buffer_len = len;
     }
 }
 
@@ -128,7 +193,7 @@ void sha256_final(sha256_ctx_t* ctx, uint8_t* hash) {
         while (ctx->buffer_len < 64) {
             ctx->buffer[ctx->buffer_len++] = 0x00;
         }
-        sha256_transform(ctx, ctx->buffer);
+        sha256_transform_blocks(ctx->state, ctx->buffer, 1);
         ctx->buffer_len = 0;
     }
     
@@ -143,7 +208,7 @@ void sha256_final(sha256_ctx_t* ctx, uint8_t* hash) {
     }
     
     // Process final block
-    sha256_transform(ctx, ctx->buffer);
+    sha256_transform_blocks(ctx->state, ctx->buffer, 1);
     
     // Convert hash state to output bytes (big-endian)
     for (i = 0; i < 8; i++) {
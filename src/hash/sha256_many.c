@@ -0,0 +1,145 @@
+#include "../../include/hash.h"
+#include "../../include/sha256_simd.h"
+#include <string.h>
+
+#define SHA256_MAX_LANES 16
+
+typedef void (*sha256_mb_fn_t)(uint32_t*, const uint8_t* const*, size_t);
+
+// One lane of the multi-buffer engine: full blocks straight from the message, then the padded tail
+typedef struct {
+    int active;
+    size_t msg;                  // Index of the message in this lane
+    const uint8_t* next;         // Next full block of the message
+    size_t full_blocks;          // Full blocks left in the message
+    uint8_t tail[128];           // Last partial block, padding and length (1 or 2 blocks)
+    size_t tail_blocks;          // Padded blocks in tail
+    size_t tail_left;            // Padded blocks not yet hashed
+} sha256_lane_t;
+
+static void lane_start(sha256_lane_t* lane, size_t msg, const uint8_t* data, size_t len) {
+    size_t rem = len % 64;
+    uint64_t bits = (uint64_t)len * 8;
+
+    lane->active = 1;
+    lane->msg = msg;
+    lane->next = data;
+    lane->full_blocks = len / 64;
+
+    // Same padding as sha256_final: 0x80, zeros, 64-bit big-endian length
+    memset(lane->tail, 0, sizeof(lane->tail));
+    if (rem > 0) {
+        memcpy(lane->tail, data + len - rem, rem);
+    }
+    lane->tail[rem] = 0x80;
+    lane->tail_blocks = rem + 9 > 64 ? 2 : 1;
+    lane->tail_left = lane->tail_blocks;
+    for (int i = 0; i < 8; i++) {
+        lane->tail[64 * lane->tail_blocks - 1 - i] = (uint8_t)(bits >> (8 * i));
+    }
+}
+
+// Blocks the lane can take before it switches from message to tail or finishes
+static size_t lane_run(const sha256_lane_t* lane) {
+    return lane->full_blocks > 0 ? lane->full_blocks : lane->tail_left;
+}
+
+static const uint8_t* lane_ptr(const sha256_lane_t* lane) {
+    return lane->full_blocks > 0 ? lane->next : lane->tail + 64 * (lane->tail_blocks - lane->tail_left);
+}
+
+/**
+ * Hash count independent messages; lanes are refilled as soon as their message is done,
+ * so messages of different lengths keep all lanes busy
+ */
+void sha256_many(const uint8_t* const* msgs, const size_t* lens, size_t count, uint8_t (*digests)[32]) {
+    sha256_mb_fn_t fn = NULL;
+    size_t lanes = 0;
+#ifdef CRYPTOCORE_HAVE_SHA256_SIMD
+    // A single sha256rnds2 stream outruns 8 AVX2 lanes; only 16 AVX-512 lanes beat it
+    if (sha256_avx512_available()) {
+        fn = sha256_x16_avx512_blocks;
+        lanes = SHA256_AVX512_LANES;
+    } else if (sha256_avx2_available() && !sha256_shani_available()) {
+        fn = sha256_x8_avx2_blocks;
+        lanes = SHA256_AVX2_LANES;
+    }
+#endif
+
+    // No multi-buffer kernel or a single message: one at a time through the regular path
+    if (!fn || count < 2) {
+        for (size_t i = 0; i < count; i++) {
+            sha256_ctx_t ctx;
+            sha256_init(&ctx);
+            sha256_update(&ctx, msgs[i], lens[i]);
+            sha256_final(&ctx, digests[i]);
+        }
+        return;
+    }
+
+    sha256_ctx_t iv;
+    sha256_init(&iv);
+
+    sha256_lane_t lane[SHA256_MAX_LANES];
+    uint32_t state[8 * SHA256_MAX_LANES];
+    const uint8_t* ptr[SHA256_MAX_LANES];
+    size_t next_msg = 0;
+    memset(lane, 0, sizeof(lane));
+
+    for (;;) {
+        // Refill idle lanes and find the common run length
+        size_t run = 0;
+        int first = -1;
+        for (size_t j = 0; j < lanes; j++) {
+            if (!lane[j].active && next_msg < count) {
+                lane_start(&lane[j], next_msg, msgs[next_msg], lens[next_msg]);
+                for (int w = 0; w < 8; w++) {
+                    state[w * lanes + j] = iv.state[w];
+                }
+                next_msg++;
+            }
+            if (lane[j].active) {
+                size_t n = lane_run(&lane[j]);
+                if (first < 0 || n < run) {
+                    run = n;
+                }
+                if (first < 0) {
+                    first = (int)j;
+                }
+            }
+        }
+        if (first < 0) {
+            break;
+        }
+
+        // Idle lanes repeat an active lane's blocks; their state is discarded
+        for (size_t j = 0; j < lanes; j++) {
+            ptr[j] = lane_ptr(&lane[lane[j].active ? j : (size_t)first]);
+        }
+        fn(state, ptr, run);
+
+        for (size_t j = 0; j < lanes; j++) {
+            sha256_lane_t* l = &lane[j];
+            if (!l->active) {
+                continue;
+            }
+            if (l->full_blocks > 0) {
+                l->next += 64 * run;
+                l->full_blocks -= run;
+                continue;
+            }
+            l->tail_left -= run;
+            if (l->tail_left == 0) {
+                uint8_t* out = digests[l->msg];
+                for (int w = 0; w < 8; w++) {
+                    uint32_t v = state[w * lanes + j];
+                    out[4 * w] = (uint8_t)(v >> 24);
+                    out[4 * w + 1] = (uint8_t)(v >> 16);
+                    out[4 * w + 2] = (uint8_t)(v >> 8);
+                    out[4 * w + 3] = (uint8_t)v;
+                }
+                l->active = 0;
+            }
+        }
+    }
+}
@@ -0,0 +1,358 @@
+#include "../../include/sha256_simd.h"
+#include "../../include/cpu_features.h"
+
+#ifdef CRYPTOCORE_HAVE_SHA256_SIMD
+
+#include <immintrin.h>
+
+#define SHANI_TARGET __attribute__((target("sha,sse4.1,ssse3")))
+#define AVX2_TARGET __attribute__((target("avx2")))
+#define AVX512_TARGET __attribute__((target("avx512f")))
+
+int sha256_shani_available(void) {
+    const cpu_features_t* f = cpu_features_get();
+    return f->sha && f->ssse3 && f->sse41;
+}
+
+int sha256_avx2_available(void) {
+    return cpu_features_get()->avx2;
+}
+
+int sha256_avx512_available(void) {
+    return cpu_features_get()->avx512f;
+}
+
+/* ---------------- SHA extensions ---------------- */
+
+/*
+ * Four rounds on message group g (words 4g..4g+3)
+ * m0 = group g, m1 = group g + 1, m3 = group g - 1 (registers rotate between calls)
+ * While the rounds run, group g + 1 is completed (msg2) and group g + 3 is started (msg1)
+ */
+#define SHANI_ROUNDS(g, m0, m1, m3)                                                 \
+    do {                                                                            \
+        __m128i wk = _mm_add_epi32(m0, _mm_loadu_si128((const __m128i*)&sha256_k[4 * (g)])); \
+        state1 = _mm_sha256rnds2_epu32(state1, state0, wk);                         \
+        if ((g) >= 3 && (g) <= 14) {                                                \
+            m1 = _mm_add_epi32(m1, _mm_alignr_epi8(m0, m3, 4));                     \
+            m1 = _mm_sha256msg2_epu32(m1, m0);                                      \
+        }                                                                           \
+        wk = _mm_shuffle_epi32(wk, 0x0E);                                           \
+        state0 = _mm_sha256rnds2_epu32(state0, state1, wk);                         \
+        if ((g) >= 1 && (g) <= 12) {                                                \
+            m3 = _mm_sha256msg1_epu32(m3, m0);                                      \
+        }                                                                           \
+    } while (0)
+
+SHANI_TARGET void sha256_shani_blocks(uint32_t* state, const uint8_t* data, size_t nblocks) {
+    // Big-endian words of the message
+    const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+
+    // sha256rnds2 keeps the state as ABEF / CDGH (lanes listed high to low)
+    __m128i tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[0]), 0xB1);  // CDAB
+    __m128i state1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i*)&state[4]), 0x1B);  // EFGH
+    __m128i state0 = _mm_alignr_epi8(tmp, state1, 8);                                    // ABEF
+    state1 = _mm_blend_epi16(state1, tmp, 0xF0);                                         // CDGH
+
+    while (nblocks-- > 0) {
+        __m128i abef = state0;
+        __m128i cdgh = state1;
+
+        __m128i m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 0)), bswap);
+        __m128i m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 16)), bswap);
+        __m128i m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 32)), bswap);
+        __m128i m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i*)(data + 48)), bswap);
+
+        SHANI_ROUNDS(0, m0, m1, m3);
+        SHANI_ROUNDS(1, m1, m2, m0);
+        SHANI_ROUNDS(2, m2, m3, m1);
+        SHANI_ROUNDS(3, m3, m0, m2);
+        SHANI_ROUNDS(4, m0, m1, m3);
+        SHANI_ROUNDS(5, m1, m2, m0);
+        SHANI_ROUNDS(6, m2, m3, m1);
+        SHANI_ROUNDS(7, m3, m0, m2);
+        SHANI_ROUNDS(8, m0, m1, m3);
+        SHANI_ROUNDS(9, m1, m2, m0);
+        SHANI_ROUNDS(10, m2, m3, m1);
+        SHANI_ROUNDS(11, m3, m0, m2);
+        SHANI_ROUNDS(12, m0, m1, m3);
+        SHANI_ROUNDS(13, m1, m2, m0);
+        SHANI_ROUNDS(14, m2, m3, m1);
+        SHANI_ROUNDS(15, m3, m0, m2);
+
+        state0 = _mm_add_epi32(state0, abef);
+        state1 = _mm_add_epi32(state1, cdgh);
+        data += 64;
+    }
+
+    // Back to ABCD / EFGH
+    tmp = _mm_shuffle_epi32(state0, 0x1B);                  // FEBA
+    state1 = _mm_shuffle_epi32(state1, 0xB1);               // DCHG
+    state0 = _mm_blend_epi16(tmp, state1, 0xF0);            // DCBA
+    state1 = _mm_alignr_epi8(state1, tmp, 8);               // HGFE
+    _mm_storeu_si128((__m128i*)&state[0], state0);
+    _mm_storeu_si128((__m128i*)&state[4], state1);
+}
+
+/* ---------------- AVX2 message schedule ---------------- */
+
+#define ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define BSIG0(x) (ROTR(x, 2) ^ ROTR(x, 13) ^ ROTR(x, 22))
+#define BSIG1(x) (ROTR(x, 6) ^ ROTR(x, 11) ^ ROTR(x, 25))
+
+#define VROTR(x, n) _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32 - (n)))
+#define VSSIG0(x) _mm256_xor_si256(_mm256_xor_si256(VROTR(x, 7), VROTR(x, 18)), _mm256_srli_epi32(x, 3))
+#define VSSIG1(x) _mm256_xor_si256(_mm256_xor_si256(VROTR(x, 17), VROTR(x, 19)), _mm256_srli_epi32(x, 10))
+
+// One round with W[i] + K[i] already summed
+#define ROUND_WK(a, b, c, d, e, f, g, h, wk)                        \
+    do {                                                            \
+        uint32_t t1 = (h) + BSIG1(e) + CH(e, f, g) + (wk);          \
+        (d) += t1;                                                  \
+        (h) = t1 + BSIG0(a) + MAJ(a, b, c);                         \
+    } while (0)
+
+/**
+ * Scalar rounds over a precomputed W + K schedule; stride 8 words per group of 4
+ * (the AVX2 schedule stores the two blocks' groups interleaved)
+ */
+static inline void rounds_wk(uint32_t* state, const uint32_t* wk) {
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (int i = 0; i < 16; i += 2) {
+        const uint32_t* w = wk + 8 * i;
+        ROUND_WK(a, b, c, d, e, f, g, h, w[0]);
+        ROUND_WK(h, a, b, c, d, e, f, g, w[1]);
+        ROUND_WK(g, h, a, b, c, d, e, f, w[2]);
+        ROUND_WK(f, g, h, a, b, c, d, e, w[3]);
+        ROUND_WK(e, f, g, h, a, b, c, d, w[8]);
+        ROUND_WK(d, e, f, g, h, a, b, c, w[9]);
+        ROUND_WK(c, d, e, f, g, h, a, b, w[10]);
+        ROUND_WK(b, c, d, e, f, g, h, a, w[11]);
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+/**
+ * Message schedule of two blocks: lane 0 holds block p0, lane 1 block p1
+ * wk[8 * g .. 8 * g + 3] = W + K of group g for p0, wk[8 * g + 4 .. + 7] for p1
+ */
+static inline AVX2_TARGET void schedule2_avx2(const uint8_t* p0, const uint8_t* p1, uint32_t* wk) {
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    const __m256i lo2 = _mm256_setr_epi32(-1, -1, 0, 0, -1, -1, 0, 0);
+    __m256i x[4];
+    for (int g = 0; g < 4; g++) {
+        __m256i m = _mm256_inserti128_si256(_mm256_castsi128_si256(_mm_loadu_si128((const __m128i*)(p0 + 16 * g))),
+                                            _mm_loadu_si128((const __m128i*)(p1 + 16 * g)), 1);
+        x[g] = _mm256_shuffle_epi8(m, bswap);
+    }
+    for (int g = 0; g < 16; g++) {
+        __m256i k = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)&sha256_k[4 * g]));
+        if (g >= 4) {
+            // W[t..t+3] = SSIG1(W[t-2..t+1]) + W[t-7..t-4] + SSIG0(W[t-15..t-12]) + W[t-16..t-13]
+            __m256i x0 = x[g & 3], x1 = x[(g + 1) & 3], x2 = x[(g + 2) & 3], x3 = x[(g + 3) & 3];
+            __m256i t = _mm256_add_epi32(x0, VSSIG0(_mm256_alignr_epi8(x1, x0, 4)));
+            t = _mm256_add_epi32(t, _mm256_alignr_epi8(x3, x2, 4));
+            // W[t], W[t+1] depend on W[t-2], W[t-1]; W[t+2], W[t+3] on the two words just computed
+            __m256i s1 = VSSIG1(_mm256_shuffle_epi32(x3, 0x4E));
+            t = _mm256_add_epi32(t, _mm256_and_si256(s1, lo2));
+            s1 = VSSIG1(_mm256_shuffle_epi32(t, 0x4E));
+            t = _mm256_add_epi32(t, _mm256_andnot_si256(lo2, s1));
+            x[g & 3] = t;
+        }
+        _mm256_storeu_si256((__m256i*)(wk + 8 * g), _mm256_add_epi32(x[g & 3], k));
+    }
+}
+
+AVX2_TARGET void sha256_avx2_blocks(uint32_t* state, const uint8_t* data, size_t nblocks) {
+    uint32_t wk[128] __attribute__((aligned(32)));
+    while (nblocks > 0) {
+        // Odd last block: the second lane repeats it and its schedule is ignored
+        const uint8_t* p1 = nblocks > 1 ? data + 64 : data;
+        schedule2_avx2(data, p1, wk);
+        rounds_wk(state, wk);
+        if (nblocks > 1) {
+            rounds_wk(state, wk + 4);
+            data += 128;
+            nblocks -= 2;
+        } else {
+            data += 64;
+            nblocks -= 1;
+        }
+    }
+}
+
+/* ---------------- Multi-buffer: 8 lanes (AVX2), 16 lanes (AVX-512) ---------------- */
+
+/**
+ * 8x8 transpose of 32-bit words: on input r[j] = words 0..7 of lane j, on output r[w] = word w of lanes 0..7
+ */
+static inline AVX2_TARGET void transpose8_avx2(__m256i* r) {
+    __m256i t0 = _mm256_unpacklo_epi32(r[0], r[1]);
+    __m256i t1 = _mm256_unpackhi_epi32(r[0], r[1]);
+    __m256i t2 = _mm256_unpacklo_epi32(r[2], r[3]);
+    __m256i t3 = _mm256_unpackhi_epi32(r[2], r[3]);
+    __m256i t4 = _mm256_unpacklo_epi32(r[4], r[5]);
+    __m256i t5 = _mm256_unpackhi_epi32(r[4], r[5]);
+    __m256i t6 = _mm256_unpacklo_epi32(r[6], r[7]);
+    __m256i t7 = _mm256_unpackhi_epi32(r[6], r[7]);
+    __m256i u0 = _mm256_unpacklo_epi64(t0, t2);
+    __m256i u1 = _mm256_unpackhi_epi64(t0, t2);
+    __m256i u2 = _mm256_unpacklo_epi64(t1, t3);
+    __m256i u3 = _mm256_unpackhi_epi64(t1, t3);
+    __m256i u4 = _mm256_unpacklo_epi64(t4, t6);
+    __m256i u5 = _mm256_unpackhi_epi64(t4, t6);
+    __m256i u6 = _mm256_unpacklo_epi64(t5, t7);
+    __m256i u7 = _mm256_unpackhi_epi64(t5, t7);
+    r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+    r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+    r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+    r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+    r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+    r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+    r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+    r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+}
+
+/**
+ * Message words of one block from 8 lanes, byte-swapped: w[i] = word i of lanes 0..7
+ */
+static inline AVX2_TARGET void load8_avx2(__m256i* w, const uint8_t* const* data, size_t offset) {
+    const __m256i bswap = _mm256_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+                                           3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12);
+    for (int half = 0; half < 2; half++) {
+        for (int j = 0; j < 8; j++) {
+            w[8 * half + j] = _mm256_loadu_si256((const __m256i*)(data[j] + offset + 32 * half));
+        }
+        transpose8_avx2(w + 8 * half);
+    }
+    for (int i = 0; i < 16; i++) {
+        w[i] = _mm256_shuffle_epi8(w[i], bswap);
+    }
+}
+
+#define X8_BSIG0(x) _mm256_xor_si256(_mm256_xor_si256(VROTR(x, 2), VROTR(x, 13)), VROTR(x, 22))
+#define X8_BSIG1(x) _mm256_xor_si256(_mm256_xor_si256(VROTR(x, 6), VROTR(x, 11)), VROTR(x, 25))
+#define X8_CH(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_andnot_si256(x, z))
+#define X8_MAJ(x, y, z) _mm256_xor_si256(_mm256_and_si256(x, y), _mm256_and_si256(z, _mm256_xor_si256(x, y)))
+
+#define X8_ROUND(a, b, c, d, e, f, g, h, i)                                                     \
+    do {                                                                                        \
+        __m256i wi = W[(i) & 15];                                                               \
+        if ((i) >= 16) {                                                                        \
+            wi = _mm256_add_epi32(_mm256_add_epi32(wi, W[((i) - 7) & 15]),                      \
+                                  _mm256_add_epi32(VSSIG0(W[((i) - 15) & 15]), VSSIG1(W[((i) - 2) & 15]))); \
+            W[(i) & 15] = wi;                                                                   \
+        }                                                                                       \
+        __m256i t1 = _mm256_add_epi32(_mm256_add_epi32(h, X8_BSIG1(e)),                         \
+                                      _mm256_add_epi32(X8_CH(e, f, g), _mm256_add_epi32(wi, _mm256_set1_epi32((int)sha256_k[i])))); \
+        d = _mm256_add_epi32(d, t1);                                                            \
+        h = _mm256_add_epi32(t1, _mm256_add_epi32(X8_BSIG0(a), X8_MAJ(a, b, c)));               \
+    } while (0)
+
+AVX2_TARGET void sha256_x8_avx2_blocks(uint32_t* state, const uint8_t* const* data, size_t nblocks) {
+    __m256i s[8];
+    for (int w = 0; w < 8; w++) {
+        s[w] = _mm256_loadu_si256((const __m256i*)(state + 8 * w));
+    }
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        __m256i W[16];
+        load8_avx2(W, data, 64 * blk);
+        __m256i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i += 8) {
+            X8_ROUND(a, b, c, d, e, f, g, h, i + 0);
+            X8_ROUND(h, a, b, c, d, e, f, g, i + 1);
+            X8_ROUND(g, h, a, b, c, d, e, f, i + 2);
+            X8_ROUND(f, g, h, a, b, c, d, e, i + 3);
+            X8_ROUND(e, f, g, h, a, b, c, d, i + 4);
+            X8_ROUND(d, e, f, g, h, a, b, c, i + 5);
+            X8_ROUND(c, d, e, f, g, h, a, b, i + 6);
+            X8_ROUND(b, c, d, e, f, g, h, a, i + 7);
+        }
+        s[0] = _mm256_add_epi32(s[0], a); s[1] = _mm256_add_epi32(s[1], b);
+        s[2] = _mm256_add_epi32(s[2], c); s[3] = _mm256_add_epi32(s[3], d);
+        s[4] = _mm256_add_epi32(s[4], e); s[5] = _mm256_add_epi32(s[5], f);
+        s[6] = _mm256_add_epi32(s[6], g); s[7] = _mm256_add_epi32(s[7], h);
+    }
+    for (int w = 0; w < 8; w++) {
+        _mm256_storeu_si256((__m256i*)(state + 8 * w), s[w]);
+    }
+}
+
+/* AVX-512: native rotates, three-input logic in one vpternlogd */
+#define X16_XOR3(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0x96)
+#define X16_BSIG0(x) X16_XOR3(_mm512_ror_epi32(x, 2), _mm512_ror_epi32(x, 13), _mm512_ror_epi32(x, 22))
+#define X16_BSIG1(x) X16_XOR3(_mm512_ror_epi32(x, 6), _mm512_ror_epi32(x, 11), _mm512_ror_epi32(x, 25))
+#define X16_SSIG0(x) X16_XOR3(_mm512_ror_epi32(x, 7), _mm512_ror_epi32(x, 18), _mm512_srli_epi32(x, 3))
+#define X16_SSIG1(x) X16_XOR3(_mm512_ror_epi32(x, 17), _mm512_ror_epi32(x, 19), _mm512_srli_epi32(x, 10))
+#define X16_CH(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xCA)
+#define X16_MAJ(x, y, z) _mm512_ternarylogic_epi32(x, y, z, 0xE8)
+
+#define X16_ROUND(a, b, c, d, e, f, g, h, i)                                                    \
+    do {                                                                                        \
+        __m512i wi = W[(i) & 15];                                                               \
+        if ((i) >= 16) {                                                                        \
+            wi = _mm512_add_epi32(_mm512_add_epi32(wi, W[((i) - 7) & 15]),                      \
+                                  _mm512_add_epi32(X16_SSIG0(W[((i) - 15) & 15]), X16_SSIG1(W[((i) - 2) & 15]))); \
+            W[(i) & 15] = wi;                                                                   \
+        }                                                                                       \
+        __m512i t1 = _mm512_add_epi32(_mm512_add_epi32(h, X16_BSIG1(e)),                        \
+                                      _mm512_add_epi32(X16_CH(e, f, g), _mm512_add_epi32(wi, _mm512_set1_epi32((int)sha256_k[i])))); \
+        d = _mm512_add_epi32(d, t1);                                                            \
+        h = _mm512_add_epi32(t1, _mm512_add_epi32(X16_BSIG0(a), X16_MAJ(a, b, c)));             \
+    } while (0)
+
+AVX512_TARGET void sha256_x16_avx512_blocks(uint32_t* state, const uint8_t* const* data, size_t nblocks) {
+    __m512i s[8];
+    for (int w = 0; w < 8; w++) {
+        s[w] = _mm512_loadu_si512((const void*)(state + 16 * w));
+    }
+    for (size_t blk = 0; blk < nblocks; blk++) {
+        // Lanes 0..7 and 8..15 are transposed as two AVX2 groups and joined per word
+        __m512i W[16];
+        __m256i lo[16], hi[16];
+        load8_avx2(lo, data, 64 * blk);
+        load8_avx2(hi, data + 8, 64 * blk);
+        for (int i = 0; i < 16; i++) {
+            W[i] = _mm512_inserti64x4(_mm512_castsi256_si512(lo[i]), hi[i], 1);
+        }
+        __m512i a = s[0], b = s[1], c = s[2], d = s[3], e = s[4], f = s[5], g = s[6], h = s[7];
+        for (int i = 0; i < 64; i += 8) {
+            X16_ROUND(a, b, c, d, e, f, g, h, i + 0);
+            X16_ROUND(h, a, b, c, d, e, f, g, i + 1);
+            X16_ROUND(g, h, a, b, c, d, e, f, i + 2);
+            X16_ROUND(f, g, h, a, b, c, d, e, i + 3);
+            X16_ROUND(e, f, g, h, a, b, c, d, i + 4);
+            X16_ROUND(d, e, f, g, h, a, b, c, i + 5);
+            X16_ROUND(c, d, e, f, g, h, a, b, i + 6);
+            X16_ROUND(b, c, d, e, f, g, h, a, i + 7);
+        }
+        s[0] = _mm512_add_epi32(s[0], a); s[1] = _mm512_add_epi32(s[1], b);
+        s[2] = _mm512_add_epi32(s[2], c); s[3] = _mm512_add_epi32(s[3], d);
+        s[4] = _mm512_add_epi32(s[4], e); s[5] = _mm512_add_epi32(s[5], f);
+        s[6] = _mm512_add_epi32(s[6], g); s[7] = _mm512_add_epi32(s[7], h);
+    }
+    for (int w = 0; w < 8; w++) {
+        _mm512_storeu_si512((void*)(state + 16 * w), s[w]);
+    }
+}
+
+#else
+
+int sha256_shani_available(void) {
+    return 0;
+}
+
+int sha256_avx2_available(void) {
+    return 0;
+}
+
+int sha256_avx512_available(void) {
+    return 0;
+}
+
+#endif /* CRYPTOCORE_HAVE_SHA256_SIMD */
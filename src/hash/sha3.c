@@ -1,67 +1,305 @@
 #include "../../include/hash.h"
+#include "../../include/keccak_simd.h"
 #include <stdio.h>
 #include <string.h>
-#include <openssl/evp.h>
 
-// Hash a file using SHA3-256 (via OpenSSL)
+/*
+ * SHA-3 and SHAKE (FIPS 202), cSHAKE (SP 800-185) on a native Keccak-f[1600] sponge
+ */
+
+#define ROTL64(x, n) (((x) << (n)) | ((x) >> (64 - (n))))
+
+#define SHA3_SUFFIX 0x06                // Domain bits 01 plus the first padding bit
+#define SHAKE_SUFFIX 0x1f               // Domain bits 1111 plus the first padding bit
+#define CSHAKE_SUFFIX 0x04              // Domain bits 00 plus the first padding bit
+
+const uint64_t keccak_rc[24] = {
+    0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+    0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+    0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+    0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+    0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+    0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+/**
+ * Keccak-f[1600] permutation; lane (x, y) is st[x + 5 * y]
+ * The 25 lanes live in locals and every step of a round is spelled out,
+ * so rho/pi are plain rotations into renamed registers
+ */
+void keccak_f1600(uint64_t* st) {
+    uint64_t a00, a01, a02, a03, a04, a05, a06, a07, a08, a09, a10, a11, a12, a13, a14, a15, a16, a17, a18, a19, a20, a21, a22, a23, a24;
+    uint64_t b00, b01, b02, b03, b04, b05, b06, b07, b08, b09, b10, b11, b12, b13, b14, b15, b16, b17, b18, b19, b20, b21, b22, b23, b24;
+    uint64_t c0, c1, c2, c3, c4, d0, d1, d2, d3, d4;
+
+    a00 = st[0]; a01 = st[1]; a02 = st[2]; a03 = st[3]; a04 = st[4];
+    a05 = st[5]; a06 = st[6]; a07 = st[7]; a08 = st[8]; a09 = st[9];
+    a10 = st[10]; a11 = st[11]; a12 = st[12]; a13 = st[13]; a14 = st[14];
+    a15 = st[15]; a16 = st[16]; a17 = st[17]; a18 = st[18]; a19 = st[19];
+    a20 = st[20]; a21 = st[21]; a22 = st[22]; a23 = st[23]; a24 = st[24];
+
+    for (int round = 0; round < 24; round++) {
+        /* theta */
+        c0 = a00 ^ a05 ^ a10 ^ a15 ^ a20;
+        c1 = a01 ^ a06 ^ a11 ^ a16 ^ a21;
+        c2 = a02 ^ a07 ^ a12 ^ a17 ^ a22;
+        c3 = a03 ^ a08 ^ a13 ^ a18 ^ a23;
+        c4 = a04 ^ a09 ^ a14 ^ a19 ^ a24;
+        d0 = c4 ^ ROTL64(c1, 1);
+        d1 = c0 ^ ROTL64(c2, 1);
+        d2 = c1 ^ ROTL64(c3, 1);
+        d3 = c2 ^ ROTL64(c4, 1);
+        d4 = c3 ^ ROTL64(c0, 1);
+        /* rho, pi */
+        b00 = a00 ^ d0;
+        b01 = ROTL64(a06 ^ d1, 44);
+        b02 = ROTL64(a12 ^ d2, 43);
+        b03 = ROTL64(a18 ^ d3, 21);
+        b04 = ROTL64(a24 ^ d4, 14);
+        b05 = ROTL64(a03 ^ d3, 28);
+        b06 = ROTL64(a09 ^ d4, 20);
+        b07 = ROTL64(a10 ^ d0, 3);
+        b08 = ROTL64(a16 ^ d1, 45);
+        b09 = ROTL64(a22 ^ d2, 61);
+        b10 = ROTL64(a01 ^ d1, 1);
+        b11 = ROTL64(a07 ^ d2, 6);
+        b12 = ROTL64(a13 ^ d3, 25);
+        b13 = ROTL64(a19 ^ d4, 8);
+        b14 = ROTL64(a20 ^ d0, 18);
+        b15 = ROTL64(a04 ^ d4, 27);
+        b16 = ROTL64(a05 ^ d0, 36);
+        b17 = ROTL64(a11 ^ d1, 10);
+        b18 = ROTL64(a17 ^ d2, 15);
+        b19 = ROTL64(a23 ^ d3, 56);
+        b20 = ROTL64(a02 ^ d2, 62);
+        b21 = ROTL64(a08 ^ d3, 55);
+        b22 = ROTL64(a14 ^ d4, 39);
+        b23 = ROTL64(a15 ^ d0, 41);
+        b24 = ROTL64(a21 ^ d1, 2);
+        /* chi */
+        a00 = b00 ^ (~b01 & b02);
+        a01 = b01 ^ (~b02 & b03);
+        a02 = b02 ^ (~b03 & b04);
+        a03 = b03 ^ (~b04 & b00);
+        a04 = b04 ^ (~b00 & b01);
+        a05 = b05 ^ (~b06 & b07);
+        a06 = b06 ^ (~b07 & b08);
+        a07 = b07 ^ (~b08 & b09);
+        a08 = b08 ^ (~b09 & b05);
+        a09 = b09 ^ (~b05 & b06);
+        a10 = b10 ^ (~b11 & b12);
+        a11 = b11 ^ (~b12 & b13);
+        a12 = b12 ^ (~b13 & b14);
+        a13 = b13 ^ (~b14 & b10);
+        a14 = b14 ^ (~b10 & b11);
+        a15 = b15 ^ (~b16 & b17);
+        a16 = b16 ^ (~b17 & b18);
+        a17 = b17 ^ (~b18 & b19);
+        a18 = b18 ^ (~b19 & b15);
+        a19 = b19 ^ (~b15 & b16);
+        a20 = b20 ^ (~b21 & b22);
+        a21 = b21 ^ (~b22 & b23);
+        a22 = b22 ^ (~b23 & b24);
+        a23 = b23 ^ (~b24 & b20);
+        a24 = b24 ^ (~b20 & b21);
+        /* iota */
+        a00 ^= keccak_rc[round];
+    }
+
+    st[0] = a00; st[1] = a01; st[2] = a02; st[3] = a03; st[4] = a04;
+    st[5] = a05; st[6] = a06; st[7] = a07; st[8] = a08; st[9] = a09;
+    st[10] = a10; st[11] = a11; st[12] = a12; st[13] = a13; st[14] = a14;
+    st[15] = a15; st[16] = a16; st[17] = a17; st[18] = a18; st[19] = a19;
+    st[20] = a20; st[21] = a21; st[22] = a22; st[23] = a23; st[24] = a24;
+}
+
+static uint64_t load_le64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static void sponge_init(sha3_ctx_t* ctx, size_t rate, uint8_t suffix, size_t digest_len) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->rate = rate;
+    ctx->suffix = suffix;
+    ctx->digest_len = digest_len;
+}
+
+void sha3_init(sha3_ctx_t* ctx, size_t digest_len) {
+    // Capacity is twice the digest length
+    sponge_init(ctx, 200 - 2 * digest_len, SHA3_SUFFIX, digest_len);
+}
+
+void shake_init(sha3_ctx_t* ctx, unsigned int security_bits) {
+    // SHAKE128: 168-byte rate, SHAKE256: 136-byte rate
+    sponge_init(ctx, 200 - security_bits / 4, SHAKE_SUFFIX, 0);
+}
+
+void sha3_update(sha3_ctx_t* ctx, const uint8_t* data, size_t len) {
+    // Finish a partially absorbed block byte by byte
+    while (ctx->pos > 0 && len > 0) {
+        ctx->state[ctx->pos / 8] ^= (uint64_t)*data++ << (8 * (ctx->pos % 8));
+        len--;
+        if (++ctx->pos == ctx->rate) {
+            keccak_f1600(ctx->state);
+            ctx->pos = 0;
+        }
+    }
+    if (ctx->pos > 0) {
+        return;
+    }
+
+    // Full blocks are XORed into the state a lane at a time
+    size_t lanes = ctx->rate / 8;
+    while (len >= ctx->rate) {
+        for (size_t i = 0; i < lanes; i++) {
+            ctx->state[i] ^= load_le64(data + 8 * i);
+        }
+        keccak_f1600(ctx->state);
+        data += ctx->rate;
+        len -= ctx->rate;
+    }
+
+    for (size_t i = 0; i < len; i++) {
+        ctx->state[i / 8] ^= (uint64_t)data[i] << (8 * (i % 8));
+    }
+    ctx->pos = len;
+}
+
+size_t sp800_185_left_encode(uint8_t* out, uint64_t x) {
+    size_t n = 1;
+    while (n < 8 && (x >> (8 * n)) != 0) {
+        n++;
+    }
+    out[0] = (uint8_t)n;
+    for (size_t i = 0; i < n; i++) {
+        out[1 + i] = (uint8_t)(x >> (8 * (n - 1 - i)));
+    }
+    return n + 1;
+}
+
+size_t sp800_185_right_encode(uint8_t* out, uint64_t x) {
+    size_t n = sp800_185_left_encode(out, x) - 1;
+    memmove(out, out + 1, n);
+    out[n] = (uint8_t)n;
+    return n + 1;
+}
+
+// encode_string(s): bit length, then the bytes
+static void absorb_encoded_string(sha3_ctx_t* ctx, const uint8_t* s, size_t len) {
+    uint8_t enc[9];
+    sha3_update(ctx, enc, sp800_185_left_encode(enc, (uint64_t)len * 8));
+    sha3_update(ctx, s, len);
+}
+
+// Zero fill to the end of the block: XORing zeros is a no-op, only the permutation is left
+static void absorb_zero_pad(sha3_ctx_t* ctx) {
+    if (ctx->pos > 0) {
+        keccak_f1600(ctx->state);
+        ctx->pos = 0;
+    }
+}
+
+void sha3_absorb_bytepad(sha3_ctx_t* ctx, const uint8_t* s, size_t len) {
+    uint8_t enc[9];
+    sha3_update(ctx, enc, sp800_185_left_encode(enc, ctx->rate));
+    absorb_encoded_string(ctx, s, len);
+    absorb_zero_pad(ctx);
+}
+
+void cshake_init(sha3_ctx_t* ctx, unsigned int security_bits, const uint8_t* name, size_t name_len,
+                 const uint8_t* custom, size_t custom_len) {
+    shake_init(ctx, security_bits);
+    // With empty N and S cSHAKE is plain SHAKE
+    if (name_len == 0 && custom_len == 0) {
+        return;
+    }
+    ctx->suffix = CSHAKE_SUFFIX;
+
+    // bytepad(encode_string(N) || encode_string(S), rate)
+    uint8_t enc[9];
+    sha3_update(ctx, enc, sp800_185_left_encode(enc, ctx->rate));
+    absorb_encoded_string(ctx, name, name_len);
+    absorb_encoded_string(ctx, custom, custom_len);
+    absorb_zero_pad(ctx);
+}
+
+// Domain suffix and pad10*1, then switch the sponge to squeezing
+static void sponge_pad(sha3_ctx_t* ctx) {
+    ctx->state[ctx->pos / 8] ^= (uint64_t)ctx->suffix << (8 * (ctx->pos % 8));
+    ctx->state[(ctx->rate - 1) / 8] ^= 0x80ULL << (8 * ((ctx->rate - 1) % 8));
+    keccak_f1600(ctx->state);
+    ctx->pos = 0;
+    ctx->squeezing = 1;
+}
+
+void shake_squeeze(sha3_ctx_t* ctx, uint8_t* out, size_t len) {
+    if (!ctx->squeezing) {
+        sponge_pad(ctx);
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (ctx->pos == ctx->rate) {
+            keccak_f1600(ctx->state);
+            ctx->pos = 0;
+        }
+        out[i] = (uint8_t)(ctx->state[ctx->pos / 8] >> (8 * (ctx->pos % 8)));
+        ctx->pos++;
+    }
+}
+
+void sha3_final(sha3_ctx_t* ctx, uint8_t* hash) {
+    // Every SHA-3 digest fits in the first block of output
+    shake_squeeze(ctx, hash, ctx->digest_len);
+}
+
+// Absorb a whole file into an initialized context
 // Returns 0 on success, -1 on error
-int sha3_256_hash_file(const char* filepath, uint8_t* hash) {
-    EVP_MD_CTX* ctx = NULL;
-    const EVP_MD* md = NULL;
-    FILE* f = NULL;
-    uint8_t buffer[4096];
+static int absorb_file(sha3_ctx_t* ctx, const char* filepath) {
+    FILE* f = fopen(filepath, "rb");
+    uint8_t buffer[65536];
     size_t bytes_read;
-    unsigned int hash_len = 32;
-    
-    f = fopen(filepath, "rb");
+
     if (!f) {
         fprintf(stderr, "Error: Failed to open file '%s'\n", filepath);
         return -1;
     }
-    
-    // Get SHA3-256 algorithm
-    md = EVP_sha3_256();
-    if (!md) {
-        fprintf(stderr, "Error: SHA3-256 not available\n");
-        fclose(f);
-        return -1;
+
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        sha3_update(ctx, buffer, bytes_read);
     }
-    
-    // Create and initialize context
-    ctx = EVP_MD_CTX_new();
-    if (!ctx) {
-        fprintf(stderr, "Error: Failed to create hash context\n");
-        fclose(f);
+
+    int failed = ferror(f);
+    fclose(f);
+    if (failed) {
+        fprintf(stderr, "Error: Failed to read file '%s'\n", filepath);
         return -1;
     }
-    
-    if (EVP_DigestInit_ex(ctx, md, NULL) != 1) {
-        fprintf(stderr, "Error: Failed to initialize digest\n");
-        EVP_MD_CTX_free(ctx);
-        fclose(f);
+    return 0;
+}
+
+int sha3_hash_file(const char* filepath, size_t digest_len, uint8_t* hash) {
+    sha3_ctx_t ctx;
+    sha3_init(&ctx, digest_len);
+    if (absorb_file(&ctx, filepath) != 0) {
         return -1;
     }
-    
-    // Read file in chunks and update hash
-    while ((bytes_read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
-        if (EVP_DigestUpdate(ctx, buffer, bytes_read) != 1) {
-            fprintf(stderr, "Error: Failed to update digest\n");
-            EVP_MD_CTX_free(ctx);
-            fclose(f);
-            return -1;
-        }
-    }
-    
-    // Finalize hash
-    if (EVP_DigestFinal_ex(ctx, hash, &hash_len) != 1) {
-        fprintf(stderr, "Error: Failed to finalize digest\n");
-        EVP_MD_CTX_free(ctx);
-        fclose(f);
+    sha3_final(&ctx, hash);
+    return 0;
+}
+
+int sha3_256_hash_file(const char* filepath, uint8_t* hash) {
+    return sha3_hash_file(filepath, 32, hash);
+}
+
+int shake_hash_file(const char* filepath, unsigned int security_bits, uint8_t* out, size_t out_len) {
+    sha3_ctx_t ctx;
+    shake_init(&ctx, security_bits);
+    if (absorb_file(&ctx, filepath) != 0) {
         return -1;
     }
-    
-    EVP_MD_CTX_free(ctx);
-    fclose(f);
+    shake_squeeze(&ctx, out, out_len);
     return 0;
 }
-
@@ -0,0 +1,231 @@
+#include "../../include/hash.h"
+#include <stdio.h>
+#include <string.h>
+
+// SHA-512 constants (first 64 bits of fractional parts of cube roots of first 80 primes)
+static const uint64_t sha512_k[80] = {
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+    0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+    0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+    0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+    0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+    0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+    0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+    0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+    0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+    0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+    0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+    0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+    0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+    0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+// Initial states: SHA-512 (square roots of the first 8 primes), SHA-384 (primes 9..16),
+// SHA-512/256 (generated as in FIPS 180-4 section 5.3.6)
+static const uint64_t sha512_iv[8] = {
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+static const uint64_t sha384_iv[8] = {
+    0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+    0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+static const uint64_t sha512_256_iv[8] = {
+    0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+    0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+};
+
+// Helper macros
+#define ROTR64(x, n) (((x) >> (n)) | ((x) << (64 - (n))))
+#define CH(x, y, z) (((x) & (y)) ^ (~(x) & (z)))
+#define MAJ(x, y, z) (((x) & (y)) ^ ((x) & (z)) ^ ((y) & (z)))
+#define BSIG0(x) (ROTR64(x, 28) ^ ROTR64(x, 34) ^ ROTR64(x, 39))
+#define BSIG1(x) (ROTR64(x, 14) ^ ROTR64(x, 18) ^ ROTR64(x, 41))
+#define SSIG0(x) (ROTR64(x, 1) ^ ROTR64(x, 8) ^ ((x) >> 7))
+#define SSIG1(x) (ROTR64(x, 19) ^ ROTR64(x, 61) ^ ((x) >> 6))
+
+static void sha512_init_iv(sha512_ctx_t* ctx, const uint64_t* iv, size_t digest_len) {
+    memcpy(ctx->state, iv, sizeof(ctx->state));
+    ctx->byte_count = 0;
+    ctx->buffer_len = 0;
+    ctx->digest_len = digest_len;
+}
+
+void sha512_init(sha512_ctx_t* ctx) {
+    sha512_init_iv(ctx, sha512_iv, 64);
+}
+
+void sha384_init(sha512_ctx_t* ctx) {
+    sha512_init_iv(ctx, sha384_iv, 48);
+}
+
+void sha512_256_init(sha512_ctx_t* ctx) {
+    sha512_init_iv(ctx, sha512_256_iv, 32);
+}
+
+// One round; the caller rotates the roles of a..h instead of moving the values
+#define ROUND(a, b, c, d, e, f, g, h, k, w)                         \
+    do {                                                            \
+        uint64_t t1 = (h) + BSIG1(e) + CH(e, f, g) + (k) + (w);     \
+        (d) += t1;                                                  \
+        (h) = t1 + BSIG0(a) + MAJ(a, b, c);                         \
+    } while (0)
+
+// Process nblocks consecutive 1024-bit blocks; the state stays in locals between blocks
+static void sha512_blocks(uint64_t* state, const uint8_t* data, size_t nblocks) {
+    uint64_t W[80];
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+    int i;
+
+    while (nblocks-- > 0) {
+        // Prepare message schedule (W[0..79])
+        for (i = 0; i < 16; i++) {
+            const uint8_t* p = data + i * 8;
+            W[i] = ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) |
+                   ((uint64_t)p[3] << 32) | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) |
+                   ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+        }
+        for (i = 16; i < 80; i++) {
+            W[i] = SSIG1(W[i - 2]) + W[i - 7] + SSIG0(W[i - 15]) + W[i - 16];
+        }
+
+        uint64_t a0 = a, b0 = b, c0 = c, d0 = d, e0 = e, f0 = f, g0 = g, h0 = h;
+
+        // Main loop (80 rounds, 8 per iteration)
+        for (i = 0; i < 80; i += 8) {
+            ROUND(a, b, c, d, e, f, g, h, sha512_k[i + 0], W[i + 0]);
+            ROUND(h, a, b, c, d, e, f, g, sha512_k[i + 1], W[i + 1]);
+            ROUND(g, h, a, b, c, d, e, f, sha512_k[i + 2], W[i + 2]);
+            ROUND(f, g, h, a, b, c, d, e, sha512_k[i + 3], W[i + 3]);
+            ROUND(e, f, g, h, a, b, c, d, sha512_k[i + 4], W[i + 4]);
+            ROUND(d, e, f, g, h, a, b, c, sha512_k[i + 5], W[i + 5]);
+            ROUND(c, d, e, f, g, h, a, b, sha512_k[i + 6], W[i + 6]);
+            ROUND(b, c, d, e, f, g, h, a, sha512_k[i + 7], W[i + 7]);
+        }
+
+        a += a0; b += b0; c += c0; d += d0;
+        e += e0; f += f0; g += g0; h += h0;
+        data += 128;
+    }
+
+    state[0] = a;
+    state[1] = b;
+    state[2] = c;
+    state[3] = d;
+    state[4] = e;
+    state[5] = f;
+    state[6] = g;
+    state[7] = h;
+}
+
+// Update hash with new data
+// Full blocks are hashed straight from the caller's buffer; only the head and tail are copied
+void sha512_update(sha512_ctx_t* ctx, const uint8_t* data, size_t len) {
+    ctx->byte_count += len;
+
+    // Complete a partially filled buffer first
+    if (ctx->buffer_len > 0 && len > 0) {
+        size_t take = 128 - ctx->buffer_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buffer + ctx->buffer_len, data, take);
+        ctx->buffer_len += take;
+        data += take;
+        len -= take;
+        if (ctx->buffer_len < 128) {
+            return;
+        }
+        sha512_blocks(ctx->state, ctx->buffer, 1);
+        ctx->buffer_len = 0;
+    }
+
+    size_t nblocks = len / 128;
+    if (nblocks > 0) {
+        sha512_blocks(ctx->state, data, nblocks);
+        data += nblocks * 128;
+        len -= nblocks * 128;
+    }
+
+    // Keep the tail for the next call
+    if (len > 0) {
+        memcpy(ctx->buffer, data, len);
+        ctx->buffer_len = len;
+    }
+}
+
+// Finalize hash computation; writes digest_len bytes (64, 48 or 32)
+void sha512_final(sha512_ctx_t* ctx, uint8_t* hash) {
+    // 128-bit message length in bits; the upper 61 bits of the byte count become the high word
+    uint64_t bits_hi = ctx->byte_count >> 61;
+    uint64_t bits_lo = ctx->byte_count << 3;
+    size_t i;
+
+    // Append padding bit '1'
+    ctx->buffer[ctx->buffer_len++] = 0x80;
+
+    // Not enough space for the length: pad and process an extra block
+    if (ctx->buffer_len > 112) {
+        memset(ctx->buffer + ctx->buffer_len, 0, 128 - ctx->buffer_len);
+        sha512_blocks(ctx->state, ctx->buffer, 1);
+        ctx->buffer_len = 0;
+    }
+    memset(ctx->buffer + ctx->buffer_len, 0, 112 - ctx->buffer_len);
+
+    // Append message length (128 bits, big-endian)
+    for (i = 0; i < 8; i++) {
+        ctx->buffer[112 + i] = (uint8_t)(bits_hi >> (56 - i * 8));
+        ctx->buffer[120 + i] = (uint8_t)(bits_lo >> (56 - i * 8));
+    }
+    sha512_blocks(ctx->state, ctx->buffer, 1);
+
+    // Big-endian state words, truncated to the digest length
+    for (i = 0; i < ctx->digest_len; i++) {
+        hash[i] = (uint8_t)(ctx->state[i / 8] >> (56 - 8 * (i % 8)));
+    }
+}
+
+// Hash a file with SHA-512 (digest_len 64), SHA-384 (48) or SHA-512/256 (32)
+// Returns 0 on success, -1 on error
+int sha512_hash_file(const char* filepath, size_t digest_len, uint8_t* hash) {
+    sha512_ctx_t ctx;
+    if (digest_len == 64) {
+        sha512_init(&ctx);
+    } else if (digest_len == 48) {
+        sha384_init(&ctx);
+    } else if (digest_len == 32) {
+        sha512_256_init(&ctx);
+    } else {
+        fprintf(stderr, "Error: SHA-512 digest length must be 64, 48 or 32 bytes\n");
+        return -1;
+    }
+
+    FILE* f = fopen(filepath, "rb");
+    uint8_t buffer[65536];
+    size_t bytes_read;
+
+    if (!f) {
+        fprintf(stderr, "Error: Failed to open file '%s'\n", filepath);
+        return -1;
+    }
+
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        sha512_update(&ctx, buffer, bytes_read);
+    }
+
+    int failed = ferror(f);
+    fclose(f);
+    if (failed) {
+        fprintf(stderr, "Error: Failed to read file '%s'\n", filepath);
+        return -1;
+    }
+    sha512_final(&ctx, hash);
+    return 0;
+}
@@ -1,10 +1,10 @@
 #include "../../include/mac.h"
+#include "../../include/xor.h"
+#include "../../include/aes_core.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <openssl/aes.h>
 
-#define AES_BLOCK_SIZE 16
 #define RB 0x87  // Constant for 128-bit blocks (NIST SP 800-38B)
 
 /**
@@ -18,22 +18,44 @@ static void left_shift_one(const uint8_t* input, uint8_t* output) {
     }
 }
 
+#define CMAC_BATCH_BLOCKS 64  // Blocks per bulk CBC-MAC pass
+
+/**
+ * CBC-MAC over nblocks full blocks: state = E(state ^ block) for each block
+ * Runs through the CBC encryption path of the active AES engine
+ */
+static void cbc_mac_blocks(const aes_core_key_t* aes_key, uint8_t* state, const uint8_t* data, size_t nblocks) {
+    uint8_t scratch[CMAC_BATCH_BLOCKS * AES_BLOCK_SIZE];
+    aes_cbc_stream_t st;
+    
+    memcpy(st.iv, state, AES_BLOCK_SIZE);
+    while (nblocks > 0) {
+        size_t n = (nblocks < CMAC_BATCH_BLOCKS) ? nblocks : CMAC_BATCH_BLOCKS;
+        st.in = data;
+        st.out = scratch;
+        st.nblocks = n;
+        aes_core_cbc_encrypt_multi(aes_key, &st, 1);
+        data += n * AES_BLOCK_SIZE;
+        nblocks -= n;
+    }
+    memcpy(state, st.iv, AES_BLOCK_SIZE);
+}
+
 /**
  * Generate subkeys K1 and K2 according to NIST SP 800-38B
  */
 static int generate_subkeys(const uint8_t* key, uint8_t* k1, uint8_t* k2) {
-    AES_KEY aes_key;
+    aes_core_key_t aes_key;
     uint8_t L[AES_BLOCK_SIZE];
-    uint8_t temp[AES_BLOCK_SIZE];
     
     // Set up AES key
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
         return -1;
     }
     
     // L = AES-Encrypt(0^128, K)
     memset(L, 0, AES_BLOCK_SIZE);
-    AES_encrypt(L, L, &aes_key);
+    aes_core_encrypt_blocks(&aes_key, L, L, 1);
     
     // Generate K1
     left_shift_one(L, k1);
@@ -47,18 +69,10 @@ static int generate_subkeys(const uint8_t* key, uint8_t* k1, uint8_t* k2) {
         k2[AES_BLOCK_SIZE - 1] ^= RB;
     }
     
+    aes_core_key_clear(&aes_key);
     return 0;
 }
 
-/**
- * XOR two blocks
- */
-static void xor_blocks(uint8_t* out, const uint8_t* a, const uint8_t* b) {
-    for (int i = 0; i < AES_BLOCK_SIZE; i++) {
-        out[i] = a[i] ^ b[i];
-    }
-}
-
 /**
  * Initialize AES-CMAC context with a key
  */
@@ -77,10 +91,8 @@ int cmac_init(cmac_ctx_t* ctx, const uint8_t* key) {
     
     // Initialize state to zero
     memset(ctx->prev_encrypted, 0, AES_BLOCK_SIZE);
-    memset(ctx->last_block, 0, AES_BLOCK_SIZE);
     memset(ctx->partial_block, 0, AES_BLOCK_SIZE);
     ctx->block_offset = 0;
-    ctx->has_last_block = 0;
     ctx->initialized = 1;
     
     return 0;
@@ -88,75 +100,53 @@ int cmac_init(cmac_ctx_t* ctx, const uint8_t* key) {
 
 /**
  * Update CMAC with new data (streaming)
+ * The last 1..16 bytes seen so far always stay in partial_block: only cmac_final
+ * knows whether they form the final block (K1) or need padding (K2)
  */
 int cmac_update(cmac_ctx_t* ctx, const uint8_t* data, size_t len) {
-    if (!ctx || !ctx->initialized || !data) {
+    if (!ctx || !ctx->initialized || (!data && len > 0)) {
         return -1;
     }
+    if (len == 0) {
+        return 0;
+    }
     
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(ctx->key, 128, &aes_key) < 0) {
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, ctx->key) < 0) {
         return -1;
     }
     
     size_t i = 0;
     
-    // Process any partial block first
+    // Top up the buffered block first
     if (ctx->block_offset > 0) {
         size_t to_copy = AES_BLOCK_SIZE - ctx->block_offset;
         if (to_copy > len) {
             to_copy = len;
         }
-        
         memcpy(ctx->partial_block + ctx->block_offset, data, to_copy);
         ctx->block_offset += to_copy;
         i += to_copy;
         
-        // If block is complete, encrypt it (CBC-MAC)
-        if (ctx->block_offset == AES_BLOCK_SIZE) {
-            uint8_t encrypted[AES_BLOCK_SIZE];
-            uint8_t block[AES_BLOCK_SIZE];
-            // CBC-MAC: XOR with previous encrypted state
-            memcpy(block, ctx->partial_block, AES_BLOCK_SIZE);
-            xor_blocks(block, block, ctx->prev_encrypted);
-            AES_encrypt(block, encrypted, &aes_key);
-            memcpy(ctx->prev_encrypted, encrypted, AES_BLOCK_SIZE);
-            ctx->block_offset = 0;
+        // More data follows, so the buffered block is not the last one
+        if (i == len) {
+            aes_core_key_clear(&aes_key);
+            return 0;
         }
+        cbc_mac_blocks(&aes_key, ctx->prev_encrypted, ctx->partial_block, 1);
+        ctx->block_offset = 0;
     }
     
-    // Process full blocks (but don't encrypt the last one if it's the final block)
-    while (i + AES_BLOCK_SIZE <= len) {
-        // If we have a pending last block, encrypt it first
-        if (ctx->has_last_block) {
-            uint8_t encrypted[AES_BLOCK_SIZE];
-            uint8_t block[AES_BLOCK_SIZE];
-            // CBC-MAC: XOR with previous encrypted state
-            memcpy(block, ctx->last_block, AES_BLOCK_SIZE);
-            xor_blocks(block, block, ctx->prev_encrypted);
-            AES_encrypt(block, encrypted, &aes_key);
-            memcpy(ctx->prev_encrypted, encrypted, AES_BLOCK_SIZE);
-            ctx->has_last_block = 0;
-        }
-        
-        // Store current block as potential last block
-        memcpy(ctx->last_block, data + i, AES_BLOCK_SIZE);
-        ctx->has_last_block = 1;
-        
-        i += AES_BLOCK_SIZE;
-    }
+    // All full blocks except the one holding the last byte go through CBC-MAC in one bulk pass
+    size_t nblocks = (len - i - 1) / AES_BLOCK_SIZE;
+    cbc_mac_blocks(&aes_key, ctx->prev_encrypted, data + i, nblocks);
+    i += nblocks * AES_BLOCK_SIZE;
     
-    // Store remaining bytes in partial_block (incomplete block)
-    if (i < len) {
-        size_t remaining = len - i;
-        // Clear any previous incomplete block data
-        if (ctx->block_offset == 0) {
-            memset(ctx->partial_block, 0, AES_BLOCK_SIZE);
-        }
-        memcpy(ctx->partial_block + ctx->block_offset, data + i, remaining);
-        ctx->block_offset += remaining;
-    }
+    // Keep the tail (1..16 bytes) for the next call or cmac_final
+    memcpy(ctx->partial_block, data + i, len - i);
+    ctx->block_offset = len - i;
     
+    aes_core_key_clear(&aes_key);
     return 0;
 }
 
@@ -168,38 +158,31 @@ int cmac_final(cmac_ctx_t* ctx, uint8_t* mac) {
         return -1;
     }
     
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(ctx->key, 128, &aes_key) < 0) {
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, ctx->key) < 0) {
         return -1;
     }
     
     uint8_t final_block[AES_BLOCK_SIZE];
     
-    if (ctx->has_last_block) {
+    if (ctx->block_offset == AES_BLOCK_SIZE) {
         // Last block is complete, XOR with previous encrypted state, then K1
-        xor_blocks(final_block, ctx->last_block, ctx->prev_encrypted);
-        xor_blocks(final_block, final_block, ctx->k1);
-    } else if (ctx->block_offset > 0) {
-        // Last block is incomplete, pad and use K2
-        // Padding: add 0x80, then zeros
+        xor_bytes(final_block, ctx->partial_block, ctx->prev_encrypted, AES_BLOCK_SIZE);
+        xor_bytes(final_block, final_block, ctx->k1, AES_BLOCK_SIZE);
+    } else {
+        // Last block is incomplete or the message is empty: pad with 0x80, then zeros, and use K2
         memcpy(final_block, ctx->partial_block, ctx->block_offset);
         final_block[ctx->block_offset] = 0x80;
-        if (ctx->block_offset + 1 < AES_BLOCK_SIZE) {
-            memset(final_block + ctx->block_offset + 1, 0, AES_BLOCK_SIZE - ctx->block_offset - 1);
-        }
+        memset(final_block + ctx->block_offset + 1, 0, AES_BLOCK_SIZE - ctx->block_offset - 1);
         
         // XOR with previous encrypted state, then K2
-        xor_blocks(final_block, final_block, ctx->prev_encrypted);
-        xor_blocks(final_block, final_block, ctx->k2);
-    } else {
-        // Empty message - use K2
-        memset(final_block, 0, AES_BLOCK_SIZE);
-        final_block[0] = 0x80;  // Padding
-        xor_blocks(final_block, final_block, ctx->k2);
+        xor_bytes(final_block, final_block, ctx->prev_encrypted, AES_BLOCK_SIZE);
+        xor_bytes(final_block, final_block, ctx->k2, AES_BLOCK_SIZE);
     }
     
     // Final encryption
-    AES_encrypt(final_block, mac, &aes_key);
+    aes_core_encrypt_blocks(&aes_key, final_block, mac, 1);
+    aes_core_key_clear(&aes_key);
     
     ctx->initialized = 0;
     return 0;
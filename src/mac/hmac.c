@@ -1,10 +1,57 @@
 #include "../../include/mac.h"
 #include "../../include/hash.h"
+#include "../../include/xor.h"
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
 
-#define HMAC_BLOCK_SIZE 64  // Block size for SHA-256
+/**
+ * Block size of the hash function (bytes)
+ */
+static size_t hash_block_size(hmac_hash_t hash) {
+    return hash == HMAC_SHA256 ? 64 : 128;
+}
+
+size_t hmac_mac_size(hmac_hash_t hash) {
+    switch (hash) {
+    case HMAC_SHA384:
+        return 48;
+    case HMAC_SHA512:
+        return 64;
+    default:
+        return 32;
+    }
+}
+
+static void hash_init(hmac_hash_t hash, hmac_hash_ctx_t* ctx) {
+    switch (hash) {
+    case HMAC_SHA384:
+        sha384_init(&ctx->sha512);
+        break;
+    case HMAC_SHA512:
+        sha512_init(&ctx->sha512);
+        break;
+    default:
+        sha256_init(&ctx->sha256);
+        break;
+    }
+}
+
+static void hash_update(hmac_hash_t hash, hmac_hash_ctx_t* ctx, const uint8_t* data, size_t len) {
+    if (hash == HMAC_SHA256) {
+        sha256_update(&ctx->sha256, data, len);
+    } else {
+        sha512_update(&ctx->sha512, data, len);
+    }
+}
+
+static void hash_final(hmac_hash_t hash, hmac_hash_ctx_t* ctx, uint8_t* out) {
+    if (hash == HMAC_SHA256) {
+        sha256_final(&ctx->sha256, out);
+    } else {
+        sha512_final(&ctx->sha512, out);
+    }
+}
 
 /**
  * Process key according to RFC 2104:
@@ -12,69 +59,107 @@
  * - If key_len < block_size: pad with zeros
  * - Result is always block_size bytes
  */
-static void process_key(uint8_t* processed_key, const uint8_t* key, size_t key_len) {
-    if (key_len > HMAC_BLOCK_SIZE) {
+static void process_key(hmac_hash_t hash, uint8_t* processed_key, const uint8_t* key, size_t key_len) {
+    size_t block_size = hash_block_size(hash);
+    if (key_len > block_size) {
         // Key is longer than block size: hash it
-        sha256_ctx_t ctx;
-        sha256_init(&ctx);
-        sha256_update(&ctx, key, key_len);
-        sha256_final(&ctx, processed_key);
+        hmac_hash_ctx_t ctx;
+        hash_init(hash, &ctx);
+        hash_update(hash, &ctx, key, key_len);
+        hash_final(hash, &ctx, processed_key);
         // Pad remaining bytes with zeros
-        memset(processed_key + 32, 0, HMAC_BLOCK_SIZE - 32);
+        memset(processed_key + hmac_mac_size(hash), 0, block_size - hmac_mac_size(hash));
     } else {
         // Key is shorter or equal: copy and pad with zeros
         memcpy(processed_key, key, key_len);
-        if (key_len < HMAC_BLOCK_SIZE) {
-            memset(processed_key + key_len, 0, HMAC_BLOCK_SIZE - key_len);
+        if (key_len < block_size) {
+            memset(processed_key + key_len, 0, block_size - key_len);
         }
     }
 }
 
 /**
- * XOR two byte arrays
+ * Prepare an HMAC key: the two padded key blocks are compressed here, once per key
  */
-static void xor_bytes(uint8_t* out, const uint8_t* a, const uint8_t* b, size_t len) {
-    size_t i;
-    for (i = 0; i < len; i++) {
-        out[i] = a[i] ^ b[i];
+int hmac_key_init(hmac_key_t* key, hmac_hash_t hash, const uint8_t* key_bytes, size_t key_len) {
+    if (!key || !key_bytes || key_len == 0) {
+        return -1;
     }
-}
-
-/**
- * Initialize HMAC context with a key
- */
-int hmac_init(hmac_ctx_t* ctx, const uint8_t* key, size_t key_len) {
-    if (!ctx || !key || key_len == 0) {
+    if (hash != HMAC_SHA256 && hash != HMAC_SHA384 && hash != HMAC_SHA512) {
+        fprintf(stderr, "Error: unknown HMAC hash function %d\n", (int)hash);
         return -1;
     }
+    key->hash = hash;
+    size_t block_size = hash_block_size(hash);
     
     // Process the key
-    process_key(ctx->key, key, key_len);
+    uint8_t processed_key[HMAC_MAX_BLOCK_SIZE];
+    process_key(hash, processed_key, key_bytes, key_len);
     
     // Create inner pad: key XOR ipad (0x36 repeated)
-    uint8_t ipad[HMAC_BLOCK_SIZE];
-    memset(ipad, 0x36, HMAC_BLOCK_SIZE);
-    uint8_t inner_key[HMAC_BLOCK_SIZE];
-    xor_bytes(inner_key, ctx->key, ipad, HMAC_BLOCK_SIZE);
+    uint8_t ipad[HMAC_MAX_BLOCK_SIZE];
+    memset(ipad, 0x36, block_size);
+    uint8_t inner_key[HMAC_MAX_BLOCK_SIZE];
+    xor_bytes(inner_key, processed_key, ipad, block_size);
     
-    // Initialize inner hash context with (K ⊕ ipad)
-    sha256_init(&ctx->inner_ctx);
-    sha256_update(&ctx->inner_ctx, inner_key, HMAC_BLOCK_SIZE);
+    // Inner midstate: (K ⊕ ipad) is exactly one block, so the buffer is empty afterwards
+    hash_init(hash, &key->inner);
+    hash_update(hash, &key->inner, inner_key, block_size);
     
     // Create outer pad: key XOR opad (0x5c repeated)
-    uint8_t opad[HMAC_BLOCK_SIZE];
-    memset(opad, 0x5c, HMAC_BLOCK_SIZE);
-    uint8_t outer_key[HMAC_BLOCK_SIZE];
-    xor_bytes(outer_key, ctx->key, opad, HMAC_BLOCK_SIZE);
+    uint8_t opad[HMAC_MAX_BLOCK_SIZE];
+    memset(opad, 0x5c, block_size);
+    uint8_t outer_key[HMAC_MAX_BLOCK_SIZE];
+    xor_bytes(outer_key, processed_key, opad, block_size);
     
-    // Initialize outer hash context (will be used in final)
-    sha256_init(&ctx->outer_ctx);
-    sha256_update(&ctx->outer_ctx, outer_key, HMAC_BLOCK_SIZE);
+    // Outer midstate (copied and finished in hmac_final)
+    hash_init(hash, &key->outer);
+    hash_update(hash, &key->outer, outer_key, block_size);
     
-    ctx->initialized = 1;
+    memset(processed_key, 0, sizeof(processed_key));
+    memset(inner_key, 0, sizeof(inner_key));
+    memset(outer_key, 0, sizeof(outer_key));
+    return 0;
+}
+
+/**
+ * Initialize HMAC context from a prepared key
+ */
+void hmac_init_key(hmac_ctx_t* ctx, const hmac_key_t* key) {
+    ctx->key = *key;
+    hmac_reset(ctx);
+}
+
+/**
+ * Initialize HMAC context with a key and a hash function
+ */
+int hmac_init_alg(hmac_ctx_t* ctx, hmac_hash_t hash, const uint8_t* key, size_t key_len) {
+    if (!ctx || hmac_key_init(&ctx->key, hash, key, key_len) != 0) {
+        return -1;
+    }
+    hmac_reset(ctx);
     return 0;
 }
 
+/**
+ * Initialize HMAC-SHA256 context with a key
+ */
+int hmac_init(hmac_ctx_t* ctx, const uint8_t* key, size_t key_len) {
+    return hmac_init_alg(ctx, HMAC_SHA256, key, key_len);
+}
+
+/**
+ * Start a new message: the inner hash restarts from the key midstate
+ */
+void hmac_reset(hmac_ctx_t* ctx) {
+    ctx->inner_ctx = ctx->key.inner;
+    ctx->initialized = 1;
+}
+
+void hmac_clone(hmac_ctx_t* dst, const hmac_ctx_t* src) {
+    *dst = *src;
+}
+
 /**
  * Update HMAC with new data (streaming)
  */
@@ -84,7 +169,7 @@ void hmac_update(hmac_ctx_t* ctx, const uint8_t* data, size_t len) {
     }
     
     // Update inner hash with message data
-    sha256_update(&ctx->inner_ctx, data, len);
+    hash_update(ctx->key.hash, &ctx->inner_ctx, data, len);
 }
 
 /**
@@ -96,28 +181,48 @@ void hmac_final(hmac_ctx_t* ctx, uint8_t* mac) {
         return;
     }
     
+    hmac_hash_t hash = ctx->key.hash;
+    
     // Finalize inner hash: H((K ⊕ ipad) ∥ m)
-    uint8_t inner_hash[32];
-    sha256_final(&ctx->inner_ctx, inner_hash);
+    uint8_t inner_hash[HMAC_MAX_MAC_SIZE];
+    hash_final(hash, &ctx->inner_ctx, inner_hash);
     
     // Compute outer hash: H((K ⊕ opad) ∥ inner_hash)
-    // Note: outer_ctx already has (K ⊕ opad) in it, we just need to add inner_hash
-    sha256_update(&ctx->outer_ctx, inner_hash, 32);
-    sha256_final(&ctx->outer_ctx, mac);
+    // Note: the outer midstate already has (K ⊕ opad) in it, we just need to add inner_hash
+    hmac_hash_ctx_t outer_ctx = ctx->key.outer;
+    hash_update(hash, &outer_ctx, inner_hash, hmac_mac_size(hash));
+    hash_final(hash, &outer_ctx, mac);
     
+    // The key midstates stay: hmac_reset starts the next message
     ctx->initialized = 0;
 }
 
 /**
- * Compute HMAC for a file (convenience function with chunked processing)
+ * One-shot HMAC with a prepared key
  */
-int hmac_file(const char* filepath, const uint8_t* key, size_t key_len, uint8_t* mac) {
+void hmac_compute(const hmac_key_t* key, const uint8_t* data, size_t len, uint8_t* mac) {
+    hmac_hash_t hash = key->hash;
+    uint8_t inner_hash[HMAC_MAX_MAC_SIZE];
+    
+    hmac_hash_ctx_t ctx = key->inner;
+    hash_update(hash, &ctx, data, len);
+    hash_final(hash, &ctx, inner_hash);
+    
+    ctx = key->outer;
+    hash_update(hash, &ctx, inner_hash, hmac_mac_size(hash));
+    hash_final(hash, &ctx, mac);
+}
+
+/**
+ * Compute HMAC for a file with a prepared key (chunked processing)
+ */
+int hmac_file_key(const char* filepath, const hmac_key_t* key, uint8_t* mac) {
     hmac_ctx_t ctx;
     FILE* f;
-    uint8_t buffer[4096];
+    uint8_t buffer[65536];
     size_t bytes_read;
     
-    if (!filepath || !key || key_len == 0 || !mac) {
+    if (!filepath || !key || !mac) {
         return -1;
     }
     
@@ -127,10 +232,7 @@ int hmac_file(const char* filepath, const uint8_t* key, size_t key_len, uint8_t*
         return -1;
     }
     
-    if (hmac_init(&ctx, key, key_len) != 0) {
-        fclose(f);
-        return -1;
-    }
+    hmac_init_key(&ctx, key);
     
     // Process file in chunks
     while ((bytes_read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
@@ -148,3 +250,24 @@ int hmac_file(const char* filepath, const uint8_t* key, size_t key_len, uint8_t*
     return 0;
 }
 
+/**
+ * Compute HMAC for a file (convenience function)
+ */
+int hmac_file_alg(const char* filepath, hmac_hash_t hash, const uint8_t* key, size_t key_len, uint8_t* mac) {
+    hmac_key_t prepared;
+    
+    if (!filepath || !key || key_len == 0 || !mac) {
+        return -1;
+    }
+    if (hmac_key_init(&prepared, hash, key, key_len) != 0) {
+        return -1;
+    }
+    return hmac_file_key(filepath, &prepared, mac);
+}
+
+/**
+ * Compute HMAC-SHA256 for a file
+ */
+int hmac_file(const char* filepath, const uint8_t* key, size_t key_len, uint8_t* mac) {
+    return hmac_file_alg(filepath, HMAC_SHA256, key, key_len, mac);
+}
@@ -0,0 +1,73 @@
+#include "../../include/mac.h"
+#include "../../include/hash.h"
+#include <string.h>
+#include <stdio.h>
+
+/**
+ * KMAC (NIST SP 800-185):
+ * cSHAKE(bytepad(encode_string(K), rate) || X || right_encode(L), L, "KMAC", S)
+ * The key costs one permutation per rate-sized block of padded key; the message
+ * then goes through the same sponge with no inner/outer pass
+ */
+int kmac_init(kmac_ctx_t* ctx, unsigned int security_bits, const uint8_t* key, size_t key_len,
+              const uint8_t* custom, size_t custom_len, size_t mac_len) {
+    if (!ctx || (!key && key_len > 0) || (!custom && custom_len > 0)) {
+        return -1;
+    }
+    if (security_bits != 128 && security_bits != 256) {
+        fprintf(stderr, "Error: KMAC security level must be 128 or 256 bits\n");
+        return -1;
+    }
+    
+    cshake_init(&ctx->sponge, security_bits, (const uint8_t*)"KMAC", 4, custom, custom_len);
+    sha3_absorb_bytepad(&ctx->sponge, key, key_len);
+    ctx->mac_len = mac_len;
+    return 0;
+}
+
+void kmac_update(kmac_ctx_t* ctx, const uint8_t* data, size_t len) {
+    sha3_update(&ctx->sponge, data, len);
+}
+
+void kmac_final(kmac_ctx_t* ctx, uint8_t* mac) {
+    // The requested length is absorbed last, so different lengths give unrelated MACs
+    uint8_t enc[9];
+    sha3_update(&ctx->sponge, enc, sp800_185_right_encode(enc, (uint64_t)ctx->mac_len * 8));
+    shake_squeeze(&ctx->sponge, mac, ctx->mac_len);
+}
+
+int kmac_file(const char* filepath, unsigned int security_bits, const uint8_t* key, size_t key_len,
+              uint8_t* mac, size_t mac_len) {
+    kmac_ctx_t ctx;
+    FILE* f;
+    uint8_t buffer[65536];
+    size_t bytes_read;
+    
+    if (!filepath || !mac) {
+        return -1;
+    }
+    
+    if (kmac_init(&ctx, security_bits, key, key_len, NULL, 0, mac_len) != 0) {
+        return -1;
+    }
+    
+    f = fopen(filepath, "rb");
+    if (!f) {
+        fprintf(stderr, "Error: Failed to open file '%s'\n", filepath);
+        return -1;
+    }
+    
+    while ((bytes_read = fread(buffer, 1, sizeof(buffer), f)) > 0) {
+        kmac_update(&ctx, buffer, bytes_read);
+    }
+    
+    if (ferror(f)) {
+        fprintf(stderr, "Error: Failed to read file '%s'\n", filepath);
+        fclose(f);
+        return -1;
+    }
+    
+    fclose(f);
+    kmac_final(&ctx, mac);
+    return 0;
+}
@@ -0,0 +1,297 @@
+#include "../../include/poly1305.h"
+#include "../../include/cpu_features.h"
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define POLY1305_HAVE_AVX2 1
+#endif
+
+#define LIMB_MASK 0x3ffffff
+#define HIBIT ((uint32_t)1 << 24)  // 2^128 in limb 4 (appended to every full block)
+
+/* Shorter runs are cheaper on the scalar path than the 4-way setup and final combine */
+#define POLY1305_AVX2_MIN_BLOCKS 16
+
+static uint32_t load_le32(const uint8_t* p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store_le32(uint8_t* p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/**
+ * h = (h * r) mod 2^130 - 5, with the carry chain folded back into limb 0
+ */
+static void mul_reduce(uint32_t* h, const uint32_t* r) {
+    uint32_t s1 = r[1] * 5, s2 = r[2] * 5, s3 = r[3] * 5, s4 = r[4] * 5;
+    uint64_t d0 = (uint64_t)h[0] * r[0] + (uint64_t)h[1] * s4 + (uint64_t)h[2] * s3 + (uint64_t)h[3] * s2 + (uint64_t)h[4] * s1;
+    uint64_t d1 = (uint64_t)h[0] * r[1] + (uint64_t)h[1] * r[0] + (uint64_t)h[2] * s4 + (uint64_t)h[3] * s3 + (uint64_t)h[4] * s2;
+    uint64_t d2 = (uint64_t)h[0] * r[2] + (uint64_t)h[1] * r[1] + (uint64_t)h[2] * r[0] + (uint64_t)h[3] * s4 + (uint64_t)h[4] * s3;
+    uint64_t d3 = (uint64_t)h[0] * r[3] + (uint64_t)h[1] * r[2] + (uint64_t)h[2] * r[1] + (uint64_t)h[3] * r[0] + (uint64_t)h[4] * s4;
+    uint64_t d4 = (uint64_t)h[0] * r[4] + (uint64_t)h[1] * r[3] + (uint64_t)h[2] * r[2] + (uint64_t)h[3] * r[1] + (uint64_t)h[4] * r[0];
+
+    uint64_t c;
+    c = d0 >> 26; h[0] = (uint32_t)d0 & LIMB_MASK; d1 += c;
+    c = d1 >> 26; h[1] = (uint32_t)d1 & LIMB_MASK; d2 += c;
+    c = d2 >> 26; h[2] = (uint32_t)d2 & LIMB_MASK; d3 += c;
+    c = d3 >> 26; h[3] = (uint32_t)d3 & LIMB_MASK; d4 += c;
+    c = d4 >> 26; h[4] = (uint32_t)d4 & LIMB_MASK;
+    h[0] += (uint32_t)c * 5;
+    h[1] += h[0] >> 26;
+    h[0] &= LIMB_MASK;
+}
+
+/**
+ * Scalar path: h = (h + m) * r for each 16-byte block
+ */
+static void blocks_portable(uint32_t* h, const uint32_t* r, const uint8_t* m, size_t nblocks, uint32_t hibit) {
+    for (size_t i = 0; i < nblocks; i++, m += 16) {
+        h[0] += load_le32(m) & LIMB_MASK;
+        h[1] += (load_le32(m + 3) >> 2) & LIMB_MASK;
+        h[2] += (load_le32(m + 6) >> 4) & LIMB_MASK;
+        h[3] += (load_le32(m + 9) >> 6) & LIMB_MASK;
+        h[4] += (load_le32(m + 12) >> 8) | hibit;
+        mul_reduce(h, r);
+    }
+}
+
+#ifdef POLY1305_HAVE_AVX2
+#define AVX2_TARGET __attribute__((target("avx2")))
+
+/**
+ * Four consecutive blocks into 26-bit limbs, one block per 64-bit lane (lane i = block i)
+ */
+static inline AVX2_TARGET void load_blocks4(const uint8_t* m, __m256i* a) {
+    const __m256i mask = _mm256_set1_epi64x(LIMB_MASK);
+    __m256i x = _mm256_loadu_si256((const __m256i*)m);          // m0.lo m0.hi m1.lo m1.hi
+    __m256i y = _mm256_loadu_si256((const __m256i*)(m + 32));   // m2.lo m2.hi m3.lo m3.hi
+    __m256i lo = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(x, y), _MM_SHUFFLE(3, 1, 2, 0));
+    __m256i hi = _mm256_permute4x64_epi64(_mm256_unpackhi_epi64(x, y), _MM_SHUFFLE(3, 1, 2, 0));
+    a[0] = _mm256_and_si256(lo, mask);
+    a[1] = _mm256_and_si256(_mm256_srli_epi64(lo, 26), mask);
+    a[2] = _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(lo, 52), _mm256_slli_epi64(hi, 12)), mask);
+    a[3] = _mm256_and_si256(_mm256_srli_epi64(hi, 14), mask);
+    a[4] = _mm256_or_si256(_mm256_srli_epi64(hi, 40), _mm256_set1_epi64x(HIBIT));
+}
+
+#define MUL(x, y) _mm256_mul_epu32(x, y)
+
+/**
+ * Lane-wise a = a * r mod 2^130 - 5 (s = 5 * r), same carry chain as mul_reduce
+ */
+static inline AVX2_TARGET void mul_reduce4(__m256i* a, const __m256i* r, const __m256i* s) {
+    const __m256i mask = _mm256_set1_epi64x(LIMB_MASK);
+    __m256i d0 = _mm256_add_epi64(_mm256_add_epi64(MUL(a[0], r[0]), MUL(a[1], s[4])),
+                                  _mm256_add_epi64(_mm256_add_epi64(MUL(a[2], s[3]), MUL(a[3], s[2])), MUL(a[4], s[1])));
+    __m256i d1 = _mm256_add_epi64(_mm256_add_epi64(MUL(a[0], r[1]), MUL(a[1], r[0])),
+                                  _mm256_add_epi64(_mm256_add_epi64(MUL(a[2], s[4]), MUL(a[3], s[3])), MUL(a[4], s[2])));
+    __m256i d2 = _mm256_add_epi64(_mm256_add_epi64(MUL(a[0], r[2]), MUL(a[1], r[1])),
+                                  _mm256_add_epi64(_mm256_add_epi64(MUL(a[2], r[0]), MUL(a[3], s[4])), MUL(a[4], s[3])));
+    __m256i d3 = _mm256_add_epi64(_mm256_add_epi64(MUL(a[0], r[3]), MUL(a[1], r[2])),
+                                  _mm256_add_epi64(_mm256_add_epi64(MUL(a[2], r[1]), MUL(a[3], r[0])), MUL(a[4], s[4])));
+    __m256i d4 = _mm256_add_epi64(_mm256_add_epi64(MUL(a[0], r[4]), MUL(a[1], r[3])),
+                                  _mm256_add_epi64(_mm256_add_epi64(MUL(a[2], r[2]), MUL(a[3], r[1])), MUL(a[4], r[0])));
+
+    __m256i c;
+    c = _mm256_srli_epi64(d0, 26); a[0] = _mm256_and_si256(d0, mask); d1 = _mm256_add_epi64(d1, c);
+    c = _mm256_srli_epi64(d1, 26); a[1] = _mm256_and_si256(d1, mask); d2 = _mm256_add_epi64(d2, c);
+    c = _mm256_srli_epi64(d2, 26); a[2] = _mm256_and_si256(d2, mask); d3 = _mm256_add_epi64(d3, c);
+    c = _mm256_srli_epi64(d3, 26); a[3] = _mm256_and_si256(d3, mask); d4 = _mm256_add_epi64(d4, c);
+    c = _mm256_srli_epi64(d4, 26); a[4] = _mm256_and_si256(d4, mask);
+    a[0] = _mm256_add_epi64(a[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+    c = _mm256_srli_epi64(a[0], 26);
+    a[0] = _mm256_and_si256(a[0], mask);
+    a[1] = _mm256_add_epi64(a[1], c);
+}
+
+static inline AVX2_TARGET void scale5(const __m256i* r, __m256i* s) {
+    for (int j = 1; j < 5; j++) {
+        s[j] = _mm256_add_epi64(r[j], _mm256_slli_epi64(r[j], 2));
+    }
+}
+
+/**
+ * 4-way Horner: lane i accumulates blocks i, i+4, i+8, ... multiplied by r^4 per step,
+ * the lanes are then weighted by r^4, r^3, r^2, r^1 and summed
+ * nblocks is a multiple of 4 (at least 4)
+ */
+AVX2_TARGET
+static void blocks_avx2(uint32_t* h, const uint32_t rpow[4][5], const uint8_t* m, size_t nblocks) {
+    __m256i r[5], s[5], a[5], b[5];
+    for (int j = 0; j < 5; j++) {
+        r[j] = _mm256_set1_epi64x(rpow[3][j]);
+    }
+    scale5(r, s);
+
+    load_blocks4(m, a);
+    for (int j = 0; j < 5; j++) {
+        a[j] = _mm256_add_epi64(a[j], _mm256_set_epi64x(0, 0, 0, h[j]));
+    }
+    for (m += 64, nblocks -= 4; nblocks >= 4; m += 64, nblocks -= 4) {
+        mul_reduce4(a, r, s);
+        load_blocks4(m, b);
+        for (int j = 0; j < 5; j++) {
+            a[j] = _mm256_add_epi64(a[j], b[j]);
+        }
+    }
+
+    for (int j = 0; j < 5; j++) {
+        r[j] = _mm256_set_epi64x(rpow[0][j], rpow[1][j], rpow[2][j], rpow[3][j]);
+    }
+    scale5(r, s);
+    mul_reduce4(a, r, s);
+
+    uint64_t d[5];
+    for (int j = 0; j < 5; j++) {
+        __m128i x = _mm_add_epi64(_mm256_castsi256_si128(a[j]), _mm256_extracti128_si256(a[j], 1));
+        x = _mm_add_epi64(x, _mm_unpackhi_epi64(x, x));
+        _mm_storel_epi64((__m128i*)&d[j], x);
+    }
+    uint64_t c;
+    c = d[0] >> 26; h[0] = (uint32_t)d[0] & LIMB_MASK; d[1] += c;
+    c = d[1] >> 26; h[1] = (uint32_t)d[1] & LIMB_MASK; d[2] += c;
+    c = d[2] >> 26; h[2] = (uint32_t)d[2] & LIMB_MASK; d[3] += c;
+    c = d[3] >> 26; h[3] = (uint32_t)d[3] & LIMB_MASK; d[4] += c;
+    c = d[4] >> 26; h[4] = (uint32_t)d[4] & LIMB_MASK;
+    h[0] += (uint32_t)c * 5;
+    h[1] += h[0] >> 26;
+    h[0] &= LIMB_MASK;
+}
+#endif
+
+#ifdef POLY1305_HAVE_AVX2
+/* 1 - 4-way AVX2 path, 0 - scalar, -1 - not resolved yet; resolved once and published atomically */
+static int use_avx2 = -1;
+
+static int avx2_enabled(void) {
+    int enabled = __atomic_load_n(&use_avx2, __ATOMIC_ACQUIRE);
+    if (enabled < 0) {
+        enabled = cpu_features_get()->avx2 ? 1 : 0;
+        __atomic_store_n(&use_avx2, enabled, __ATOMIC_RELEASE);
+    }
+    return enabled;
+}
+#endif
+
+const char* poly1305_impl_name(void) {
+#ifdef POLY1305_HAVE_AVX2
+    if (avx2_enabled()) {
+        return "avx2";
+    }
+#endif
+    return "portable";
+}
+
+void poly1305_init(poly1305_ctx_t* ctx, const uint8_t* key) {
+    memset(ctx, 0, sizeof(*ctx));
+
+    // r &= 0x0ffffffc0ffffffc0ffffffc0fffffff
+    ctx->r[0] = load_le32(key) & 0x3ffffff;
+    ctx->r[1] = (load_le32(key + 3) >> 2) & 0x3ffff03;
+    ctx->r[2] = (load_le32(key + 6) >> 4) & 0x3ffc0ff;
+    ctx->r[3] = (load_le32(key + 9) >> 6) & 0x3f03fff;
+    ctx->r[4] = (load_le32(key + 12) >> 8) & 0x00fffff;
+    for (int i = 0; i < 4; i++) {
+        ctx->pad[i] = load_le32(key + 16 + 4 * i);
+    }
+
+#ifdef POLY1305_HAVE_AVX2
+    if (avx2_enabled()) {
+        ctx->avx2 = 1;
+        memcpy(ctx->rpow[0], ctx->r, sizeof(ctx->r));
+        for (int i = 1; i < 4; i++) {
+            memcpy(ctx->rpow[i], ctx->rpow[i - 1], sizeof(ctx->r));
+            mul_reduce(ctx->rpow[i], ctx->r);
+        }
+    }
+#endif
+}
+
+/**
+ * Full blocks: the 4-way AVX2 path for long runs, the scalar path for the rest
+ */
+static void process_blocks(poly1305_ctx_t* ctx, const uint8_t* m, size_t nblocks) {
+#ifdef POLY1305_HAVE_AVX2
+    if (ctx->avx2 && nblocks >= POLY1305_AVX2_MIN_BLOCKS) {
+        size_t vec = nblocks & ~(size_t)3;
+        blocks_avx2(ctx->h, (const uint32_t (*)[5])ctx->rpow, m, vec);
+        m += vec * 16;
+        nblocks -= vec;
+    }
+#endif
+    blocks_portable(ctx->h, ctx->r, m, nblocks, HIBIT);
+}
+
+void poly1305_update(poly1305_ctx_t* ctx, const uint8_t* data, size_t len) {
+    if (ctx->buf_len > 0) {
+        size_t take = 16 - ctx->buf_len;
+        if (take > len) {
+            take = len;
+        }
+        memcpy(ctx->buf + ctx->buf_len, data, take);
+        ctx->buf_len += take;
+        data += take;
+        len -= take;
+        if (ctx->buf_len < 16) {
+            return;
+        }
+        blocks_portable(ctx->h, ctx->r, ctx->buf, 1, HIBIT);
+        ctx->buf_len = 0;
+    }
+
+    size_t nblocks = len / 16;
+    if (nblocks > 0) {
+        process_blocks(ctx, data, nblocks);
+    }
+    ctx->buf_len = len - nblocks * 16;
+    memcpy(ctx->buf, data + nblocks * 16, ctx->buf_len);
+}
+
+void poly1305_final(poly1305_ctx_t* ctx, uint8_t* tag) {
+    uint32_t* h = ctx->h;
+
+    // Last partial block: append 0x01 and zero-pad, without the 2^128 bit
+    if (ctx->buf_len > 0) {
+        ctx->buf[ctx->buf_len] = 1;
+        memset(ctx->buf + ctx->buf_len + 1, 0, 16 - ctx->buf_len - 1);
+        blocks_portable(h, ctx->r, ctx->buf, 1, 0);
+    }
+
+    // Full carry
+    uint32_t c;
+    c = h[1] >> 26; h[1] &= LIMB_MASK; h[2] += c;
+    c = h[2] >> 26; h[2] &= LIMB_MASK; h[3] += c;
+    c = h[3] >> 26; h[3] &= LIMB_MASK; h[4] += c;
+    c = h[4] >> 26; h[4] &= LIMB_MASK; h[0] += c * 5;
+    c = h[0] >> 26; h[0] &= LIMB_MASK; h[1] += c;
+
+    // g = h - p = h + 5 - 2^130; select h or g without branching
+    uint32_t g[5];
+    c = h[0] + 5; g[0] = c & LIMB_MASK; c >>= 26;
+    c += h[1]; g[1] = c & LIMB_MASK; c >>= 26;
+    c += h[2]; g[2] = c & LIMB_MASK; c >>= 26;
+    c += h[3]; g[3] = c & LIMB_MASK; c >>= 26;
+    g[4] = h[4] + c - ((uint32_t)1 << 26);
+    uint32_t mask = (g[4] >> 31) - 1;  // all ones if h >= p
+    for (int i = 0; i < 5; i++) {
+        h[i] = (h[i] & ~mask) | (g[i] & mask);
+    }
+
+    // h mod 2^128, then tag = h + s
+    uint32_t w0 = h[0] | (h[1] << 26);
+    uint32_t w1 = (h[1] >> 6) | (h[2] << 20);
+    uint32_t w2 = (h[2] >> 12) | (h[3] << 14);
+    uint32_t w3 = (h[3] >> 18) | (h[4] << 8);
+    uint64_t f;
+    f = (uint64_t)w0 + ctx->pad[0]; store_le32(tag, (uint32_t)f);
+    f = (uint64_t)w1 + ctx->pad[1] + (f >> 32); store_le32(tag + 4, (uint32_t)f);
+    f = (uint64_t)w2 + ctx->pad[2] + (f >> 32); store_le32(tag + 8, (uint32_t)f);
+    f = (uint64_t)w3 + ctx->pad[3] + (f >> 32); store_le32(tag + 12, (uint32_t)f);
+
+    memset(ctx, 0, sizeof(*ctx));
+}
@@ -0,0 +1,255 @@
+#include "../../include/aes_mode.h"
+#include "../../include/aes_parallel.h"
+#include "../../include/modes.h"
+#include <stdio.h>
+#include <string.h>
+
+int aes_mode_parse(const char* name, aes_mode_t* mode) {
+    static const char* const names[] = {"ecb", "cbc", "cfb", "ofb", "ctr"};
+    for (int i = 0; i < (int)(sizeof(names) / sizeof(names[0])); i++) {
+        if (strcmp(name, names[i]) == 0) {
+            *mode = (aes_mode_t)i;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+int aes_mode_init(aes_mode_ctx_t* ctx, aes_mode_t mode, int encrypt,
+                  const unsigned char* key, const unsigned char* iv) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->mode = mode;
+    ctx->encrypt = encrypt;
+
+    // Ключ дешифрования нужен только ECB/CBC: CFB, OFB и CTR всегда шифруют блоки
+    int inverse = !encrypt && (mode == AES_MODE_ECB || mode == AES_MODE_CBC);
+    int rc = inverse ? aes_core_set_decrypt_key(&ctx->key, key) : aes_core_set_encrypt_key(&ctx->key, key);
+    if (rc < 0) {
+        fprintf(stderr, "Error: Failed to set AES %s key\n", inverse ? "decryption" : "encryption");
+        return -1;
+    }
+
+    if (mode != AES_MODE_ECB) {
+        if (!iv) {
+            fprintf(stderr, "Error: IV is required for this mode\n");
+            aes_core_key_clear(&ctx->key);
+            return -1;
+        }
+        memcpy(ctx->iv, iv, AES_BLOCK_SIZE);
+    }
+    return 0;
+}
+
+void aes_mode_set_pool(aes_mode_ctx_t* ctx, thread_pool_t* pool) {
+    ctx->pool = pool;
+}
+
+int aes_mode_seek(aes_mode_ctx_t* ctx, unsigned long long offset) {
+    if (ctx->mode != AES_MODE_CTR) {
+        fprintf(stderr, "Error: random access is only supported in CTR mode\n");
+        return -1;
+    }
+    increment_counter_be(ctx->iv, offset / AES_BLOCK_SIZE);
+    ctx->buf_len = (size_t)(offset % AES_BLOCK_SIZE);
+    if (ctx->buf_len > 0) {
+        // Смещение внутри блока: поток ключа блока готовится как для хвоста предыдущего вызова
+        aes_core_encrypt_blocks(&ctx->key, ctx->iv, ctx->ks, 1);
+        increment_counter_be(ctx->iv, 1);
+    }
+    return 0;
+}
+
+/**
+ * Обработка nblocks полных блоков ECB/CBC (in и out могут совпадать)
+ */
+static void process_blocks(aes_mode_ctx_t* ctx, const unsigned char* in, unsigned char* out, size_t nblocks) {
+    if (nblocks == 0) {
+        return;
+    }
+    if (ctx->mode == AES_MODE_ECB) {
+        if (ctx->encrypt) {
+            aes_par_encrypt_blocks(ctx->pool, &ctx->key, in, out, nblocks);
+        } else {
+            aes_par_decrypt_blocks(ctx->pool, &ctx->key, in, out, nblocks);
+        }
+    } else if (ctx->encrypt) {
+        // Шифрование CBC последовательно по природе: один поток, цепочка продолжается в ctx->iv
+        aes_cbc_stream_t stream;
+        stream.in = in;
+        stream.out = out;
+        stream.nblocks = nblocks;
+        memcpy(stream.iv, ctx->iv, AES_BLOCK_SIZE);
+        aes_core_cbc_encrypt_multi(&ctx->key, &stream, 1);
+        memcpy(ctx->iv, stream.iv, AES_BLOCK_SIZE);
+    } else {
+        aes_par_cbc_decrypt(ctx->pool, &ctx->key, ctx->iv, in, out, nblocks);
+    }
+}
+
+static int update_block_mode(aes_mode_ctx_t* ctx, const unsigned char* in, size_t in_len,
+                             unsigned char* out, size_t* out_len) {
+    size_t produced = 0;
+
+    if (ctx->buf_len > 0) {
+        if (in == out) {
+            // На месте: накопленные байты ставятся перед данными, дальше весь буфер обрабатывается пакетом
+            memmove(out + ctx->buf_len, in, in_len);
+            memcpy(out, ctx->buf, ctx->buf_len);
+            in_len += ctx->buf_len;
+            ctx->buf_len = 0;
+        } else {
+            size_t take = AES_BLOCK_SIZE - ctx->buf_len;
+            if (take > in_len) {
+                take = in_len;
+            }
+            memcpy(ctx->buf + ctx->buf_len, in, take);
+            ctx->buf_len += take;
+            in += take;
+            in_len -= take;
+
+            // При дешифровании полный блок удерживается, пока не известно, что он не последний
+            if (ctx->buf_len < AES_BLOCK_SIZE || (!ctx->encrypt && in_len == 0)) {
+                *out_len = 0;
+                return 0;
+            }
+            process_blocks(ctx, ctx->buf, out, 1);
+            produced = AES_BLOCK_SIZE;
+            ctx->buf_len = 0;
+        }
+    }
+
+    size_t nblocks = in_len / AES_BLOCK_SIZE;
+    size_t rest = in_len % AES_BLOCK_SIZE;
+    if (!ctx->encrypt && rest == 0 && nblocks > 0) {
+        nblocks--;
+        rest = AES_BLOCK_SIZE;
+    }
+
+    process_blocks(ctx, in, out + produced, nblocks);
+    memcpy(ctx->buf, in + nblocks * AES_BLOCK_SIZE, rest);
+    ctx->buf_len = rest;
+
+    *out_len = produced + nblocks * AES_BLOCK_SIZE;
+    return 0;
+}
+
+/**
+ * XOR входа с остатком потока ключа текущего блока; для CFB собирает шифртекст блока
+ * Возвращает число обработанных байт
+ */
+static size_t xor_partial(aes_mode_ctx_t* ctx, const unsigned char* in, unsigned char* out, size_t len) {
+    size_t i = 0;
+    while (i < len && ctx->buf_len < AES_BLOCK_SIZE) {
+        unsigned char c = in[i];
+        unsigned char p = (unsigned char)(c ^ ctx->ks[ctx->buf_len]);
+        out[i] = p;
+        if (ctx->mode == AES_MODE_CFB) {
+            ctx->buf[ctx->buf_len] = ctx->encrypt ? p : c;
+        }
+        ctx->buf_len++;
+        i++;
+    }
+    if (ctx->buf_len == AES_BLOCK_SIZE) {
+        // Блок завершен: для CFB его шифртекст становится регистром сдвига
+        if (ctx->mode == AES_MODE_CFB) {
+            memcpy(ctx->iv, ctx->buf, AES_BLOCK_SIZE);
+        }
+        ctx->buf_len = 0;
+    }
+    return i;
+}
+
+static int update_stream_mode(aes_mode_ctx_t* ctx, const unsigned char* in, size_t in_len,
+                              unsigned char* out, size_t* out_len) {
+    size_t i = 0;
+
+    // Сначала дорабатывается неполный блок предыдущего вызова
+    if (ctx->buf_len > 0) {
+        i = xor_partial(ctx, in, out, in_len);
+    }
+
+    // Полные блоки - одним пакетом
+    size_t nblocks = (in_len - i) / AES_BLOCK_SIZE;
+    size_t bulk = nblocks * AES_BLOCK_SIZE;
+    if (nblocks > 0) {
+        switch (ctx->mode) {
+            case AES_MODE_CFB:
+                if (ctx->encrypt) {
+                    aes_core_cfb_encrypt(&ctx->key, ctx->iv, in + i, out + i, bulk);
+                } else {
+                    aes_par_cfb_decrypt(ctx->pool, &ctx->key, ctx->iv, in + i, out + i, nblocks);
+                }
+                break;
+            case AES_MODE_OFB:
+                aes_core_ofb_xor(&ctx->key, ctx->iv, in + i, out + i, bulk);
+                break;
+            default:
+                aes_par_ctr_xor(ctx->pool, &ctx->key, ctx->iv, in + i, out + i, bulk);
+                break;
+        }
+        i += bulk;
+    }
+
+    // Хвост: поток ключа следующего блока сохраняется в контексте для следующего вызова
+    if (i < in_len) {
+        switch (ctx->mode) {
+            case AES_MODE_CFB:
+                aes_core_encrypt_blocks(&ctx->key, ctx->iv, ctx->ks, 1);
+                break;
+            case AES_MODE_OFB:
+                aes_core_encrypt_blocks(&ctx->key, ctx->iv, ctx->iv, 1);
+                memcpy(ctx->ks, ctx->iv, AES_BLOCK_SIZE);
+                break;
+            default:
+                aes_core_encrypt_blocks(&ctx->key, ctx->iv, ctx->ks, 1);
+                increment_counter_be(ctx->iv, 1);
+                break;
+        }
+        xor_partial(ctx, in + i, out + i, in_len - i);
+    }
+
+    *out_len = in_len;
+    return 0;
+}
+
+int aes_mode_update(aes_mode_ctx_t* ctx, const unsigned char* in, size_t in_len,
+                    unsigned char* out, size_t* out_len) {
+    if (ctx->mode == AES_MODE_ECB || ctx->mode == AES_MODE_CBC) {
+        return update_block_mode(ctx, in, in_len, out, out_len);
+    }
+    return update_stream_mode(ctx, in, in_len, out, out_len);
+}
+
+int aes_mode_final(aes_mode_ctx_t* ctx, unsigned char* out, size_t* out_len) {
+    *out_len = 0;
+    if (ctx->mode != AES_MODE_ECB && ctx->mode != AES_MODE_CBC) {
+        return 0;
+    }
+
+    unsigned char block[AES_BLOCK_SIZE];
+    if (ctx->encrypt) {
+        // Дополнение PKCS#7 всегда добавляет блок (полный блок дополнения при кратной длине)
+        pkcs7_pad_block(block, ctx->buf, ctx->buf_len);
+        process_blocks(ctx, block, out, 1);
+        *out_len = AES_BLOCK_SIZE;
+        return 0;
+    }
+
+    if (ctx->buf_len != AES_BLOCK_SIZE) {
+        fprintf(stderr, "Error: Ciphertext length must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
+        return -1;
+    }
+    process_blocks(ctx, ctx->buf, block, 1);
+    int padding_len = pkcs7_unpad_length(block);
+    if (padding_len < 0) {
+        return -1;
+    }
+    memcpy(out, block, AES_BLOCK_SIZE - (size_t)padding_len);
+    *out_len = AES_BLOCK_SIZE - (size_t)padding_len;
+    ctx->buf_len = 0;
+    return 0;
+}
+
+void aes_mode_cleanup(aes_mode_ctx_t* ctx) {
+    aes_core_key_clear(&ctx->key);
+}
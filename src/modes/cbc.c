@@ -1,168 +1,142 @@
 #include "../../include/modes.h"
 #include "../../include/ecb.h"
+#include "../../include/aes_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <openssl/aes.h>
-
-/**
- * Применение дополнения PKCS#7 к открытому тексту
- */
-static unsigned char* apply_pkcs7_padding(const unsigned char* data, size_t data_len, size_t* padded_len) {
-    // Вычисление необходимого дополнения
-    size_t padding_bytes = AES_BLOCK_SIZE - (data_len % AES_BLOCK_SIZE);
-    *padded_len = data_len + padding_bytes;
-
-    unsigned char* padded = (unsigned char*)malloc(*padded_len);
-    if (!padded) {
-        fprintf(stderr, "Error: Failed to allocate memory\n");
-        return NULL;
-    }
 
-    // Копирование исходных данных
-    memcpy(padded, data, data_len);
+int aes_cbc_encrypt_into(const unsigned char* plaintext, size_t plaintext_len,
+                         const unsigned char* key, const unsigned char* iv,
+                         unsigned char* out, size_t out_capacity, size_t* output_size) {
+    size_t padded_len = AES_PKCS7_PADDED_SIZE(plaintext_len);
+    if (out_capacity < padded_len) {
+        fprintf(stderr, "Error: Output buffer too small (%zu bytes required)\n", padded_len);
+        return -1;
+    }
 
-    // Добавление байтов дополнения
-    for (size_t i = 0; i < padding_bytes; i++) {
-        padded[data_len + i] = (unsigned char)padding_bytes;
+    // Настройка ключа AES
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
     }
 
-    return padded;
+    // Дополнение PKCS#7 затрагивает только последний блок: он собирается до шифрования на месте
+    size_t full = plaintext_len - plaintext_len % AES_BLOCK_SIZE;
+    unsigned char last[AES_BLOCK_SIZE];
+    pkcs7_pad_block(last, plaintext + full, plaintext_len - full);
+
+    // Шифрование в режиме CBC: один поток, цепочка начинается с IV
+    aes_cbc_stream_t stream;
+    stream.in = plaintext;
+    stream.out = out;
+    stream.nblocks = full / AES_BLOCK_SIZE;
+    memcpy(stream.iv, iv, AES_BLOCK_SIZE);
+    aes_core_cbc_encrypt_multi(&aes_key, &stream, 1);
+
+    // Последний блок продолжает ту же цепочку
+    stream.in = last;
+    stream.out = out + full;
+    stream.nblocks = 1;
+    aes_core_cbc_encrypt_multi(&aes_key, &stream, 1);
+    aes_core_key_clear(&aes_key);
+
+    *output_size = padded_len;
+    return 0;
 }
 
-/**
- * Удаление и проверка дополнения PKCS#7
- */
-static unsigned char* remove_pkcs7_padding(const unsigned char* data, size_t data_len, size_t* unpadded_len) {
-    if (data_len == 0 || data_len % AES_BLOCK_SIZE != 0) {
-        fprintf(stderr, "Error: Invalid ciphertext length for decryption\n");
-        return NULL;
+int aes_cbc_encrypt_inplace(unsigned char* buf, size_t data_len, size_t buf_capacity,
+                            const unsigned char* key, const unsigned char* iv, size_t* output_size) {
+    return aes_cbc_encrypt_into(buf, data_len, key, iv, buf, buf_capacity, output_size);
+}
+
+int aes_cbc_decrypt_into(const unsigned char* ciphertext, size_t ciphertext_len,
+                         const unsigned char* key, const unsigned char* iv,
+                         unsigned char* out, size_t out_capacity, size_t* output_size) {
+    if (ciphertext_len == 0 || ciphertext_len % AES_BLOCK_SIZE != 0) {
+        fprintf(stderr, "Error: Ciphertext length must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
+        return -1;
     }
 
-    // Получение длины дополнения из последнего байта
-    unsigned char padding_len = data[data_len - 1];
+    // Настройка ключа AES
+    aes_core_key_t aes_key;
+    if (aes_core_set_decrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES decryption key\n");
+        return -1;
+    }
 
-    // Проверка длины дополнения
-    if (padding_len == 0 || padding_len > AES_BLOCK_SIZE) {
-        fprintf(stderr, "Error: Invalid PKCS#7 padding\n");
-        return NULL;
+    // Сначала последний блок (до записи в out, который может совпадать с ciphertext):
+    // длина дополнения определяет размер результата
+    size_t full = ciphertext_len - AES_BLOCK_SIZE;
+    const unsigned char* prev = (full > 0) ? ciphertext + full - AES_BLOCK_SIZE : iv;
+    unsigned char last[AES_BLOCK_SIZE];
+    aes_core_decrypt_blocks(&aes_key, ciphertext + full, last, 1);
+    xor_blocks(last, last, prev, AES_BLOCK_SIZE);
+    int padding_len = pkcs7_unpad_length(last);
+    if (padding_len < 0) {
+        aes_core_key_clear(&aes_key);
+        return -1;
     }
 
-    // Проверка корректности всех байтов дополнения
-    for (size_t i = data_len - padding_len; i < data_len; i++) {
-        if (data[i] != padding_len) {
-            fprintf(stderr, "Error: Invalid PKCS#7 padding\n");
-            return NULL;
-        }
+    size_t plain_len = ciphertext_len - (size_t)padding_len;
+    if (out_capacity < plain_len) {
+        fprintf(stderr, "Error: Output buffer too small (%zu bytes required)\n", plain_len);
+        aes_core_key_clear(&aes_key);
+        return -1;
     }
 
-    *unpadded_len = data_len - padding_len;
+    // Дешифрование CBC параллельно по блокам: каждый блок зависит только от шифртекста
+    unsigned char chain[AES_BLOCK_SIZE];
+    memcpy(chain, iv, AES_BLOCK_SIZE);
+    aes_core_cbc_decrypt(&aes_key, chain, ciphertext, out, full / AES_BLOCK_SIZE);
+    memcpy(out + full, last, AES_BLOCK_SIZE - (size_t)padding_len);
+    aes_core_key_clear(&aes_key);
 
-    unsigned char* unpadded = (unsigned char*)malloc(*unpadded_len);
-    if (!unpadded) {
-        fprintf(stderr, "Error: Failed to allocate memory\n");
-        return NULL;
-    }
+    *output_size = plain_len;
+    return 0;
+}
 
-    memcpy(unpadded, data, *unpadded_len);
-    return unpadded;
+int aes_cbc_decrypt_inplace(unsigned char* buf, size_t buf_len, const unsigned char* key,
+                            const unsigned char* iv, size_t* output_size) {
+    return aes_cbc_decrypt_into(buf, buf_len, key, iv, buf, buf_len, output_size);
 }
 
 unsigned char* aes_cbc_encrypt(const unsigned char* plaintext, size_t plaintext_len,
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size) {
-    // Применение дополнения PKCS#7
-    size_t padded_len;
-    unsigned char* padded = apply_pkcs7_padding(plaintext, plaintext_len, &padded_len);
-    if (!padded) {
-        return NULL;
-    }
-
     // Выделение буфера для выходных данных
+    size_t padded_len = AES_PKCS7_PADDED_SIZE(plaintext_len);
     unsigned char* ciphertext = (unsigned char*)malloc(padded_len);
     if (!ciphertext) {
         fprintf(stderr, "Error: Failed to allocate memory\n");
-        free(padded);
         return NULL;
     }
 
-    // Настройка ключа AES
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES encryption key\n");
-        free(padded);
+    if (aes_cbc_encrypt_into(plaintext, plaintext_len, key, iv, ciphertext, padded_len, output_size) != 0) {
         free(ciphertext);
         return NULL;
     }
-
-    // Буфер для предыдущего блока шифртекста (начинается с IV)
-    unsigned char prev_block[AES_BLOCK_SIZE];
-    memcpy(prev_block, iv, AES_BLOCK_SIZE);
-
-    // Шифрование каждого блока в режиме CBC
-    for (size_t i = 0; i < padded_len; i += AES_BLOCK_SIZE) {
-        unsigned char xored_block[AES_BLOCK_SIZE];
-        
-        // XOR текущего блока открытого текста с предыдущим блоком шифртекста
-        xor_blocks(xored_block, padded + i, prev_block, AES_BLOCK_SIZE);
-        
-        // Шифрование результата XOR
-        AES_encrypt(xored_block, ciphertext + i, &aes_key);
-        
-        // Сохранение текущего блока шифртекста для следующей итерации
-        memcpy(prev_block, ciphertext + i, AES_BLOCK_SIZE);
-    }
-
-    free(padded);
-    *output_size = padded_len;
     return ciphertext;
 }
 
 unsigned char* aes_cbc_decrypt(const unsigned char* ciphertext, size_t ciphertext_len,
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size) {
-    if (ciphertext_len % AES_BLOCK_SIZE != 0) {
+    if (ciphertext_len == 0 || ciphertext_len % AES_BLOCK_SIZE != 0) {
         fprintf(stderr, "Error: Ciphertext length must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
         return NULL;
     }
 
-    // Выделение буфера для дешифрованных данных (с дополнением)
-    unsigned char* decrypted_padded = (unsigned char*)malloc(ciphertext_len);
-    if (!decrypted_padded) {
+    // Выделение буфера для дешифрованных данных (открытый текст короче шифртекста)
+    unsigned char* plaintext = (unsigned char*)malloc(ciphertext_len);
+    if (!plaintext) {
         fprintf(stderr, "Error: Failed to allocate memory\n");
         return NULL;
     }
 
-    // Настройка ключа AES
-    AES_KEY aes_key;
-    if (AES_set_decrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES decryption key\n");
-        free(decrypted_padded);
+    if (aes_cbc_decrypt_into(ciphertext, ciphertext_len, key, iv, plaintext, ciphertext_len, output_size) != 0) {
+        free(plaintext);
         return NULL;
     }
-
-    // Буфер для предыдущего блока шифртекста (начинается с IV)
-    unsigned char prev_block[AES_BLOCK_SIZE];
-    memcpy(prev_block, iv, AES_BLOCK_SIZE);
-
-    // Дешифрование каждого блока в режиме CBC
-    for (size_t i = 0; i < ciphertext_len; i += AES_BLOCK_SIZE) {
-        unsigned char decrypted_block[AES_BLOCK_SIZE];
-        
-        // Дешифрование текущего блока
-        AES_decrypt(ciphertext + i, decrypted_block, &aes_key);
-        
-        // XOR с предыдущим блоком шифртекста
-        xor_blocks(decrypted_padded + i, decrypted_block, prev_block, AES_BLOCK_SIZE);
-        
-        // Сохранение текущего блока шифртекста для следующей итерации
-        memcpy(prev_block, ciphertext + i, AES_BLOCK_SIZE);
-    }
-
-    // Удаление дополнения PKCS#7
-    unsigned char* plaintext = remove_pkcs7_padding(decrypted_padded, ciphertext_len, output_size);
-    free(decrypted_padded);
-
     return plaintext;
 }
-
@@ -1,59 +1,83 @@
 #include "../../include/modes.h"
 #include "../../include/ecb.h"
+#include "../../include/aes_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <openssl/aes.h>
-
-unsigned char* aes_cfb_encrypt(const unsigned char* plaintext, size_t plaintext_len,
-                                const unsigned char* key, const unsigned char* iv,
-                                size_t* output_size) {
-    // CFB - потоковый шифр, дополнение не требуется
-    unsigned char* ciphertext = (unsigned char*)malloc(plaintext_len);
-    if (!ciphertext) {
-        fprintf(stderr, "Error: Failed to allocate memory\n");
-        return NULL;
-    }
 
+int aes_cfb_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
     // Настройка ключа AES для шифрования
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
         fprintf(stderr, "Error: Failed to set AES encryption key\n");
-        free(ciphertext);
-        return NULL;
+        return -1;
     }
 
     // Регистр сдвига (начинается с IV)
     unsigned char shift_register[AES_BLOCK_SIZE];
     memcpy(shift_register, iv, AES_BLOCK_SIZE);
 
-    size_t i = 0;
-    // Обработка полных блоков
-    while (i + AES_BLOCK_SIZE <= plaintext_len) {
-        unsigned char encrypted_register[AES_BLOCK_SIZE];
-        
-        // Шифрование регистра сдвига
-        AES_encrypt(shift_register, encrypted_register, &aes_key);
-        
-        // XOR с блоком открытого текста
-        xor_blocks(ciphertext + i, plaintext + i, encrypted_register, AES_BLOCK_SIZE);
-        
-        // Обновление регистра сдвига (становится блоком шифртекста)
-        memcpy(shift_register, ciphertext + i, AES_BLOCK_SIZE);
-        
-        i += AES_BLOCK_SIZE;
+    // Каждый блок шифртекста сразу записывается в выходной буфер и становится регистром сдвига
+    aes_core_cfb_encrypt(&aes_key, shift_register, in, out, len);
+    aes_core_key_clear(&aes_key);
+    return 0;
+}
+
+int aes_cfb_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
+    // Настройка ключа AES для шифрования (даже для дешифрования!)
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
     }
 
+    // Регистр сдвига (начинается с IV)
+    unsigned char shift_register[AES_BLOCK_SIZE];
+    memcpy(shift_register, iv, AES_BLOCK_SIZE);
+
+    // Полные блоки: поток ключа строится из уже известного шифртекста, пакетами
+    size_t full_blocks = len / AES_BLOCK_SIZE;
+    aes_core_cfb_decrypt(&aes_key, shift_register, in, out, full_blocks);
+    size_t i = full_blocks * AES_BLOCK_SIZE;
+
     // Обработка последнего неполного блока (если есть)
-    if (i < plaintext_len) {
+    if (i < len) {
         unsigned char encrypted_register[AES_BLOCK_SIZE];
-        size_t remaining = plaintext_len - i;
-        
+        size_t remaining = len - i;
+
         // Шифрование регистра сдвига
-        AES_encrypt(shift_register, encrypted_register, &aes_key);
-        
+        aes_core_encrypt_blocks(&aes_key, shift_register, encrypted_register, 1);
+
         // XOR только с оставшимися байтами
-        xor_blocks(ciphertext + i, plaintext + i, encrypted_register, remaining);
+        xor_blocks(out + i, in + i, encrypted_register, remaining);
+    }
+    aes_core_key_clear(&aes_key);
+    return 0;
+}
+
+int aes_cfb_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_cfb_encrypt_into(buf, len, key, iv, buf);
+}
+
+int aes_cfb_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_cfb_decrypt_into(buf, len, key, iv, buf);
+}
+
+unsigned char* aes_cfb_encrypt(const unsigned char* plaintext, size_t plaintext_len,
+                                const unsigned char* key, const unsigned char* iv,
+                                size_t* output_size) {
+    // CFB - потоковый шифр, дополнение не требуется
+    unsigned char* ciphertext = (unsigned char*)malloc(plaintext_len);
+    if (!ciphertext) {
+        fprintf(stderr, "Error: Failed to allocate memory\n");
+        return NULL;
+    }
+
+    if (aes_cfb_encrypt_into(plaintext, plaintext_len, key, iv, ciphertext) != 0) {
+        free(ciphertext);
+        return NULL;
     }
 
     *output_size = plaintext_len;
@@ -63,55 +87,17 @@ unsigned char* aes_cfb_encrypt(const unsigned char* plaintext, size_t plaintext_
 unsigned char* aes_cfb_decrypt(const unsigned char* ciphertext, size_t ciphertext_len,
                                 const unsigned char* key, const unsigned char* iv,
                                 size_t* output_size) {
-    // CFB дешифрование - то же самое, что и шифрование, но XOR с шифртекстом
     unsigned char* plaintext = (unsigned char*)malloc(ciphertext_len);
     if (!plaintext) {
         fprintf(stderr, "Error: Failed to allocate memory\n");
         return NULL;
     }
 
-    // Настройка ключа AES для шифрования (даже для дешифрования!)
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+    if (aes_cfb_decrypt_into(ciphertext, ciphertext_len, key, iv, plaintext) != 0) {
         free(plaintext);
         return NULL;
     }
 
-    // Регистр сдвига (начинается с IV)
-    unsigned char shift_register[AES_BLOCK_SIZE];
-    memcpy(shift_register, iv, AES_BLOCK_SIZE);
-
-    size_t i = 0;
-    // Обработка полных блоков
-    while (i + AES_BLOCK_SIZE <= ciphertext_len) {
-        unsigned char encrypted_register[AES_BLOCK_SIZE];
-        
-        // Шифрование регистра сдвига
-        AES_encrypt(shift_register, encrypted_register, &aes_key);
-        
-        // XOR с блоком шифртекста
-        xor_blocks(plaintext + i, ciphertext + i, encrypted_register, AES_BLOCK_SIZE);
-        
-        // Обновление регистра сдвига (становится блоком шифртекста)
-        memcpy(shift_register, ciphertext + i, AES_BLOCK_SIZE);
-        
-        i += AES_BLOCK_SIZE;
-    }
-
-    // Обработка последнего неполного блока (если есть)
-    if (i < ciphertext_len) {
-        unsigned char encrypted_register[AES_BLOCK_SIZE];
-        size_t remaining = ciphertext_len - i;
-        
-        // Шифрование регистра сдвига
-        AES_encrypt(shift_register, encrypted_register, &aes_key);
-        
-        // XOR только с оставшимися байтами
-        xor_blocks(plaintext + i, ciphertext + i, encrypted_register, remaining);
-    }
-
     *output_size = ciphertext_len;
     return plaintext;
 }
-
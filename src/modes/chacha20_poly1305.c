@@ -0,0 +1,143 @@
+#include "../../include/chacha20_poly1305.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Порция, которая шифруется и сразу аутентифицируется, пока находится в L1 */
+#define CHACHA20_POLY1305_CHUNK 4096
+
+static const unsigned char zero_pad[16] = {0};
+
+int chacha20_poly1305_init(chacha20_poly1305_ctx_t* ctx, const unsigned char* key, const unsigned char* nonce, int encrypt) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->encrypt = encrypt;
+
+    // Одноразовый ключ Poly1305 = первые 32 байта блока 0
+    unsigned char otk[CHACHA20_BLOCK_SIZE] = {0};
+    chacha20_init(&ctx->chacha, key, nonce, 0);
+    chacha20_xor(&ctx->chacha, otk, otk, sizeof(otk));
+    poly1305_init(&ctx->poly, otk);
+    memset(otk, 0, sizeof(otk));
+
+    // Блок 0 израсходован целиком: данные начинаются с блока 1
+    return 0;
+}
+
+int chacha20_poly1305_aad(chacha20_poly1305_ctx_t* ctx, const unsigned char* aad, size_t aad_len) {
+    if (ctx->data_started) {
+        fprintf(stderr, "Error: ChaCha20-Poly1305 AAD must precede the data\n");
+        return -1;
+    }
+    if (aad_len > 0) {
+        poly1305_update(&ctx->poly, aad, aad_len);
+    }
+    ctx->aad_len += aad_len;
+    return 0;
+}
+
+/**
+ * Дополнение нулями до границы 16 байт после AAD и после шифртекста
+ */
+static void pad16(chacha20_poly1305_ctx_t* ctx, uint64_t len) {
+    size_t rem = (size_t)(len % 16);
+    if (rem > 0) {
+        poly1305_update(&ctx->poly, zero_pad, 16 - rem);
+    }
+}
+
+int chacha20_poly1305_update(chacha20_poly1305_ctx_t* ctx, const unsigned char* in, size_t len, unsigned char* out) {
+    if (!ctx->data_started) {
+        pad16(ctx, ctx->aad_len);
+        ctx->data_started = 1;
+    }
+    if ((uint64_t)len > CHACHA20_POLY1305_MAX_DATA_LEN - ctx->data_len) {
+        fprintf(stderr, "Error: ChaCha20-Poly1305 message exceeds %llu bytes for a single nonce\n",
+                (unsigned long long)CHACHA20_POLY1305_MAX_DATA_LEN);
+        return -1;
+    }
+    ctx->data_len += len;
+
+    // Poly1305 всегда по шифртексту: при дешифровании до XOR, при шифровании после
+    while (len > 0) {
+        size_t n = len < CHACHA20_POLY1305_CHUNK ? len : CHACHA20_POLY1305_CHUNK;
+        if (!ctx->encrypt) {
+            poly1305_update(&ctx->poly, in, n);
+        }
+        chacha20_xor(&ctx->chacha, in, out, n);
+        if (ctx->encrypt) {
+            poly1305_update(&ctx->poly, out, n);
+        }
+        in += n;
+        out += n;
+        len -= n;
+    }
+    return 0;
+}
+
+static void store_le64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+void chacha20_poly1305_final(chacha20_poly1305_ctx_t* ctx, unsigned char* tag) {
+    if (!ctx->data_started) {
+        pad16(ctx, ctx->aad_len);
+        ctx->data_started = 1;
+    }
+    pad16(ctx, ctx->data_len);
+
+    // Последний блок: длины AAD и данных в байтах (little-endian)
+    unsigned char lengths[16];
+    store_le64(lengths, ctx->aad_len);
+    store_le64(lengths + 8, ctx->data_len);
+    poly1305_update(&ctx->poly, lengths, sizeof(lengths));
+    poly1305_final(&ctx->poly, tag);
+    memset(&ctx->chacha, 0, sizeof(ctx->chacha));
+}
+
+int chacha20_poly1305_final_verify(chacha20_poly1305_ctx_t* ctx, const unsigned char* expected_tag) {
+    unsigned char tag[CHACHA20_POLY1305_TAG_SIZE];
+    chacha20_poly1305_final(ctx, tag);
+
+    // Сравнение без раннего выхода: время не зависит от позиции первого расхождения
+    unsigned char diff = 0;
+    for (int i = 0; i < CHACHA20_POLY1305_TAG_SIZE; i++) {
+        diff |= (unsigned char)(tag[i] ^ expected_tag[i]);
+    }
+    if (diff != 0) {
+        fprintf(stderr, "Error: ChaCha20-Poly1305 authentication failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+int chacha20_poly1305_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                                   const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+                                   unsigned char* out, unsigned char* tag) {
+    chacha20_poly1305_ctx_t ctx;
+    if (chacha20_poly1305_init(&ctx, key, nonce, 1) != 0 ||
+        chacha20_poly1305_aad(&ctx, aad, aad_len) != 0 ||
+        chacha20_poly1305_update(&ctx, in, len, out) != 0) {
+        return -1;
+    }
+    chacha20_poly1305_final(&ctx, tag);
+    return 0;
+}
+
+int chacha20_poly1305_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                                   const unsigned char* nonce, const unsigned char* aad, size_t aad_len,
+                                   const unsigned char* tag, unsigned char* out) {
+    chacha20_poly1305_ctx_t ctx;
+    if (chacha20_poly1305_init(&ctx, key, nonce, 0) != 0 ||
+        chacha20_poly1305_aad(&ctx, aad, aad_len) != 0 ||
+        chacha20_poly1305_update(&ctx, in, len, out) != 0) {
+        return -1;
+    }
+    if (chacha20_poly1305_final_verify(&ctx, tag) != 0) {
+        // Непроверенный открытый текст не возвращается
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
@@ -0,0 +1,243 @@
+#include "../../include/container.h"
+#include "../../include/gcm.h"
+#include "../../include/chacha20_poly1305.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Номер порции в nonce - 32 бита */
+#define CONTAINER_MAX_CHUNKS ((uint64_t)1 << 32)
+
+static void store_le32(unsigned char* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static void store_le64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)(v >> (8 * i));
+    }
+}
+
+static uint32_t load_le32(const unsigned char* p) {
+    uint32_t v = 0;
+    for (int i = 3; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static uint64_t load_le64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 7; i >= 0; i--) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+size_t container_key_size(container_aead_t aead) {
+    return aead == CONTAINER_AEAD_CHACHA20_POLY1305 ? CHACHA20_POLY1305_KEY_SIZE : AES_128_KEY_SIZE;
+}
+
+/**
+ * Проверка параметров и вычисление числа порций
+ */
+static int setup(container_t* c, container_aead_t aead, const unsigned char* key) {
+    if (aead != CONTAINER_AEAD_AES_GCM && aead != CONTAINER_AEAD_CHACHA20_POLY1305) {
+        fprintf(stderr, "Error: unknown container AEAD %d\n", (int)aead);
+        return -1;
+    }
+    if (c->chunk_size < CONTAINER_MIN_CHUNK_SIZE || c->chunk_size > CONTAINER_MAX_CHUNK_SIZE) {
+        fprintf(stderr, "Error: container chunk size must be %d..%d bytes\n",
+                CONTAINER_MIN_CHUNK_SIZE, CONTAINER_MAX_CHUNK_SIZE);
+        return -1;
+    }
+    // Пустой открытый текст - одна пустая последняя порция
+    c->chunk_count = c->plain_len == 0 ? 1 : (c->plain_len + c->chunk_size - 1) / c->chunk_size;
+    if (c->chunk_count > CONTAINER_MAX_CHUNKS) {
+        fprintf(stderr, "Error: container needs more than 2^32 chunks, increase the chunk size\n");
+        return -1;
+    }
+    c->aead = aead;
+    memcpy(c->key, key, container_key_size(aead));
+    return 0;
+}
+
+int container_init(container_t* c, container_aead_t aead, const unsigned char* key, uint32_t chunk_size,
+                   const unsigned char* nonce_prefix, uint64_t plain_len) {
+    memset(c, 0, sizeof(*c));
+    c->chunk_size = chunk_size;
+    c->plain_len = plain_len;
+    if (setup(c, aead, key) != 0) {
+        return -1;
+    }
+    memcpy(c->nonce_prefix, nonce_prefix, CONTAINER_NONCE_PREFIX_SIZE);
+
+    // Заголовок; байты 6-7 и 27-31 зарезервированы (нули)
+    memcpy(c->header, CONTAINER_MAGIC, 4);
+    c->header[4] = CONTAINER_VERSION;
+    c->header[5] = (unsigned char)aead;
+    store_le32(c->header + 8, chunk_size);
+    store_le64(c->header + 12, plain_len);
+    memcpy(c->header + 20, nonce_prefix, CONTAINER_NONCE_PREFIX_SIZE);
+    return 0;
+}
+
+int container_parse_header(container_t* c, container_aead_t aead, const unsigned char* key,
+                           const unsigned char* header) {
+    memset(c, 0, sizeof(*c));
+    if (memcmp(header, CONTAINER_MAGIC, 4) != 0) {
+        fprintf(stderr, "Error: not a chunked container (bad magic)\n");
+        return -1;
+    }
+    if (header[4] != CONTAINER_VERSION) {
+        fprintf(stderr, "Error: unsupported container version %d\n", header[4]);
+        return -1;
+    }
+    if (header[5] != (unsigned char)aead) {
+        fprintf(stderr, "Error: container was sealed with a different algorithm\n");
+        return -1;
+    }
+    c->chunk_size = load_le32(header + 8);
+    c->plain_len = load_le64(header + 12);
+    if (setup(c, aead, key) != 0) {
+        return -1;
+    }
+    memcpy(c->nonce_prefix, header + 20, CONTAINER_NONCE_PREFIX_SIZE);
+    memcpy(c->header, header, CONTAINER_HEADER_SIZE);
+    return 0;
+}
+
+size_t container_chunk_plain_len(const container_t* c, uint64_t index) {
+    uint64_t start = index * c->chunk_size;
+    uint64_t left = c->plain_len - start;
+    return left < c->chunk_size ? (size_t)left : c->chunk_size;
+}
+
+uint64_t container_chunk_offset(const container_t* c, uint64_t index) {
+    return CONTAINER_HEADER_SIZE + index * ((uint64_t)c->chunk_size + CONTAINER_TAG_SIZE);
+}
+
+uint64_t container_index_offset(const container_t* c) {
+    return CONTAINER_HEADER_SIZE + c->plain_len + c->chunk_count * CONTAINER_TAG_SIZE;
+}
+
+uint64_t container_file_size(const container_t* c) {
+    return container_index_offset(c) + c->chunk_count * 8 + CONTAINER_FOOTER_SIZE;
+}
+
+void container_encode_index(const container_t* c, unsigned char* out) {
+    for (uint64_t i = 0; i < c->chunk_count; i++) {
+        store_le64(out + i * 8, container_chunk_offset(c, i));
+    }
+    unsigned char* footer = out + c->chunk_count * 8;
+    memcpy(footer, CONTAINER_INDEX_MAGIC, 4);
+    store_le32(footer + 4, (uint32_t)(c->chunk_count - 1));
+    store_le64(footer + 8, container_index_offset(c));
+}
+
+int container_check_index(const container_t* c, const unsigned char* index) {
+    // Индекс не секретен, но должен в точности соответствовать аутентифицированному заголовку
+    const unsigned char* footer = index + c->chunk_count * 8;
+    if (memcmp(footer, CONTAINER_INDEX_MAGIC, 4) != 0 ||
+        load_le32(footer + 4) != (uint32_t)(c->chunk_count - 1) ||
+        load_le64(footer + 8) != container_index_offset(c)) {
+        return -1;
+    }
+    for (uint64_t i = 0; i < c->chunk_count; i++) {
+        if (load_le64(index + i * 8) != container_chunk_offset(c, i)) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Nonce порции: префикс || номер (big-endian) || признак последней порции
+ */
+static void chunk_nonce(const container_t* c, uint64_t index, unsigned char* nonce) {
+    memcpy(nonce, c->nonce_prefix, CONTAINER_NONCE_PREFIX_SIZE);
+    for (int i = 0; i < 4; i++) {
+        nonce[CONTAINER_NONCE_PREFIX_SIZE + i] = (unsigned char)(index >> (24 - 8 * i));
+    }
+    nonce[11] = index + 1 == c->chunk_count ? 1 : 0;
+}
+
+typedef struct {
+    const container_t* c;
+    uint64_t first;
+    const unsigned char* in;
+    unsigned char* out;
+    int seal;
+    int* failed;                        // По признаку на порцию
+} chunk_job_t;
+
+static void run_chunk(void* arg, size_t k) {
+    chunk_job_t* job = (chunk_job_t*)arg;
+    const container_t* c = job->c;
+    uint64_t index = job->first + k;
+    size_t len = container_chunk_plain_len(c, index);
+    // Порции пакета, кроме последней в контейнере, полные: позиции в буферах известны заранее
+    size_t sealed_stride = (size_t)c->chunk_size + CONTAINER_TAG_SIZE;
+    const unsigned char* in = job->in + k * (job->seal ? c->chunk_size : sealed_stride);
+    unsigned char* out = job->out + k * (job->seal ? sealed_stride : c->chunk_size);
+
+    unsigned char nonce[12];
+    chunk_nonce(c, index, nonce);
+    int rc;
+    if (job->seal) {
+        rc = c->aead == CONTAINER_AEAD_AES_GCM
+           ? aes_gcm_encrypt_into(in, len, c->key, nonce, c->header, CONTAINER_HEADER_SIZE, out, out + len)
+           : chacha20_poly1305_encrypt_into(in, len, c->key, nonce, c->header, CONTAINER_HEADER_SIZE, out, out + len);
+    } else {
+        rc = c->aead == CONTAINER_AEAD_AES_GCM
+           ? aes_gcm_decrypt_into(in, len, c->key, nonce, c->header, CONTAINER_HEADER_SIZE, in + len, out)
+           : chacha20_poly1305_decrypt_into(in, len, c->key, nonce, c->header, CONTAINER_HEADER_SIZE, in + len, out);
+    }
+    job->failed[k] = rc != 0;
+}
+
+/* Порций в одном вызове run_chunks (признаки ошибок на стеке) */
+#define CONTAINER_MAX_BATCH 1024
+
+static int run_chunks(thread_pool_t* pool, const container_t* c, uint64_t first, const unsigned char* in,
+                      unsigned char* out, size_t count, int seal, uint64_t* bad_chunk) {
+    int failed[CONTAINER_MAX_BATCH];
+    while (count > 0) {
+        size_t n = count < CONTAINER_MAX_BATCH ? count : CONTAINER_MAX_BATCH;
+        chunk_job_t job = { c, first, in, out, seal, failed };
+        thread_pool_run(pool, run_chunk, &job, n);
+        for (size_t k = 0; k < n; k++) {
+            if (failed[k]) {
+                if (bad_chunk) {
+                    *bad_chunk = first + k;
+                }
+                return -1;
+            }
+        }
+        size_t sealed_stride = (size_t)c->chunk_size + CONTAINER_TAG_SIZE;
+        in += n * (seal ? c->chunk_size : sealed_stride);
+        out += n * (seal ? sealed_stride : c->chunk_size);
+        first += n;
+        count -= n;
+    }
+    return 0;
+}
+
+int container_seal_chunks(thread_pool_t* pool, const container_t* c, uint64_t first,
+                          const unsigned char* in, unsigned char* out, size_t count) {
+    if (first + count > c->chunk_count) {
+        fprintf(stderr, "Error: container chunk index out of range\n");
+        return -1;
+    }
+    return run_chunks(pool, c, first, in, out, count, 1, NULL);
+}
+
+int container_open_chunks(thread_pool_t* pool, const container_t* c, uint64_t first,
+                          const unsigned char* in, unsigned char* out, size_t count, uint64_t* bad_chunk) {
+    if (first + count > c->chunk_count) {
+        fprintf(stderr, "Error: container chunk index out of range\n");
+        return -1;
+    }
+    return run_chunks(pool, c, first, in, out, count, 0, bad_chunk);
+}
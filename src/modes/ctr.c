@@ -1,21 +1,76 @@
 #include "../../include/modes.h"
 #include "../../include/ecb.h"
+#include "../../include/aes_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <openssl/aes.h>
 
-/**
- * Инкремент счетчика (big-endian)
- */
-static void increment_counter(unsigned char* counter) {
-    // Инкремент с конца (big-endian)
-    for (int i = AES_BLOCK_SIZE - 1; i >= 0; i--) {
-        if (++counter[i] != 0) {
-            break;  // Нет переноса
+int aes_ctr_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
+    // Настройка ключа AES для шифрования
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
+    }
+
+    // Инициализация счетчика из IV
+    unsigned char counter[AES_BLOCK_SIZE];
+    memcpy(counter, iv, AES_BLOCK_SIZE);
+
+    // Блоки счетчика шифруются пакетами, поток ключа накладывается широкими словами;
+    // последний неполный блок использует только нужные байты потока ключа
+    aes_core_ctr_xor(&aes_key, counter, in, out, len);
+    aes_core_key_clear(&aes_key);
+    return 0;
+}
+
+int aes_ctr_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
+    // CTR - шифрование и дешифрование идентичны (XOR с тем же потоком ключа)
+    return aes_ctr_encrypt_into(in, len, key, iv, out);
+}
+
+int aes_ctr_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_ctr_encrypt_into(buf, len, key, iv, buf);
+}
+
+int aes_ctr_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_ctr_encrypt_into(buf, len, key, iv, buf);
+}
+
+int aes_ctr_decrypt_range(const unsigned char* in, size_t len, const unsigned char* key,
+                          const unsigned char* iv, unsigned long long offset, unsigned char* out) {
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
+    }
+
+    // Счетчик блока, в который попадает offset
+    unsigned char counter[AES_BLOCK_SIZE];
+    memcpy(counter, iv, AES_BLOCK_SIZE);
+    increment_counter_be(counter, offset / AES_BLOCK_SIZE);
+
+    // Начало участка внутри блока: часть потока ключа этого блока пропускается
+    size_t skip = (size_t)(offset % AES_BLOCK_SIZE);
+    if (skip > 0 && len > 0) {
+        unsigned char ks[AES_BLOCK_SIZE];
+        aes_core_encrypt_blocks(&aes_key, counter, ks, 1);
+        increment_counter_be(counter, 1);
+        size_t take = AES_BLOCK_SIZE - skip;
+        if (take > len) {
+            take = len;
         }
-        // Продолжаем, если был перенос
+        xor_blocks(out, in, ks + skip, take);
+        in += take;
+        out += take;
+        len -= take;
     }
+
+    aes_core_ctr_xor(&aes_key, counter, in, out, len);
+    aes_core_key_clear(&aes_key);
+    return 0;
 }
 
 unsigned char* aes_ctr_encrypt(const unsigned char* plaintext, size_t plaintext_len,
@@ -28,47 +83,11 @@ unsigned char* aes_ctr_encrypt(const unsigned char* plaintext, size_t plaintext_
         return NULL;
     }
 
-    // Настройка ключа AES для шифрования
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+    if (aes_ctr_encrypt_into(plaintext, plaintext_len, key, iv, ciphertext) != 0) {
         free(ciphertext);
         return NULL;
     }
 
-    // Инициализация счетчика из IV
-    unsigned char counter[AES_BLOCK_SIZE];
-    memcpy(counter, iv, AES_BLOCK_SIZE);
-
-    size_t i = 0;
-    // Обработка полных блоков
-    while (i + AES_BLOCK_SIZE <= plaintext_len) {
-        unsigned char keystream[AES_BLOCK_SIZE];
-        
-        // Шифрование счетчика для генерации потока ключа
-        AES_encrypt(counter, keystream, &aes_key);
-        
-        // XOR потока ключа с блоком открытого текста
-        xor_blocks(ciphertext + i, plaintext + i, keystream, AES_BLOCK_SIZE);
-        
-        // Инкремент счетчика
-        increment_counter(counter);
-        
-        i += AES_BLOCK_SIZE;
-    }
-
-    // Обработка последнего неполного блока (если есть)
-    if (i < plaintext_len) {
-        unsigned char keystream[AES_BLOCK_SIZE];
-        size_t remaining = plaintext_len - i;
-        
-        // Шифрование счетчика
-        AES_encrypt(counter, keystream, &aes_key);
-        
-        // XOR только с оставшимися байтами
-        xor_blocks(ciphertext + i, plaintext + i, keystream, remaining);
-    }
-
     *output_size = plaintext_len;
     return ciphertext;
 }
@@ -79,4 +98,3 @@ unsigned char* aes_ctr_decrypt(const unsigned char* ciphertext, size_t ciphertex
     // CTR - шифрование и дешифрование идентичны (XOR с тем же потоком ключа)
     return aes_ctr_encrypt(ciphertext, ciphertext_len, key, iv, output_size);
 }
-
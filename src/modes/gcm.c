@@ -0,0 +1,212 @@
+#include "../../include/gcm.h"
+#include "../../include/modes.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * inc32: увеличение младших 32 бит блока счетчика (без переноса в старшие биты)
+ */
+static void inc32(unsigned char* counter) {
+    for (int i = AES_BLOCK_SIZE - 1; i >= AES_BLOCK_SIZE - 4; i--) {
+        if (++counter[i] != 0) {
+            break;
+        }
+    }
+}
+
+int aes_gcm_init(aes_gcm_ctx_t* ctx, const unsigned char* key, const unsigned char* iv, int encrypt) {
+    memset(ctx, 0, sizeof(*ctx));
+    ctx->encrypt = encrypt;
+
+    // GCM использует только прямое преобразование AES (и для дешифрования)
+    if (aes_core_set_encrypt_key(&ctx->key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
+    }
+
+    // H = E_K(0^128)
+    unsigned char h[AES_BLOCK_SIZE] = {0};
+    aes_core_encrypt_blocks(&ctx->key, h, h, 1);
+    ghash_init(&ctx->ghash, h);
+
+    // J0 = IV || 0^31 || 1; данные шифруются начиная с inc32(J0)
+    memcpy(ctx->j0, iv, AES_GCM_IV_SIZE);
+    ctx->j0[AES_BLOCK_SIZE - 1] = 1;
+    memcpy(ctx->counter, ctx->j0, AES_BLOCK_SIZE);
+    inc32(ctx->counter);
+    return 0;
+}
+
+int aes_gcm_aad(aes_gcm_ctx_t* ctx, const unsigned char* aad, size_t aad_len) {
+    if (ctx->data_started) {
+        fprintf(stderr, "Error: GCM AAD must precede the data\n");
+        return -1;
+    }
+    ctx->aad_len += aad_len;
+
+    if (ctx->buf_len > 0) {
+        size_t take = AES_BLOCK_SIZE - ctx->buf_len;
+        if (take > aad_len) {
+            take = aad_len;
+        }
+        memcpy(ctx->buf + ctx->buf_len, aad, take);
+        ctx->buf_len += take;
+        aad += take;
+        aad_len -= take;
+        if (ctx->buf_len < AES_BLOCK_SIZE) {
+            return 0;
+        }
+        ghash_blocks(&ctx->ghash, ctx->y, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+
+    size_t nblocks = aad_len / AES_BLOCK_SIZE;
+    ghash_blocks(&ctx->ghash, ctx->y, aad, nblocks);
+    ctx->buf_len = aad_len - nblocks * AES_BLOCK_SIZE;
+    memcpy(ctx->buf, aad + nblocks * AES_BLOCK_SIZE, ctx->buf_len);
+    return 0;
+}
+
+/**
+ * Завершение AAD: неполный блок дополняется нулями
+ */
+static void start_data(aes_gcm_ctx_t* ctx) {
+    if (ctx->buf_len > 0) {
+        memset(ctx->buf + ctx->buf_len, 0, AES_BLOCK_SIZE - ctx->buf_len);
+        ghash_blocks(&ctx->ghash, ctx->y, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+    ctx->data_started = 1;
+}
+
+/**
+ * XOR с остатком потока ключа текущего блока; шифртекст блока собирается в buf для GHASH
+ * Возвращает число обработанных байт
+ */
+static size_t xor_partial(aes_gcm_ctx_t* ctx, const unsigned char* in, unsigned char* out, size_t len) {
+    size_t i = 0;
+    while (i < len && ctx->buf_len < AES_BLOCK_SIZE) {
+        unsigned char c = in[i];
+        unsigned char p = (unsigned char)(c ^ ctx->ks[ctx->buf_len]);
+        out[i] = p;
+        ctx->buf[ctx->buf_len++] = ctx->encrypt ? p : c;
+        i++;
+    }
+    if (ctx->buf_len == AES_BLOCK_SIZE) {
+        ghash_blocks(&ctx->ghash, ctx->y, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+    return i;
+}
+
+int aes_gcm_update(aes_gcm_ctx_t* ctx, const unsigned char* in, size_t len, unsigned char* out) {
+    if (!ctx->data_started) {
+        start_data(ctx);
+    }
+    if ((uint64_t)len > AES_GCM_MAX_DATA_LEN - ctx->data_len) {
+        fprintf(stderr, "Error: GCM message exceeds %llu bytes for a single IV\n",
+                (unsigned long long)AES_GCM_MAX_DATA_LEN);
+        return -1;
+    }
+    ctx->data_len += len;
+
+    size_t i = 0;
+    if (ctx->buf_len > 0) {
+        i = xor_partial(ctx, in, out, len);
+    }
+
+    // Полные блоки: CTR и GHASH за один проход
+    size_t nblocks = (len - i) / AES_BLOCK_SIZE;
+    aes_core_gcm_ctr_ghash(&ctx->key, &ctx->ghash, ctx->counter, ctx->y, in + i, out + i, nblocks, ctx->encrypt);
+    i += nblocks * AES_BLOCK_SIZE;
+
+    // Хвост: поток ключа следующего блока сохраняется для следующего вызова
+    if (i < len) {
+        aes_core_encrypt_blocks(&ctx->key, ctx->counter, ctx->ks, 1);
+        inc32(ctx->counter);
+        xor_partial(ctx, in + i, out + i, len - i);
+    }
+    return 0;
+}
+
+void aes_gcm_final(aes_gcm_ctx_t* ctx, unsigned char* tag) {
+    if (!ctx->data_started) {
+        start_data(ctx);
+    }
+    if (ctx->buf_len > 0) {
+        memset(ctx->buf + ctx->buf_len, 0, AES_BLOCK_SIZE - ctx->buf_len);
+        ghash_blocks(&ctx->ghash, ctx->y, ctx->buf, 1);
+        ctx->buf_len = 0;
+    }
+
+    // Последний блок GHASH: длины AAD и данных в битах (big-endian)
+    unsigned char lengths[AES_BLOCK_SIZE];
+    uint64_t aad_bits = ctx->aad_len * 8;
+    uint64_t data_bits = ctx->data_len * 8;
+    for (int i = 7; i >= 0; i--) {
+        lengths[i] = (unsigned char)aad_bits;
+        lengths[8 + i] = (unsigned char)data_bits;
+        aad_bits >>= 8;
+        data_bits >>= 8;
+    }
+    ghash_blocks(&ctx->ghash, ctx->y, lengths, 1);
+
+    // Тег = E_K(J0) ^ GHASH
+    unsigned char ekj0[AES_BLOCK_SIZE];
+    aes_core_encrypt_blocks(&ctx->key, ctx->j0, ekj0, 1);
+    xor_blocks(tag, ekj0, ctx->y, AES_GCM_TAG_SIZE);
+}
+
+int aes_gcm_final_verify(aes_gcm_ctx_t* ctx, const unsigned char* expected_tag) {
+    unsigned char tag[AES_GCM_TAG_SIZE];
+    aes_gcm_final(ctx, tag);
+
+    // Сравнение без раннего выхода: время не зависит от позиции первого расхождения
+    unsigned char diff = 0;
+    for (int i = 0; i < AES_GCM_TAG_SIZE; i++) {
+        diff |= (unsigned char)(tag[i] ^ expected_tag[i]);
+    }
+    if (diff != 0) {
+        fprintf(stderr, "Error: GCM authentication failed\n");
+        return -1;
+    }
+    return 0;
+}
+
+void aes_gcm_cleanup(aes_gcm_ctx_t* ctx) {
+    aes_core_key_clear(&ctx->key);
+}
+
+int aes_gcm_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, const unsigned char* aad, size_t aad_len,
+                         unsigned char* out, unsigned char* tag) {
+    aes_gcm_ctx_t ctx;
+    if (aes_gcm_init(&ctx, key, iv, 1) != 0) {
+        return -1;
+    }
+    if (aes_gcm_aad(&ctx, aad, aad_len) != 0 || aes_gcm_update(&ctx, in, len, out) != 0) {
+        aes_gcm_cleanup(&ctx);
+        return -1;
+    }
+    aes_gcm_final(&ctx, tag);
+    aes_gcm_cleanup(&ctx);
+    return 0;
+}
+
+int aes_gcm_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, const unsigned char* aad, size_t aad_len,
+                         const unsigned char* tag, unsigned char* out) {
+    aes_gcm_ctx_t ctx;
+    if (aes_gcm_init(&ctx, key, iv, 0) != 0) {
+        return -1;
+    }
+    int rc = (aes_gcm_aad(&ctx, aad, aad_len) != 0 || aes_gcm_update(&ctx, in, len, out) != 0) ? -1
+             : aes_gcm_final_verify(&ctx, tag);
+    aes_gcm_cleanup(&ctx);
+    if (rc != 0) {
+        // Непроверенный открытый текст не возвращается
+        memset(out, 0, len);
+        return -1;
+    }
+    return 0;
+}
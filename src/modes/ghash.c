@@ -0,0 +1,123 @@
+#include "../../include/ghash.h"
+#include <stdint.h>
+#include <string.h>
+
+static inline uint64_t load_be64(const unsigned char* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) {
+        v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+static inline void store_be64(unsigned char* p, uint64_t v) {
+    for (int i = 7; i >= 0; i--) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+/**
+ * Умножение без переносов 64x64 -> младшие 64 бита на обычном целочисленном умножении:
+ * биты разнесены по четырем маскам с "дырами", чтобы переносы не смешивали соседние биты
+ * (время не зависит от данных)
+ */
+static inline uint64_t bmul64(uint64_t x, uint64_t y) {
+    uint64_t x0 = x & 0x1111111111111111ULL;
+    uint64_t x1 = x & 0x2222222222222222ULL;
+    uint64_t x2 = x & 0x4444444444444444ULL;
+    uint64_t x3 = x & 0x8888888888888888ULL;
+    uint64_t y0 = y & 0x1111111111111111ULL;
+    uint64_t y1 = y & 0x2222222222222222ULL;
+    uint64_t y2 = y & 0x4444444444444444ULL;
+    uint64_t y3 = y & 0x8888888888888888ULL;
+    uint64_t z0 = (x0 * y0) ^ (x1 * y3) ^ (x2 * y2) ^ (x3 * y1);
+    uint64_t z1 = (x0 * y1) ^ (x1 * y0) ^ (x2 * y3) ^ (x3 * y2);
+    uint64_t z2 = (x0 * y2) ^ (x1 * y1) ^ (x2 * y0) ^ (x3 * y3);
+    uint64_t z3 = (x0 * y3) ^ (x1 * y2) ^ (x2 * y1) ^ (x3 * y0);
+    z0 &= 0x1111111111111111ULL;
+    z1 &= 0x2222222222222222ULL;
+    z2 &= 0x4444444444444444ULL;
+    z3 &= 0x8888888888888888ULL;
+    return z0 | z1 | z2 | z3;
+}
+
+/**
+ * Разворот порядка битов 64-битного слова
+ */
+static inline uint64_t rev64(uint64_t x) {
+    x = ((x & 0x5555555555555555ULL) << 1) | ((x >> 1) & 0x5555555555555555ULL);
+    x = ((x & 0x3333333333333333ULL) << 2) | ((x >> 2) & 0x3333333333333333ULL);
+    x = ((x & 0x0F0F0F0F0F0F0F0FULL) << 4) | ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL);
+    return __builtin_bswap64(x);
+}
+
+/**
+ * Переносимый GHASH: умножение Карацубы на 64-битных половинах, старшие половины
+ * произведений получаются из умножения развернутых слов, затем редукция
+ */
+static void ghash_ctmul64(const unsigned char* h, unsigned char* y, const unsigned char* in, size_t nblocks) {
+    uint64_t y1 = load_be64(y), y0 = load_be64(y + 8);
+    uint64_t h1 = load_be64(h), h0 = load_be64(h + 8);
+    uint64_t h0r = rev64(h0), h1r = rev64(h1);
+    uint64_t h2 = h0 ^ h1, h2r = h0r ^ h1r;
+
+    for (size_t i = 0; i < nblocks; i++, in += 16) {
+        y1 ^= load_be64(in);
+        y0 ^= load_be64(in + 8);
+
+        uint64_t y0r = rev64(y0), y1r = rev64(y1);
+        uint64_t y2 = y0 ^ y1, y2r = y0r ^ y1r;
+
+        uint64_t z0 = bmul64(y0, h0);
+        uint64_t z1 = bmul64(y1, h1);
+        uint64_t z2 = bmul64(y2, h2);
+        uint64_t z0h = bmul64(y0r, h0r);
+        uint64_t z1h = bmul64(y1r, h1r);
+        uint64_t z2h = bmul64(y2r, h2r);
+        z2 ^= z0 ^ z1;
+        z2h ^= z0h ^ z1h;
+        z0h = rev64(z0h) >> 1;
+        z1h = rev64(z1h) >> 1;
+        z2h = rev64(z2h) >> 1;
+
+        uint64_t v0 = z0, v1 = z0h ^ z2, v2 = z1 ^ z2h, v3 = z1h;
+
+        // Сдвиг на бит (отраженное представление) и редукция по x^128 + x^7 + x^2 + x + 1
+        v3 = (v3 << 1) | (v2 >> 63);
+        v2 = (v2 << 1) | (v1 >> 63);
+        v1 = (v1 << 1) | (v0 >> 63);
+        v0 = (v0 << 1);
+        v2 ^= v0 ^ (v0 >> 1) ^ (v0 >> 2) ^ (v0 >> 7);
+        v1 ^= (v0 << 63) ^ (v0 << 62) ^ (v0 << 57);
+        v3 ^= v1 ^ (v1 >> 1) ^ (v1 >> 2) ^ (v1 >> 7);
+        v2 ^= (v1 << 63) ^ (v1 << 62) ^ (v1 << 57);
+
+        y0 = v2;
+        y1 = v3;
+    }
+
+    store_be64(y, y1);
+    store_be64(y + 8, y0);
+}
+
+void ghash_init(ghash_key_t* key, const unsigned char* h) {
+    memset(key, 0, sizeof(*key));
+    memcpy(key->h, h, 16);
+    key->clmul = ghash_clmul_available();
+#ifdef CRYPTOCORE_HAVE_AESNI
+    if (key->clmul) {
+        ghash_clmul_init(h, &key->hpow[0][0]);
+    }
+#endif
+}
+
+void ghash_blocks(const ghash_key_t* key, unsigned char* y, const unsigned char* in, size_t nblocks) {
+#ifdef CRYPTOCORE_HAVE_AESNI
+    if (key->clmul) {
+        ghash_clmul_blocks(&key->hpow[0][0], y, in, nblocks);
+        return;
+    }
+#endif
+    ghash_ctmul64(key->h, y, in, nblocks);
+}
@@ -1,9 +1,42 @@
 #include "../../include/modes.h"
 #include "../../include/ecb.h"
+#include "../../include/aes_core.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <openssl/aes.h>
+
+int aes_ofb_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
+    // Настройка ключа AES для шифрования
+    aes_core_key_t aes_key;
+    if (aes_core_set_encrypt_key(&aes_key, key) < 0) {
+        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+        return -1;
+    }
+
+    // Регистр обратной связи (начинается с IV)
+    unsigned char feedback[AES_BLOCK_SIZE];
+    memcpy(feedback, iv, AES_BLOCK_SIZE);
+
+    // Поток ключа накладывается прямо в выходной буфер, включая неполный последний блок
+    aes_core_ofb_xor(&aes_key, feedback, in, out, len);
+    aes_core_key_clear(&aes_key);
+    return 0;
+}
+
+int aes_ofb_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key,
+                         const unsigned char* iv, unsigned char* out) {
+    // OFB - шифрование и дешифрование идентичны (XOR с тем же потоком ключа)
+    return aes_ofb_encrypt_into(in, len, key, iv, out);
+}
+
+int aes_ofb_encrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_ofb_encrypt_into(buf, len, key, iv, buf);
+}
+
+int aes_ofb_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key, const unsigned char* iv) {
+    return aes_ofb_encrypt_into(buf, len, key, iv, buf);
+}
 
 unsigned char* aes_ofb_encrypt(const unsigned char* plaintext, size_t plaintext_len,
                                 const unsigned char* key, const unsigned char* iv,
@@ -15,47 +48,11 @@ unsigned char* aes_ofb_encrypt(const unsigned char* plaintext, size_t plaintext_
         return NULL;
     }
 
-    // Настройка ключа AES для шифрования
-    AES_KEY aes_key;
-    if (AES_set_encrypt_key(key, 128, &aes_key) < 0) {
-        fprintf(stderr, "Error: Failed to set AES encryption key\n");
+    if (aes_ofb_encrypt_into(plaintext, plaintext_len, key, iv, ciphertext) != 0) {
         free(ciphertext);
         return NULL;
     }
 
-    // Регистр обратной связи (начинается с IV)
-    unsigned char feedback[AES_BLOCK_SIZE];
-    memcpy(feedback, iv, AES_BLOCK_SIZE);
-
-    size_t i = 0;
-    // Обработка полных блоков
-    while (i + AES_BLOCK_SIZE <= plaintext_len) {
-        unsigned char keystream[AES_BLOCK_SIZE];
-        
-        // Шифрование регистра обратной связи для генерации потока ключа
-        AES_encrypt(feedback, keystream, &aes_key);
-        
-        // XOR потока ключа с блоком открытого текста
-        xor_blocks(ciphertext + i, plaintext + i, keystream, AES_BLOCK_SIZE);
-        
-        // Обновление регистра обратной связи (становится потоком ключа)
-        memcpy(feedback, keystream, AES_BLOCK_SIZE);
-        
-        i += AES_BLOCK_SIZE;
-    }
-
-    // Обработка последнего неполного блока (если есть)
-    if (i < plaintext_len) {
-        unsigned char keystream[AES_BLOCK_SIZE];
-        size_t remaining = plaintext_len - i;
-        
-        // Шифрование регистра обратной связи
-        AES_encrypt(feedback, keystream, &aes_key);
-        
-        // XOR только с оставшимися байтами
-        xor_blocks(ciphertext + i, plaintext + i, keystream, remaining);
-    }
-
     *output_size = plaintext_len;
     return ciphertext;
 }
@@ -66,4 +63,3 @@ unsigned char* aes_ofb_decrypt(const unsigned char* ciphertext, size_t ciphertex
     // OFB - шифрование и дешифрование идентичны (XOR с тем же потоком ключа)
     return aes_ofb_encrypt(ciphertext, ciphertext_len, key, iv, output_size);
 }
-
@@ -1,12 +1,24 @@
 #include "../../include/modes.h"
+#include "../../include/xor.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <openssl/rand.h>
 
 void xor_blocks(unsigned char* output, const unsigned char* a, const unsigned char* b, size_t len) {
-    for (size_t i = 0; i < len; i++) {
-        output[i] = a[i] ^ b[i];
+    // Общий векторизованный XOR (SSE2/AVX2 или машинные слова)
+    xor_bytes(output, a, b, len);
+}
+
+void increment_counter_be(unsigned char* counter, unsigned long long blocks) {
+    for (int i = 0; i < 16; i++) {
+        unsigned int idx = 15 - i;
+        unsigned int add = (unsigned int)(blocks & 0xFF);
+        unsigned int sum = counter[idx] + add;
+        counter[idx] = (unsigned char)(sum & 0xFF);
+        blocks >>= 8;
+        if ((sum >> 8) == 0 && blocks == 0) break;
+        blocks += (sum >> 8);
     }
 }
 
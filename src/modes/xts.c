@@ -0,0 +1,162 @@
+#include "../../include/xts.h"
+#include <stdio.h>
+#include <string.h>
+
+/* Единиц, начальные твики которых шифруются одним пакетом */
+#define XTS_UNIT_BATCH 64
+
+/* Минимальный участок на поток (64 КБ) и верхняя граница числа участков */
+#define XTS_PAR_MIN_BYTES (64 * 1024)
+#define XTS_PAR_MAX_SLICES 256
+
+int aes_xts_init(aes_xts_key_t* ctx, const unsigned char* key, size_t unit_size, int encrypt) {
+    memset(ctx, 0, sizeof(*ctx));
+    if (unit_size < AES_BLOCK_SIZE || unit_size % AES_BLOCK_SIZE != 0) {
+        fprintf(stderr, "Error: XTS data unit size must be a multiple of %d bytes\n", AES_BLOCK_SIZE);
+        return -1;
+    }
+    // IEEE 1619-2018: одинаковые половины ключа недопустимы
+    if (memcmp(key, key + AES_128_KEY_SIZE, AES_128_KEY_SIZE) == 0) {
+        fprintf(stderr, "Error: XTS key halves must differ\n");
+        return -1;
+    }
+    int rc = encrypt ? aes_core_set_encrypt_key(&ctx->data_key, key)
+                     : aes_core_set_decrypt_key(&ctx->data_key, key);
+    if (rc < 0 || aes_core_set_encrypt_key(&ctx->tweak_key, key + AES_128_KEY_SIZE) < 0) {
+        fprintf(stderr, "Error: Failed to set AES XTS key\n");
+        aes_xts_cleanup(ctx);
+        return -1;
+    }
+    ctx->unit_size = unit_size;
+    ctx->encrypt = encrypt;
+    return 0;
+}
+
+static void store_le64(unsigned char* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) {
+        p[i] = (unsigned char)v;
+        v >>= 8;
+    }
+}
+
+/**
+ * Умножение твика на x в GF(2^128) (little-endian, многочлен x^128 + x^7 + x^2 + x + 1)
+ */
+static void mul_alpha(unsigned char* t) {
+    unsigned char carry = t[AES_BLOCK_SIZE - 1] >> 7;
+    for (int i = AES_BLOCK_SIZE - 1; i > 0; i--) {
+        t[i] = (unsigned char)((t[i] << 1) | (t[i - 1] >> 7));
+    }
+    t[0] = (unsigned char)((t[0] << 1) ^ (0x87 & (0 - carry)));
+}
+
+/**
+ * Одна единица данных длиной len >= AES_BLOCK_SIZE; tweak - зашифрованный номер единицы
+ */
+static void crypt_unit(const aes_xts_key_t* ctx, unsigned char* tweak, const unsigned char* in,
+                       unsigned char* out, size_t len) {
+    size_t tail = len % AES_BLOCK_SIZE;
+    // При заимствовании шифртекста последний полный блок обрабатывается отдельно
+    size_t nblocks = len / AES_BLOCK_SIZE - (tail ? 1 : 0);
+    aes_core_xts_blocks(&ctx->data_key, tweak, in, out, nblocks, ctx->encrypt);
+    if (!tail) {
+        return;
+    }
+    in += nblocks * AES_BLOCK_SIZE;
+    out += nblocks * AES_BLOCK_SIZE;
+
+    // Твики двух последних блоков: T(m-1) и T(m)
+    unsigned char t_prev[AES_BLOCK_SIZE], t_last[AES_BLOCK_SIZE];
+    memcpy(t_prev, tweak, AES_BLOCK_SIZE);
+    memcpy(t_last, tweak, AES_BLOCK_SIZE);
+    mul_alpha(t_last);
+
+    unsigned char block[AES_BLOCK_SIZE];
+    unsigned char partial[AES_BLOCK_SIZE];
+    memcpy(partial, in + AES_BLOCK_SIZE, tail);
+    // Шифрование: блок m-1 с T(m-1), дешифрование: с T(m)
+    aes_core_xts_blocks(&ctx->data_key, ctx->encrypt ? t_prev : t_last, in, block, 1, ctx->encrypt);
+    memcpy(out + AES_BLOCK_SIZE, block, tail);
+    memcpy(block, partial, tail);
+    aes_core_xts_blocks(&ctx->data_key, ctx->encrypt ? t_last : t_prev, block, out, 1, ctx->encrypt);
+}
+
+/**
+ * Последовательная обработка: начальные твики E_K2(номер) до XTS_UNIT_BATCH единиц
+ * шифруются одним вызовом (пакетом через конвейер AES), а не по блоку на единицу
+ */
+static void crypt_units(const aes_xts_key_t* ctx, uint64_t unit, const unsigned char* in,
+                        unsigned char* out, size_t len) {
+    unsigned char tweaks[XTS_UNIT_BATCH * AES_BLOCK_SIZE];
+    while (len > 0) {
+        size_t nunits = (len + ctx->unit_size - 1) / ctx->unit_size;
+        if (nunits > XTS_UNIT_BATCH) {
+            nunits = XTS_UNIT_BATCH;
+        }
+        memset(tweaks, 0, nunits * AES_BLOCK_SIZE);
+        for (size_t i = 0; i < nunits; i++) {
+            store_le64(tweaks + i * AES_BLOCK_SIZE, unit + i);
+        }
+        aes_core_encrypt_blocks(&ctx->tweak_key, tweaks, tweaks, nunits);
+
+        for (size_t i = 0; i < nunits; i++) {
+            size_t ulen = len < ctx->unit_size ? len : ctx->unit_size;
+            crypt_unit(ctx, tweaks + i * AES_BLOCK_SIZE, in, out, ulen);
+            in += ulen;
+            out += ulen;
+            len -= ulen;
+        }
+        unit += nunits;
+    }
+}
+
+typedef struct {
+    const aes_xts_key_t* ctx;
+    uint64_t first_unit;
+    const unsigned char* in;
+    unsigned char* out;
+    size_t len;
+    size_t units_per_slice;
+} xts_job_t;
+
+static void run_slice(void* arg, size_t index) {
+    xts_job_t* job = (xts_job_t*)arg;
+    size_t offset = index * job->units_per_slice * job->ctx->unit_size;
+    size_t len = job->len - offset;
+    size_t slice_len = job->units_per_slice * job->ctx->unit_size;
+    if (len > slice_len) {
+        len = slice_len;
+    }
+    crypt_units(job->ctx, job->first_unit + index * job->units_per_slice,
+                job->in + offset, job->out + offset, len);
+}
+
+int aes_xts_crypt(thread_pool_t* pool, const aes_xts_key_t* ctx, uint64_t first_unit,
+                  const unsigned char* in, unsigned char* out, size_t len) {
+    size_t last = len % ctx->unit_size;
+    if ((last > 0 && last < AES_BLOCK_SIZE) || (len > 0 && len < AES_BLOCK_SIZE)) {
+        fprintf(stderr, "Error: XTS data unit must be at least %d bytes\n", AES_BLOCK_SIZE);
+        return -1;
+    }
+
+    // Единицы независимы: участки по целому числу единиц, не меньше XTS_PAR_MIN_BYTES
+    size_t nunits = (len + ctx->unit_size - 1) / ctx->unit_size;
+    size_t nslices = (size_t)thread_pool_size(pool);
+    if (nslices > len / XTS_PAR_MIN_BYTES) nslices = len / XTS_PAR_MIN_BYTES;
+    if (nslices > XTS_PAR_MAX_SLICES) nslices = XTS_PAR_MAX_SLICES;
+    if (nslices > nunits) nslices = nunits;
+    if (nslices <= 1) {
+        crypt_units(ctx, first_unit, in, out, len);
+        return 0;
+    }
+
+    xts_job_t job = { ctx, first_unit, in, out, len, (nunits + nslices - 1) / nslices };
+    nslices = (nunits + job.units_per_slice - 1) / job.units_per_slice;
+    thread_pool_run(pool, run_slice, &job, nslices);
+    return 0;
+}
+
+void aes_xts_cleanup(aes_xts_key_t* ctx) {
+    aes_core_key_clear(&ctx->data_key);
+    aes_core_key_clear(&ctx->tweak_key);
+}
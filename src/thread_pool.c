@@ -0,0 +1,179 @@
+#include "../include/thread_pool.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef _WIN32
+#include <windows.h>
+typedef HANDLE pool_thread_t;
+typedef CRITICAL_SECTION pool_mutex_t;
+typedef CONDITION_VARIABLE pool_cond_t;
+#define pool_mutex_init(m)     InitializeCriticalSection(m)
+#define pool_mutex_destroy(m)  DeleteCriticalSection(m)
+#define pool_lock(m)           EnterCriticalSection(m)
+#define pool_unlock(m)         LeaveCriticalSection(m)
+#define pool_cond_init(c)      InitializeConditionVariable(c)
+#define pool_cond_destroy(c)   ((void)(c))
+#define pool_wait(c, m)        SleepConditionVariableCS(c, m, INFINITE)
+#define pool_broadcast(c)      WakeAllConditionVariable(c)
+#else
+#include <pthread.h>
+typedef pthread_t pool_thread_t;
+typedef pthread_mutex_t pool_mutex_t;
+typedef pthread_cond_t pool_cond_t;
+#define pool_mutex_init(m)     pthread_mutex_init(m, NULL)
+#define pool_mutex_destroy(m)  pthread_mutex_destroy(m)
+#define pool_lock(m)           pthread_mutex_lock(m)
+#define pool_unlock(m)         pthread_mutex_unlock(m)
+#define pool_cond_init(c)      pthread_cond_init(c, NULL)
+#define pool_cond_destroy(c)   pthread_cond_destroy(c)
+#define pool_wait(c, m)        pthread_cond_wait(c, m)
+#define pool_broadcast(c)      pthread_cond_broadcast(c)
+#endif
+
+struct thread_pool {
+    pool_thread_t* threads;     // Рабочие потоки (nthreads - 1, вызывающий поток не входит)
+    int nthreads;
+    pool_mutex_t lock;
+    pool_cond_t work_cond;      // Появились задания или запрошена остановка
+    pool_cond_t done_cond;      // Все задания текущего вызова завершены
+    thread_pool_fn fn;
+    void* arg;
+    size_t count;               // Число заданий текущего вызова
+    size_t next;                // Следующее невыданное задание
+    size_t active;              // Задания в работе
+    int shutdown;
+};
+
+/**
+ * Выбор и выполнение заданий до исчерпания очереди (вызывается под блокировкой)
+ */
+static void drain_jobs(thread_pool_t* pool) {
+    while (pool->next < pool->count) {
+        size_t index = pool->next++;
+        pool->active++;
+        pool_unlock(&pool->lock);
+        pool->fn(pool->arg, index);
+        pool_lock(&pool->lock);
+        pool->active--;
+    }
+    if (pool->active == 0) {
+        pool_broadcast(&pool->done_cond);
+    }
+}
+
+#ifdef _WIN32
+static DWORD WINAPI worker_main(LPVOID param)
+#else
+static void* worker_main(void* param)
+#endif
+{
+    thread_pool_t* pool = (thread_pool_t*)param;
+    pool_lock(&pool->lock);
+    while (1) {
+        while (!pool->shutdown && pool->next >= pool->count) {
+            pool_wait(&pool->work_cond, &pool->lock);
+        }
+        if (pool->shutdown) {
+            break;
+        }
+        drain_jobs(pool);
+    }
+    pool_unlock(&pool->lock);
+    return 0;
+}
+
+thread_pool_t* thread_pool_create(int nthreads) {
+    if (nthreads < 1) {
+        fprintf(stderr, "Error: Invalid thread count %d\n", nthreads);
+        return NULL;
+    }
+
+    thread_pool_t* pool = (thread_pool_t*)calloc(1, sizeof(thread_pool_t));
+    if (!pool) {
+        fprintf(stderr, "Error: Failed to allocate memory for thread pool\n");
+        return NULL;
+    }
+    pool->threads = (pool_thread_t*)calloc((size_t)nthreads, sizeof(pool_thread_t));
+    if (!pool->threads) {
+        fprintf(stderr, "Error: Failed to allocate memory for thread pool\n");
+        free(pool);
+        return NULL;
+    }
+    pool_mutex_init(&pool->lock);
+    pool_cond_init(&pool->work_cond);
+    pool_cond_init(&pool->done_cond);
+
+    // Вызывающий поток тоже выполняет задания, поэтому запускается nthreads - 1 рабочих
+    pool->nthreads = 1;
+    for (int i = 0; i < nthreads - 1; i++) {
+#ifdef _WIN32
+        pool->threads[i] = CreateThread(NULL, 0, worker_main, pool, 0, NULL);
+        int ok = (pool->threads[i] != NULL);
+#else
+        int ok = (pthread_create(&pool->threads[i], NULL, worker_main, pool) == 0);
+#endif
+        if (!ok) {
+            fprintf(stderr, "Error: Failed to create worker thread\n");
+            thread_pool_destroy(pool);
+            return NULL;
+        }
+        pool->nthreads++;
+    }
+
+    return pool;
+}
+
+int thread_pool_size(const thread_pool_t* pool) {
+    return pool ? pool->nthreads : 1;
+}
+
+void thread_pool_run(thread_pool_t* pool, thread_pool_fn fn, void* arg, size_t count) {
+    if (!pool || pool->nthreads == 1 || count <= 1) {
+        for (size_t i = 0; i < count; i++) {
+            fn(arg, i);
+        }
+        return;
+    }
+
+    pool_lock(&pool->lock);
+    pool->fn = fn;
+    pool->arg = arg;
+    pool->count = count;
+    pool->next = 0;
+    pool->active = 0;
+    pool_broadcast(&pool->work_cond);
+
+    drain_jobs(pool);
+    while (pool->next < pool->count || pool->active > 0) {
+        pool_wait(&pool->done_cond, &pool->lock);
+    }
+    pool->count = 0;
+    pool->next = 0;
+    pool_unlock(&pool->lock);
+}
+
+void thread_pool_destroy(thread_pool_t* pool) {
+    if (!pool) {
+        return;
+    }
+
+    pool_lock(&pool->lock);
+    pool->shutdown = 1;
+    pool_broadcast(&pool->work_cond);
+    pool_unlock(&pool->lock);
+
+    for (int i = 0; i < pool->nthreads - 1; i++) {
+#ifdef _WIN32
+        WaitForSingleObject(pool->threads[i], INFINITE);
+        CloseHandle(pool->threads[i]);
+#else
+        pthread_join(pool->threads[i], NULL);
+#endif
+    }
+
+    pool_cond_destroy(&pool->work_cond);
+    pool_cond_destroy(&pool->done_cond);
+    pool_mutex_destroy(&pool->lock);
+    free(pool->threads);
+    free(pool);
+}
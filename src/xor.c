@@ -0,0 +1,118 @@
+#include "../include/xor.h"
+#include "../include/cpu_features.h"
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define XOR_HAVE_SIMD 1
+#endif
+
+/* Короткие буферы (блок AES и меньше) обрабатываются словами без диспетчеризации */
+#define XOR_SIMD_MIN 32
+
+typedef void (*xor_fn_t)(unsigned char*, const unsigned char*, const unsigned char*, size_t);
+
+/**
+ * Переносимый путь: 64-битные слова, затем оставшиеся байты
+ * memcpy допускает невыровненные адреса и сводится компилятором к обычной загрузке
+ */
+static void xor_words(unsigned char* out, const unsigned char* a, const unsigned char* b, size_t len) {
+    size_t i = 0;
+    for (; i + 8 <= len; i += 8) {
+        uint64_t x, y;
+        memcpy(&x, a + i, 8);
+        memcpy(&y, b + i, 8);
+        x ^= y;
+        memcpy(out + i, &x, 8);
+    }
+    for (; i < len; i++) {
+        out[i] = a[i] ^ b[i];
+    }
+}
+
+#ifdef XOR_HAVE_SIMD
+__attribute__((target("sse2")))
+static void xor_sse2(unsigned char* out, const unsigned char* a, const unsigned char* b, size_t len) {
+    size_t i = 0;
+    for (; i + 64 <= len; i += 64) {
+        __m128i x0 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        __m128i x1 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i + 16)), _mm_loadu_si128((const __m128i*)(b + i + 16)));
+        __m128i x2 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i + 32)), _mm_loadu_si128((const __m128i*)(b + i + 32)));
+        __m128i x3 = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i + 48)), _mm_loadu_si128((const __m128i*)(b + i + 48)));
+        _mm_storeu_si128((__m128i*)(out + i), x0);
+        _mm_storeu_si128((__m128i*)(out + i + 16), x1);
+        _mm_storeu_si128((__m128i*)(out + i + 32), x2);
+        _mm_storeu_si128((__m128i*)(out + i + 48), x3);
+    }
+    for (; i + 16 <= len; i += 16) {
+        __m128i x = _mm_xor_si128(_mm_loadu_si128((const __m128i*)(a + i)), _mm_loadu_si128((const __m128i*)(b + i)));
+        _mm_storeu_si128((__m128i*)(out + i), x);
+    }
+    xor_words(out + i, a + i, b + i, len - i);
+}
+
+__attribute__((target("avx2")))
+static void xor_avx2(unsigned char* out, const unsigned char* a, const unsigned char* b, size_t len) {
+    size_t i = 0;
+    for (; i + 128 <= len; i += 128) {
+        __m256i x0 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        __m256i x1 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i + 32)), _mm256_loadu_si256((const __m256i*)(b + i + 32)));
+        __m256i x2 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i + 64)), _mm256_loadu_si256((const __m256i*)(b + i + 64)));
+        __m256i x3 = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i + 96)), _mm256_loadu_si256((const __m256i*)(b + i + 96)));
+        _mm256_storeu_si256((__m256i*)(out + i), x0);
+        _mm256_storeu_si256((__m256i*)(out + i + 32), x1);
+        _mm256_storeu_si256((__m256i*)(out + i + 64), x2);
+        _mm256_storeu_si256((__m256i*)(out + i + 96), x3);
+    }
+    for (; i + 32 <= len; i += 32) {
+        __m256i x = _mm256_xor_si256(_mm256_loadu_si256((const __m256i*)(a + i)), _mm256_loadu_si256((const __m256i*)(b + i)));
+        _mm256_storeu_si256((__m256i*)(out + i), x);
+    }
+    xor_words(out + i, a + i, b + i, len - i);
+}
+#endif
+
+typedef struct {
+    xor_fn_t fn;
+    const char* name;
+} xor_impl_t;
+
+static const xor_impl_t impl_words = { xor_words, "portable" };
+#ifdef XOR_HAVE_SIMD
+static const xor_impl_t impl_sse2 = { xor_sse2, "sse2" };
+static const xor_impl_t impl_avx2 = { xor_avx2, "avx2" };
+#endif
+
+/* Выбор один раз; указатель публикуется атомарно, поэтому первый вызов возможен из любого потока */
+static const xor_impl_t* active_impl = NULL;
+
+static const xor_impl_t* get_impl(void) {
+    const xor_impl_t* impl = __atomic_load_n(&active_impl, __ATOMIC_ACQUIRE);
+    if (impl) {
+        return impl;
+    }
+    impl = &impl_words;
+#ifdef XOR_HAVE_SIMD
+    const cpu_features_t* cpu = cpu_features_get();
+    if (cpu->avx2) {
+        impl = &impl_avx2;
+    } else if (cpu->sse2) {
+        impl = &impl_sse2;
+    }
+#endif
+    __atomic_store_n(&active_impl, impl, __ATOMIC_RELEASE);
+    return impl;
+}
+
+const char* xor_impl_name(void) {
+    return get_impl()->name;
+}
+
+void xor_bytes(unsigned char* out, const unsigned char* a, const unsigned char* b, size_t len) {
+    if (len < XOR_SIMD_MIN) {
+        xor_words(out, a, b, len);
+        return;
+    }
+    get_impl()->fn(out, a, b, len);
+}
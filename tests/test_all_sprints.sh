@@ -1,6 +1,6 @@
 #!/bin/bash
 # Комплексные тесты для всех спринтов CryptoCore
-# Проверяет функциональность Sprint 1-5
+# Проверяет функциональность Sprint 1-6
 
 # Цвета для вывода
 RED='\033[0;31m'
@@ -704,6 +704,60 @@ if [ -f test_hash_output.txt ]; then
     fi
 fi
 
+# Тест 4.7: SHA-3 и SHAKE на известных векторах
+echo "=== TEST 4.7: SHA-3 / SHAKE Known Answers ==="
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm sha3-256 --input test_abc.txt 2>&1 | awk '{print $1}')
+check_hash "SHA3-256 of 'abc'" "3a985da74fe225b2045c172d6bd390bd855f086e3e9d525b46bfe24511431532" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm sha3-512 --input test_abc.txt 2>&1 | awk '{print $1}')
+check_hash "SHA3-512 of 'abc'" "b751850b1a57168a5693cd924b6b096e08f621827444f70d884f5d0240d2712e10e116e9192af3c91a7ec57647e3934057340b4cf408d5a56592f8274eec53f0" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm shake128 --input test_empty_hash.txt 2>&1 | awk '{print $1}')
+check_hash "SHAKE128 of empty file (256 bits)" "7f9c2ba4e88f827d616045507605853ed73b8093f6efbc88eb1a6eacfa66ef26" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm shake256 --input test_empty_hash.txt 2>&1 | awk '{print $1}')
+check_hash "SHAKE256 of empty file (512 bits)" "46b9dd2b0ba88d13233b3feb743eeb243fcd52ea62b81b82b50c27646ed5762fd75dc4ddd8c0f200cb05019d67b592f6fc821c49479ab48640292eacb3b7c4be" "$HASH_VALUE"
+
+# Тест 4.8: Вход длиннее нескольких блоков губки
+echo "=== TEST 4.8: SHAKE128 Multi-Block Input ==="
+for i in $(seq 0 255); do printf "\\$(printf '%03o' $i)"; done > test_shake_block.bin
+cat test_shake_block.bin test_shake_block.bin test_shake_block.bin test_shake_block.bin \
+    test_shake_block.bin test_shake_block.bin test_shake_block.bin test_shake_block.bin > test_shake_multi.bin
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm shake128 --input test_shake_multi.bin 2>&1 | awk '{print $1}')
+check_hash "SHAKE128 of 2048-byte input" "02a5c992aacbcfa4a01f70238b10ac319f4fce9b75f688c4c5b32b524f30272f" "$HASH_VALUE"
+
+# Тест 4.9: ParallelHash (блоки по 8 КБ, последний блок неполный)
+echo "=== TEST 4.9: ParallelHash ==="
+for i in $(seq 1 10); do cat test_shake_multi.bin; done > test_ph_input.bin
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm parallelhash128 --input test_ph_input.bin 2>&1 | awk '{print $1}')
+check_hash "ParallelHash128 of 20480-byte input" "79dbf34e256f3222d9c41780b9d84a5c194c34bf3c2ac653fed962edeb68be98" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm parallelhash256 --threads 4 --input test_ph_input.bin 2>&1 | awk '{print $1}')
+check_hash "ParallelHash256 of 20480-byte input (4 threads)" "bbeb4166d8373ad12925a3a1cf6b976e4137f1f82ed25be19c7df08827796d1318b4b78de6a1e9ff6c570e19f9ba0a74a738144b7fe622b0a31a4aec12a979a7" "$HASH_VALUE"
+
+# Несколько пакетов чтения с опережением: результат не зависит от числа потоков
+head -c $((9 * 1024 * 1024 + 123)) /dev/urandom > test_ph_large.bin 2>/dev/null
+PH_ONE=$($CRYPTOCORE dgst --algorithm parallelhash256 --input test_ph_large.bin 2>&1 | awk '{print $1}')
+PH_MANY=$($CRYPTOCORE dgst --algorithm parallelhash256 --threads 3 --input test_ph_large.bin 2>&1 | awk '{print $1}')
+check_hash "ParallelHash256 with 1 and 3 threads" "$PH_ONE" "$PH_MANY"
+
+# Тест 4.10: BLAKE3 (дерево порций по 1 КБ)
+echo "=== TEST 4.10: BLAKE3 ==="
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm blake3 --input test_empty_hash.txt 2>&1 | awk '{print $1}')
+check_hash "BLAKE3 of empty file" "af1349b9f5f9a1a6a0404dea36dcc9499bcb25c9adc112b7cc9a93cae41f3262" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm blake3 --input test_abc.txt 2>&1 | awk '{print $1}')
+check_hash "BLAKE3 of 'abc'" "6437b3ac38465133ffb63b75273a8db548c558465d79db03fd359c6cd5bd9d85" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm blake3 --input test_ph_input.bin 2>&1 | awk '{print $1}')
+check_hash "BLAKE3 of 20480-byte input" "84be82c353eca3c77fd8a4f6330fea17e764349db6bb9781d67835ed9accd064" "$HASH_VALUE"
+B3_ONE=$($CRYPTOCORE dgst --algorithm blake3 --input test_ph_large.bin 2>&1 | awk '{print $1}')
+B3_MANY=$($CRYPTOCORE dgst --algorithm blake3 --threads 3 --input test_ph_large.bin 2>&1 | awk '{print $1}')
+check_hash "BLAKE3 with 1 and 3 threads" "$B3_ONE" "$B3_MANY"
+
+# Тест 4.11: SHA-384, SHA-512, SHA-512/256
+echo "=== TEST 4.11: SHA-512 Family Known Answers ==="
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm sha384 --input test_abc.txt 2>&1 | awk '{print $1}')
+check_hash "SHA-384 of 'abc'" "cb00753f45a35e8bb5a03d699ac65007272c32ab0eded1631a8b605a43ff5bed8086072ba1e7cc2358baeca134c825a7" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm sha512 --input test_abc.txt 2>&1 | awk '{print $1}')
+check_hash "SHA-512 of 'abc'" "ddaf35a193617abacc417349ae20413112e6fa4e89a97ea20a9eeee64b55d39a2192992a274fc1a836ba3c23a3feebbd454d4423643ce80e2a9ac94fa54ca49f" "$HASH_VALUE"
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm sha512-256 --input test_empty_hash.txt 2>&1 | awk '{print $1}')
+check_hash "SHA-512/256 of empty file" "c672b8d1ef56ed28ab87c3622c5114069bdd3ad7b8f9737498d0c01ecef0967a" "$HASH_VALUE"
+
 end_sprint "SPRINT 4"
 
 # ============================================
@@ -748,8 +802,555 @@ else
     check_success "HMAC verification"
 fi
 
+# Тест 5.3: KMAC (NIST SP 800-185, Sample #1 и #5)
+echo "=== TEST 5.3: KMAC Known Answers ==="
+KEY_KMAC="404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+printf '\x00\x01\x02\x03' > test_kmac_msg.bin
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm kmac128 --kmac --key "$KEY_KMAC" --input test_kmac_msg.bin 2>&1 | awk '{print $1}')
+check_hash "KMAC128 sample #1" "e5780b0d3ea6f7d3a429c5706aa43a00fadbd7d49628839e3187243f456ee14e" "$HASH_VALUE"
+for i in $(seq 0 199); do printf "\\$(printf '%03o' $i)"; done > test_kmac_long.bin
+HASH_VALUE=$($CRYPTOCORE dgst --algorithm kmac256 --kmac --key "$KEY_KMAC" --input test_kmac_long.bin 2>&1 | awk '{print $1}')
+check_hash "KMAC256 sample #5" "75358cf39e41494e949707927cee0af20a3ff553904c86b08f21cc414bcfd691589d27cf5e15369cbbff8b9a4c2eb17800855d0235ff635da82533ec6b759b69" "$HASH_VALUE"
+
+echo "=== TEST 5.4: KMAC Verification ==="
+$CRYPTOCORE dgst --algorithm kmac256 --kmac --key "$KEY_KMAC" --input test_kmac_long.bin \
+    --output test_kmac_file.txt > /dev/null 2>&1
+if $CRYPTOCORE dgst --algorithm kmac256 --kmac --key "$KEY_KMAC" --input test_kmac_long.bin \
+    --verify test_kmac_file.txt > /dev/null 2>&1; then
+    check_success "KMAC verification"
+else
+    check_failure "KMAC verification"
+fi
+if ! $CRYPTOCORE dgst --algorithm kmac256 --kmac --key "00$KEY_KMAC" --input test_kmac_long.bin \
+    --verify test_kmac_file.txt > /dev/null 2>&1; then
+    check_success "KMAC with a wrong key is rejected"
+else
+    check_failure "KMAC with a wrong key is rejected"
+fi
+
 end_sprint "SPRINT 5"
 
+# ============================================
+# SPRINT 6: Multithreaded modes (--threads)
+# ============================================
+start_sprint "SPRINT 6: Multithreaded modes"
+
+KEY6="000102030405060708090a0b0c0d0e0f"
+
+# Файл в несколько мегабайт, чтобы участки распределялись по потокам
+head -c 3145757 /dev/urandom > test_mt_plain.bin 2>/dev/null
+
+for MODE in ecb cbc cfb ctr; do
+    echo "=== TEST 6: $MODE with --threads ==="
+    if $CRYPTOCORE --algorithm aes --mode $MODE --encrypt --key "$KEY6" \
+        --input test_mt_plain.bin --output test_mt_${MODE}_enc.bin --threads 4 > /dev/null 2>&1; then
+        check_success "$MODE encryption with 4 threads"
+    else
+        check_failure "$MODE encryption with 4 threads"
+    fi
+
+    # Дешифрование одним потоком: результат должен совпадать с многопоточным шифрованием
+    $CRYPTOCORE --algorithm aes --mode $MODE --decrypt --key "$KEY6" \
+        --input test_mt_${MODE}_enc.bin --output test_mt_${MODE}_dec1.bin > /dev/null 2>&1
+    check_files_equal "$MODE: 4-thread encrypt, 1-thread decrypt" test_mt_plain.bin test_mt_${MODE}_dec1.bin
+
+    $CRYPTOCORE --algorithm aes --mode $MODE --decrypt --key "$KEY6" \
+        --input test_mt_${MODE}_enc.bin --output test_mt_${MODE}_dec3.bin --threads 3 > /dev/null 2>&1
+    check_files_equal "$MODE: 3-thread decrypt" test_mt_plain.bin test_mt_${MODE}_dec3.bin
+done
+
+if ! $CRYPTOCORE --algorithm aes --mode ctr --encrypt --key "$KEY6" \
+    --input test_mt_plain.bin --output test_mt_bad.bin --threads 0 > /dev/null 2>&1; then
+    check_success "Reject --threads 0"
+else
+    check_failure "Reject --threads 0"
+fi
+
+end_sprint "SPRINT 6"
+
+# ============================================
+# SPRINT 7: Selectable AES engines (--engine)
+# ============================================
+start_sprint "SPRINT 7: AES engines"
+
+KEY7="2b7e151628aed2a6abf7158809cf4f3c"
+
+echo "=== TEST 7: --version ==="
+if $CRYPTOCORE --version > test_engine_version.txt 2>&1; then
+    check_success "--version"
+else
+    check_failure "--version"
+fi
+if grep -q "AES engine:" test_engine_version.txt; then
+    check_success "--version reports the active AES engine"
+else
+    check_failure "--version reports the active AES engine"
+fi
+
+# Неполный последний блок и несколько пакетов по 8/16 блоков
+head -c 100005 /dev/urandom > test_engine_plain.bin 2>/dev/null
+
+# Шифрование переносимой реализацией, дешифрование каждой доступной
+ENGINES=$(sed -n 's/^Available engines://p' test_engine_version.txt)
+for MODE in ecb cbc cfb ofb ctr gcm; do
+    echo "=== TEST 7: $MODE across engines ==="
+    if $CRYPTOCORE --algorithm aes --mode $MODE --encrypt --key "$KEY7" --engine portable \
+        --input test_engine_plain.bin --output test_engine_${MODE}_enc.bin > /dev/null 2>&1; then
+        check_success "$MODE encryption with portable engine"
+    else
+        check_failure "$MODE encryption with portable engine"
+    fi
+    for ENGINE in $ENGINES; do
+        $CRYPTOCORE --algorithm aes --mode $MODE --decrypt --key "$KEY7" --engine $ENGINE \
+            --input test_engine_${MODE}_enc.bin --output test_engine_${MODE}_dec.bin > /dev/null 2>&1
+        check_files_equal "$MODE: portable encrypt, $ENGINE decrypt" test_engine_plain.bin test_engine_${MODE}_dec.bin
+    done
+done
+
+if ! $CRYPTOCORE --version --engine no-such-engine > /dev/null 2>&1; then
+    check_success "Reject unknown --engine"
+else
+    check_failure "Reject unknown --engine"
+fi
+
+end_sprint "SPRINT 7"
+
+# ============================================
+# SPRINT 8: AES-GCM authenticated encryption
+# ============================================
+start_sprint "SPRINT 8: AES-GCM"
+
+KEY8="feffe9928665731c6d6a8f9467308308"
+
+echo "=== TEST 8.1: GCM roundtrip and file format ==="
+head -c 70001 /dev/urandom > test_gcm_plain.bin 2>/dev/null
+if $CRYPTOCORE --algorithm aes --mode gcm --encrypt --key "$KEY8" \
+    --input test_gcm_plain.bin --output test_gcm_enc.bin > /dev/null 2>&1; then
+    check_success "GCM encryption"
+else
+    check_failure "GCM encryption"
+fi
+$CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY8" \
+    --input test_gcm_enc.bin --output test_gcm_dec.bin > /dev/null 2>&1
+check_files_equal "GCM decryption" test_gcm_plain.bin test_gcm_dec.bin
+# Заголовок: 12 байт nonce + 16 байт тега, шифртекст без дополнения
+if [ "$(wc -c < test_gcm_enc.bin)" -eq $((70001 + 28)) ]; then
+    check_success "GCM output is plaintext + 28 byte header"
+else
+    check_failure "GCM output is plaintext + 28 byte header"
+fi
+
+echo "=== TEST 8.2: GCM detects modification ==="
+cp test_gcm_enc.bin test_gcm_tampered.bin
+printf '\x01' | dd of=test_gcm_tampered.bin bs=1 seek=5000 conv=notrunc 2>/dev/null
+rm -f test_gcm_tampered_dec.bin
+if ! $CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY8" \
+    --input test_gcm_tampered.bin --output test_gcm_tampered_dec.bin > /dev/null 2>&1; then
+    check_success "Reject modified GCM ciphertext"
+else
+    check_failure "Reject modified GCM ciphertext"
+fi
+if [ ! -f test_gcm_tampered_dec.bin ]; then
+    check_success "No output left after failed GCM authentication"
+else
+    check_failure "No output left after failed GCM authentication"
+fi
+if ! $CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "000102030405060708090a0b0c0d0e0f" \
+    --input test_gcm_enc.bin --output test_gcm_wrongkey.bin > /dev/null 2>&1; then
+    check_success "Reject GCM decryption with wrong key"
+else
+    check_failure "Reject GCM decryption with wrong key"
+fi
+
+echo "=== TEST 8.3: GCM empty file ==="
+: > test_gcm_empty.txt
+$CRYPTOCORE --algorithm aes --mode gcm --encrypt --key "$KEY8" \
+    --input test_gcm_empty.txt --output test_gcm_empty.enc > /dev/null 2>&1
+$CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY8" \
+    --input test_gcm_empty.enc --output test_gcm_empty.dec > /dev/null 2>&1
+check_files_equal "GCM empty file roundtrip" test_gcm_empty.txt test_gcm_empty.dec
+
+end_sprint "SPRINT 8"
+
+# ============================================
+# SPRINT 9: XTS for sector-addressable images
+# ============================================
+start_sprint "SPRINT 9: AES-XTS"
+
+KEY9="000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+
+echo "=== TEST 9.1: XTS roundtrip, size preserved ==="
+# 20 секторов по 4096 байт и неполный последний сектор (заимствование шифртекста)
+head -c $((4096 * 20 + 100)) /dev/urandom > test_xts_plain.img 2>/dev/null
+if $CRYPTOCORE --algorithm aes --mode xts --encrypt --key "$KEY9" \
+    --input test_xts_plain.img --output test_xts_enc.img > /dev/null 2>&1; then
+    check_success "XTS encryption"
+else
+    check_failure "XTS encryption"
+fi
+if [ "$(wc -c < test_xts_enc.img)" -eq $((4096 * 20 + 100)) ]; then
+    check_success "XTS output has the input size"
+else
+    check_failure "XTS output has the input size"
+fi
+for ENGINE in $ENGINES; do
+    $CRYPTOCORE --algorithm aes --mode xts --decrypt --key "$KEY9" --engine $ENGINE --threads 4 \
+        --input test_xts_enc.img --output test_xts_dec.img > /dev/null 2>&1
+    check_files_equal "XTS: decrypt with $ENGINE engine" test_xts_plain.img test_xts_dec.img
+done
+
+echo "=== TEST 9.2: XTS single sector decryption ==="
+dd if=test_xts_enc.img of=test_xts_sector7.enc bs=4096 skip=7 count=1 2>/dev/null
+dd if=test_xts_plain.img of=test_xts_sector7.plain bs=4096 skip=7 count=1 2>/dev/null
+$CRYPTOCORE --algorithm aes --mode xts --decrypt --key "$KEY9" --first-sector 7 \
+    --input test_xts_sector7.enc --output test_xts_sector7.dec > /dev/null 2>&1
+check_files_equal "XTS: sector 7 decrypted on its own" test_xts_sector7.plain test_xts_sector7.dec
+
+echo "=== TEST 9.3: XTS 512-byte sectors ==="
+$CRYPTOCORE --algorithm aes --mode xts --encrypt --key "$KEY9" --sector-size 512 \
+    --input test_xts_plain.img --output test_xts_enc512.img > /dev/null 2>&1
+$CRYPTOCORE --algorithm aes --mode xts --decrypt --key "$KEY9" --sector-size 512 \
+    --input test_xts_enc512.img --output test_xts_dec512.img > /dev/null 2>&1
+check_files_equal "XTS: 512-byte sector roundtrip" test_xts_plain.img test_xts_dec512.img
+if ! cmp -s test_xts_enc.img test_xts_enc512.img; then
+    check_success "XTS: sector size changes the ciphertext"
+else
+    check_failure "XTS: sector size changes the ciphertext"
+fi
+
+if ! $CRYPTOCORE --algorithm aes --mode xts --encrypt --key "$KEY7" \
+    --input test_xts_plain.img --output test_xts_badkey.img > /dev/null 2>&1; then
+    check_success "Reject 128-bit key for XTS"
+else
+    check_failure "Reject 128-bit key for XTS"
+fi
+
+end_sprint "SPRINT 9"
+
+# ============================================
+# SPRINT 10: ChaCha20-Poly1305
+# ============================================
+start_sprint "SPRINT 10: ChaCha20-Poly1305"
+
+KEY10="808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+
+echo "=== TEST 10.1: ChaCha20-Poly1305 roundtrip and file format ==="
+head -c 70001 /dev/urandom > test_chacha_plain.bin 2>/dev/null
+if $CRYPTOCORE --algorithm chacha20 --encrypt --key "$KEY10" \
+    --input test_chacha_plain.bin --output test_chacha_enc.bin > /dev/null 2>&1; then
+    check_success "ChaCha20-Poly1305 encryption"
+else
+    check_failure "ChaCha20-Poly1305 encryption"
+fi
+$CRYPTOCORE --algorithm chacha20 --mode chacha20-poly1305 --decrypt --key "$KEY10" \
+    --input test_chacha_enc.bin --output test_chacha_dec.bin > /dev/null 2>&1
+check_files_equal "ChaCha20-Poly1305 decryption" test_chacha_plain.bin test_chacha_dec.bin
+# Тот же заголовок, что у GCM: 12 байт nonce + 16 байт тега
+if [ "$(wc -c < test_chacha_enc.bin)" -eq $((70001 + 28)) ]; then
+    check_success "ChaCha20-Poly1305 output is plaintext + 28 byte header"
+else
+    check_failure "ChaCha20-Poly1305 output is plaintext + 28 byte header"
+fi
+
+echo "=== TEST 10.2: ChaCha20-Poly1305 detects modification ==="
+cp test_chacha_enc.bin test_chacha_tampered.bin
+printf '\x01' | dd of=test_chacha_tampered.bin bs=1 seek=5000 conv=notrunc 2>/dev/null
+rm -f test_chacha_tampered_dec.bin
+if ! $CRYPTOCORE --algorithm chacha20 --decrypt --key "$KEY10" \
+    --input test_chacha_tampered.bin --output test_chacha_tampered_dec.bin > /dev/null 2>&1; then
+    check_success "Reject modified ChaCha20-Poly1305 ciphertext"
+else
+    check_failure "Reject modified ChaCha20-Poly1305 ciphertext"
+fi
+if [ ! -f test_chacha_tampered_dec.bin ]; then
+    check_success "No output left after failed ChaCha20-Poly1305 authentication"
+else
+    check_failure "No output left after failed ChaCha20-Poly1305 authentication"
+fi
+if ! $CRYPTOCORE --algorithm chacha20 --decrypt --key "$KEY9" \
+    --input test_chacha_enc.bin --output test_chacha_wrongkey.bin > /dev/null 2>&1; then
+    check_success "Reject ChaCha20-Poly1305 decryption with wrong key"
+else
+    check_failure "Reject ChaCha20-Poly1305 decryption with wrong key"
+fi
+if ! $CRYPTOCORE --algorithm chacha20 --mode cbc --encrypt --key "$KEY10" \
+    --input test_chacha_plain.bin --output test_chacha_cbc.bin > /dev/null 2>&1; then
+    check_success "Reject AES modes for chacha20"
+else
+    check_failure "Reject AES modes for chacha20"
+fi
+
+end_sprint "SPRINT 10"
+
+# ============================================
+# SPRINT 11: CTR random access
+# ============================================
+start_sprint "SPRINT 11: CTR random access"
+
+echo "=== TEST 11.1: CTR range decryption ==="
+head -c 1000003 /dev/urandom > test_range_plain.bin 2>/dev/null
+$CRYPTOCORE --algorithm aes --mode ctr --encrypt --key "$KEY7" \
+    --input test_range_plain.bin --output test_range_enc.bin > /dev/null 2>&1
+# Смещение не на границе блока, участок пересекает границы порций
+$CRYPTOCORE --algorithm aes --mode ctr --decrypt --key "$KEY7" --offset 500007 --length 4099 \
+    --input test_range_enc.bin --output test_range_part.bin > /dev/null 2>&1
+tail -c +500008 test_range_plain.bin | head -c 4099 > test_range_expected.bin
+check_files_equal "CTR: --offset/--length decrypts only the range" test_range_expected.bin test_range_part.bin
+$CRYPTOCORE --algorithm aes --mode ctr --decrypt --key "$KEY7" --offset 999990 \
+    --input test_range_enc.bin --output test_range_tail.bin > /dev/null 2>&1
+tail -c 13 test_range_plain.bin > test_range_tail_expected.bin
+check_files_equal "CTR: --offset without --length decrypts to EOF" test_range_tail_expected.bin test_range_tail.bin
+
+echo "=== TEST 11.2: CTR range validation ==="
+if ! $CRYPTOCORE --algorithm aes --mode ctr --decrypt --key "$KEY7" --offset 1000000 --length 100 \
+    --input test_range_enc.bin --output test_range_bad.bin > /dev/null 2>&1; then
+    check_success "Reject range past the end of the ciphertext"
+else
+    check_failure "Reject range past the end of the ciphertext"
+fi
+if ! $CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY7" --offset 16 \
+    --input test_range_enc.bin --output test_range_bad.bin > /dev/null 2>&1; then
+    check_success "Reject --offset for non-CTR modes"
+else
+    check_failure "Reject --offset for non-CTR modes"
+fi
+
+end_sprint "SPRINT 11"
+
+# ============================================
+# SPRINT 12: Chunked AEAD container
+# ============================================
+start_sprint "SPRINT 12: Chunked AEAD container"
+
+echo "=== TEST 12.1: Container round trip ==="
+head -c 300001 /dev/urandom > test_chunked_plain.bin 2>/dev/null
+$CRYPTOCORE --algorithm aes --mode gcm --encrypt --key "$KEY7" --chunked --chunk-size 4096 --threads 4 \
+    --input test_chunked_plain.bin --output test_chunked_enc.bin > /dev/null 2>&1
+$CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY7" --chunked --threads 4 \
+    --input test_chunked_enc.bin --output test_chunked_dec.bin > /dev/null 2>&1
+check_files_equal "GCM container: encrypt/decrypt with 4 threads" test_chunked_plain.bin test_chunked_dec.bin
+$CRYPTOCORE --algorithm chacha20 --encrypt --key "$KEY9" --chunked --chunk-size 4096 \
+    --input test_chunked_plain.bin --output test_chunked_cc_enc.bin > /dev/null 2>&1
+$CRYPTOCORE --algorithm chacha20 --decrypt --key "$KEY9" --chunked --threads 3 \
+    --input test_chunked_cc_enc.bin --output test_chunked_cc_dec.bin > /dev/null 2>&1
+check_files_equal "ChaCha20-Poly1305 container: encrypt/decrypt" test_chunked_plain.bin test_chunked_cc_dec.bin
+
+echo "=== TEST 12.2: Container tamper detection ==="
+# Один байт шифртекста порции 50 (32 байта заголовка + 50 * (4096 + 16))
+cp test_chunked_enc.bin test_chunked_tampered.bin
+printf '\x01' | dd of=test_chunked_tampered.bin bs=1 seek=205632 conv=notrunc 2>/dev/null
+if ! $CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY7" --chunked --threads 4 \
+    --input test_chunked_tampered.bin --output test_chunked_tampered_dec.bin > /dev/null 2>&1 && \
+    [ ! -f test_chunked_tampered_dec.bin ]; then
+    check_success "Reject container with a corrupted chunk"
+else
+    check_failure "Reject container with a corrupted chunk"
+fi
+head -c 200000 test_chunked_enc.bin > test_chunked_truncated.bin
+if ! $CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY7" --chunked \
+    --input test_chunked_truncated.bin --output test_chunked_tampered_dec.bin > /dev/null 2>&1; then
+    check_success "Reject truncated container"
+else
+    check_failure "Reject truncated container"
+fi
+rm -f test_chunked_tampered_dec.bin
+
+end_sprint "SPRINT 12"
+
+# ============================================
+# SPRINT 13: Encrypt-then-MAC
+# ============================================
+start_sprint "SPRINT 13: Encrypt-then-MAC"
+
+MAC_KEY="00112233445566778899aabbccddeeff00112233445566778899aabbccddeeff"
+CMAC_KEY="ffeeddccbbaa99887766554433221100"
+
+echo "=== TEST 13.1: MAC computed in the encryption pass ==="
+head -c 100005 /dev/urandom > test_etm_plain.bin 2>/dev/null
+$CRYPTOCORE --algorithm aes --mode cbc --encrypt --key "$KEY7" --mac hmac --mac-key "$MAC_KEY" \
+    --input test_etm_plain.bin --output test_etm_enc.bin > /dev/null 2>&1
+if $CRYPTOCORE dgst --algorithm sha256 --hmac --key "$MAC_KEY" --input test_etm_enc.bin \
+    --verify test_etm_enc.bin.mac > /dev/null 2>&1; then
+    check_success "HMAC sidecar matches dgst --hmac of the ciphertext"
+else
+    check_failure "HMAC sidecar matches dgst --hmac of the ciphertext"
+fi
+$CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY7" --mac hmac --mac-key "$MAC_KEY" \
+    --input test_etm_enc.bin --output test_etm_dec.bin > /dev/null 2>&1
+check_files_equal "HMAC: decrypt with verification" test_etm_plain.bin test_etm_dec.bin
+$CRYPTOCORE --algorithm aes --mode ctr --encrypt --key "$KEY7" --mac cmac --mac-key "$CMAC_KEY" \
+    --input test_etm_plain.bin --output test_etm_cmac_enc.bin > /dev/null 2>&1
+if $CRYPTOCORE dgst --algorithm sha256 --cmac --key "$CMAC_KEY" --input test_etm_cmac_enc.bin \
+    --verify test_etm_cmac_enc.bin.mac > /dev/null 2>&1; then
+    check_success "CMAC sidecar matches dgst --cmac of the ciphertext"
+else
+    check_failure "CMAC sidecar matches dgst --cmac of the ciphertext"
+fi
+
+echo "=== TEST 13.2: MAC mismatch on decryption ==="
+cp test_etm_cmac_enc.bin test_etm_tampered.bin
+cp test_etm_cmac_enc.bin.mac test_etm_tampered.bin.mac
+printf '\x01' | dd of=test_etm_tampered.bin bs=1 seek=5000 conv=notrunc 2>/dev/null
+rm -f test_etm_tampered_dec.bin
+if ! $CRYPTOCORE --algorithm aes --mode ctr --decrypt --key "$KEY7" --mac cmac --mac-key "$CMAC_KEY" \
+    --input test_etm_tampered.bin --output test_etm_tampered_dec.bin > /dev/null 2>&1 && \
+    [ ! -f test_etm_tampered_dec.bin ]; then
+    check_success "Reject ciphertext with a wrong MAC"
+else
+    check_failure "Reject ciphertext with a wrong MAC"
+fi
+
+echo "=== TEST 13.3: CBC tampering in the last blocks ==="
+# Изменение предпоследнего блока портит дополнение PKCS#7: ошибка должна быть только ошибкой MAC
+ETM_SIZE=$(wc -c < test_etm_enc.bin)
+for POS in $((ETM_SIZE - 1)) $((ETM_SIZE - 17)); do
+    cp test_etm_enc.bin test_etm_cbc_tampered.bin
+    cp test_etm_enc.bin.mac test_etm_cbc_tampered.bin.mac
+    printf '\x01' | dd of=test_etm_cbc_tampered.bin bs=1 seek=$POS conv=notrunc 2>/dev/null
+    rm -f test_etm_cbc_tampered_dec.bin
+    if ! $CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY7" --mac hmac --mac-key "$MAC_KEY" \
+        --input test_etm_cbc_tampered.bin --output test_etm_cbc_tampered_dec.bin > test_etm_cbc_tampered.log 2>&1 && \
+        grep -q "HMAC verification failed" test_etm_cbc_tampered.log && \
+        ! grep -qi "padding" test_etm_cbc_tampered.log && \
+        [ ! -f test_etm_cbc_tampered_dec.bin ]; then
+        check_success "CBC byte $POS tampered: only the MAC failure is reported, no output left"
+    else
+        check_failure "CBC byte $POS tampered: only the MAC failure is reported, no output left"
+    fi
+done
+# Без --mac неверное дополнение (последний файл цикла: изменен предпоследний блок) тоже не оставляет частичный открытый текст
+rm -f test_etm_cbc_tampered_dec.bin
+if ! $CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY7" \
+    --input test_etm_cbc_tampered.bin --output test_etm_cbc_tampered_dec.bin > /dev/null 2>&1 && \
+    [ ! -f test_etm_cbc_tampered_dec.bin ]; then
+    check_success "Padding error removes the partial output"
+else
+    check_failure "Padding error removes the partial output"
+fi
+
+end_sprint "SPRINT 13"
+
+# ============================================
+# SPRINT 14: Пакетное хеширование
+# ============================================
+start_sprint "SPRINT 14: Batch dgst"
+
+echo "=== TEST 14.1: Many files in one dgst ==="
+rm -rf test_batch_dir
+mkdir -p test_batch_dir
+for size in 0 1 55 56 63 64 65 119 120 1000 4096 100000 1048577; do
+    head -c $size /dev/urandom > test_batch_dir/f_$size.bin 2>/dev/null
+done
+$CRYPTOCORE dgst --algorithm sha256 --input test_batch_dir/*.bin > test_batch_many.txt 2>/dev/null
+rm -f test_batch_single.txt
+for f in test_batch_dir/*.bin; do
+    $CRYPTOCORE dgst --algorithm sha256 --input "$f" >> test_batch_single.txt 2>/dev/null
+done
+check_files_equal "Batch SHA-256 matches per-file dgst" test_batch_many.txt test_batch_single.txt
+
+echo "=== TEST 14.2: Directory input ==="
+$CRYPTOCORE dgst --algorithm sha256 --input test_batch_dir --output test_batch_dir.txt > /dev/null 2>&1
+check_files_equal "Directory dgst matches per-file dgst" test_batch_dir.txt test_batch_single.txt
+
+echo "=== TEST 14.3: Missing file is reported ==="
+if ! $CRYPTOCORE dgst --algorithm sha256 --input test_batch_dir/f_1.bin test_batch_missing.bin \
+    > test_batch_partial.txt 2>/dev/null && grep -q "f_1.bin" test_batch_partial.txt; then
+    check_success "Missing file fails the batch, other files are hashed"
+else
+    check_failure "Missing file fails the batch, other files are hashed"
+fi
+
+echo "=== TEST 14.4: Batch HMAC ==="
+BATCH_KEY=00112233445566778899aabbccddeeff
+$CRYPTOCORE dgst --algorithm sha512 --hmac --key $BATCH_KEY --input test_batch_dir/*.bin > test_batch_hmac_many.txt 2>/dev/null
+rm -f test_batch_hmac_single.txt
+for f in test_batch_dir/*.bin; do
+    $CRYPTOCORE dgst --algorithm sha512 --hmac --key $BATCH_KEY --input "$f" >> test_batch_hmac_single.txt 2>/dev/null
+done
+check_files_equal "Batch HMAC-SHA512 matches per-file HMAC" test_batch_hmac_many.txt test_batch_hmac_single.txt
+
+end_sprint "SPRINT 14"
+
+# ============================================
+# SPRINT 15: Многобуферное CBC-шифрование директории
+# ============================================
+start_sprint "SPRINT 15: CBC directory encryption"
+
+KEY15="0123456789abcdef0123456789abcdef"
+
+echo "=== TEST 15.1: CBC directory roundtrip ==="
+# 12 файлов - две группы по 8 полос; пустой, короче блока и больше 1 МБ (несколько проходов полосы)
+rm -rf test_dir_plain test_dir_enc test_dir_dec
+mkdir -p test_dir_plain
+DIR_SIZES="0 5 16 17 1000 4096 65537 1048576 2621447 31 48 300000"
+i=0
+for size in $DIR_SIZES; do
+    head -c $size /dev/urandom > test_dir_plain/file_$i.bin 2>/dev/null
+    i=$((i + 1))
+done
+# Новые имена зашифрованных файлов читаются из stdin в порядке имен исходных
+for j in $(seq 0 11); do echo "enc_$j.bin"; done | \
+    $CRYPTOCORE --algorithm aes --mode cbc --encrypt --key "$KEY15" \
+    --input test_dir_plain --output test_dir_enc > test_dir_enc.log 2>&1
+if grep -q "Encrypted 12 of 12 files" test_dir_enc.log; then
+    check_success "CBC directory encryption of 12 files"
+else
+    check_failure "CBC directory encryption of 12 files"
+fi
+# Порядок файлов в директории не определен: зашифрованное имя берется из metadata.txt
+ENC_EMPTY=$(grep '^file_0.bin|' test_dir_enc/metadata.txt | cut -d'|' -f2)
+ENC_LARGE=$(grep '^file_8.bin|' test_dir_enc/metadata.txt | cut -d'|' -f2)
+# Пустой файл: IV и один блок дополнения
+if [ -n "$ENC_EMPTY" ] && [ "$(wc -c < "test_dir_enc/$ENC_EMPTY")" -eq 32 ]; then
+    check_success "Empty file encrypts to IV + one padding block"
+else
+    check_failure "Empty file encrypts to IV + one padding block"
+fi
+
+$CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY15" \
+    --input test_dir_enc --output test_dir_dec > /dev/null 2>&1
+DIR_OK=1
+for f in test_dir_plain/*.bin; do
+    cmp -s "$f" "test_dir_dec/$(basename "$f")" || DIR_OK=0
+done
+if [ $DIR_OK -eq 1 ]; then
+    check_success "CBC directory decryption restores every file"
+else
+    check_failure "CBC directory decryption restores every file"
+fi
+
+echo "=== TEST 15.2: Directory file matches single-file CBC ==="
+# Файл из многобуферного пути расшифровывается обычным однофайловым путем
+$CRYPTOCORE --algorithm aes --mode cbc --decrypt --key "$KEY15" \
+    --input "test_dir_enc/$ENC_LARGE" --output test_dir_single.bin > /dev/null 2>&1
+check_files_equal "Single-file decryption of a 2.5 MB directory entry" test_dir_plain/file_8.bin test_dir_single.bin
+
+end_sprint "SPRINT 15"
+
+# ============================================
+# SPRINT 16: Функции режимов с буфером вызывающей стороны
+# ============================================
+start_sprint "SPRINT 16: Caller-buffer mode APIs"
+
+# *_into, *_inplace и aes_ctr_decrypt_range не вызываются из CLI: проверяются отдельной программой (make test-api)
+TEST_API="$PROJECT_DIR/test_modes_api"
+if [ ! -f "$TEST_API" ] && [ -f "$PROJECT_DIR/test_modes_api.exe" ]; then
+    TEST_API="$PROJECT_DIR/test_modes_api.exe"
+fi
+echo "=== TEST 16.1: ECB/CBC/CFB/OFB/CTR into, in-place and range on every AES engine ==="
+if [ -f "$TEST_API" ]; then
+    if "$TEST_API" > test_modes_api_output.txt 2>&1; then
+        check_success "Caller-buffer mode APIs ($(grep '^Passed:' test_modes_api_output.txt))"
+    else
+        grep "✗" test_modes_api_output.txt | head -10
+        check_failure "Caller-buffer mode APIs"
+    fi
+else
+    echo -e "${YELLOW}⚠${NC} test_modes_api not built, skipping (run: make test-api)"
+fi
+
+end_sprint "SPRINT 16"
+
 # ============================================
 # Итоговые результаты
 # ============================================
@@ -294,6 +294,31 @@ else
 fi
 echo ""
 
+# ============================================
+# TEST-11: HMAC-SHA384/SHA512 (RFC 4231 Test Case 2 и 6)
+# ============================================
+echo "=== TEST-11: HMAC-SHA384 / HMAC-SHA512 ==="
+RESULT=$($CRYPTOCORE dgst --algorithm sha384 --hmac --key "$KEY2" --input test2.txt 2>&1 | awk '{print $1}')
+check_result "RFC 4231 Test Case 2 (SHA-384)" "af45d2e376484031617f78d2b58a6b1b9c7ef464f5a01b47e42ec3736322445e8e2240ca5e69e2c78b3239ecfab21649" "$RESULT"
+RESULT=$($CRYPTOCORE dgst --algorithm sha512 --hmac --key "$KEY2" --input test2.txt 2>&1 | awk '{print $1}')
+check_result "RFC 4231 Test Case 2 (SHA-512)" "164b7a7bfcf819e2e395fbe73b56e0a387bd64222e831fd610270cd7ea2505549758bf75c05a994a6d034f65f8f0e6fdcaeab1a34d4a6b4b636e070a38bce737" "$RESULT"
+# Ключ 131 байт длиннее блока SHA-512 (128 байт) и хешируется
+echo -n "Test Using Larger Than Block-Size Key - Hash Key First" > test6.txt
+KEY6=$(printf 'aa%.0s' $(seq 1 131))
+RESULT=$($CRYPTOCORE dgst --algorithm sha512 --hmac --key "$KEY6" --input test6.txt 2>&1 | awk '{print $1}')
+check_result "RFC 4231 Test Case 6 (SHA-512)" "80b24263c7c1a3ebb71493c1dd7be8b49b46d1f41b4aeec1121b013783f8f3526b56d037e05f2598bd0fd2215d6a1e5295e64f73f63f0aec8b915a985d786598" "$RESULT"
+$CRYPTOCORE dgst --algorithm sha512 --hmac --key "$KEY2" --input test2.txt --output test2.hmac512 > /dev/null 2>&1
+$CRYPTOCORE dgst --algorithm sha512 --hmac --key "$KEY2" --input test2.txt --verify test2.hmac512 > /dev/null 2>&1
+EXIT_CODE=$?
+if [ $EXIT_CODE -eq 0 ]; then
+    echo -e "${GREEN}✓${NC} HMAC-SHA512 verification"
+    ((PASSED++))
+else
+    echo -e "${RED}✗${NC} HMAC-SHA512 verification - verification should have succeeded"
+    ((FAILED++))
+fi
+echo ""
+
 # ============================================
 # Итоги
 # ============================================
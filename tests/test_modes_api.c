@@ -0,0 +1,245 @@
+/*
+ * Тесты библиотечных функций режимов AES с буфером вызывающей стороны
+ * (*_into, *_inplace, aes_ctr_decrypt_range): CLI их не использует
+ * Сборка и запуск: make test-api && ./test_modes_api
+ */
+#include "../include/ecb.h"
+#include "../include/modes.h"
+#include "../include/aes_core.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define GREEN "\033[0;32m"
+#define RED "\033[0;31m"
+#define NC "\033[0m"
+
+static int g_passed = 0;
+static int g_failed = 0;
+
+static void check(int ok, const char* engine, const char* name, size_t len) {
+    if (ok) {
+        g_passed++;
+    } else {
+        printf(RED "✗" NC " [%s] %s (len %zu)\n", engine, name, len);
+        g_failed++;
+    }
+}
+
+static const unsigned char KEY[AES_128_KEY_SIZE] = {
+    0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6, 0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+static const unsigned char IV[AES_BLOCK_SIZE] = {
+    0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f
+};
+
+/* Длины вокруг границ блока и пакетов реализаций */
+static const size_t LENGTHS[] = { 0, 1, 15, 16, 17, 31, 32, 100, 255, 256, 4097 };
+#define NLENGTHS (sizeof(LENGTHS) / sizeof(LENGTHS[0]))
+#define MAX_LEN 4097
+
+typedef unsigned char* (*alloc_fn)(const unsigned char*, size_t, const unsigned char*, const unsigned char*, size_t*);
+typedef int (*into_fn)(const unsigned char*, size_t, const unsigned char*, const unsigned char*, unsigned char*);
+typedef int (*inplace_fn)(unsigned char*, size_t, const unsigned char*, const unsigned char*);
+
+/* Обертки ECB с той же сигнатурой, что и у режимов с IV */
+static unsigned char* ecb_encrypt_alloc(const unsigned char* in, size_t len, const unsigned char* key,
+                                        const unsigned char* iv, size_t* out_len) {
+    (void)iv;
+    return aes_ecb_encrypt(in, len, key, out_len);
+}
+
+static int ecb_encrypt_into(const unsigned char* in, size_t len, const unsigned char* key, const unsigned char* iv,
+                            unsigned char* out, size_t cap, size_t* out_len) {
+    (void)iv;
+    return aes_ecb_encrypt_into(in, len, key, out, cap, out_len);
+}
+
+static int ecb_encrypt_inplace(unsigned char* buf, size_t len, size_t cap, const unsigned char* key,
+                               const unsigned char* iv, size_t* out_len) {
+    (void)iv;
+    return aes_ecb_encrypt_inplace(buf, len, cap, key, out_len);
+}
+
+static int ecb_decrypt_into(const unsigned char* in, size_t len, const unsigned char* key, const unsigned char* iv,
+                            unsigned char* out, size_t cap, size_t* out_len) {
+    (void)iv;
+    return aes_ecb_decrypt_into(in, len, key, out, cap, out_len);
+}
+
+static int ecb_decrypt_inplace(unsigned char* buf, size_t len, const unsigned char* key,
+                               const unsigned char* iv, size_t* out_len) {
+    (void)iv;
+    return aes_ecb_decrypt_inplace(buf, len, key, out_len);
+}
+
+typedef struct {
+    const char* name;
+    alloc_fn encrypt_alloc;
+    int (*encrypt_into)(const unsigned char*, size_t, const unsigned char*, const unsigned char*,
+                        unsigned char*, size_t, size_t*);
+    int (*encrypt_inplace)(unsigned char*, size_t, size_t, const unsigned char*, const unsigned char*, size_t*);
+    int (*decrypt_into)(const unsigned char*, size_t, const unsigned char*, const unsigned char*,
+                        unsigned char*, size_t, size_t*);
+    int (*decrypt_inplace)(unsigned char*, size_t, const unsigned char*, const unsigned char*, size_t*);
+} padded_mode_t;
+
+typedef struct {
+    const char* name;
+    alloc_fn encrypt_alloc;
+    into_fn encrypt_into;
+    into_fn decrypt_into;
+    inplace_fn encrypt_inplace;
+    inplace_fn decrypt_inplace;
+} stream_mode_t;
+
+static const padded_mode_t PADDED_MODES[] = {
+    { "ECB", ecb_encrypt_alloc, ecb_encrypt_into, ecb_encrypt_inplace, ecb_decrypt_into, ecb_decrypt_inplace },
+    { "CBC", aes_cbc_encrypt, aes_cbc_encrypt_into, aes_cbc_encrypt_inplace, aes_cbc_decrypt_into, aes_cbc_decrypt_inplace },
+};
+
+static const stream_mode_t STREAM_MODES[] = {
+    { "CFB", aes_cfb_encrypt, aes_cfb_encrypt_into, aes_cfb_decrypt_into, aes_cfb_encrypt_inplace, aes_cfb_decrypt_inplace },
+    { "OFB", aes_ofb_encrypt, aes_ofb_encrypt_into, aes_ofb_decrypt_into, aes_ofb_encrypt_inplace, aes_ofb_decrypt_inplace },
+    { "CTR", aes_ctr_encrypt, aes_ctr_encrypt_into, aes_ctr_decrypt_into, aes_ctr_encrypt_inplace, aes_ctr_decrypt_inplace },
+};
+
+/**
+ * ECB/CBC: совпадение с выделяющей версией, работа на месте и отказ при малом буфере
+ */
+static void test_padded_mode(const padded_mode_t* m, const char* engine, const unsigned char* plain) {
+    unsigned char out[MAX_LEN + AES_BLOCK_SIZE];
+    unsigned char buf[MAX_LEN + AES_BLOCK_SIZE];
+    unsigned char dec[MAX_LEN + AES_BLOCK_SIZE];
+    char name[64];
+
+    for (size_t k = 0; k < NLENGTHS; k++) {
+        size_t len = LENGTHS[k], padded = AES_PKCS7_PADDED_SIZE(len), ref_len = 0, n = 0;
+        unsigned char* ref = m->encrypt_alloc(plain, len, KEY, IV, &ref_len);
+
+        snprintf(name, sizeof(name), "%s encrypt_into matches the allocating version", m->name);
+        int rc = m->encrypt_into(plain, len, KEY, IV, out, padded, &n);
+        check(ref && rc == 0 && n == padded && ref_len == padded && memcmp(out, ref, padded) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s encrypt_inplace matches the allocating version", m->name);
+        memcpy(buf, plain, len);
+        rc = m->encrypt_inplace(buf, len, padded, KEY, IV, &n);
+        check(ref && rc == 0 && n == padded && memcmp(buf, ref, padded) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s decrypt_into round trip", m->name);
+        rc = m->decrypt_into(out, padded, KEY, IV, dec, len, &n);
+        check(rc == 0 && n == len && memcmp(dec, plain, len) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s decrypt_inplace round trip", m->name);
+        rc = m->decrypt_inplace(buf, padded, KEY, IV, &n);
+        check(rc == 0 && n == len && memcmp(buf, plain, len) == 0, engine, name, len);
+
+        // Буфер на байт меньше нужного: ошибка, выход не тронут
+        snprintf(name, sizeof(name), "%s encrypt_into rejects a short buffer", m->name);
+        memset(buf, 0xa5, sizeof(buf));
+        rc = m->encrypt_into(plain, len, KEY, IV, buf, padded - 1, &n);
+        check(rc == -1 && buf[0] == 0xa5, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s encrypt_inplace rejects a short buffer", m->name);
+        memcpy(buf, plain, len);
+        rc = m->encrypt_inplace(buf, len, padded - 1, KEY, IV, &n);
+        check(rc == -1 && memcmp(buf, plain, len) == 0, engine, name, len);
+
+        if (len > 0) {
+            snprintf(name, sizeof(name), "%s decrypt_into rejects a short buffer", m->name);
+            memset(dec, 0xa5, sizeof(dec));
+            rc = m->decrypt_into(out, padded, KEY, IV, dec, len - 1, &n);
+            check(rc == -1 && dec[0] == 0xa5, engine, name, len);
+        }
+        free(ref);
+    }
+}
+
+/**
+ * CFB/OFB/CTR: совпадение с выделяющей версией и работа на месте
+ */
+static void test_stream_mode(const stream_mode_t* m, const char* engine, const unsigned char* plain) {
+    unsigned char out[MAX_LEN];
+    unsigned char buf[MAX_LEN];
+    unsigned char dec[MAX_LEN];
+    char name[64];
+
+    for (size_t k = 0; k < NLENGTHS; k++) {
+        size_t len = LENGTHS[k], ref_len = 0;
+        unsigned char* ref = m->encrypt_alloc(plain, len, KEY, IV, &ref_len);
+
+        snprintf(name, sizeof(name), "%s encrypt_into matches the allocating version", m->name);
+        int rc = m->encrypt_into(plain, len, KEY, IV, out);
+        check(ref && rc == 0 && ref_len == len && memcmp(out, ref, len) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s encrypt_inplace matches the allocating version", m->name);
+        memcpy(buf, plain, len);
+        rc = m->encrypt_inplace(buf, len, KEY, IV);
+        check(ref && rc == 0 && memcmp(buf, ref, len) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s decrypt_into round trip", m->name);
+        rc = m->decrypt_into(out, len, KEY, IV, dec);
+        check(rc == 0 && memcmp(dec, plain, len) == 0, engine, name, len);
+
+        snprintf(name, sizeof(name), "%s decrypt_inplace round trip", m->name);
+        rc = m->decrypt_inplace(buf, len, KEY, IV);
+        check(rc == 0 && memcmp(buf, plain, len) == 0, engine, name, len);
+        free(ref);
+    }
+}
+
+/**
+ * aes_ctr_decrypt_range: участок с любого смещения равен тому же участку полного дешифрования
+ */
+static void test_ctr_range(const char* engine, const unsigned char* plain) {
+    static const size_t OFFSETS[] = { 0, 1, 15, 16, 17, 100, 4000 };
+    unsigned char ct[MAX_LEN];
+    unsigned char part[MAX_LEN];
+
+    aes_ctr_encrypt_into(plain, MAX_LEN, KEY, IV, ct);
+    for (size_t i = 0; i < sizeof(OFFSETS) / sizeof(OFFSETS[0]); i++) {
+        size_t off = OFFSETS[i];
+        size_t lens[] = { 0, 1, 15, 16, 33, MAX_LEN - off };
+        for (size_t j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+            size_t len = lens[j];
+            if (off + len > MAX_LEN) {
+                continue;
+            }
+            memset(part, 0, sizeof(part));
+            int rc = aes_ctr_decrypt_range(ct + off, len, KEY, IV, off, part);
+            check(rc == 0 && memcmp(part, plain + off, len) == 0, engine, "CTR decrypt_range matches the full decryption", off);
+        }
+    }
+}
+
+int main(void) {
+    unsigned char plain[MAX_LEN];
+    unsigned int x = 12345;
+    for (size_t i = 0; i < MAX_LEN; i++) {
+        x = x * 1103515245u + 12345u;
+        plain[i] = (unsigned char)(x >> 16);
+    }
+
+    // Каждая доступная реализация AES проходит все проверки
+    for (int e = 0; e < AES_ENGINE_COUNT; e++) {
+        if (!aes_engine_available((aes_engine_t)e) || aes_engine_select((aes_engine_t)e) != 0) {
+            continue;
+        }
+        const char* engine = aes_engine_name((aes_engine_t)e);
+        int before = g_failed;
+        for (size_t i = 0; i < sizeof(PADDED_MODES) / sizeof(PADDED_MODES[0]); i++) {
+            test_padded_mode(&PADDED_MODES[i], engine, plain);
+        }
+        for (size_t i = 0; i < sizeof(STREAM_MODES) / sizeof(STREAM_MODES[0]); i++) {
+            test_stream_mode(&STREAM_MODES[i], engine, plain);
+        }
+        test_ctr_range(engine, plain);
+        if (g_failed == before) {
+            printf(GREEN "✓" NC " [%s] *_into, *_inplace and CTR range APIs\n", engine);
+        }
+    }
+
+    printf("Passed: %d\n", g_passed);
+    printf("Failed: %d\n", g_failed);
+    return g_failed == 0 ? 0 : 1;
+}
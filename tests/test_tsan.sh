@@ -0,0 +1,129 @@
+#!/bin/bash
+# Многопоточные режимы CryptoCore под ThreadSanitizer
+# Сборка: make tsan (создает cryptocore_tsan в корне проекта)
+
+# Цвета для вывода
+RED='\033[0;31m'
+GREEN='\033[0;32m'
+YELLOW='\033[1;33m'
+NC='\033[0m' # No Color
+
+SCRIPT_DIR="$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)"
+PROJECT_DIR="$(cd "$SCRIPT_DIR/.." && pwd)"
+
+CRYPTOCORE="$PROJECT_DIR/cryptocore_tsan"
+if [ ! -f "$CRYPTOCORE" ]; then
+    CRYPTOCORE="./cryptocore_tsan"
+fi
+if [ ! -f "$CRYPTOCORE" ]; then
+    echo "Error: cryptocore_tsan executable not found!"
+    echo "Please build it first: make tsan"
+    exit 1
+fi
+
+echo "Using cryptocore: $CRYPTOCORE"
+
+# Отчет о гонке завершает процесс с кодом 66
+export TSAN_OPTIONS="exitcode=66 halt_on_error=1"
+
+PASSED=0
+FAILED=0
+
+# Запуск команды под TSan: успех, если код возврата 0 и в stderr нет отчета о гонке
+run_tsan() {
+    local test_name="$1"
+    shift
+    if "$@" > /dev/null 2> tsan_stderr.txt && ! grep -q "ThreadSanitizer" tsan_stderr.txt; then
+        echo -e "${GREEN}✓${NC} $test_name"
+        ((PASSED++))
+        return 0
+    else
+        echo -e "${RED}✗${NC} $test_name"
+        grep -A12 "WARNING: ThreadSanitizer" tsan_stderr.txt | head -24
+        ((FAILED++))
+        return 1
+    fi
+}
+
+check_files_equal() {
+    local test_name="$1"
+    if cmp -s "$2" "$3" 2>/dev/null; then
+        echo -e "${GREEN}✓${NC} $test_name"
+        ((PASSED++))
+        return 0
+    else
+        echo -e "${RED}✗${NC} $test_name"
+        ((FAILED++))
+        return 1
+    fi
+}
+
+echo "=========================================="
+echo "  ThreadSanitizer Tests for CryptoCore"
+echo "=========================================="
+echo ""
+
+TEST_DIR=$(mktemp -d)
+trap "rm -rf $TEST_DIR" EXIT
+cd "$TEST_DIR"
+
+echo "Test directory: $TEST_DIR"
+echo ""
+
+KEY="000102030405060708090a0b0c0d0e0f"
+KEY256="000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+
+# Несколько мегабайт, чтобы задания пула действительно шли параллельно
+head -c 3145757 /dev/urandom > tsan_plain.bin 2>/dev/null
+
+echo "=== TSAN-1: Chunked AEAD containers ==="
+run_tsan "GCM container encrypt, 4 threads" \
+    $CRYPTOCORE --algorithm aes --mode gcm --encrypt --key "$KEY" --chunked --chunk-size 65536 --threads 4 \
+    --input tsan_plain.bin --output tsan_gcm.enc
+run_tsan "GCM container decrypt, 4 threads" \
+    $CRYPTOCORE --algorithm aes --mode gcm --decrypt --key "$KEY" --chunked --threads 4 \
+    --input tsan_gcm.enc --output tsan_gcm.dec
+check_files_equal "GCM container roundtrip" tsan_plain.bin tsan_gcm.dec
+run_tsan "ChaCha20-Poly1305 container encrypt, 4 threads" \
+    $CRYPTOCORE --algorithm chacha20 --encrypt --key "$KEY256" --chunked --chunk-size 65536 --threads 4 \
+    --input tsan_plain.bin --output tsan_cc.enc
+run_tsan "ChaCha20-Poly1305 container decrypt, 4 threads" \
+    $CRYPTOCORE --algorithm chacha20 --decrypt --key "$KEY256" --chunked --threads 4 \
+    --input tsan_cc.enc --output tsan_cc.dec
+check_files_equal "ChaCha20-Poly1305 container roundtrip" tsan_plain.bin tsan_cc.dec
+echo ""
+
+echo "=== TSAN-2: Parallel AES modes ==="
+for MODE in ecb cbc ctr; do
+    run_tsan "$MODE encrypt, 4 threads" \
+        $CRYPTOCORE --algorithm aes --mode $MODE --encrypt --key "$KEY" --threads 4 \
+        --input tsan_plain.bin --output tsan_$MODE.enc
+    run_tsan "$MODE decrypt, 4 threads" \
+        $CRYPTOCORE --algorithm aes --mode $MODE --decrypt --key "$KEY" --threads 4 \
+        --input tsan_$MODE.enc --output tsan_$MODE.dec
+    check_files_equal "$MODE roundtrip" tsan_plain.bin tsan_$MODE.dec
+done
+run_tsan "xts encrypt, 4 threads" \
+    $CRYPTOCORE --algorithm aes --mode xts --encrypt --key "$KEY256" --threads 4 \
+    --input tsan_plain.bin --output tsan_xts.enc
+echo ""
+
+echo "=== TSAN-3: Threaded hashes ==="
+run_tsan "BLAKE3, 4 threads" $CRYPTOCORE dgst --algorithm blake3 --threads 4 --input tsan_plain.bin
+run_tsan "ParallelHash256, 4 threads" $CRYPTOCORE dgst --algorithm parallelhash256 --threads 4 --input tsan_plain.bin
+echo ""
+
+# ============================================
+# Итоги
+# ============================================
+echo "=========================================="
+echo "  Test Results"
+echo "=========================================="
+echo -e "${GREEN}Passed: $PASSED${NC}"
+if [ $FAILED -gt 0 ]; then
+    echo -e "${RED}Failed: $FAILED${NC}"
+    exit 1
+else
+    echo -e "${GREEN}Failed: $FAILED${NC}"
+    exit 0
+fi